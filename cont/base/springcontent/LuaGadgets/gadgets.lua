@@ -1525,6 +1525,12 @@ function gadgetHandler:UnitDamaged(
   end
 end
 
+function gadgetHandler:UnitDamagedBatch(numEvents, events)
+  for _,g in r_ipairs(self.UnitDamagedBatchList) do
+    g:UnitDamagedBatch(numEvents, events)
+  end
+end
+
 function gadgetHandler:UnitStunned(unitID, unitDefID, unitTeam, stunned)
   for _,g in r_ipairs(self.UnitStunnedList) do
     g:UnitStunned(unitID, unitDefID, unitTeam, stunned)
@@ -1768,6 +1774,12 @@ function gadgetHandler:ProjectileCreated(proID, proOwnerID, proWeaponDefID)
   end
 end
 
+function gadgetHandler:ProjectileCreatedBatch(numEvents, events)
+  for _,g in r_ipairs(self.ProjectileCreatedBatchList) do
+    g:ProjectileCreatedBatch(numEvents, events)
+  end
+end
+
 function gadgetHandler:ProjectileDestroyed(proID)
   for _,g in r_ipairs(self.ProjectileDestroyedList) do
     g:ProjectileDestroyed(proID)
@@ -49,6 +49,7 @@ end
 --
 
 local fbiFiles = VFS.DirList('units/', '*.fbi', nil, true)
+VFS.PrefetchFiles(fbiFiles)
 
 
 for _, filename in ipairs(fbiFiles) do
@@ -73,6 +74,7 @@ end
 
 
 local luaFiles = VFS.DirList('units/', '*.lua', nil, true)
+VFS.PrefetchFiles(luaFiles)
 
 for _, filename in ipairs(luaFiles) do
   local udEnv = {}
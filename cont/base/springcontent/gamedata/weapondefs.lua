@@ -47,6 +47,7 @@ end
 --
 
 local tdfFiles = VFS.DirList('weapons/', '*.tdf', nil, true)
+VFS.PrefetchFiles(tdfFiles)
 
 for _, filename in ipairs(tdfFiles) do
   local wds, err = TDF.Parse(filename)
@@ -68,6 +69,7 @@ end
 --
 
 local luaFiles = VFS.DirList('weapons/', '*.lua', nil, true)
+VFS.PrefetchFiles(luaFiles)
 
 for _, filename in ipairs(luaFiles) do
   local wdEnv = {}
@@ -0,0 +1,223 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "DemoBatch.h"
+
+#include "Game/CommandMessage.h"
+#include "Game/Game.h"
+#include "Game/GameSetup.h"
+#include "Game/GlobalUnsynced.h"
+#include "Net/GameServer.h"
+#include "Net/Protocol/NetProtocol.h"
+#include "Sim/Misc/GlobalConstants.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/Team.h"
+#include "Sim/Misc/TeamHandler.h"
+#include "System/SpringMath.h"
+#include "System/StringUtil.h"
+#include "System/TdfParser.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/FileSystem.h"
+#include "System/Log/ILog.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "System/Misc/TracyDefs.h"
+
+CDemoBatch demoBatch;
+
+// how far the server is told to skip ahead of the sim
+static constexpr int SKIP_CHUNK_FRAMES = GAME_SPEED * 60;
+
+
+static std::string JsonString(const std::string& str)
+{
+	std::string ret = "\"";
+
+	for (const char c: str) {
+		switch (c) {
+			case '"' : { ret += "\\\""; } break;
+			case '\\': { ret += "\\\\"; } break;
+			case '\n': { ret += "\\n"; } break;
+			case '\r': { ret += "\\r"; } break;
+			case '\t': { ret += "\\t"; } break;
+			default  : {
+				// remaining control characters are not allowed verbatim
+				if (static_cast<unsigned char>(c) < 0x20) {
+					ret += IntToString(static_cast<unsigned char>(c), "\\u%04x");
+				} else {
+					ret += c;
+				}
+			} break;
+		}
+	}
+
+	return (ret + "\"");
+}
+
+static std::string JsonFloat(float f)
+{
+	// JSON has no representation of NaN or infinity
+	if (!math::isfinite(f))
+		return "null";
+
+	return (FloatToString(f, "%.9g"));
+}
+
+
+bool CDemoBatch::Init(const std::string& listFile, const std::string& outputDir_)
+{
+	std::ifstream file(listFile);
+
+	if (!file.is_open()) {
+		LOG_L(L_ERROR, "[DemoBatch::%s] can not open demo list \"%s\"", __func__, listFile.c_str());
+		return false;
+	}
+
+	demoFiles.clear();
+	demoIndex = 0;
+	skipFrame = 0;
+
+	outputDir = outputDir_;
+	FileSystem::EnsurePathSepAtEnd(outputDir);
+
+	for (std::string line; std::getline(file, line); ) {
+		StringTrimInPlace(line);
+
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		if (FileSystem::GetExtension(line) != "sdfz") {
+			LOG_L(L_WARNING, "[DemoBatch::%s] skipping \"%s\" (not a demo)", __func__, line.c_str());
+			continue;
+		}
+
+		demoFiles.emplace_back(std::move(line));
+	}
+
+	LOG("[DemoBatch::%s] replaying %u demos from \"%s\"", __func__, static_cast<unsigned>(demoFiles.size()), listFile.c_str());
+	return (!demoFiles.empty());
+}
+
+std::string CDemoBatch::GetStartScript() const
+{
+	TdfParser::TdfSection setup;
+	TdfParser::TdfSection* g = setup.construct_subsection("GAME");
+
+	g->add_name_value("DemoFile", GetDemoFile());
+	g->AddPair("IsHost", 1);
+
+	std::ostringstream str;
+	setup.print(str);
+	return str.str();
+}
+
+
+void CDemoBatch::Update()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+
+	if (!IsActive())
+		return;
+	if (game == nullptr || gameServer == nullptr || !game->playing)
+		return;
+	if (gu->globalReload || gu->globalQuit)
+		return;
+
+	// the server drops its reader after sending the last demo packet, so once the
+	// queue is empty everything has been simulated; same check as ClientReadNet
+	if (gameServer->GetDemoReader() == nullptr) {
+		if (clientNet->Peek(0) != nullptr)
+			return;
+
+		WriteStats();
+		NextDemo();
+		return;
+	}
+
+	SkipAhead();
+}
+
+void CDemoBatch::SkipAhead()
+{
+	// keep the queue filled with a bounded number of frames instead of
+	// handing the whole demo to the client at once
+	if ((skipFrame - gs->frameNum) > (SKIP_CHUNK_FRAMES / 2))
+		return;
+
+	skipFrame = std::max(skipFrame, gs->frameNum) + SKIP_CHUNK_FRAMES;
+
+	CommandMessage pckt("skip f" + IntToString(skipFrame), gu->myPlayerNum);
+	clientNet->Send(pckt.Pack());
+}
+
+void CDemoBatch::WriteStats() const
+{
+	// prefixed by the list position since demos in different directories may share a name
+	const std::string fileName = outputDir + IntToString(int(demoIndex), "%04i-") + FileSystem::GetBasename(GetDemoFile()) + ".json";
+	const std::string filePath = dataDirsAccess.LocateFile(fileName, FileQueryFlags::WRITE | FileQueryFlags::CREATE_DIRS);
+
+	std::ofstream file(filePath);
+
+	if (!file.is_open()) {
+		LOG_L(L_ERROR, "[DemoBatch::%s] can not write \"%s\"", __func__, filePath.c_str());
+		return;
+	}
+
+	// Gaia is not a player team and has no statistics worth reporting
+	const int numTeams = teamHandler.ActiveTeams() - int(gs->useLuaGaia);
+
+	file << "{\n";
+	file << "\t\"demo\": " << JsonString(GetDemoFile()) << ",\n";
+	file << "\t\"frames\": " << gs->frameNum << ",\n";
+	file << "\t\"teams\": [";
+
+	for (int i = 0; i < numTeams; ++i) {
+		const CTeam* team = teamHandler.Team(i);
+
+		file << ((i > 0)? ",": "") << "\n\t\t{\n";
+		file << "\t\t\t\"team\": " << team->teamNum << ",\n";
+		file << "\t\t\t\"allyTeam\": " << team->teamAllyteam << ",\n";
+		file << "\t\t\t\"stats\": [";
+
+		for (size_t j = 0, n = team->statHistory.size(); j < n; ++j) {
+			const TeamStatistics& s = team->statHistory[j];
+
+			file << ((j > 0)? ",": "") << "\n\t\t\t\t{";
+			file << "\"frame\": " << s.frame;
+			file << ", \"metalUsed\": " << JsonFloat(s.metalUsed) << ", \"energyUsed\": " << JsonFloat(s.energyUsed);
+			file << ", \"metalProduced\": " << JsonFloat(s.metalProduced) << ", \"energyProduced\": " << JsonFloat(s.energyProduced);
+			file << ", \"metalExcess\": " << JsonFloat(s.metalExcess) << ", \"energyExcess\": " << JsonFloat(s.energyExcess);
+			file << ", \"metalReceived\": " << JsonFloat(s.metalReceived) << ", \"energyReceived\": " << JsonFloat(s.energyReceived);
+			file << ", \"metalSent\": " << JsonFloat(s.metalSent) << ", \"energySent\": " << JsonFloat(s.energySent);
+			file << ", \"damageDealt\": " << JsonFloat(s.damageDealt) << ", \"damageReceived\": " << JsonFloat(s.damageReceived);
+			file << ", \"unitsProduced\": " << s.unitsProduced << ", \"unitsDied\": " << s.unitsDied;
+			file << ", \"unitsReceived\": " << s.unitsReceived << ", \"unitsSent\": " << s.unitsSent;
+			file << ", \"unitsCaptured\": " << s.unitsCaptured << ", \"unitsOutCaptured\": " << s.unitsOutCaptured;
+			file << ", \"unitsKilled\": " << s.unitsKilled;
+			file << "}";
+		}
+
+		file << "\n\t\t\t]\n\t\t}";
+	}
+
+	file << "\n\t]\n}\n";
+
+	LOG("[DemoBatch::%s] demo %u/%u \"%s\" done at frame %d, stats written to \"%s\"", __func__, static_cast<unsigned>(demoIndex + 1), static_cast<unsigned>(demoFiles.size()), GetDemoFile().c_str(), gs->frameNum, filePath.c_str());
+}
+
+void CDemoBatch::NextDemo()
+{
+	skipFrame = 0;
+
+	if (++demoIndex >= demoFiles.size()) {
+		gu->globalQuit = true;
+		return;
+	}
+
+	// copied out of gameSetup by SpringApp before it resets
+	gameSetup->reloadScript = GetStartScript();
+	gu->globalReload = true;
+}
@@ -0,0 +1,48 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef DEMO_BATCH_H
+#define DEMO_BATCH_H
+
+#include <string>
+#include <vector>
+
+/**
+ * Replays a list of demos back to back in one process (--batch-demos) and
+ * writes the team statistics of each one as JSON. Demos are fed to the sim
+ * by skipping ahead, so it runs as fast as it can; every demo after the first
+ * is started through the regular reload path, which keeps the archive scanner
+ * and VFS around. While a batch is active CGame::LoadDefs always goes through
+ * the defs snapshot cache, so demos sharing game, map and setup do not run
+ * the def scripts again. Demos are replayed sequentially.
+ */
+class CDemoBatch
+{
+public:
+	bool Init(const std::string& listFile, const std::string& outputDir);
+
+	bool IsActive() const { return (demoIndex < demoFiles.size()); }
+
+	const std::string& GetDemoFile() const { return demoFiles[demoIndex]; }
+	std::string GetStartScript() const;
+
+	/// called by CGame after reading the net-queue
+	void Update();
+
+private:
+	void SkipAhead();
+	void WriteStats() const;
+	void NextDemo();
+
+private:
+	std::vector<std::string> demoFiles;
+	std::string outputDir;
+
+	size_t demoIndex = 0;
+
+	/// frame the server was last told to skip to
+	int skipFrame = 0;
+};
+
+extern CDemoBatch demoBatch;
+
+#endif // DEMO_BATCH_H
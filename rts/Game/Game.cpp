@@ -10,8 +10,10 @@
 #include "ChatMessage.h"
 #include "CommandMessage.h"
 #include "ConsoleHistory.h"
+#include "DemoBatch.h"
 #include "GameHelper.h"
 #include "GameSetup.h"
+#include "GameVersion.h"
 #include "GlobalUnsynced.h"
 #include "LoadScreen.h"
 #include "SelectedUnitsHandler.h"
@@ -74,6 +76,7 @@
 #include "Sim/Misc/DamageArrayHandler.h"
 #include "Sim/Misc/YardmapStatusEffectsMap.h"
 #include "Sim/Misc/GeometricObjects.h"
+#include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/GroundBlockingObjectMap.h"
 #include "Sim/Misc/BuildingMaskMap.h"
 #include "Sim/Misc/LosHandler.h"
@@ -119,6 +122,9 @@
 #include "System/SafeUtil.h"
 #include "System/SpringExitCode.h"
 #include "System/SpringMath.h"
+#include "System/FileSystem/ArchiveScanner.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/LoadSave/LoadSaveHandler.h"
 #include "System/LoadSave/DemoRecorder.h"
@@ -130,6 +136,7 @@
 #include "System/Sound/ISoundChannels.h"
 #include "System/Sync/DumpState.h"
 #include "System/TimeProfiler.h"
+#include "System/Threading/TaskGraph.h"
 #include "System/LoadLock.h"
 
 #include "System/Misc/TracyDefs.h"
@@ -147,6 +154,9 @@ CONFIG(int, ShowPlayerInfo).defaultValue(1).headlessValue(0);
 CONFIG(float, GuiOpacity).defaultValue(0.8f).minimumValue(0.0f).maximumValue(1.0f).description("Sets the opacity of the built-in Spring UI. Generally has no effect on LuaUI widgets. Can be set in-game using shift+, to decrease and shift+. to increase.");
 CONFIG(std::string, InputTextGeo).defaultValue("");
 
+CONFIG(bool, DefsSnapshotCache).defaultValue(false).safemodeValue(false).description("Store the table returned by gamedata/defs.lua in the cache directory and reuse it on later loads of the same game, map and setup instead of running the def scripts again.");
+CONFIG(bool, SimFrameTaskGraph).defaultValue(false).safemodeValue(false).description("Run the independent stages of each simulation frame concurrently on worker threads where their declared data accesses allow it.");
+
 CONFIG(int, SmoothTimeOffset).defaultValue(0).headlessValue(0).description("Enables frametimeoffset smoothing, 0 = off (old version), -1 = forced 0.5,  1-20 smooth, recommended = 2-3");
 
 CGame* game = nullptr;
@@ -249,6 +259,7 @@ CGame::CGame(const std::string& mapFileName, const std::string& modFileName, ILo
 	showSpeed = configHandler->GetBool("ShowSpeed");
 
 	speedControl = configHandler->GetInt("SpeedControl");
+	simFrameTaskGraph = configHandler->GetBool("SimFrameTaskGraph");
 
 	playerRoster.SetSortTypeByCode((PlayerRoster::SortType)configHandler->GetInt("ShowPlayerInfo"));
 
@@ -556,6 +567,74 @@ void CGame::LoadMap(const std::string& mapFileName)
 }
 
 
+// everything the defs environment exposes besides the VFS and Game constants
+static sha512::raw_digest CalcDefsSnapshotKey()
+{
+	std::string keyData;
+
+	const auto AddString = [&](const std::string& str) { keyData.append(str); keyData.push_back('\0'); };
+	const auto AddInt = [&](std::int64_t num) { keyData.append(reinterpret_cast<const char*>(&num), sizeof(num)); };
+	const auto AddBool = [&](bool b) { keyData.push_back(char(b)); };
+	const auto AddFloat = [&](float num) { keyData.append(reinterpret_cast<const char*>(&num), sizeof(num)); };
+	const auto AddDigest = [&](const sha512::raw_digest& dig) { keyData.append(reinterpret_cast<const char*>(dig.data()), dig.size()); };
+	const auto AddMap = [&](const spring::unordered_map<std::string, std::string>& map) {
+		std::vector< std::pair<std::string, std::string> > pairs(map.begin(), map.end());
+		std::sort(pairs.begin(), pairs.end());
+
+		AddInt(pairs.size());
+
+		for (const auto& pair: pairs) {
+			AddString(pair.first);
+			AddString(pair.second);
+		}
+	};
+
+	AddString(SpringVersion::GetSync());
+	AddDigest(archiveScanner->GetArchiveCompleteChecksumBytes(gameSetup->modName));
+	AddDigest(archiveScanner->GetArchiveCompleteChecksumBytes(gameSetup->mapName));
+	AddMap(gameSetup->GetModOptionsCont());
+	AddMap(gameSetup->GetMapOptionsCont());
+
+	for (const PlayerBase& player: gameSetup->GetPlayerStartingDataCont()) {
+		AddInt(player.team);
+		AddBool(player.spectator);
+	}
+	for (const TeamBase& team: gameSetup->GetTeamStartingDataCont()) {
+		AddInt(team.GetLeader());
+		AddInt(team.teamAllyteam);
+		AddFloat(team.GetIncomeMultiplier());
+		AddString(team.GetSideName());
+		AddMap(team.GetAllValues());
+	}
+	for (const AllyTeam& allyTeam: gameSetup->GetAllyStartingDataCont()) {
+		AddMap(allyTeam.GetAllValues());
+	}
+	for (const SkirmishAIData& aiData: gameSetup->GetAIStartingDataCont()) {
+		AddInt(aiData.team);
+		AddInt(aiData.hostPlayer);
+		AddString(aiData.name);
+		AddString(aiData.shortName);
+		AddString(aiData.version);
+		AddMap(aiData.options);
+	}
+
+	sha512::raw_digest key;
+	sha512::calc_digest(reinterpret_cast<const uint8_t*>(keyData.data()), keyData.size(), key.data());
+	return key;
+}
+
+static std::string GetDefsSnapshotFilePath(const sha512::raw_digest& key)
+{
+	sha512::hex_digest hexKey;
+	sha512::dump_digest(key, hexKey);
+
+	const std::string sep(1, FileSystem::GetNativePathSeparator());
+	const std::string dir = FileSystem::GetCacheDir() + sep + "defs" + sep;
+
+	return (dataDirsAccess.LocateDir(dir, FileQueryFlags::WRITE | FileQueryFlags::CREATE_DIRS) + hexKey.data() + ".dat");
+}
+
+
 void CGame::LoadDefs(LuaParser* defsParser)
 {
 	ENTER_SYNCED_CODE();
@@ -589,9 +668,24 @@ void CGame::LoadDefs(LuaParser* defsParser)
 		defsParser->EndTable();
 		#undef LSR_ADDFUNC
 
-		// run the parser
-		if (!defsParser->Execute())
-			throw content_error("Defs-Parser: " + defsParser->GetErrorLog());
+		// batch replays always reuse the defs of earlier demos with the same game, map and setup
+		const bool useSnapshot = configHandler->GetBool("DefsSnapshotCache") || demoBatch.IsActive();
+		const sha512::raw_digest snapshotKey = useSnapshot? CalcDefsSnapshotKey(): sha512::raw_digest{};
+		const std::string snapshotFile = useSnapshot? GetDefsSnapshotFilePath(snapshotKey): "";
+
+		if (!useSnapshot || !defsParser->ReadSnapshot(snapshotFile, snapshotKey)) {
+			const auto rngState = gsRNG.GetGenState();
+
+			// run the parser
+			if (!defsParser->Execute())
+				throw content_error("Defs-Parser: " + defsParser->GetErrorLog());
+
+			// defs drawing synced random numbers differ from game to game
+			if (useSnapshot && gsRNG.GetGenState() == rngState)
+				defsParser->WriteSnapshot(snapshotFile, snapshotKey);
+		} else {
+			LOG("[Game::%s] loaded gamedata definitions from \"%s\"", __func__, snapshotFile.c_str());
+		}
 
 		const LuaTable& root = defsParser->GetRoot();
 
@@ -650,7 +744,7 @@ void CGame::PreLoadSimulation(LuaParser* defsParser)
 
 	loadscreen->SetLoadMessage("Creating QuadField & CEGs");
 	moveDefHandler.Init(defsParser);
-	quadField.Init(int2(mapDims.mapx, mapDims.mapy), modInfo.quadFieldQuadSizeInElmos);
+	quadField.Init(int2(mapDims.mapx, mapDims.mapy), modInfo.quadFieldQuadSizeInElmos, modInfo.quadFieldFlatStorage);
 	damageArrayHandler.Init(defsParser);
 	explGenHandler.Init();
 }
@@ -1245,6 +1339,8 @@ bool CGame::Update()
 
 	LEAVE_SYNCED_CODE();
 
+	demoBatch.Update();
+
 	{
 		SLuaAllocError error = {};
 
@@ -1732,6 +1828,64 @@ void CGame::StartPlaying()
 
 static const char* const tracingSimFrameName = "SimFrame";
 
+enum SimResource: CTaskGraph::ResourceMask {
+	SIM_HEIGHTMAP    = 1 << 0, // synced heightmap, read-only outside of mapDamage and Lua
+	SIM_HEIGHTBOUNDS = 1 << 1, // readMap height bounds and hmUpdated
+	SIM_SMOOTHMESH   = 1 << 2,
+	SIM_UNITS        = 1 << 3,
+	SIM_PATHING      = 1 << 4,
+	SIM_QUADFIELD    = 1 << 5,
+	SIM_LOS          = 1 << 6,
+	SIM_GHOSTS       = 1 << 7,
+
+	// anything that can raise a callin must assume Lua touches everything
+	SIM_ALL          = ~CTaskGraph::ResourceMask(0),
+};
+
+/**
+ * Stages of SimFrame in their reference order. Most of them either run Lua
+ * callins or reach state that Lua can modify and therefore act as barriers;
+ * what is left to overlap is the height-bounds update (on a worker) with the
+ * smooth-mesh update (on the main thread, which parallelizes it internally).
+ */
+static void AddSimFrameStages(CTaskGraph& graph)
+{
+	graph.AddStage("Helper", SIM_ALL, SIM_ALL, true, []() { helper->Update(); });
+	graph.AddStage("ReadMap", SIM_HEIGHTMAP, SIM_HEIGHTBOUNDS, false, []() { readMap->Update(); });
+	graph.AddStage("SmoothGround", SIM_HEIGHTMAP, SIM_SMOOTHMESH, true, []() { smoothGround.UpdateSmoothMesh(); });
+	graph.AddStage("MapDamage", SIM_ALL, SIM_ALL, true, []() { mapDamage->Update(); SYNC_SUBSYSTEM_DONE(SUBSYS_GAMEFRAME); });
+	graph.AddStage("Units", SIM_ALL, SIM_ALL, true, []() { unitHandler.Update(); SYNC_SUBSYSTEM_DONE(SUBSYS_UNITS); });
+	graph.AddStage("Pathing", SIM_ALL, SIM_PATHING, true, []() { pathManager->Update(); SYNC_SUBSYSTEM_DONE(SUBSYS_PATHING); });
+	graph.AddStage("Projectiles", SIM_ALL, SIM_ALL, true, []() { projectileHandler.Update(); SYNC_SUBSYSTEM_DONE(SUBSYS_PROJECTILES); });
+	graph.AddStage("Features", SIM_ALL, SIM_ALL, true, []() { featureHandler.Update(); SYNC_SUBSYSTEM_DONE(SUBSYS_FEATURES); });
+	graph.AddStage("QuadField", SIM_UNITS, SIM_QUADFIELD, true, []() { quadField.Update(); });
+	graph.AddStage("Script", SIM_ALL, SIM_ALL, true, []() {
+		/* The default GAME_SPEED is 30, which doesn't divide 1000 well,
+		 * so scripts will perceive 990ms per second. But this is fine,
+		 * since doing "29th February" style of extra counting would be
+		 * disruptive to sleeps that assume a constant tick length while
+		 * not being otherwise perceptible since most animations don't
+		 * run that long. */
+		static constexpr int tickMs = 1000 / GAME_SPEED;
+
+		SCOPED_TIMER("Sim::Script");
+		unitScriptEngine->Tick(tickMs);
+		SYNC_SUBSYSTEM_DONE(SUBSYS_SCRIPTS);
+	});
+	graph.AddStage("EnvResources", SIM_ALL, SIM_ALL, true, []() { envResHandler.Update(); });
+	graph.AddStage("Los", SIM_UNITS, SIM_LOS, true, []() { losHandler->Update(); SYNC_SUBSYSTEM_DONE(SUBSYS_LOS); });
+	// dead ghosts have to be updated in sim, after los,
+	// to make sure they represent the current knowledge correctly.
+	// should probably be split from drawer
+	graph.AddStage("Ghosts", SIM_LOS, SIM_ALL, true, []() { CUnitDrawer::UpdateGhostedBuildings(); });
+	graph.AddStage("Intercepts", SIM_ALL, SIM_ALL, true, []() { interceptHandler.Update(false); });
+
+	graph.AddStage("Teams", SIM_ALL, SIM_ALL, true, []() { teamHandler.GameFrame(gs->frameNum); });
+	graph.AddStage("Players", SIM_ALL, SIM_ALL, true, []() { playerHandler.GameFrame(gs->frameNum); });
+	graph.AddStage("BatchedEvents", SIM_ALL, SIM_ALL, true, []() { eventHandler.DeliverBatchedEvents(); });
+	graph.AddStage("GameFramePost", SIM_ALL, SIM_ALL, true, []() { eventHandler.GameFramePost(gs->frameNum); });
+}
+
 void CGame::SimFrame() {
 	ENTER_SYNCED_CODE();
 	ASSERT_SYNCED(gsRNG.GetGenState());
@@ -1808,37 +1962,12 @@ void CGame::SimFrame() {
 			eventHandler.GameFrame(gs->frameNum);
 		}
 
-		helper->Update();
-		readMap->Update();
-		smoothGround.UpdateSmoothMesh();
-		mapDamage->Update();
-		unitHandler.Update();
-		pathManager->Update();
-		projectileHandler.Update();
-		featureHandler.Update();
-		{
-			/* The default GAME_SPEED is 30, which doesn't divide 1000 well,
-			 * so scripts will perceive 990ms per second. But this is fine,
-			 * since doing "29th February" style of extra counting would be
-			 * disruptive to sleeps that assume a constant tick length while
-			 * not being otherwise perceptible since most animations don't
-			 * run that long. */
-			static constexpr int tickMs = 1000 / GAME_SPEED;
-
-			SCOPED_TIMER("Sim::Script");
-			unitScriptEngine->Tick(tickMs);
-		}
-		envResHandler.Update();
-		losHandler->Update();
-		// dead ghosts have to be updated in sim, after los,
-		// to make sure they represent the current knowledge correctly.
-		// should probably be split from drawer
-		CUnitDrawer::UpdateGhostedBuildings();
-		interceptHandler.Update(false);
+		static CTaskGraph simGraph;
 
-		teamHandler.GameFrame(gs->frameNum);
-		playerHandler.GameFrame(gs->frameNum);
-		eventHandler.GameFramePost(gs->frameNum);
+		if (simGraph.Empty())
+			AddSimFrameStages(simGraph);
+
+		simGraph.Execute(simFrameTaskGraph);
 	}
 
 	lastSimFrameTime = spring_gettime();
@@ -1865,6 +1994,10 @@ void CGame::SimFrame() {
 	// useful for desync-debugging (enter instead of -1 start & end frame of the range you want to debug)
 	DumpState(-1, -1, 1, std::nullopt);
 
+#ifdef SYNCCHECK
+	CSyncChecker::EndFrame(gs->frameNum, gsRNG.GetGenState());
+#endif
+
 	ASSERT_SYNCED(gsRNG.GetGenState());
 	LEAVE_SYNCED_CODE();
 }
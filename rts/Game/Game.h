@@ -210,6 +210,9 @@ public:
 	// 0 := 1/f rate, 1 := 30/s rate
 	int luaGCControl = 0;
 
+	// overlap independent SimFrame stages, see CTaskGraph
+	bool simFrameTaskGraph = false;
+
 private:
 	JobDispatcher jobDispatcher;
 
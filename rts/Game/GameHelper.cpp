@@ -40,6 +40,7 @@
 #include "System/EventHandler.h"
 #include "System/SpringMath.h"
 #include "System/Sound/ISoundChannels.h"
+#include "System/Threading/ThreadPool.h"
 
 #include "System/Misc/TracyDefs.h"
 
@@ -655,53 +656,173 @@ namespace {
 
 
 
-size_t CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets)
-{
-	const CUnit*  weaponOwner = weapon->owner;
-	const CUnit* lastAttacker = ((weaponOwner->lastAttackFrame + 200) <= gs->frameNum) ? weaponOwner->lastAttacker : nullptr;
-
-	const      WeaponDef* weaponDef = weapon->weaponDef;
-	const DynDamageArray* weaponDmg = weapon->damages;
+namespace {
+	// per-weapon inputs to the target priority calculation
+	struct WeaponTargetParams {
+		WeaponTargetParams(const CWeapon* w): weapon(w) {
+			const CUnit* weaponOwner = weapon->owner;
+			const DynDamageArray* weaponDmg = weapon->damages;
+
+			owner = weaponOwner;
+			lastAttacker = ((weaponOwner->lastAttackFrame + 200) <= gs->frameNum) ? weaponOwner->lastAttacker : nullptr;
+			weaponDef = weapon->weaponDef;
+
+			ownerPos = weaponOwner->pos;
+			worldMainDir = weapon->weaponDir;
+
+			aimPosHeight = weapon->aimFromPos.y;
+			// how much damage the weapon deals over 1 second
+			secDamage = weaponDmg->GetDefault() * weapon->salvoSize / weapon->reloadTime * GAME_SPEED;
+			heightMod = weaponDef->heightmod;
+			weaponAimAdjustPriority = weapon->weaponAimAdjustPriority;
+
+			baseRange = weapon->range;
+			rangeBoost = weapon->autoTargetRangeBoost;
+			// find theoretical maximum range based on height above lowest point on map
+			// scanRadius = weapon->GetRange2D(rangeBoost, (minMapHeight - aimPosHeight) * heightMod);
+			scanRadius = baseRange + rangeBoost + (aimPosHeight - std::max(0.0f, readMap->GetCurrMinHeight())) * heightMod;
+
+			paralyzer = (weaponDmg->paralyzeDamageTime != 0);
+		}
 
-	const float3& ownerPos = weaponOwner->pos;
-	const float3 testPos;
+		const CWeapon* weapon;
+		const CUnit* owner;
+		const CUnit* lastAttacker;
+		const WeaponDef* weaponDef;
 
-	const float aimPosHeight = weapon->aimFromPos.y;
-	const float minMapHeight = std::max(0.0f, readMap->GetCurrMinHeight());
+		float3 ownerPos;
+		float3 worldMainDir;
 
-	// how much damage the weapon deals over 1 second
-	const float secDamage = weaponDmg->GetDefault() * weapon->salvoSize / weapon->reloadTime * GAME_SPEED;
-	const float heightMod = weaponDef->heightmod;
+		float aimPosHeight;
+		float secDamage;
+		float heightMod;
+		float weaponAimAdjustPriority;
 
-	const float3 worldMainDir = weapon->weaponDir;
-	const float weaponAimAdjustPriority = weapon->weaponAimAdjustPriority;
+		float baseRange;
+		float rangeBoost;
+		float scanRadius;
 
-	const float  baseRange = weapon->range;
-	const float rangeBoost = weapon->autoTargetRangeBoost;
-	// find theoretical maximum range based on height above lowest point on map
-	// const float scanRadius = weapon->GetRange2D(rangeBoost, (minMapHeight - aimPosHeight) * heightMod);
-	const float scanRadius = baseRange + rangeBoost + (aimPosHeight - minMapHeight) * heightMod;
+		bool paralyzer;
+	};
 
 	// [0] := default, [1,2,3,4,5,6] := target is {avoidee, in bad category, crashing, last attacker, paralyzed, outside unboosted range}
 	constexpr float tgtPriorityMults[] = {1.0f, 10.0f, 100.0f, 1000.0f, 0.5f, 4.0f, 100000.0f};
 
-	const bool paralyzer = (weaponDmg->paralyzeDamageTime != 0);
+	// Calculates the part of the priority that only reads simulation state, returns
+	// false if <targetUnit> can not be engaged. Safe to call from worker threads.
+	bool CalcBaseTargetPriority(const WeaponTargetParams& wtp, const CUnit* avoidUnit, CUnit* targetUnit, unsigned short& targetLOSState, float& targetPriority)
+	{
+		const CWeapon* weapon = wtp.weapon;
+		const float3 testPos;
+
+		if (!weapon->TestTarget(testPos, SWeaponTarget(targetUnit)))
+			return false;
+
+		float3 targetPos;
+
+		targetLOSState = targetUnit->losStatus[wtp.owner->allyteam];
+		targetPriority = tgtPriorityMults[(targetUnit == avoidUnit) * 1];
+
+		if (targetLOSState & LOS_INLOS) {
+			targetPos = targetUnit->aimPos;
+		} else if (targetLOSState & LOS_INRADAR) {
+			targetPos = weapon->GetUnitPositionWithError(targetUnit);
+			targetPriority *= tgtPriorityMults[1];
+		} else {
+			return false;
+		}
+
+		const float modRange = weapon->GetRange2D(wtp.rangeBoost, (targetPos.y - wtp.aimPosHeight) * wtp.heightMod);
+		const float sqDist2D = wtp.ownerPos.SqDistance2D(targetPos);
+
+		if (sqDist2D > Square(modRange))
+			return false;
+
+		const float3 worldTargetDir = (targetPos - wtp.ownerPos).SafeNormalize();
+		const float angleOffset =  (1.f - wtp.worldMainDir.dot(worldTargetDir));
+		const float angleMod = angleOffset * wtp.weaponAimAdjustPriority + 1.f;
+
+		// Strengthen focus towards the front, desire should weaken quadratically rather
+		// than linearly otherwise target distance can too easily cause units to choose a
+		// target that requires turning around to fire at.
+		const float angleMul = angleMod*angleMod;
+
+		const float dist2D = math::sqrt(sqDist2D);
+		const float rangeMul = (dist2D * wtp.weaponDef->proximityPriority + modRange * 0.4f + 100.0f);
+
+		targetPriority *= angleMul;
+		targetPriority *= rangeMul;
+		targetPriority *= tgtPriorityMults[(dist2D > wtp.baseRange) * 6];
+
+		if (targetLOSState & LOS_INLOS) {
+			targetPriority *= (wtp.secDamage + targetUnit->health);
+
+			if (wtp.paralyzer && targetUnit->paralyzeDamage > (modInfo.paralyzeOnMaxHealth? targetUnit->maxHealth: targetUnit->health))
+				targetPriority *= tgtPriorityMults[5];
+		} else {
+			targetPriority *= (wtp.secDamage + 10000.0f);
+		}
+
+		return true;
+	}
+
+	// Applies the remaining priority modifiers; TargetWeight calls into the unit script
+	// so this must run on the main thread.
+	float CalcFinalTargetPriority(const WeaponTargetParams& wtp, const CUnit* targetUnit, unsigned short targetLOSState, float targetPriority)
+	{
+		const CWeapon* weapon = wtp.weapon;
+
+		if ((targetLOSState & LOS_INLOS) && weapon->hasTargetWeight)
+			targetPriority *= weapon->TargetWeight(targetUnit);
+
+		if (targetLOSState & LOS_PREVLOS) {
+			const float damageMul = std::max(0.0001f, weapon->damages->Get(targetUnit->armorType) * targetUnit->curArmorMultiple);
+
+			targetPriority /= (damageMul * targetUnit->power);
+			targetPriority *= tgtPriorityMults[((targetUnit->category & weapon->badTargetCategory) != 0) * 2];
+			targetPriority *= tgtPriorityMults[(targetUnit->IsCrashing()) * 3];
+			targetPriority *= tgtPriorityMults[(targetUnit == wtp.lastAttacker) * 4];
+		}
+
+		return targetPriority;
+	}
+
+	void SortWeaponTargets(std::vector<std::pair<float, CUnit*>>& targets)
+	{
+		std::stable_sort(targets.begin(), targets.end(), [](const std::pair<float, CUnit*>& a, const std::pair<float, CUnit*>& b) { return (a.first < b.first); });
+	}
+} // end of namespace
+
+
+
+size_t CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets)
+{
+	const WeaponTargetParams wtp(weapon);
 
 	// copy on purpose since the below calls lua
 	QuadFieldQuery qfQuery;
-	quadField.GetQuads(qfQuery, ownerPos, scanRadius);
+	quadField.GetQuads(qfQuery, wtp.ownerPos, wtp.scanRadius);
 
 	targets.clear();
 	targets.reserve(32);
 
 	const int tempNum = gs->GetTempNum();
 
+	// AllowWeaponTarget lets Lua move units anywhere, and with flat storage that
+	// can relocate every cell of the array; iterate a copy of the quad instead
+	std::vector<CUnit*> quadUnits;
+
 	for (int t = 0; t < teamHandler.ActiveAllyTeams(); ++t) {
-		if (teamHandler.Ally(weaponOwner->allyteam, t))
+		if (teamHandler.Ally(wtp.owner->allyteam, t))
 			continue;
 
 		for (const int qi: *qfQuery.quads) {
-			const std::vector<CUnit*>& allyTeamUnits = quadField.GetQuad(qi).teamUnits[t];
+			std::span<CUnit* const> allyTeamUnits = quadField.GetQuad(qi).teamUnits[t];
+
+			if (quadField.UsingFlatStorage()) {
+				quadUnits.assign(allyTeamUnits.begin(), allyTeamUnits.end());
+				allyTeamUnits = quadUnits;
+			}
 
 			for (CUnit* targetUnit: allyTeamUnits) {
 				if (targetUnit->tempNum == tempNum)
@@ -709,80 +830,159 @@ size_t CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* av
 
 				targetUnit->tempNum = tempNum;
 
-				if (!weapon->TestTarget(testPos, SWeaponTarget(targetUnit)))
+				unsigned short targetLOSState = 0;
+				float targetPriority = 0.0f;
+
+				if (!CalcBaseTargetPriority(wtp, avoidUnit, targetUnit, targetLOSState, targetPriority))
 					continue;
 
-				const unsigned short targetLOSState = targetUnit->losStatus[weaponOwner->allyteam];
+				targetPriority = CalcFinalTargetPriority(wtp, targetUnit, targetLOSState, targetPriority);
 
-				float targetPriority = tgtPriorityMults[(targetUnit == avoidUnit) * 1];
-				float3 targetPos;
+				const bool allowTarget = eventHandler.AllowWeaponTarget(wtp.owner->id, targetUnit->id, weapon->weaponNum, wtp.weaponDef->id, &targetPriority);
 
-				if (targetLOSState & LOS_INLOS) {
-					targetPos = targetUnit->aimPos;
-				} else if (targetLOSState & LOS_INRADAR) {
-					targetPos = weapon->GetUnitPositionWithError(targetUnit);
-					targetPriority *= tgtPriorityMults[1];
-				} else {
+				// Lua call may have changed tempNum, so needs to be set again
+				targetUnit->tempNum = tempNum;
+
+				if (!allowTarget)
 					continue;
-				}
 
-				const float modRange = weapon->GetRange2D(rangeBoost, (targetPos.y - aimPosHeight) * heightMod);
-				const float sqDist2D = ownerPos.SqDistance2D(targetPos);
+				targets.emplace_back(targetPriority, targetUnit);
+			}
+		}
+	}
 
-				if (sqDist2D > Square(modRange))
-					continue;
+	SortWeaponTargets(targets);
+	return (targets.size());
+}
 
-				const float3 worldTargetDir = (targetPos - ownerPos).SafeNormalize();
-				const float angleOffset =  (1.f - worldMainDir.dot(worldTargetDir));
-				const float angleMod = angleOffset * weaponAimAdjustPriority + 1.f;
 
-				// Strengthen focus towards the front, desire should weaken quadratically rather
-				// than linearly otherwise target distance can too easily cause units to choose a
-				// target that requires turning around to fire at.
-				const float angleMul = angleMod*angleMod;
+void CGameHelper::PrepareWeaponTargets(const std::vector<CUnit*>& units, size_t idxBeg, size_t idxEnd)
+{
+	ZoneScoped;
+	ClearPreparedWeaponTargets();
 
-				const float dist2D = math::sqrt(sqDist2D);
-				const float rangeMul = (dist2D * weaponDef->proximityPriority + modRange * 0.4f + 100.0f);
-				const float damageMul = std::max(0.0001f, weaponDmg->Get(targetUnit->armorType) * targetUnit->curArmorMultiple);
+	if (!modInfo.weaponTargetAcquisitionMT)
+		return;
 
-				targetPriority *= angleMul;
-				targetPriority *= rangeMul;
-				targetPriority *= tgtPriorityMults[(dist2D > baseRange) * 6];
+	numPreparedTargets = 0;
+	preparedTargetUnits.resize(unitHandler.MaxUnits(), -1);
 
-				if (targetLOSState & LOS_INLOS) {
-					targetPriority *= (secDamage + targetUnit->health);
+	// reserve one slot per weapon so lookups are a plain offset from the owner's first slot
+	for (size_t i = idxBeg; i < idxEnd; ++i) {
+		const CUnit* unit = units[i];
 
-					if (paralyzer && targetUnit->paralyzeDamage > (modInfo.paralyzeOnMaxHealth? targetUnit->maxHealth: targetUnit->health))
-						targetPriority *= tgtPriorityMults[5];
+		if (!unit->CanUpdateWeapons())
+			continue;
 
-					if (weapon->hasTargetWeight)
-						targetPriority *= weapon->TargetWeight(targetUnit);
+		preparedTargetUnits[unit->id] = numPreparedTargets;
 
-				} else {
-					targetPriority *= (secDamage + 10000.0f);
-				}
+		for (const CWeapon* w: unit->weapons) {
+			if (numPreparedTargets >= preparedTargets.size())
+				preparedTargets.emplace_back();
 
-				if (targetLOSState & LOS_PREVLOS) {
-					targetPriority /= (damageMul * targetUnit->power);
-					targetPriority *= tgtPriorityMults[((targetUnit->category & weapon->badTargetCategory) != 0) * 2];
-					targetPriority *= tgtPriorityMults[(targetUnit->IsCrashing()) * 3];
-					targetPriority *= tgtPriorityMults[(targetUnit == lastAttacker) * 4];
-				}
+			PreparedWeaponTargets& pwt = preparedTargets[numPreparedTargets++];
 
-				const bool allowTarget = eventHandler.AllowWeaponTarget(weaponOwner->id, targetUnit->id, weapon->weaponNum, weaponDef->id, &targetPriority);
+			pwt.weapon = w;
+			pwt.avoidUnit = (w->avoidTarget && w->HaveUnitTarget()) ? w->GetCurrentTarget().unit : nullptr;
+			pwt.candidates.clear();
 
-				// Lua call may have changed tempNum, so needs to be set again
-				targetUnit->tempNum = tempNum;
+			// conservative subset of AllowWeaponAutoTarget that does not involve Lua,
+			// weapons that fail it (or whose state changes) use the serial path
+			pwt.valid = !w->weaponDef->noAutoTarget && !w->noAutoTarget;
+			pwt.valid &= (w->slavedTo == nullptr && !w->weaponDef->interceptor);
+			pwt.valid &= (unit->fireState >= FIRESTATE_FIREATWILL);
+		}
+	}
 
-				if (!allowTarget)
-					continue;
+	for_mt_chunk(0, numPreparedTargets, [this](const int i) {
+		PreparedWeaponTargets& pwt = preparedTargets[i];
 
-				targets.emplace_back(targetPriority, targetUnit);
+		if (!pwt.valid)
+			return;
+
+		const WeaponTargetParams wtp(pwt.weapon);
+		const int threadNum = ThreadPool::GetThreadNum();
+
+		QuadFieldQuery qfQuery;
+		qfQuery.threadOwner = threadNum;
+		quadField.GetQuads(qfQuery, wtp.ownerPos, wtp.scanRadius);
+
+		const int tempNum = gs->GetMtTempNum(threadNum);
+
+		for (int t = 0; t < teamHandler.ActiveAllyTeams(); ++t) {
+			if (teamHandler.Ally(wtp.owner->allyteam, t))
+				continue;
+
+			for (const int qi: *qfQuery.quads) {
+				for (CUnit* targetUnit: quadField.GetQuad(qi).teamUnits[t]) {
+					if (targetUnit->GetMtTempNum() == tempNum)
+						continue;
+
+					targetUnit->SetMtTempNum(tempNum);
+
+					WeaponTargetCandidate wtc = {targetUnit, 0.0f, 0};
+
+					if (!CalcBaseTargetPriority(wtp, pwt.avoidUnit, targetUnit, wtc.losState, wtc.priority))
+						continue;
+
+					pwt.candidates.push_back(wtc);
+				}
 			}
 		}
+	});
+}
+
+void CGameHelper::ClearPreparedWeaponTargets()
+{
+	for (size_t i = 0; i < numPreparedTargets; ++i) {
+		const CUnit* owner = preparedTargets[i].weapon->owner;
+
+		if (size_t(owner->id) < preparedTargetUnits.size())
+			preparedTargetUnits[owner->id] = -1;
+	}
+
+	numPreparedTargets = 0;
+}
+
+size_t CGameHelper::GeneratePreparedWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets)
+{
+	const CUnit* owner = weapon->owner;
+
+	if (numPreparedTargets == 0 || size_t(owner->id) >= preparedTargetUnits.size() || preparedTargetUnits[owner->id] < 0)
+		return (GenerateWeaponTargets(weapon, avoidUnit, targets));
+
+	PreparedWeaponTargets& pwt = preparedTargets[preparedTargetUnits[owner->id] + weapon->weaponNum];
+
+	assert(pwt.weapon == weapon);
+
+	// candidates are only usable once, and only if they were scored for the same avoidee
+	if (!pwt.valid || pwt.avoidUnit != avoidUnit)
+		return (GenerateWeaponTargets(weapon, avoidUnit, targets));
+
+	pwt.valid = false;
+
+	const WeaponTargetParams wtp(weapon);
+
+	targets.clear();
+	targets.reserve(pwt.candidates.size());
+
+	// Lua callins run in the same order as the serial path would visit the candidates
+	for (const WeaponTargetCandidate& wtc: pwt.candidates) {
+		CUnit* targetUnit = wtc.unit;
+
+		// may have been killed by an earlier unit's SlowUpdate
+		if (targetUnit->isDead && !modInfo.fireAtKilled)
+			continue;
+
+		float targetPriority = CalcFinalTargetPriority(wtp, targetUnit, wtc.losState, wtc.priority);
+
+		if (!eventHandler.AllowWeaponTarget(owner->id, targetUnit->id, weapon->weaponNum, wtp.weaponDef->id, &targetPriority))
+			continue;
+
+		targets.emplace_back(targetPriority, targetUnit);
 	}
 
-	std::stable_sort(targets.begin(), targets.end(), [](const std::pair<float, CUnit*>& a, const std::pair<float, CUnit*>& b) { return (a.first < b.first); });
+	SortWeaponTargets(targets);
 	return (targets.size());
 }
 
@@ -150,6 +150,16 @@ public:
 
 	static size_t GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets);
 
+	/**
+	 * Two-phase variant of GenerateWeaponTargets, enabled by the weaponTargetAcquisitionMT modrule.
+	 * PrepareWeaponTargets gathers and scores the candidates of every weapon owned by units[idxBeg, idxEnd)
+	 * in parallel; GeneratePreparedWeaponTargets later applies the script and Lua callins serially and
+	 * falls back to GenerateWeaponTargets for weapons that have no usable prepared candidates.
+	 */
+	void PrepareWeaponTargets(const std::vector<CUnit*>& units, size_t idxBeg, size_t idxEnd);
+	void ClearPreparedWeaponTargets();
+	size_t GeneratePreparedWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets);
+
 	void Init();
 	void Kill();
 	void Update();
@@ -205,6 +215,24 @@ private:
 	std::array<std::vector<WaitingDamage>, 128> waitingDamages;
 	static_assert (std::has_single_bit(std::tuple_size_v <decltype(waitingDamages)>), "Size is used in bit hax and must be 2^N");
 
+	struct WeaponTargetCandidate {
+		CUnit* unit;
+		float priority; // excludes TargetWeight and the PREVLOS modifiers
+		unsigned short losState;
+	};
+	struct PreparedWeaponTargets {
+		const CWeapon* weapon = nullptr;
+		const CUnit* avoidUnit = nullptr;
+		std::vector<WeaponTargetCandidate> candidates;
+		bool valid = false;
+	};
+
+	// slots are reused between frames to keep their candidate capacity
+	std::vector<PreparedWeaponTargets> preparedTargets;
+	// index of each unit's first slot, -1 if it has none
+	std::vector<int> preparedTargetUnits;
+	size_t numPreparedTargets = 0;
+
 public:
 	std::vector<int> targetUnitIDs; // GetEnemyUnits{NoLosTest}
 	std::vector<std::pair<float, CUnit*>> targetPairs; // GenerateWeaponTargets
@@ -127,7 +127,11 @@ void CPreGame::LoadSaveFile(const std::string& save)
 
 	saveFileHandler = ILoadSaveHandler::CreateHandler(save);
 
-	if (saveFileHandler->LoadGameStartInfo(save) || configHandler->GetBool("LoadBadSaves")) {
+	const bool goodSave = saveFileHandler->LoadGameStartInfo(save);
+	// LoadBadSaves only overrides version mismatches; without a script the save could not be read at all
+	const bool badSave = (configHandler->GetBool("LoadBadSaves") && !saveFileHandler->GetScriptText().empty());
+
+	if (goodSave || badSave) {
 		StartServer(saveFileHandler->GetScriptText());
 		return;
 	}
@@ -21,7 +21,11 @@
 #include "System/GlobalConfig.h"
 #include "System/SpringMath.h"
 
+#include "xsimd/xsimd.hpp"
+
 #include <algorithm>
+#include <array>
+#include <limits>
 #include <vector>
 
 #include "System/Misc/TracyDefs.h"
@@ -184,96 +188,108 @@ inline static bool TestTrajectoryConeHelper(
 
 
 
-//////////////////////////////////////////////////////////////////////
-// Raytracing
-//////////////////////////////////////////////////////////////////////
+namespace {
+	struct TraceScanFlags {
+		TraceScanFlags(int traceFlags) {
+			// NOTE:
+			//   the bits here and in Test*Cone are interpreted as "do not scan for {enemy,friendly,...}
+			//   objects in quads" rather than "return false if ray hits an {enemy,friendly,...} object"
+			//   consequently a weapon with (e.g.) avoidFriendly=true that wants to check whether it has
+			//   a free line of fire should *not* set the NOFRIENDLIES bit in its trace-flags, etc
+			scanForEnemies  = ((traceFlags & Collision::NOENEMIES   ) == 0);
+			scanForAllies   = ((traceFlags & Collision::NOFRIENDLIES) == 0);
+			scanForFeatures = ((traceFlags & Collision::NOFEATURES  ) == 0);
+			scanForNeutrals = ((traceFlags & Collision::NONEUTRALS  ) == 0);
+			scanForGround   = ((traceFlags & Collision::NOGROUND    ) == 0);
+			scanForCloaked  = ((traceFlags & Collision::NOCLOAKED   ) == 0);
 
-namespace TraceRay {
+			scanForAnyUnits = scanForEnemies || scanForAllies || scanForNeutrals || scanForCloaked;
+		}
 
-// called by {CRifle, CBeamLaser, CLightningCannon}::Fire(), CWeapon::HaveFreeLineOfFire(), and Skirmish AIs
-float TraceRay(const float3& p, const float3& d, float l, int f, const CUnit* o, CUnit*& hu, CFeature*& hf, CollisionQuery* cq)
-{
-	assert(o != nullptr);
-	return (TraceRay(p, d, l, f, o->allyteam, o, hu, hf, cq));
-}
+		bool scanForEnemies;
+		bool scanForAllies;
+		bool scanForFeatures;
+		bool scanForNeutrals;
+		bool scanForGround;
+		bool scanForCloaked;
+		bool scanForAnyUnits;
+	};
+
+	/**
+	 * Objects a ray can hit, in the order TraceRay tests them: all
+	 * features of the quads, then all units. Bounding spheres are stored as
+	 * structure-of-arrays so MarkRay can reject several objects at once.
+	 */
+	struct TraceCandidates {
+		void Clear() {
+			objects.clear();
+
+			cx.clear();
+			cy.clear();
+			cz.clear();
+			rSq.clear();
+
+			numFeatures = 0;
+		}
 
-float TraceRay(
-	const float3& pos,
-	const float3& dir,
-	float traceLength,
-	int traceFlags,
-	int allyTeam,
-	const CUnit* owner,
-	CUnit*& hitUnit,
-	CFeature*& hitFeature,
-	CollisionQuery* hitColQuery
-) {
-	RECOIL_DETAILED_TRACY_ZONE;
-	// NOTE:
-	//   the bits here and in Test*Cone are interpreted as "do not scan for {enemy,friendly,...}
-	//   objects in quads" rather than "return false if ray hits an {enemy,friendly,...} object"
-	//   consequently a weapon with (e.g.) avoidFriendly=true that wants to check whether it has
-	//   a free line of fire should *not* set the NOFRIENDLIES bit in its trace-flags, etc
-	const bool scanForEnemies  = ((traceFlags & Collision::NOENEMIES   ) == 0);
-	const bool scanForAllies   = ((traceFlags & Collision::NOFRIENDLIES) == 0);
-	const bool scanForFeatures = ((traceFlags & Collision::NOFEATURES  ) == 0);
-	const bool scanForNeutrals = ((traceFlags & Collision::NONEUTRALS  ) == 0);
-	const bool scanForGround   = ((traceFlags & Collision::NOGROUND    ) == 0);
-	const bool scanForCloaked  = ((traceFlags & Collision::NOCLOAKED   ) == 0);
+		void AddObject(CSolidObject* obj) {
+			const CollisionVolume* cv = &obj->collisionVolume;
 
-	const bool scanForAnyUnits = scanForEnemies || scanForAllies || scanForNeutrals || scanForCloaked;
+			// DetectHit can never return true for these
+			if (obj->IsInVoid())
+				return;
+			if (!cv->DefaultToPieceTree() && cv->IgnoreHits())
+				return;
 
-	hitFeature = nullptr;
-	hitUnit = nullptr;
+			objects.push_back(obj);
 
-	if (dir == ZeroVector)
-		return -1.0f;
-
-	if (scanForFeatures || scanForAnyUnits) {
-		CollisionQuery cq;
-
-		QuadFieldQuery qfQuery;
-		quadField.GetQuadsOnRay(qfQuery, pos, dir, traceLength);
+			if (cv->DefaultToPieceTree()) {
+				// piece volumes are not bounded by the object's own volume
+				cx.push_back(0.0f);
+				cy.push_back(0.0f);
+				cz.push_back(0.0f);
+				rSq.push_back(std::numeric_limits<float>::infinity());
+				return;
+			}
 
-		// locally point somewhere non-NULL; we cannot pass hitColQuery
-		// to DetectHit directly because each call resets it internally
-		if (hitColQuery == nullptr)
-			hitColQuery = &cq;
+			// same placement as CCollisionHandler::Intersect; every point it can report
+			// lies within the volume's bounding box, the margin absorbs rounding error
+			// (the matrix is not kept, most candidates are rejected by MarkRay)
+			CMatrix44f volMat = obj->GetTransformMatrix(true);
+			volMat.Translate(obj->relMidPos);
+			volMat.Translate(cv->GetOffsets());
 
-		// feature intersection
-		if (scanForFeatures) {
-			for (const int quadIdx: *qfQuery.quads) {
-				const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
-
-				for (CFeature* f: quad.features) {
-					// NOTE:
-					//   if f is non-blocking, ProjectileHandler will not test
-					//   for collisions with projectiles so we can skip it here
-					if (!f->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
-						continue;
+			const float3& volPos = volMat.GetPos();
+			const float volRad = cv->GetHScales().Length() * 1.01f + 1.0f;
 
-					if (CCollisionHandler::DetectHit(f, f->GetTransformMatrix(true), pos, pos + dir * traceLength, &cq, true)) {
-						const float len = cq.GetHitPosDist(pos, dir);
+			cx.push_back(volPos.x);
+			cy.push_back(volPos.y);
+			cz.push_back(volPos.z);
+			rSq.push_back(volRad * volRad);
+		}
 
-						// we want the closest feature (intersection point) on the ray
-						if (len >= traceLength)
+		void AddQuads(const std::vector<int>& quads, const TraceScanFlags& scanFlags, const CUnit* owner) {
+			if (scanFlags.scanForFeatures) {
+				for (const int quadIdx: quads) {
+					for (CFeature* f: quadField.GetQuad(quadIdx).features) {
+						// NOTE:
+						//   if f is non-blocking, ProjectileHandler will not test
+						//   for collisions with projectiles so we can skip it here
+						if (!f->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
 							continue;
 
-						traceLength = len;
-
-						hitFeature = f;
-						*hitColQuery = cq;
+						AddObject(f);
 					}
 				}
 			}
-		}
 
-		// unit intersection
-		if (scanForAnyUnits) {
-			for (const int quadIdx: *qfQuery.quads) {
-				const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
+			numFeatures = objects.size();
+
+			if (!scanFlags.scanForAnyUnits)
+				return;
 
-				for (CUnit* u: quad.units) {
+			for (const int quadIdx: quads) {
+				for (CUnit* u: quadField.GetQuad(quadIdx).units) {
 					if (u == owner)
 						continue;
 
@@ -282,26 +298,106 @@ float TraceRay(
 
 					bool doHitTest = false;
 
-					doHitTest |= (scanForAllies   && u->allyteam == owner->allyteam);
-					doHitTest |= (scanForEnemies  && u->allyteam != owner->allyteam);
-					doHitTest |= (scanForNeutrals && u->IsNeutral());
-					doHitTest |= (scanForCloaked  && u->IsCloaked());
+					doHitTest |= (scanFlags.scanForAllies   && u->allyteam == owner->allyteam);
+					doHitTest |= (scanFlags.scanForEnemies  && u->allyteam != owner->allyteam);
+					doHitTest |= (scanFlags.scanForNeutrals && u->IsNeutral());
+					doHitTest |= (scanFlags.scanForCloaked  && u->IsCloaked());
 
 					if (!doHitTest)
 						continue;
 
-					if (CCollisionHandler::DetectHit(u, u->GetTransformMatrix(true), pos, pos + dir * traceLength, &cq, true)) {
-						const float len = cq.GetHitPosDist(pos, dir);
+					AddObject(u);
+				}
+			}
+		}
+
+		// sets mask[i] iff the bounding sphere of objects[i] touches segment [pos, pos + dir * length]
+		void MarkRay(const float3& pos, const float3& dir, float length) {
+			using BatchType = xsimd::simd_type<float>;
+			constexpr size_t BATCH_SIZE = xsimd::simd_traits<float>::size;
 
-						// we want the closest unit (intersection point) on the ray
-						if (len >= traceLength)
-							continue;
+			const size_t numObjects = objects.size();
+			const size_t numBatched = numObjects - (numObjects % BATCH_SIZE);
 
-						traceLength = len;
+			// <dir> is not required to be normalized
+			const float invDirSq = 1.0f / dir.SqLength();
 
-						hitUnit = u;
-						*hitColQuery = cq;
-					}
+			const BatchType px(pos.x), py(pos.y), pz(pos.z);
+			const BatchType dx(dir.x), dy(dir.y), dz(dir.z);
+			const BatchType tMin(0.0f), tMax(length), tScale(invDirSq);
+
+			std::array<bool, BATCH_SIZE> batchMask;
+
+			mask.resize(numObjects);
+
+			for (size_t i = 0; i < numBatched; i += BATCH_SIZE) {
+				BatchType ox, oy, oz, orSq;
+
+				ox.load_unaligned(&cx[i]);
+				oy.load_unaligned(&cy[i]);
+				oz.load_unaligned(&cz[i]);
+				orSq.load_unaligned(&rSq[i]);
+
+				const BatchType rx = ox - px;
+				const BatchType ry = oy - py;
+				const BatchType rz = oz - pz;
+
+				// closest point on the segment to each sphere center
+				const BatchType t = xsimd::min(xsimd::max((rx * dx + ry * dy + rz * dz) * tScale, tMin), tMax);
+
+				const BatchType ex = rx - dx * t;
+				const BatchType ey = ry - dy * t;
+				const BatchType ez = rz - dz * t;
+
+				(ex * ex + ey * ey + ez * ez <= orSq).store_unaligned(batchMask.data());
+
+				std::copy(batchMask.begin(), batchMask.end(), mask.begin() + i);
+			}
+
+			for (size_t i = numBatched; i < numObjects; i++) {
+				const float3 rv = {cx[i] - pos.x, cy[i] - pos.y, cz[i] - pos.z};
+				const float3 ev = rv - dir * std::clamp(rv.dot(dir) * invDirSq, 0.0f, length);
+
+				mask[i] = (ev.SqLength() <= rSq[i]);
+			}
+		}
+
+		// exact intersection tests for the objects accepted by the last MarkRay
+		float TraceObjects(
+			const float3& pos,
+			const float3& dir,
+			float traceLength,
+			CUnit*& hitUnit,
+			CFeature*& hitFeature,
+			CollisionQuery* hitColQuery
+		) const {
+			CollisionQuery cq;
+
+			// locally point somewhere non-NULL; we cannot pass hitColQuery
+			// to DetectHit directly because each call resets it internally
+			if (hitColQuery == nullptr)
+				hitColQuery = &cq;
+
+			for (size_t i = 0, n = objects.size(); i < n; i++) {
+				if (!mask[i])
+					continue;
+
+				if (!CCollisionHandler::DetectHit(objects[i], objects[i]->GetTransformMatrix(true), pos, pos + dir * traceLength, &cq, true))
+					continue;
+
+				const float len = cq.GetHitPosDist(pos, dir);
+
+				// we want the closest feature or unit (intersection point) on the ray
+				if (len >= traceLength)
+					continue;
+
+				traceLength = len;
+				*hitColQuery = cq;
+
+				if (i < numFeatures) {
+					hitFeature = static_cast<CFeature*>(objects[i]);
+				} else {
+					hitUnit = static_cast<CUnit*>(objects[i]);
 				}
 			}
 
@@ -309,10 +405,33 @@ float TraceRay(
 			if (hitUnit != nullptr)
 				hitFeature = nullptr;
 
+			return traceLength;
 		}
-	}
 
-	if (scanForGround) {
+	public:
+		std::vector<CSolidObject*> objects;
+
+		std::vector<float> cx, cy, cz, rSq;
+		std::vector<uint8_t> mask;
+
+		size_t numFeatures = 0;
+	};
+
+	// per thread, TraceRay is not restricted to the main thread
+	thread_local TraceCandidates traceCandidates;
+
+
+	float TraceGround(
+		const float3& pos,
+		const float3& dir,
+		float traceLength,
+		const TraceScanFlags& scanFlags,
+		CUnit*& hitUnit,
+		CFeature*& hitFeature
+	) {
+		if (!scanFlags.scanForGround)
+			return traceLength;
+
 		// ground intersection
 		const float groundLength = CGround::LineGroundCol(pos, pos + dir * traceLength);
 
@@ -322,10 +441,59 @@ float TraceRay(
 			hitUnit = nullptr;
 			hitFeature = nullptr;
 		}
+
+		// no intersection if no decrease in length
+		return traceLength;
+	}
+}
+
+
+
+//////////////////////////////////////////////////////////////////////
+// Raytracing
+//////////////////////////////////////////////////////////////////////
+
+namespace TraceRay {
+
+// called by {CRifle, CBeamLaser, CLightningCannon}::Fire(), CWeapon::HaveFreeLineOfFire(), and Skirmish AIs
+float TraceRay(const float3& p, const float3& d, float l, int f, const CUnit* o, CUnit*& hu, CFeature*& hf, CollisionQuery* cq)
+{
+	assert(o != nullptr);
+	return (TraceRay(p, d, l, f, o->allyteam, o, hu, hf, cq));
+}
+
+float TraceRay(
+	const float3& pos,
+	const float3& dir,
+	float traceLength,
+	int traceFlags,
+	int allyTeam,
+	const CUnit* owner,
+	CUnit*& hitUnit,
+	CFeature*& hitFeature,
+	CollisionQuery* hitColQuery
+) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	const TraceScanFlags scanFlags(traceFlags);
+
+	hitFeature = nullptr;
+	hitUnit = nullptr;
+
+	if (dir == ZeroVector)
+		return -1.0f;
+
+	if (scanFlags.scanForFeatures || scanFlags.scanForAnyUnits) {
+		QuadFieldQuery qfQuery;
+		quadField.GetQuadsOnRay(qfQuery, pos, dir, traceLength);
+
+		traceCandidates.Clear();
+		traceCandidates.AddQuads(*qfQuery.quads, scanFlags, owner);
+		traceCandidates.MarkRay(pos, dir, traceLength);
+
+		traceLength = traceCandidates.TraceObjects(pos, dir, traceLength, hitUnit, hitFeature, hitColQuery);
 	}
 
-	// no intersection if no decrease in length
-	return traceLength;
+	return (TraceGround(pos, dir, traceLength, scanFlags, hitUnit, hitFeature));
 }
 
 
@@ -343,7 +511,7 @@ void TraceRayShields(
 	quadField.GetQuadsOnRay(qfQuery, start, dir, length);
 
 	for (const int quadIdx: *qfQuery.quads) {
-		const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
+		const CQuadField::QuadView quad = quadField.GetQuad(quadIdx);
 
 		for (CPlasmaRepulser* r: quad.repulsers) {
 			if (!r->CanIntercept(emitter->weaponDef->interceptedByShieldType, emitter->owner->allyteam))
@@ -429,7 +597,7 @@ float GuiTraceRay(
 	}
 
 	for (const int quadIdx: *qfQuery.quads) {
-		const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
+		const CQuadField::QuadView quad = quadField.GetQuad(quadIdx);
 
 		// Unit Intersection
 		for (const CUnit* u: quad.units) {
@@ -545,7 +713,7 @@ bool TestCone(
 	const bool scanForFeatures = ((traceFlags & Collision::NOFEATURES  ) == 0);
 
 	for (const int quadIdx: *qfQuery.quads) {
-		const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
+		const CQuadField::QuadView quad = quadField.GetQuad(quadIdx);
 
 		if (scanForAllies) {
 			for (const CUnit* u: quad.teamUnits[allyteam]) {
@@ -612,7 +780,7 @@ bool TestTrajectoryCone(
 	const bool scanForFeatures = ((traceFlags & Collision::NOFEATURES  ) == 0);
 
 	for (const int quadIdx: *qfQuery.quads) {
-		const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
+		const CQuadField::QuadView quad = quadField.GetQuad(quadIdx);
 
 		// friendly units in this quad
 		if (scanForAllies) {
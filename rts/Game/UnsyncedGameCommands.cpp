@@ -48,6 +48,7 @@
 #include "Game/UI/Groups/GroupHandler.h"
 #include "Game/UI/PlayerRoster.h"
 
+#include "Lua/LuaCallInProfiler.h"
 #include "Lua/LuaOpenGL.h"
 #include "Lua/LuaUI.h"
 #include "Lua/LuaMenu.h"
@@ -1774,6 +1775,46 @@ public:
 
 
 
+class LuaProfilerActionExecutor : public IUnsyncedActionExecutor {
+public:
+	LuaProfilerActionExecutor() : IUnsyncedActionExecutor(
+		"LuaProfiler",
+		"Per-callin Lua profiling: on|off|reset, log [numEntries], dump [fileName]"
+	) {}
+
+	bool Execute(const UnsyncedAction& action) const final {
+		const std::vector<std::string> args = CSimpleParser::Tokenize(action.GetArgs());
+
+		if (args.empty()) {
+			luaCallInProfiler.SetEnabled(!luaCallInProfiler.IsEnabled());
+			LOG("Lua callin profiling %s", luaCallInProfiler.IsEnabled()? "enabled": "disabled");
+			return true;
+		}
+
+		if (args[0] == "on" || args[0] == "off") {
+			luaCallInProfiler.SetEnabled(args[0] == "on");
+			LOG("Lua callin profiling %s", luaCallInProfiler.IsEnabled()? "enabled": "disabled");
+			return true;
+		}
+		if (args[0] == "reset") {
+			luaCallInProfiler.Reset();
+			return true;
+		}
+		if (args[0] == "log") {
+			luaCallInProfiler.Log((args.size() > 1)? std::max(StringToInt(args[1]), 1): 20);
+			return true;
+		}
+		if (args[0] == "dump") {
+			luaCallInProfiler.Dump((args.size() > 1)? args[1]: "LuaProfile.csv");
+			return true;
+		}
+
+		return false;
+	}
+};
+
+
+
 class GameInfoActionExecutor : public IUnsyncedActionExecutor {
 public:
 	GameInfoActionExecutor() : IUnsyncedActionExecutor("GameInfo", "Enables/Disables game-info panel rendering") {
@@ -4056,6 +4097,7 @@ void UnsyncedGameCommands::AddDefaultActionExecutors()
 	AddActionExecutor(AllocActionExecutor<LuaUIActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<LuaMenuActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<LuaGarbageCollectControlExecutor>());
+	AddActionExecutor(AllocActionExecutor<LuaProfilerActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<MiniMapActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<GroundDecalsActionExecutor>());
 
@@ -0,0 +1,175 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "LuaCallInProfiler.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#include "LuaHandle.h"
+#include "LuaInclude.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/Log/ILog.h"
+
+CLuaCallInProfiler luaCallInProfiler;
+
+
+CLuaCallInProfiler::ScopedCallIn::ScopedCallIn(const CLuaHandle* handle, lua_State* L, const char* callIn)
+{
+	if (!luaCallInProfiler.IsEnabled() || handle == nullptr)
+		return;
+
+	const SLuaAllocState& allocState = GetLuaContextData(L)->allocState;
+
+	luaHandle = handle;
+	luaState = L;
+	callInName = callIn;
+
+	startNumAllocs = allocState.numLuaAllocs.load();
+	startAllocBytes = allocState.allocedBytes.load();
+
+	prevHook = lua_gethook(L);
+	prevHookMask = lua_gethookmask(L);
+	prevHookCount = lua_gethookcount(L);
+
+	lua_sethook(L, SampleHook, LUA_MASKCOUNT, SAMPLE_INSTRUCTIONS);
+
+	startTime = spring_gettime();
+}
+
+CLuaCallInProfiler::ScopedCallIn::~ScopedCallIn()
+{
+	if (luaHandle == nullptr)
+		return;
+
+	const spring_time dt = spring_gettime() - startTime;
+	const SLuaAllocState& allocState = GetLuaContextData(luaState)->allocState;
+
+	lua_sethook(luaState, prevHook, prevHookMask, prevHookCount);
+
+	const std::uint64_t numAllocs = allocState.numLuaAllocs.load() - startNumAllocs;
+	const std::int64_t allocBytes = std::int64_t(allocState.allocedBytes.load() - startAllocBytes);
+
+	luaCallInProfiler.AddCallIn(luaHandle, callInName, dt.toNanoSecsi(), numAllocs, allocBytes);
+}
+
+
+void CLuaCallInProfiler::SampleHook(lua_State* L, lua_Debug* ar)
+{
+	const CLuaHandle* handle = CLuaHandle::GetHandle(L);
+
+	if (handle == nullptr)
+		return;
+
+	luaCallInProfiler.AddSample(handle, L);
+}
+
+
+void CLuaCallInProfiler::AddCallIn(const CLuaHandle* handle, const char* callIn, std::uint64_t dt, std::uint64_t numAllocs, std::int64_t allocBytes)
+{
+	std::lock_guard<decltype(mutex)> lck(mutex);
+
+	CallInStats& stats = handles[handle->GetName()].callIns[callIn];
+
+	stats.numCalls += 1;
+	stats.totalTime += dt;
+	stats.maxTime = std::max(stats.maxTime, dt);
+	stats.numAllocs += numAllocs;
+	stats.allocBytes += allocBytes;
+}
+
+void CLuaCallInProfiler::AddSample(const CLuaHandle* handle, lua_State* L)
+{
+	// the hook's own record only describes the event, level 0 is the running function
+	lua_Debug fr;
+
+	if (lua_getstack(L, 0, &fr) == 0 || lua_getinfo(L, "S", &fr) == 0)
+		return;
+
+	char key[LUA_IDSIZE + 16];
+	SNPRINTF(key, sizeof(key), "%s:%d", fr.short_src, fr.linedefined);
+
+	std::lock_guard<decltype(mutex)> lck(mutex);
+
+	handles[handle->GetName()].samples[key] += 1;
+}
+
+
+void CLuaCallInProfiler::Reset()
+{
+	std::lock_guard<decltype(mutex)> lck(mutex);
+	handles.clear();
+}
+
+
+void CLuaCallInProfiler::Log(size_t maxEntries) const
+{
+	struct Entry {
+		const std::string* handle;
+		const std::string* callIn;
+		const CallInStats* stats;
+	};
+
+	std::vector<Entry> entries;
+	std::lock_guard<decltype(mutex)> lck(mutex);
+
+	for (const auto& handlePair: handles) {
+		for (const auto& callInPair: handlePair.second.callIns) {
+			entries.push_back({&handlePair.first, &callInPair.first, &callInPair.second});
+		}
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return (a.stats->totalTime > b.stats->totalTime); });
+
+	LOG("[LuaCallInProfiler] %-24s %-28s %10s %12s %10s %12s %12s", "handle", "callin", "calls", "total[ms]", "max[ms]", "allocs", "bytes");
+
+	for (size_t i = 0, n = std::min(maxEntries, entries.size()); i < n; i++) {
+		const Entry& e = entries[i];
+		const CallInStats& s = *e.stats;
+
+		LOG(
+			"[LuaCallInProfiler] %-24s %-28s %10" PRIu64 " %12.3f %10.3f %12" PRIu64 " %12" PRId64,
+			e.handle->c_str(), e.callIn->c_str(), s.numCalls, s.totalTime * 1e-6, s.maxTime * 1e-6, s.numAllocs, s.allocBytes
+		);
+	}
+}
+
+bool CLuaCallInProfiler::Dump(const std::string& fileName) const
+{
+	const std::string filePath = dataDirsAccess.LocateFile(fileName, FileQueryFlags::WRITE | FileQueryFlags::CREATE_DIRS);
+	std::ofstream file(filePath, std::ios::out | std::ios::trunc);
+
+	if (!file.good()) {
+		LOG_L(L_WARNING, "[LuaCallInProfiler::%s] could not open \"%s\"", __func__, filePath.c_str());
+		return false;
+	}
+
+	std::lock_guard<decltype(mutex)> lck(mutex);
+
+	// one row per callin followed by one row per sampled function; columns
+	// that do not apply to a row type are left empty
+	file << "type,handle,name,calls,totalTimeNs,maxTimeNs,allocs,allocBytes,samples\n";
+
+	for (const auto& handlePair: handles) {
+		for (const auto& callInPair: handlePair.second.callIns) {
+			const CallInStats& s = callInPair.second;
+
+			file << "callin," << handlePair.first << ',' << callInPair.first << ',';
+			file << s.numCalls << ',' << s.totalTime << ',' << s.maxTime << ',' << s.numAllocs << ',' << s.allocBytes << ",\n";
+		}
+
+		for (const auto& samplePair: handlePair.second.samples) {
+			// source names can contain commas
+			std::string name = samplePair.first;
+			std::replace(name.begin(), name.end(), ',', ';');
+
+			file << "sample," << handlePair.first << ',' << name << ",,,,,," << samplePair.second << '\n';
+		}
+	}
+
+	LOG("[LuaCallInProfiler] statistics written to \"%s\"", filePath.c_str());
+	return (file.good());
+}
@@ -0,0 +1,95 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LUA_CALLIN_PROFILER_H
+#define LUA_CALLIN_PROFILER_H
+
+#include <cstdint>
+#include <string>
+
+#include "System/Misc/SpringTime.h"
+#include "System/Threading/SpringThreading.h"
+#include "System/UnorderedMap.hpp"
+
+struct lua_State;
+struct lua_Debug;
+class CLuaHandle;
+
+/**
+ * Collects per-handle and per-callin statistics of the Lua callins run
+ * through CLuaHandle::RunCallInTraceback while enabled: call counts, wall
+ * time and the number of allocations and net bytes allocated by the
+ * handle's state. While a callin runs, a Lua count-hook also samples the
+ * function on top of the stack every SAMPLE_INSTRUCTIONS instructions,
+ * overriding any hook installed via debug.sethook for its duration.
+ *
+ * All figures are inclusive, i.e. include callins nested in other callins.
+ */
+class CLuaCallInProfiler
+{
+public:
+	struct CallInStats {
+		std::uint64_t numCalls = 0;
+		std::uint64_t totalTime = 0; // nanoseconds
+		std::uint64_t maxTime = 0;
+		std::uint64_t numAllocs = 0;
+		std::int64_t allocBytes = 0;
+	};
+
+	struct HandleStats {
+		spring::unordered_map<std::string, CallInStats> callIns;
+		// number of samples taken per "source:line" of the sampled functions
+		spring::unordered_map<std::string, std::uint64_t> samples;
+	};
+
+	class ScopedCallIn {
+	public:
+		ScopedCallIn(const CLuaHandle* handle, lua_State* L, const char* callIn);
+		~ScopedCallIn();
+
+		bool IsActive() const { return (luaHandle != nullptr); }
+
+	private:
+		const CLuaHandle* luaHandle = nullptr;
+		lua_State* luaState = nullptr;
+		const char* callInName = nullptr;
+
+		spring_time startTime;
+
+		std::uint64_t startNumAllocs = 0;
+		std::uint64_t startAllocBytes = 0;
+
+		// previous hook, restored when the callin returns
+		void (*prevHook)(lua_State*, lua_Debug*) = nullptr;
+		int prevHookMask = 0;
+		int prevHookCount = 0;
+	};
+
+public:
+	static constexpr int SAMPLE_INSTRUCTIONS = 1000;
+
+	void SetEnabled(bool b) { enabled = b; }
+	bool IsEnabled() const { return enabled; }
+
+	void Reset();
+
+	/// logs the <maxEntries> callins with the highest total time
+	void Log(size_t maxEntries) const;
+	/// writes all collected statistics to <fileName> as CSV
+	bool Dump(const std::string& fileName) const;
+
+private:
+	static void SampleHook(lua_State* L, lua_Debug* ar);
+
+	void AddCallIn(const CLuaHandle* handle, const char* callIn, std::uint64_t dt, std::uint64_t numAllocs, std::int64_t allocBytes);
+	void AddSample(const CLuaHandle* handle, lua_State* L);
+
+private:
+	spring::unordered_map<std::string, HandleStats> handles;
+	mutable spring::mutex mutex;
+
+	bool enabled = false;
+};
+
+extern CLuaCallInProfiler luaCallInProfiler;
+
+#endif // LUA_CALLIN_PROFILER_H
@@ -7,6 +7,7 @@
 #include "LuaUI.h"
 
 #include "LuaCallInCheck.h"
+#include "LuaCallInProfiler.h"
 #include "LuaConfig.h"
 #include "LuaHashString.h"
 #include "LuaOpenGL.h"
@@ -364,7 +365,15 @@ int CLuaHandle::RunCallInTraceback(
 			// note1: disable GC outside of this scope to prevent sync errors and similar
 			// note2: we collect garbage now in its own callin "CollectGarbage"
 			// lua_gc(L, LUA_GCRESTART, 0);
-			error = lua_pcall(state, nInArgs, nOutArgs, errFuncIdx);
+			{
+				const CLuaCallInProfiler::ScopedCallIn profCallIn(handle, state, luaFunc);
+
+				ZoneNamedN(callInZone, "Lua::CallIn", profCallIn.IsActive());
+				ZoneNameV(callInZone, luaFunc, strlen(luaFunc));
+				ZoneTextV(callInZone, handle->GetName().c_str(), handle->GetName().size());
+
+				error = lua_pcall(state, nInArgs, nOutArgs, errFuncIdx);
+			}
 			// only run GC inside of "SetHandleRunning(L, true) ... SetHandleRunning(L, false)"!
 			lua_gc(state, LUA_GCSTOP, 0);
 
@@ -1342,6 +1351,57 @@ void CLuaHandle::UnitDamaged(
 	RunCallInTraceback(L, cmdStr, argCount, 0, traceBack.GetErrFuncIdx(), false);
 }
 
+/*** Called once per game frame with all units damaged since the previous call.
+ *
+ * @function UnitDamagedBatch
+ *
+ * Synced only. The events are stored back to back in a single table, ten
+ * entries per event in the order of the `UnitDamaged` arguments (unitID,
+ * unitDefID, unitTeam, damage, paralyzer, weaponDefID, projectileID,
+ * attackerID, attackerDefID, attackerTeam; the attacker fields are -1 when
+ * there is none). They appear in the order they were raised and are passed
+ * after all units and projectiles have been updated, right before
+ * `GameFramePost`; damage dealt from within this call-in is part of the
+ * next frame's batch. `UnitDamaged` is still called for every event.
+ *
+ * @param numEvents integer
+ * @param events table
+ */
+void CLuaHandle::UnitDamagedBatch(const std::vector<UnitDamagedEvent>& events)
+{
+	LUA_CALL_IN_CHECK(L);
+	luaL_checkstack(L, 5, __func__);
+
+	static const LuaHashString cmdStr(__func__);
+	const LuaUtils::ScopedDebugTraceBack traceBack(L);
+
+	if (!cmdStr.GetGlobalFunc(L))
+		return;
+
+	static constexpr int EVENT_STRIDE = 10;
+
+	lua_pushnumber(L, events.size());
+	lua_createtable(L, events.size() * EVENT_STRIDE, 0);
+
+	int idx = 0;
+
+	for (const UnitDamagedEvent& e: events) {
+		lua_pushnumber(L, e.unitID       ); lua_rawseti(L, -2, ++idx);
+		lua_pushnumber(L, e.unitDefID    ); lua_rawseti(L, -2, ++idx);
+		lua_pushnumber(L, e.unitTeam     ); lua_rawseti(L, -2, ++idx);
+		lua_pushnumber(L, e.damage       ); lua_rawseti(L, -2, ++idx);
+		lua_pushboolean(L, e.paralyzer   ); lua_rawseti(L, -2, ++idx);
+		lua_pushnumber(L, e.weaponDefID  ); lua_rawseti(L, -2, ++idx);
+		lua_pushnumber(L, e.projectileID ); lua_rawseti(L, -2, ++idx);
+		lua_pushnumber(L, e.attackerID   ); lua_rawseti(L, -2, ++idx);
+		lua_pushnumber(L, e.attackerDefID); lua_rawseti(L, -2, ++idx);
+		lua_pushnumber(L, e.attackerTeam ); lua_rawseti(L, -2, ++idx);
+	}
+
+	// call the routine
+	RunCallInTraceback(L, cmdStr, 2, 0, traceBack.GetErrFuncIdx(), false);
+}
+
 /*** Called when a unit changes its stun status.
  *
  * @function UnitStunned
@@ -2099,6 +2159,64 @@ void CLuaHandle::ProjectileCreated(const CProjectile* p)
 	RunCallIn(L, cmdStr, 3, 0);
 }
 
+/*** Called once per game frame with all projectiles created since the previous call.
+ *
+ * @function ProjectileCreatedBatch
+ *
+ * Synced only. The events are stored back to back in a single table, three
+ * entries per event (proID, proOwnerID, weaponDefID; the latter is -1 for
+ * piece projectiles), filtered by `Script.SetWatchProjectile` like
+ * `ProjectileCreated`. They appear in the order the projectiles were created
+ * and are passed right before `GameFramePost`; projectiles created from
+ * within this call-in are part of the next frame's batch.
+ *
+ * @param numEvents integer
+ * @param events table
+ */
+void CLuaHandle::ProjectileCreatedBatch(const std::vector<ProjectileCreatedEvent>& events)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (watchProjectileDefs.empty())
+		return;
+
+	LUA_CALL_IN_CHECK(L);
+	luaL_checkstack(L, 5, __func__);
+
+	static const LuaHashString cmdStr(__func__);
+
+	if (!cmdStr.GetGlobalFunc(L))
+		return;
+
+	static constexpr int EVENT_STRIDE = 3;
+
+	const bool watchPieces = watchProjectileDefs[watchProjectileDefs.size() - 1];
+
+	lua_createtable(L, events.size() * EVENT_STRIDE, 0);
+
+	int idx = 0;
+
+	for (const ProjectileCreatedEvent& e: events) {
+		// if this weapon-type is not being watched, skip
+		if ((e.weaponDefID < 0)? !watchPieces: !watchProjectileDefs[e.weaponDefID])
+			continue;
+
+		lua_pushnumber(L, e.projectileID); lua_rawseti(L, -2, ++idx);
+		lua_pushnumber(L, e.ownerID     ); lua_rawseti(L, -2, ++idx);
+		lua_pushnumber(L, e.weaponDefID ); lua_rawseti(L, -2, ++idx);
+	}
+
+	if (idx == 0) {
+		lua_pop(L, 2);
+		return;
+	}
+
+	lua_pushnumber(L, idx / EVENT_STRIDE);
+	lua_insert(L, -2);
+
+	// call the routine
+	RunCallIn(L, cmdStr, 2, 0);
+}
+
 
 /*** Called when the projectile is destroyed.
  *
@@ -142,6 +142,7 @@ class CLuaHandle : public CEventClient
 			int projectileID,
 			bool paralyzer
 		) override;
+		void UnitDamagedBatch(const std::vector<UnitDamagedEvent>& events) override;
 		void UnitStunned(const CUnit* unit, bool stunned) override;
 		void UnitExperience(const CUnit* unit, float oldExperience) override;
 		void UnitHarvestStorageFull(const CUnit* unit) override;
@@ -184,6 +185,7 @@ class CLuaHandle : public CEventClient
 		) override;
 
 		void ProjectileCreated(const CProjectile* p) override;
+		void ProjectileCreatedBatch(const std::vector<ProjectileCreatedEvent>& events) override;
 		void ProjectileDestroyed(const CProjectile* p) override;
 
 		bool Explosion(int weaponID, int projectileID, const float3& pos, const CUnit* owner) override;
@@ -5,6 +5,9 @@
 
 #include <algorithm>
 #include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 
 #include "lib/streflop/streflop_cond.h"
 
@@ -21,8 +24,11 @@
 #include "Sim/Misc/GlobalSynced.h" // gsRNG
 #include "System/Log/ILog.h"
 #include "System/FileSystem/FileHandler.h"
+#include "System/FileSystem/FileSystem.h"
+#include "System/FileSystem/MappedFile.h"
 #include "System/Misc/SpringTime.h"
 #include "System/ContainerUtil.h"
+#include "System/CRC.h"
 #include "System/TimeProfiler.h"
 #include "System/ScopedFPUSettings.h"
 #include "System/StringUtil.h"
@@ -188,6 +194,7 @@ void LuaParser::SetupEnv(bool isSyncedCtxt, bool isDefsParser)
 	AddFunc("Include",    Include);
 	AddFunc("LoadFile",   LoadFile);
 	AddFunc("FileExists", FileExists);
+	AddFunc("PrefetchFiles", PrefetchFiles);
 	EndTable();
 
 	GetTable("LOG");
@@ -292,6 +299,309 @@ bool LuaParser::Execute()
 }
 
 
+/******************************************************************************/
+
+static constexpr std::uint32_t SNAPSHOT_VERSION = 1;
+static constexpr char SNAPSHOT_MAGIC[8] = "LUAPSNP";
+
+struct SnapshotHeader {
+	char magic[sizeof(SNAPSHOT_MAGIC)];
+	std::uint32_t version;
+	std::uint32_t dataCRC;
+	sha512::raw_digest key;
+	std::uint64_t dataSize;
+};
+
+enum SnapshotTag: std::uint8_t {
+	SNAPSHOT_TAG_END       = 0,
+	SNAPSHOT_TAG_NUMBER    = 1,
+	SNAPSHOT_TAG_STRING    = 2,
+	SNAPSHOT_TAG_FALSE     = 3,
+	SNAPSHOT_TAG_TRUE      = 4,
+	SNAPSHOT_TAG_TABLE     = 5,
+	SNAPSHOT_TAG_TABLE_REF = 6,
+};
+
+template<typename T> static void AppendSnapshotData(std::vector<std::uint8_t>& data, const T* src, size_t count = 1)
+{
+	const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(src);
+	data.insert(data.end(), bytes, bytes + sizeof(T) * count);
+}
+
+template<typename T> static bool ExtractSnapshotData(const std::uint8_t*& pos, const std::uint8_t* end, T* dst, size_t count = 1)
+{
+	if (size_t(end - pos) < (sizeof(T) * count))
+		return false;
+
+	std::memcpy(dst, pos, sizeof(T) * count);
+	pos += (sizeof(T) * count);
+	return true;
+}
+
+// serializes the value on top of the stack; shared (and recursive)
+// tables are written once and referenced by their index afterwards
+static bool WriteSnapshotValue(lua_State* L, std::vector<std::uint8_t>& data, spring::unordered_map<const void*, std::uint32_t>& tableIDs)
+{
+	switch (lua_type(L, -1)) {
+		case LUA_TNUMBER: {
+			const lua_Number value = lua_tonumber(L, -1);
+
+			data.push_back(SNAPSHOT_TAG_NUMBER);
+			AppendSnapshotData(data, &value);
+			return true;
+		} break;
+
+		case LUA_TSTRING: {
+			size_t len = 0;
+			const char* str = lua_tolstring(L, -1, &len);
+			const std::uint32_t size = len;
+
+			data.push_back(SNAPSHOT_TAG_STRING);
+			AppendSnapshotData(data, &size);
+			AppendSnapshotData(data, str, len);
+			return true;
+		} break;
+
+		case LUA_TBOOLEAN: {
+			data.push_back(lua_toboolean(L, -1)? SNAPSHOT_TAG_TRUE: SNAPSHOT_TAG_FALSE);
+			return true;
+		} break;
+
+		case LUA_TTABLE: {
+			const auto iter = tableIDs.find(lua_topointer(L, -1));
+
+			if (iter != tableIDs.end()) {
+				data.push_back(SNAPSHOT_TAG_TABLE_REF);
+				AppendSnapshotData(data, &iter->second);
+				return true;
+			}
+
+			// lookups through a metatable can not be reproduced
+			if (lua_getmetatable(L, -1)) {
+				lua_pop(L, 1);
+				return false;
+			}
+
+			if (!lua_checkstack(L, 4))
+				return false;
+
+			tableIDs.emplace(lua_topointer(L, -1), tableIDs.size());
+			data.push_back(SNAPSHOT_TAG_TABLE);
+
+			const int table = lua_gettop(L);
+
+			for (lua_pushnil(L); lua_next(L, table) != 0; lua_pop(L, 1)) {
+				// copy the key, lua_tolstring would confuse lua_next
+				lua_pushvalue(L, -2);
+
+				const bool keyWritten = WriteSnapshotValue(L, data, tableIDs);
+
+				lua_pop(L, 1);
+
+				if (!keyWritten || !WriteSnapshotValue(L, data, tableIDs)) {
+					lua_pop(L, 2);
+					return false;
+				}
+			}
+
+			data.push_back(SNAPSHOT_TAG_END);
+			return true;
+		} break;
+
+		default: {
+		} break;
+	}
+
+	// functions, userdata, ...
+	return false;
+}
+
+// pushes the next value; tables created so far are kept in the
+// table at stack index <tables> to resolve references
+static bool ReadSnapshotValue(lua_State* L, const std::uint8_t*& pos, const std::uint8_t* end, int tables, std::uint32_t& numTables)
+{
+	std::uint8_t tag = SNAPSHOT_TAG_END;
+
+	if (!ExtractSnapshotData(pos, end, &tag))
+		return false;
+
+	switch (tag) {
+		case SNAPSHOT_TAG_NUMBER: {
+			lua_Number value = 0;
+
+			if (!ExtractSnapshotData(pos, end, &value))
+				return false;
+
+			lua_pushnumber(L, value);
+			return true;
+		} break;
+
+		case SNAPSHOT_TAG_STRING: {
+			std::uint32_t size = 0;
+
+			if (!ExtractSnapshotData(pos, end, &size) || size_t(end - pos) < size)
+				return false;
+
+			lua_pushlstring(L, reinterpret_cast<const char*>(pos), size);
+			pos += size;
+			return true;
+		} break;
+
+		case SNAPSHOT_TAG_FALSE:
+		case SNAPSHOT_TAG_TRUE: {
+			lua_pushboolean(L, tag == SNAPSHOT_TAG_TRUE);
+			return true;
+		} break;
+
+		case SNAPSHOT_TAG_TABLE_REF: {
+			std::uint32_t tableID = 0;
+
+			if (!ExtractSnapshotData(pos, end, &tableID) || tableID >= numTables)
+				return false;
+
+			lua_rawgeti(L, tables, tableID + 1);
+			return true;
+		} break;
+
+		case SNAPSHOT_TAG_TABLE: {
+			if (!lua_checkstack(L, 4))
+				return false;
+
+			lua_newtable(L);
+			lua_pushvalue(L, -1);
+			lua_rawseti(L, tables, ++numTables);
+
+			while (pos < end && *pos != SNAPSHOT_TAG_END) {
+				if (!ReadSnapshotValue(L, pos, end, tables, numTables))
+					return false;
+
+				// nil or NaN keys would raise an error
+				if (lua_isnumber(L, -1) && lua_tonumber(L, -1) != lua_tonumber(L, -1))
+					return false;
+
+				if (!ReadSnapshotValue(L, pos, end, tables, numTables))
+					return false;
+
+				lua_rawset(L, -3);
+			}
+
+			return (pos++ < end);
+		} break;
+
+		default: {
+		} break;
+	}
+
+	return false;
+}
+
+
+bool LuaParser::ReadSnapshot(const std::string& filePath, const sha512::raw_digest& key)
+{
+	if (!IsValid() || !FileSystem::FileExists(filePath))
+		return false;
+
+	assert(rootRef == LUA_NOREF);
+	assert(initDepth == 0);
+
+	CMappedFile snapshotFile(filePath);
+
+	if (!snapshotFile.IsOpen())
+		return false;
+
+	const std::uint8_t* fileData = snapshotFile.GetData();
+	const size_t fileSize = snapshotFile.GetSize();
+
+	SnapshotHeader header;
+
+	if (fileSize < sizeof(header))
+		return false;
+
+	std::memcpy(&header, fileData, sizeof(header));
+
+	if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 || header.version != SNAPSHOT_VERSION)
+		return false;
+	if (header.key != key || header.dataSize != (fileSize - sizeof(header)))
+		return false;
+	if (header.dataCRC != CRC::CalcDigest(fileData + sizeof(header), header.dataSize))
+		return false;
+
+	const std::uint8_t* pos = fileData + sizeof(header);
+	const std::uint8_t* end = fileData + fileSize;
+
+	std::uint32_t numTables = 0;
+
+	lua_newtable(L);
+
+	if (!ReadSnapshotValue(L, pos, end, lua_gettop(L), numTables) || pos != end || !lua_istable(L, -1)) {
+		LOG_L(L_WARNING, "[LuaParser::%s] discarding damaged snapshot \"%s\" of %s", __func__, filePath.c_str(), fileName.c_str());
+		lua_settop(L, 0);
+		return false;
+	}
+
+	lua_remove(L, -2);
+
+	initDepth = -1;
+	rootRef = luaL_ref(L, LUA_REGISTRYINDEX);
+	lua_settop(L, 0);
+
+	return (valid = true);
+}
+
+bool LuaParser::WriteSnapshot(const std::string& filePath, const sha512::raw_digest& key)
+{
+	if (!valid || rootRef == LUA_NOREF)
+		return false;
+
+	std::vector<std::uint8_t> data;
+	spring::unordered_map<const void*, std::uint32_t> tableIDs;
+
+	lua_rawgeti(L, LUA_REGISTRYINDEX, rootRef);
+
+	const bool dataWritten = WriteSnapshotValue(L, data, tableIDs);
+
+	lua_settop(L, 0);
+
+	if (!dataWritten) {
+		LOG_L(L_WARNING, "[LuaParser::%s] %s returned values that can not be stored in a snapshot", __func__, fileName.c_str());
+		return false;
+	}
+
+	SnapshotHeader header;
+
+	std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+	header.version = SNAPSHOT_VERSION;
+	header.dataCRC = CRC::CalcDigest(data.data(), data.size());
+	header.key = key;
+	header.dataSize = data.size();
+
+	const std::string tempFilePath = filePath + ".tmp";
+
+	{
+		// write to a temporary first so concurrent readers never see a partial file
+		std::ofstream snapshotFile(tempFilePath, std::ios::binary | std::ios::trunc);
+
+		snapshotFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		snapshotFile.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+		if (!snapshotFile.good()) {
+			snapshotFile.close();
+			FileSystem::Remove(tempFilePath);
+			return false;
+		}
+	}
+
+	FileSystem::Remove(filePath);
+
+	if (std::rename(tempFilePath.c_str(), filePath.c_str()) != 0) {
+		FileSystem::Remove(tempFilePath);
+		return false;
+	}
+
+	return true;
+}
+
+
 void LuaParser::AddTable(LuaTable* tbl) { spring::VectorInsertUnique(tables, tbl); }
 void LuaParser::RemoveTable(LuaTable* tbl) { spring::VectorErase(tables, tbl); }
 
@@ -733,6 +1043,35 @@ int LuaParser::FileExists(lua_State* L)
 }
 
 
+int LuaParser::PrefetchFiles(lua_State* L)
+{
+	const LuaParser* currentParser = GetLuaParser(L);
+
+	luaL_checktype(L, 1, LUA_TTABLE);
+
+	const std::string& modes = CFileHandler::AllowModes(luaL_optstring(L, 2, currentParser->accessModes.c_str()), currentParser->accessModes);
+
+	std::vector<std::string> filenames;
+	filenames.reserve(lua_objlen(L, 1));
+
+	for (int i = 1, n = lua_objlen(L, 1); i <= n; ++i) {
+		lua_rawgeti(L, 1, i);
+
+		if (lua_isstring(L, -1)) {
+			std::string filename = lua_tostring(L, -1);
+
+			if (LuaIO::IsSimplePath(filename))
+				filenames.emplace_back(std::move(filename));
+		}
+
+		lua_pop(L, 1);
+	}
+
+	CFileHandler::PrefetchFiles(filenames, modes);
+	return 0;
+}
+
+
 int LuaParser::DontMessWithMyCase(lua_State* L)
 {
 	LuaParser* currentParser = GetLuaParser(L);
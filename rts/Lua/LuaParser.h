@@ -9,6 +9,7 @@
 #include "LuaContextData.h"
 
 #include "System/FileSystem/VFSModes.h"
+#include "System/Sync/SHA512.hpp"
 #include "System/UnorderedMap.hpp"
 
 class float3;
@@ -132,6 +133,17 @@ public:
 	void SetupLua(bool isSyncedCtxt, bool isDefsParser);
 
 	bool Execute();
+
+	/**
+	 * Binary snapshot of the root table produced by Execute, for parsers
+	 * whose result is fully determined by inputs the caller hashes into
+	 * <key>. Only tables holding numbers, strings, booleans and tables
+	 * without metatables can be written. ReadSnapshot replaces Execute and
+	 * fails if the file is missing, damaged or belongs to another key.
+	 */
+	bool ReadSnapshot(const std::string& filePath, const sha512::raw_digest& key);
+	bool WriteSnapshot(const std::string& filePath, const sha512::raw_digest& key);
+
 	bool IsValid() const { return (L != nullptr); } // true if nothing failed during Execute
 	bool NoTable() const { return (errorLog.find("no return table") == 0); } // parser is still valid if true
 
@@ -209,6 +221,7 @@ private:
 	static int Include(lua_State* L);
 	static int LoadFile(lua_State* L);
 	static int FileExists(lua_State* L);
+	static int PrefetchFiles(lua_State* L);
 };
 
 
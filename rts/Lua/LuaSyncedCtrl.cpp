@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <cctype>
+#include <cstring>
 
 #include "LuaSyncedCtrl.h"
 
@@ -1316,6 +1317,28 @@ int LuaSyncedCtrl::ShareTeamResource(lua_State* L)
  *
  * See https://github.com/LuaLS/lua-language-server/issues/1814
  */
+static void SyncRulesParam(const char* caller, const std::string& key, const LuaRulesParams::Param* param)
+{
+#ifdef SYNCCHECK
+	CSyncChecker::SyncSubsystem(CSyncChecker::SUBSYS_RULESPARAMS, caller, strlen(caller));
+	CSyncChecker::SyncSubsystem(CSyncChecker::SUBSYS_RULESPARAMS, key.data(), key.size());
+
+	// erased
+	if (param == nullptr)
+		return;
+
+	CSyncChecker::SyncSubsystem(CSyncChecker::SUBSYS_RULESPARAMS, param->los);
+
+	std::visit([](const auto& value) {
+		if constexpr (std::is_same_v<std::decay_t<decltype(value)>, std::string>) {
+			CSyncChecker::SyncSubsystem(CSyncChecker::SUBSYS_RULESPARAMS, value.data(), value.size());
+		} else {
+			CSyncChecker::SyncSubsystem(CSyncChecker::SUBSYS_RULESPARAMS, value);
+		}
+	}, param->value);
+#endif
+}
+
 void SetRulesParam(lua_State* L, const char* caller, int offset,
 				LuaRulesParams::Params& params)
 {
@@ -1336,6 +1359,7 @@ void SetRulesParam(lua_State* L, const char* caller, int offset,
 		param.value.emplace <std::string> (lua_tostring(L, valIndex));
 	} else if (lua_isnoneornil(L, valIndex)) {
 		params.erase(key);
+		SyncRulesParam(caller, key, nullptr);
 		return; //no need to set los if param was erased
 	} else {
 		params.erase(key);
@@ -1370,6 +1394,8 @@ void SetRulesParam(lua_State* L, const char* caller, int offset,
 	} else {
 		param.los = luaL_optint(L, losIndex, param.los);
 	}
+
+	SyncRulesParam(caller, key, &param);
 }
 
 
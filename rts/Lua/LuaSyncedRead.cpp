@@ -231,6 +231,9 @@ bool LuaSyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetUnitDirection);
 	REGISTER_LUA_CFUNC(GetUnitHeading);
 	REGISTER_LUA_CFUNC(GetUnitVelocity);
+	REGISTER_LUA_CFUNC(GetUnitArrayPositions);
+	REGISTER_LUA_CFUNC(GetUnitArrayVelocities);
+	REGISTER_LUA_CFUNC(GetUnitArrayHealths);
 	REGISTER_LUA_CFUNC(GetUnitBuildFacing);
 	REGISTER_LUA_CFUNC(GetUnitIsBuilding);
 	REGISTER_LUA_CFUNC(GetUnitWorkerTask);
@@ -4520,6 +4523,160 @@ int LuaSyncedRead::GetUnitVelocity(lua_State* L)
 }
 
 
+/*
+ * Shared by the GetUnitArray* functions: for every unitID in the array at
+ * index 1 that passes <parseUnit>, appends one record of the unitID plus
+ * the values pushed by <pushValues> to the buffer table at index 2 (or to
+ * a new table if there is none). Entries past the last record are left as
+ * they were, so a buffer can be reused across calls without reallocation.
+ */
+template<typename ParseUnitFunc, typename PushValuesFunc>
+static int FillUnitArrayBuffer(lua_State* L, const char* caller, const ParseUnitFunc& parseUnit, const PushValuesFunc& pushValues)
+{
+	luaL_checktype(L, 1, LUA_TTABLE);
+
+	const int numUnitIDs = lua_objlen(L, 1);
+
+	if (!lua_istable(L, 2)) {
+		lua_settop(L, 1);
+		lua_createtable(L, numUnitIDs * 4, 0);
+	}
+
+	int numRecords = 0;
+	int bufIdx = 0;
+
+	for (int i = 1; i <= numUnitIDs; i++) {
+		lua_rawgeti(L, 1, i);
+
+		const CUnit* unit = parseUnit(L, caller, -1);
+
+		lua_pop(L, 1);
+
+		if (unit == nullptr)
+			continue;
+
+		lua_pushnumber(L, unit->id);
+		lua_rawseti(L, 2, ++bufIdx);
+
+		bufIdx = pushValues(unit, bufIdx);
+		numRecords += 1;
+	}
+
+	lua_pushnumber(L, numRecords);
+	lua_pushvalue(L, 2);
+	return 2;
+}
+
+/*** Gets the positions of an array of units at once
+ *
+ * @function Spring.GetUnitArrayPositions
+ *
+ * Visibility rules are the same as for `Spring.GetUnitPosition`, units that
+ * fail them (or do not exist) are left out. Each record consists of the
+ * unitID and the base position, followed by the midpoint and aimpoint if
+ * requested, so holds 4, 7 or 10 numbers.
+ *
+ * @param unitIDs integer[]
+ * @param buffer number[]? table the records are written to, starting at index 1; entries past the last record are not cleared
+ * @param midPos boolean? (Default: false) append the midpoint to each record
+ * @param aimPos boolean? (Default: false) append the aimpoint to each record
+ * @return integer numUnits number of records written
+ * @return number[] buffer
+ */
+int LuaSyncedRead::GetUnitArrayPositions(lua_State* L)
+{
+	const bool returnMidPos = luaL_optboolean(L, 3, false);
+	const bool returnAimPos = luaL_optboolean(L, 4, false);
+
+	const int readAllyTeam = CLuaHandle::GetHandleReadAllyTeam(L);
+	const bool fullRead = CLuaHandle::GetHandleFullRead(L);
+
+	return FillUnitArrayBuffer(L, __func__, ParseUnit, [&](const CUnit* unit, int bufIdx) {
+		float3 errorVec;
+
+		if (!LuaUtils::IsAllyUnit(L, unit))
+			errorVec = unit->GetLuaErrorVector(readAllyTeam, fullRead);
+
+		const auto pushPos = [&](const float3& pos) {
+			lua_pushnumber(L, pos.x + errorVec.x); lua_rawseti(L, 2, ++bufIdx);
+			lua_pushnumber(L, pos.y + errorVec.y); lua_rawseti(L, 2, ++bufIdx);
+			lua_pushnumber(L, pos.z + errorVec.z); lua_rawseti(L, 2, ++bufIdx);
+		};
+
+		pushPos(unit->pos);
+
+		if (returnMidPos)
+			pushPos(unit->midPos);
+		if (returnAimPos)
+			pushPos(unit->aimPos);
+
+		return bufIdx;
+	});
+}
+
+/*** Gets the velocities of an array of units at once
+ *
+ * @function Spring.GetUnitArrayVelocities
+ *
+ * Units outside of LOS (or that do not exist) are left out, like for
+ * `Spring.GetUnitVelocity`. Each record holds 5 numbers: unitID, velX,
+ * velY, velZ and the speed.
+ *
+ * @param unitIDs integer[]
+ * @param buffer number[]? table the records are written to, starting at index 1; entries past the last record are not cleared
+ * @return integer numUnits number of records written
+ * @return number[] buffer
+ */
+int LuaSyncedRead::GetUnitArrayVelocities(lua_State* L)
+{
+	return FillUnitArrayBuffer(L, __func__, ParseInLosUnit, [&](const CUnit* unit, int bufIdx) {
+		lua_pushnumber(L, unit->speed.x); lua_rawseti(L, 2, ++bufIdx);
+		lua_pushnumber(L, unit->speed.y); lua_rawseti(L, 2, ++bufIdx);
+		lua_pushnumber(L, unit->speed.z); lua_rawseti(L, 2, ++bufIdx);
+		lua_pushnumber(L, unit->speed.w); lua_rawseti(L, 2, ++bufIdx);
+		return bufIdx;
+	});
+}
+
+/*** Gets the health of an array of units at once
+ *
+ * @function Spring.GetUnitArrayHealths
+ *
+ * Units outside of LOS (or that do not exist) are left out, like for
+ * `Spring.GetUnitHealth`. Each record holds 6 values: unitID, health,
+ * maxHealth, paralyzeDamage, captureProgress and buildProgress. The three
+ * health values are `false` for enemy units whose def hides damage.
+ *
+ * @param unitIDs integer[]
+ * @param buffer table? table the records are written to, starting at index 1; entries past the last record are not cleared
+ * @return integer numUnits number of records written
+ * @return table buffer
+ */
+int LuaSyncedRead::GetUnitArrayHealths(lua_State* L)
+{
+	return FillUnitArrayBuffer(L, __func__, ParseInLosUnit, [&](const CUnit* unit, int bufIdx) {
+		const UnitDef* ud = unit->unitDef;
+		const bool enemyUnit = LuaUtils::IsEnemyUnit(L, unit);
+
+		if (ud->hideDamage && enemyUnit) {
+			lua_pushboolean(L, false); lua_rawseti(L, 2, ++bufIdx);
+			lua_pushboolean(L, false); lua_rawseti(L, 2, ++bufIdx);
+			lua_pushboolean(L, false); lua_rawseti(L, 2, ++bufIdx);
+		} else {
+			const float scale = (!enemyUnit || (ud->decoyDef == nullptr))? 1.0f: (ud->decoyDef->health / ud->health);
+
+			lua_pushnumber(L, scale * unit->health        ); lua_rawseti(L, 2, ++bufIdx);
+			lua_pushnumber(L, scale * unit->maxHealth     ); lua_rawseti(L, 2, ++bufIdx);
+			lua_pushnumber(L, scale * unit->paralyzeDamage); lua_rawseti(L, 2, ++bufIdx);
+		}
+
+		lua_pushnumber(L, unit->captureProgress); lua_rawseti(L, 2, ++bufIdx);
+		lua_pushnumber(L, unit->buildProgress  ); lua_rawseti(L, 2, ++bufIdx);
+		return bufIdx;
+	});
+}
+
+
 /***
  *
  * @function Spring.GetUnitBuildFacing
@@ -136,6 +136,9 @@ class LuaSyncedRead {
 		static int GetUnitDirection(lua_State* L);
 		static int GetUnitHeading(lua_State* L);
 		static int GetUnitVelocity(lua_State* L);
+		static int GetUnitArrayPositions(lua_State* L);
+		static int GetUnitArrayVelocities(lua_State* L);
+		static int GetUnitArrayHealths(lua_State* L);
 		static int GetUnitBuildFacing(lua_State* L);
 		static int GetUnitIsBuilding(lua_State* L);
 		static int GetUnitWorkerTask(lua_State* L);
@@ -1711,8 +1711,8 @@ int LuaUnsyncedRead::GetUnitViewPosition(lua_State* L)
 // never instantiated directly
 template<class T> class CWorldObjectQuadDrawer: public CReadMap::IQuadDrawer {
 public:
-	typedef std::vector<T*> ObjectList;
-	typedef std::vector< const ObjectList* > ObjectVector;
+	typedef std::span<T* const> ObjectList;
+	typedef std::vector<ObjectList> ObjectVector;
 
 	void ResetState() override {
 		objectLists.clear();
@@ -1726,16 +1726,16 @@ public:
 
 	const ObjectVector& GetObjectLists() { return objectLists; }
 
-	void AddObjectList(const ObjectList* objects) {
-		if (objects->empty())
+	void AddObjectList(ObjectList objects) {
+		if (objects.empty())
 			return;
 
 		objectLists.push_back(objects);
-		objectCount += objects->size();
+		objectCount += objects.size();
 	}
 
 protected:
-	// note: stores pointers to lists, not copies
+	// note: stores views of the quadfield's lists, not copies
 	// its size equals the number of visible quads
 	ObjectVector objectLists;
 
@@ -1746,30 +1746,24 @@ protected:
 class CVisUnitQuadDrawer: public CWorldObjectQuadDrawer<CUnit> {
 public:
 	void DrawQuad(int x, int y) override {
-		const CQuadField::Quad& q = quadField.GetQuadAt(x, y);
-		const ObjectList* o = &q.units;
-
-		AddObjectList(o);
+		const CQuadField::QuadView q = quadField.GetQuadAt(x, y);
+		AddObjectList(q.units);
 	}
 };
 
 class CVisFeatureQuadDrawer: public CWorldObjectQuadDrawer<CFeature> {
 public:
 	void DrawQuad(int x, int y) override {
-		const CQuadField::Quad& q = quadField.GetQuadAt(x, y);
-		const ObjectList* o = &q.features;
-
-		AddObjectList(o);
+		const CQuadField::QuadView q = quadField.GetQuadAt(x, y);
+		AddObjectList(q.features);
 	}
 };
 
 class CVisProjectileQuadDrawer: public CWorldObjectQuadDrawer<CProjectile> {
 public:
 	void DrawQuad(int x, int y) override {
-		const CQuadField::Quad& q = quadField.GetQuadAt(x, y);
-		const ObjectList* o = &q.projectiles;
-
-		AddObjectList(o);
+		const CQuadField::QuadView q = quadField.GetQuadAt(x, y);
+		AddObjectList(q.projectiles);
 	}
 };
 
@@ -1834,7 +1828,7 @@ int LuaUnsyncedRead::GetVisibleUnits(lua_State* L)
 
 	unsigned int count = 0;
 	for (auto visUnitList: unitQuadIter.GetObjectLists()) {
-		for (CUnit* u: *visUnitList) {
+		for (CUnit* u: visUnitList) {
 			if (u->tempNum == tempNum)
 				continue;
 
@@ -1922,7 +1916,7 @@ int LuaUnsyncedRead::GetVisibleFeatures(lua_State* L)
 
 	unsigned int count = 0;
 	for (auto visFeatureList: featureQuadIter.GetObjectLists()) {
-		for (CFeature* f: *visFeatureList) {
+		for (CFeature* f: visFeatureList) {
 			if (f->tempNum == tempNum)
 				continue;
 
@@ -1995,7 +1989,7 @@ int LuaUnsyncedRead::GetVisibleProjectiles(lua_State* L)
 
 	unsigned int count = 0;
 	for (auto visProjectileList: projQuadIter.GetObjectLists()) {
-		for (CProjectile* p: *visProjectileList) {
+		for (CProjectile* p: visProjectileList) {
 			if (p->tempNum == tempNum)
 				continue;
 
@@ -2236,7 +2230,7 @@ int LuaUnsyncedRead::GetUnitsInScreenRectangle(lua_State* L)
 
 	uint32_t count = 0;
 	for (auto visUnitList : unitQuadIter.GetObjectLists()) {
-		for (CUnit* unit : *visUnitList) {
+		for (CUnit* unit : visUnitList) {
 			if (disqualifierFunc(unit))
 				continue;
 
@@ -2293,7 +2287,7 @@ int LuaUnsyncedRead::GetFeaturesInScreenRectangle(lua_State* L)
 
 	uint32_t count = 0;
 	for (auto visFeatureList : featureQuadIter.GetObjectLists()) {
-		for ( CFeature* feature : *visFeatureList ) {
+		for ( CFeature* feature : visFeatureList ) {
 			if (feature->tempNum == tempNum)
 				continue;
 
@@ -7,6 +7,7 @@
 #include "Rendering/Env/GrassDrawer.h"
 #include "Sim/Misc/GroundBlockingObjectMap.h"
 #include "Sim/Misc/LosHandler.h"
+#include "Sim/Misc/ModInfo.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/SmoothHeightMesh.h"
 #include "Sim/Units/Unit.h"
@@ -55,6 +56,7 @@ void CBasicMapDamage::Init()
 	explosionSquaresPool.resize(4 * 1024 * 1024);
 	explosionUpdateQueue.clear();
 	explosionUpdateQueue.reserve(64);
+	recalcAreaQueue.clear();
 
 	std::fill(explosionSquaresPool.begin(), explosionSquaresPool.end(), 0.0f);
 }
@@ -253,6 +255,24 @@ void CBasicMapDamage::RecalcArea(int x1, int x2, int y1, int y2)
 }
 
 
+void CBasicMapDamage::RecalcQueuedAreas()
+{
+	if (recalcAreaQueue.empty())
+		return;
+
+	// split overlapping areas into disjoint ones so shared squares are only
+	// recalculated once; this runs after the heights of every explosion of
+	// the frame were applied, which is why it is a modrule
+	recalcAreaQueue.Process(true);
+
+	for (const SRectangle& r: recalcAreaQueue) {
+		RecalcArea(r.x1, r.x2, r.z1, r.z2);
+	}
+
+	recalcAreaQueue.clear();
+}
+
+
 void CBasicMapDamage::Update()
 {
 	SCOPED_TIMER("Sim::BasicMapDamage");
@@ -292,9 +312,16 @@ void CBasicMapDamage::Update()
 		if (e.ttl != 0)
 			continue;
 
-		RecalcArea(e.x1 - 1, e.x2 + 1, e.y1 - 1, e.y2 + 1);
+		if (!modInfo.batchMapDamageRecalc) {
+			RecalcArea(e.x1 - 1, e.x2 + 1, e.y1 - 1, e.y2 + 1);
+			continue;
+		}
+
+		recalcAreaQueue.push_back({e.x1 - 1, e.y1 - 1, e.x2 + 1, e.y2 + 1});
 	}
 
+	RecalcQueuedAreas();
+
 
 	// pop explosions that are no longer being processed
 	while (explUpdateQueueIdx < explosionUpdateQueue.size()) {
@@ -4,6 +4,7 @@
 #define _BASIC_MAP_DAMAGE_H
 
 #include "MapDamage.h"
+#include "System/Misc/RectangleOverlapHandler.h"
 
 #include <vector>
 
@@ -21,6 +22,8 @@ public:
 	bool Disabled() const override { return false; }
 
 private:
+	void RecalcQueuedAreas();
+
 	void SetExplosionSquare(float v) {
 		explosionSquaresPool[explSquaresPoolIdx] = v;
 
@@ -61,6 +64,11 @@ private:
 	std::vector<float> explosionSquaresPool;
 	std::vector<Explo> explosionUpdateQueue;
 
+	// areas of explosions that finished this frame, recalculated together
+	// so overlapping craters do not repeat the normal/slope/path updates
+	// (only used with modInfo.batchMapDamageRecalc)
+	CRectangleOverlapHandler recalcAreaQueue;
+
 	static constexpr unsigned int CRATER_TABLE_SIZE = 200;
 	static constexpr unsigned int EXPLOSION_LIFETIME = 10;
 
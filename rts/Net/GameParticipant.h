@@ -4,6 +4,7 @@
 #define _GAME_PARTICIPANT_H
 
 #include <memory>
+#include <vector>
 
 #include "Game/Players/PlayerBase.h"
 #include "Game/Players/PlayerStatistics.h"
@@ -69,6 +70,7 @@ public:
 
 	#ifdef SYNCCHECK
 	spring::unordered_map<int, unsigned int> syncResponse; // syncResponse[frameNum] = checksum
+	spring::unordered_map<int, std::vector<uint32_t>> syncSubsysResponse; // syncSubsysResponse[frameNum] = per-subsystem checksums
 	#endif
 
 private:
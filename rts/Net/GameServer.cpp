@@ -4,6 +4,7 @@
 #include "System/Net/UDPConnection.h"
 
 #include <functional>
+#include <cinttypes>
 
 #if defined DEDICATED || defined DEBUG
 	#include <iostream>
@@ -55,6 +56,7 @@
 #include "System/Log/ILog.h"
 #include "System/Platform/errorhandler.h"
 #include "System/Platform/Threading.h"
+#include "System/Sync/SyncChecker.h"
 #include "System/Threading/SpringThreading.h"
 
 #ifndef DEDICATED
@@ -262,7 +264,7 @@ void CGameServer::Initialize()
 
 	thread = spring::thread(std::bind(&CGameServer::UpdateLoop, this));
 
-	LOG("%s: thread affinity %x", __func__, Threading::GetAffinity());
+	LOG("%s: thread affinity %" PRIx64, __func__, Threading::GetAffinity());
 
 	// Something in CGameServer::CGameServer borks the FPU control word
 	// maybe the threading, or something in CNet::InitServer() ??
@@ -731,6 +733,10 @@ void CGameServer::CheckSync()
 				Broadcast(CBaseNetProtocol::Get().SendSdCheckrequest(serverFrameNum));
 			#endif
 
+				// ask everyone which subsystems diverged; answered from
+				// a short history, so this also works after a few frames
+				Broadcast(CBaseNetProtocol::Get().SendSyncSubsystemRequest(outstandingSyncFrame));
+
 				if (!desyncHasOccurred) {
 					if (globalConfig.dumpGameStateOnDesync) {
 						LOG("Desync detected. Requesting all clients to collect game state information.");
@@ -776,6 +782,7 @@ void CGameServer::CheckSync()
 		++outstandingSyncFrameIt;
 	}
 
+	CheckSyncSubsystems();
 #else
 
 	// Make it clear this build isn't suitable for release.
@@ -787,6 +794,102 @@ void CGameServer::CheckSync()
 }
 
 
+void CGameServer::CheckSyncSubsystems()
+{
+#ifdef SYNCCHECK
+	std::vector< std::pair<const std::vector<uint32_t>*, unsigned> > checksums; // <response checksums, #clients matching>
+
+	auto frameIt = outstandingSyncSubsysFrames.begin();
+
+	while (frameIt != outstandingSyncSubsysFrames.end()) {
+		const int frameNum = *frameIt;
+		const bool timedOut = (frameNum < (serverFrameNum - static_cast<int>(SYNCCHECK_TIMEOUT)));
+
+		bool completeResponseSet = true;
+
+		for (const GameParticipant& p: players) {
+			if (p.clientLink == nullptr || p.myState == GameParticipant::State::DISCONNECTING)
+				continue;
+
+			completeResponseSet &= (p.syncSubsysResponse.find(frameNum) != p.syncSubsysResponse.end());
+		}
+
+		if (!completeResponseSet && !timedOut) {
+			++frameIt;
+			continue;
+		}
+
+		// same choice of baseline as CheckSync: the local client, else the majority
+		const std::vector<uint32_t>* correctChecksums = nullptr;
+
+		if (HasLocalClient()) {
+			const auto it = players[localClientNumber].syncSubsysResponse.find(frameNum);
+
+			if (it != players[localClientNumber].syncSubsysResponse.end())
+				correctChecksums = &it->second;
+		} else {
+			checksums.clear();
+
+			for (const GameParticipant& p: players) {
+				const auto it = p.syncSubsysResponse.find(frameNum);
+
+				if (it == p.syncSubsysResponse.end())
+					continue;
+
+				const auto pred = [&](const auto& pair) { return (*pair.first == it->second); };
+				const auto iter = std::find_if(checksums.begin(), checksums.end(), pred);
+
+				if (iter == checksums.end()) {
+					checksums.emplace_back(&it->second, 1);
+				} else {
+					iter->second += 1;
+				}
+			}
+
+			const auto pred = [](const auto& a, const auto& b) { return (a.second < b.second); };
+			const auto iter = std::max_element(checksums.begin(), checksums.end(), pred);
+
+			if (iter != checksums.end())
+				correctChecksums = iter->first;
+		}
+
+		for (GameParticipant& p: players) {
+			const auto it = p.syncSubsysResponse.find(frameNum);
+
+			if (it == p.syncSubsysResponse.end())
+				continue;
+
+			if (correctChecksums != nullptr && it->second != *correctChecksums) {
+				const std::vector<uint32_t>& pChecksums = it->second;
+
+				std::string differing;
+				unsigned int firstDiffering = CSyncChecker::SUBSYS_COUNT;
+
+				for (size_t i = 0, n = std::min(pChecksums.size(), correctChecksums->size()); i < n; i++) {
+					if (pChecksums[i] == (*correctChecksums)[i])
+						continue;
+
+					firstDiffering = std::min(firstDiffering, unsigned(i));
+
+					differing += (differing.empty()? "": ", ");
+					differing += CSyncChecker::GetSubsystemName(i);
+				}
+
+				const std::string& msg = spring::format(SyncSubsysError, p.name.c_str(), frameNum, CSyncChecker::GetSubsystemName(firstDiffering), differing.c_str());
+
+				LOG_L(L_ERROR, "%s", msg.c_str());
+				Message(msg);
+			}
+
+			p.syncSubsysResponse.erase(frameNum);
+		}
+
+		frameIt = outstandingSyncSubsysFrames.erase(frameIt);
+	}
+#endif
+}
+
+
 float CGameServer::GetDemoTime() const {
 	if (!gameHasStarted) return gameTime;
 	return (startTime + serverFrameNum * INV_GAME_SPEED);
@@ -1118,7 +1221,7 @@ void CGameServer::ProcessPacket(const unsigned playerNum, std::shared_ptr<const
 				unsigned char playerNum;
 				pckt >> playerNum;
 				if (playerNum != a) {
-					Message(spring::format(WrongPlayer, msgCode, a, playerNum));
+					Message(spring::format(WrongPlayer, msgCode, a, (unsigned)playerNum));
 					break;
 				}
 				pckt >> players[playerNum].name;
@@ -1138,7 +1241,7 @@ void CGameServer::ProcessPacket(const unsigned playerNum, std::shared_ptr<const
 			const unsigned char playerNum = inbuf[1];
 			const std::uint32_t playerCheckSum = *(std::uint32_t*) &inbuf[2];
 			if (playerNum != a) {
-				Message(spring::format(WrongPlayer, msgCode, a, playerNum));
+				Message(spring::format(WrongPlayer, msgCode, a, (unsigned)playerNum));
 				break;
 			}
 			Broadcast(CBaseNetProtocol::Get().SendPathCheckSum(playerNum, playerCheckSum));
@@ -1848,6 +1951,34 @@ void CGameServer::ProcessPacket(const unsigned playerNum, std::shared_ptr<const
 			LOG("Server broadcast game state collection request.");
 			Broadcast(packet);
 			break;
+
+		case NETMSG_SYNCSUBSYS_RESPONSE: {
+#ifdef SYNCCHECK
+			try {
+				netcode::UnpackPacket pckt(packet, 1);
+
+				uint16_t packetSize; pckt >> packetSize;
+				uint8_t   playerNum; pckt >> playerNum;
+				int32_t    frameNum; pckt >> frameNum;
+
+				if (playerNum != a) {
+					Message(spring::format(WrongPlayer, msgCode, a, (unsigned)playerNum));
+					break;
+				}
+
+				const uint32_t headerSize = sizeof(uint8_t) + sizeof(packetSize) + sizeof(playerNum) + sizeof(frameNum);
+				const uint32_t numChecksums = (packetSize - std::min(uint32_t(packetSize), headerSize)) / sizeof(uint32_t);
+
+				std::vector<uint32_t> checksums(std::min(numChecksums, uint32_t(CSyncChecker::SUBSYS_COUNT)));
+				pckt >> checksums;
+
+				players[a].syncSubsysResponse[frameNum] = std::move(checksums);
+				outstandingSyncSubsysFrames.insert(frameNum);
+			} catch (const netcode::UnpackPacketException& ex) {
+				Message(spring::format("[GameServer::%s][NETMSG_SYNCSUBSYS_RESPONSE] exception \"%s\" from player \"%s\"", __func__, ex.what(), players[a].name.c_str()));
+			}
+#endif
+		} break;
 		// CGameServer should never get these messages
 		//case NETMSG_GAMEID:
 		//case NETMSG_INTERNAL_SPEED:
@@ -1893,6 +2024,7 @@ void CGameServer::HandleConnectionAttempts()
 			std::string platform;
 			uint8_t reconnect;
 			uint8_t netloss;
+			uint8_t compression = 0;
 			uint16_t netversion;
 			msg >> netversion;
 			msg >> name;
@@ -1902,10 +2034,14 @@ void CGameServer::HandleConnectionAttempts()
 			msg >> reconnect;
 			msg >> netloss;
 
+			// not sent by older clients, checked below
+			if (msg.GetRemaining() > 0)
+				msg >> compression;
+
 			if (netversion != NETWORK_VERSION)
 				throw netcode::UnpackPacketException(spring::format("Wrong network version: received %d, required %d", (int)netversion, (int)NETWORK_VERSION));
 
-			BindConnection(udpListener->AcceptConnection(), name, passwd, version, platform, false, reconnect, netloss);
+			BindConnection(udpListener->AcceptConnection(), name, passwd, version, platform, false, reconnect, netloss, compression);
 		} catch (const netcode::UnpackPacketException& ex) {
 			const asio::ip::udp::endpoint endp = prev->GetEndpoint();
 			const asio::ip::address addr = endp.address();
@@ -2731,7 +2867,7 @@ void CGameServer::UpdateLoop()
 		if (hostif != nullptr)
 			hostif->SendQuit();
 
-		LOG("%s: thread affinity %x", __func__, Threading::GetAffinity());
+		LOG("%s: thread affinity %" PRIx64, __func__, Threading::GetAffinity());
 
 		Broadcast(CBaseNetProtocol::Get().SendQuit("Server shutdown"));
 
@@ -2879,7 +3015,8 @@ unsigned CGameServer::BindConnection(
 	const std::string& clientPlatform,
 	bool isLocal,
 	bool reconnect,
-	int netloss
+	int netloss,
+	bool compression
 ) {
 	Message(spring::format("%s attempt from %s", (reconnect ? "Reconnection" : "Connection"), clientName.c_str()));
 	Message(spring::format(" -> Version: %s [%s]", clientVersion.c_str(), clientPlatform.c_str()));
@@ -3017,6 +3154,7 @@ unsigned CGameServer::BindConnection(
 
 		Message(spring::format(" -> Connection reestablished (id %i)", newPlayerNumber));
 		newPlayer.clientLink->SetLossFactor(netloss);
+		newPlayer.clientLink->SetPeerCompression(compression);
 		newPlayer.clientLink->Flush(!gameHasStarted);
 		return newPlayerNumber;
 	}
@@ -3048,6 +3186,7 @@ unsigned CGameServer::BindConnection(
 	// new connection established
 	Message(spring::format(" -> Connection established (given id %i)", newPlayerNumber));
 	clientLink->SetLossFactor(netloss);
+	clientLink->SetPeerCompression(compression);
 	clientLink->Flush(!gameHasStarted);
 	return newPlayerNumber;
 }
@@ -152,7 +152,8 @@ private:
 		const std::string& clientPlatform,
 		bool isLocal,
 		bool reconnect = false,
-		int netloss = 0
+		int netloss = 0,
+		bool compression = false
 	);
 
 	void CheckForGameStart(bool forced = false);
@@ -161,6 +162,7 @@ private:
 	void Update();
 	void ProcessPacket(const unsigned playerNum, std::shared_ptr<const netcode::RawPacket> packet);
 	void CheckSync();
+	void CheckSyncSubsystems();
 	void HandleConnectionAttempts();
 	void ServerReadNet();
 
@@ -226,6 +228,8 @@ private:
 	/////////////////// sync stuff ///////////////////
 #ifdef SYNCCHECK
 	std::set<int> outstandingSyncFrames;
+	// frames for which per-subsystem checksums have been received
+	std::set<int> outstandingSyncSubsysFrames;
 #endif
 
 	/////////////////// game status variables ///////////////////
@@ -47,6 +47,20 @@ LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_NET)
 
 static spring::unordered_map<int32_t, uint32_t> localSyncChecksums;
 
+#ifdef SYNCCHECK
+static void SendSyncSubsystemChecksums(int32_t frameNum)
+{
+	static std::vector<uint32_t> checksums;
+
+	if (!CSyncChecker::GetSubsystemChecksums(frameNum, checksums)) {
+		LOG_L(L_WARNING, "[%s] no subsystem checksums for frame %d", __func__, frameNum);
+		return;
+	}
+
+	clientNet->Send(CBaseNetProtocol::Get().SendSyncSubsystemResponse(gu->myPlayerNum, frameNum, checksums));
+}
+#endif
+
 
 void CGame::AddTraffic(int playerID, int packetCode, int length)
 {
@@ -626,6 +640,9 @@ void CGame::ClientReadNet()
 				if (haveServerDemo)
 					localSyncChecksums[gs->frameNum] = CSyncChecker::GetChecksum();
 
+				if (globalConfig.syncSubsystemChecksumInterval > 0 && (gs->frameNum % globalConfig.syncSubsystemChecksumInterval) == 0)
+					SendSyncSubsystemChecksums(gs->frameNum);
+
 				// reset checksum every 4096 frames =~ 2.5 minutes
 				if ((gs->frameNum & 4095) == 0)
 					CSyncChecker::NewFrame();
@@ -1575,6 +1592,13 @@ void CGame::ClientReadNet()
 				break;
 			}
 
+			case NETMSG_SYNCSUBSYS_REQUEST: {
+#ifdef SYNCCHECK
+				SendSyncSubsystemChecksums(*(int32_t*)(inbuf + 1));
+#endif
+				AddTraffic(-1, packetCode, dataLength);
+			} break;
+
 			default: {
 #ifdef SYNCDEBUG
 				if (!CSyncDebugger::GetInstance()->ClientReceived(inbuf))
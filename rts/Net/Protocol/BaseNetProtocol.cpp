@@ -246,6 +246,7 @@ PacketType CBaseNetProtocol::SendAttemptConnect(
 		sizeof(NETWORK_VERSION) +
 		sizeof(static_cast<uint8_t>(netloss)) +
 		sizeof(static_cast<uint8_t>(reconnect)) +
+		sizeof(uint8_t) +
 		(name.size() + 1) +
 		(passwd.size() + 1) +
 		(version.size() + 1) +
@@ -262,6 +263,8 @@ PacketType CBaseNetProtocol::SendAttemptConnect(
 	*packet << platform;
 	*packet << uint8_t(reconnect);
 	*packet << uint8_t(netloss);
+	// we can decode compressed packets
+	*packet << uint8_t(1);
 
 	return PacketType(packet);
 }
@@ -611,6 +614,24 @@ PacketType CBaseNetProtocol::SendGameStateDump()
 	return PacketType(packet);
 }
 
+PacketType CBaseNetProtocol::SendSyncSubsystemRequest(int32_t frameNum)
+{
+	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(frameNum), NETMSG_SYNCSUBSYS_REQUEST);
+	*packet << frameNum;
+	return PacketType(packet);
+}
+
+PacketType CBaseNetProtocol::SendSyncSubsystemResponse(uint8_t playerNum, int32_t frameNum, const std::vector<uint32_t>& checksums)
+{
+	const uint32_t payloadSize = sizeof(playerNum) + sizeof(frameNum) + (checksums.size() * sizeof(uint32_t));
+	const uint32_t headerSize = sizeof(uint8_t) + sizeof(uint16_t);
+	const uint32_t packetSize = headerSize + payloadSize;
+
+	PackPacket* packet = new PackPacket(packetSize, NETMSG_SYNCSUBSYS_RESPONSE);
+	*packet << static_cast<uint16_t>(packetSize) << playerNum << frameNum << checksums;
+	return PacketType(packet);
+}
+
 CBaseNetProtocol::CBaseNetProtocol()
 {
 	netcode::ProtocolDef* proto = netcode::ProtocolDef::GetInstance();
@@ -681,5 +702,7 @@ CBaseNetProtocol::CBaseNetProtocol()
 #endif // SYNCDEBUG
 
 	proto->AddType(NETMSG_GAMESTATE_DUMP, 1);
+	proto->AddType(NETMSG_SYNCSUBSYS_REQUEST, 1 + sizeof(int32_t));
+	proto->AddType(NETMSG_SYNCSUBSYS_RESPONSE, -2);
 }
 
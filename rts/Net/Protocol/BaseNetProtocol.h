@@ -119,6 +119,8 @@ public:
 #endif
 
 	PacketType SendGameStateDump();
+	PacketType SendSyncSubsystemRequest(int32_t frameNum);
+	PacketType SendSyncSubsystemResponse(uint8_t playerNum, int32_t frameNum, const std::vector<uint32_t>& checksums);
 
 private:
 	CBaseNetProtocol();
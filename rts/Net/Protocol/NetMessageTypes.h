@@ -67,6 +67,8 @@ enum NETMSG {
 #endif // SYNCDEBUG
 
 	NETMSG_GAMESTATE_DUMP	= 46, // no arguments
+	NETMSG_SYNCSUBSYS_REQUEST  = 47, // int32_t frameNum
+	NETMSG_SYNCSUBSYS_RESPONSE = 48, // uint16_t messageSize, uint8_t playerNum, int32_t frameNum, std::vector<uint32_t> checksums
 
 	NETMSG_LOGMSG           = 49, // uint8_t playerNum, uint8_t logMsgLvl, std::string strData
 	NETMSG_LUAMSG           = 50, // /* uint16_t messageSize */, uint8_t playerNum, uint16_t script, uint8_t mode, std::vector<uint8_t> rawData
@@ -79,7 +81,8 @@ enum NETMSG {
 	NETMSG_TEAMSTAT         = 60, // uint8_t teamNum, struct TeamStatistics statistics      # used by LadderBot #
 	NETMSG_CLIENTDATA       = 61, // uint16_t messageSize, std::string setupText
 
-	NETMSG_ATTEMPTCONNECT   = 65, // uint16_t msgsize, uint16_t netversion, string playername, string passwd, string VERSION_STRING_DETAILED
+	NETMSG_ATTEMPTCONNECT   = 65, // uint16_t msgsize, uint16_t netversion, string playername, string passwd, string VERSION_STRING_DETAILED, string platform,
+	                              // uint8_t reconnect, uint8_t netloss, uint8_t compression
 	NETMSG_REJECT_CONNECT   = 66, // string reason
 
 	NETMSG_AI_CREATED       = 70, // /* uint8_t messageSize */, uint8_t playerNum, uint8_t whichSkirmishAI, uint8_t team, std::string name (ends with \0)
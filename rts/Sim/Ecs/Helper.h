@@ -11,7 +11,7 @@ namespace Sim {
     void ClearRegistry();
 
     void LoadComponents(std::stringstream &iss);
-    void SaveComponents(std::stringstream &oss);
+    void SaveComponents(std::ostream &oss);
 }
 
 #endif
\ No newline at end of file
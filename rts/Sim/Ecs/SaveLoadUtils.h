@@ -26,7 +26,7 @@ public:
     {}
 
     void LoadComponents(std::stringstream &iss);
-    void SaveComponents(std::stringstream &oss);
+    void SaveComponents(std::ostream &oss);
 
 private:
     entt::registry& registry;
@@ -141,6 +141,9 @@ bool CFeatureHandler::AddFeature(CFeature* feature)
 
 	InsertActiveFeature(feature);
 	SetFeatureUpdateable(feature);
+
+	SYNC_SUBSYSTEM(SUBSYS_FEATURES, feature->id);
+	SYNC_SUBSYSTEM(SUBSYS_FEATURES, feature->pos);
 	return true;
 }
 
@@ -150,6 +153,8 @@ void CFeatureHandler::DeleteFeature(CFeature* feature)
 	RECOIL_DETAILED_TRACY_ZONE;
 	SetFeatureUpdateable(feature);
 	feature->deleteMe = true;
+
+	SYNC_SUBSYSTEM(SUBSYS_FEATURES, feature->id);
 }
 
 
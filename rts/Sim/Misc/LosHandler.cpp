@@ -19,6 +19,7 @@
 #include "System/Misc/TracyDefs.h"
 
 #define USE_STAGGERED_UPDATES 0
+#define USE_DELTA_UPDATES 1
 
 
 
@@ -61,9 +62,11 @@ inline void SLosInstance::Init(int radius, int allyteam, int2 basePos, float bas
 	this->refCount = 0;
 	this->hashNum = hashNum;
 	this->status = NONE;
+	this->deltaBase = nullptr;
 	this->isCached = false;
 	this->isQueuedForUpdate = false;
 	this->isQueuedForTerraform = false;
+	this->isQueuedForRemove = false;
 }
 
 
@@ -126,6 +129,7 @@ void ILosType::Kill()
 	losAdd.clear();
 	losDeleted.clear();
 	losRecalc.clear();
+	losDelta.clear();
 
 	// mark as invalid
 	size = {0, 0};
@@ -232,9 +236,30 @@ inline void ILosType::UpdateUnit(CUnit* unit, bool ignore)
 	if (CanRefInstance(uli))
 		return;
 
+	// the old instance is dropped by this unit's move; when nobody else uses
+	// it the new one can take over its footprint by updating the difference
+	const auto CanDeltaInstance = [&](const SLosInstance* li) -> bool {
+		#if (USE_DELTA_UPDATES == 1)
+		return (li->refCount == 0
+		    && (std::abs(li->basePos.x - baseLos.x) <= 1)
+		    && (std::abs(li->basePos.y - baseLos.y) <= 1)
+		    && (li->baseHeight == height)
+		    && (li->radius     == radius)
+		    && (li->allyteam   == allyteam)
+		);
+		#else
+		return false;
+		#endif
+	};
+
+	SLosInstance* deltaBase = nullptr;
+
 	if (uli != nullptr) {
 		unit->los[type] = nullptr;
 		UnrefInstance(uli);
+
+		if (CanDeltaInstance(uli))
+			deltaBase = uli;
 	}
 
 	const int hash = GetHashNum(unit->allyteam, baseLos, radius);
@@ -248,6 +273,11 @@ inline void ILosType::UpdateUnit(CUnit* unit, bool ignore)
 				cacheHits += (algoType == LOS_ALGO_RAYCAST);
 				unit->los[type] = li;
 				RefInstance(li);
+
+				// only (re)activated instances get added to the map
+				if (li->refCount == 1)
+					li->deltaBase = deltaBase;
+
 				return;
 			}
 		}
@@ -257,6 +287,7 @@ inline void ILosType::UpdateUnit(CUnit* unit, bool ignore)
 	cacheFails += (algoType == LOS_ALGO_RAYCAST);
 	SLosInstance* li = CreateInstance();
 	li->Init(radius, allyteam, baseLos, height, hash);
+	li->deltaBase = deltaBase;
 	li->refCount++;
 	unit->los[type] = li;
 	instanceHashes[hash].push_back(li);
@@ -304,6 +335,19 @@ inline void ILosType::LosRemove(SLosInstance* li)
 }
 
 
+inline void ILosType::LosDelta(SLosInstance* oldInstance, SLosInstance* newInstance)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	assert(oldInstance->allyteam == newInstance->allyteam);
+
+	if (algoType == LOS_ALGO_RAYCAST) {
+		losMaps[newInstance->allyteam].MoveRaycast(oldInstance, newInstance);
+	} else {
+		losMaps[newInstance->allyteam].MoveCircle(oldInstance, newInstance);
+	}
+}
+
+
 inline void ILosType::RefInstance(SLosInstance* li)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -537,6 +581,9 @@ void ILosType::Update()
 		const auto status = OptimizeInstanceUpdate(li);
 		li->isQueuedForUpdate = false;
 
+		if (status != SLosInstance::TLosStatus::NEW && status != SLosInstance::TLosStatus::REACTIVATE)
+			li->deltaBase = nullptr;
+
 		switch (status) {
 			case SLosInstance::TLosStatus::NEW: {
 				if (algoType == LOS_ALGO_RAYCAST) losRecalc.push_back(li);
@@ -551,7 +598,8 @@ void ILosType::Update()
 				losAdd.push_back(li);
 			} break;
 			case SLosInstance::TLosStatus::REMOVE: {
-				losRemove.push_back(li);
+				// added to losRemove below unless taken over by a delta-update
+				li->isQueuedForRemove = true;
 				losDeleted.push_back(li);
 			} break;
 			case SLosInstance::TLosStatus::NONE: {
@@ -568,6 +616,27 @@ void ILosType::Update()
 		}
 	}
 
+	// pair added instances with the removed instance they replace
+	losDelta.clear();
+
+	for (SLosInstance*& li: losAdd) {
+		SLosInstance* base = std::exchange(li->deltaBase, nullptr);
+
+		if (base == nullptr || !base->isQueuedForRemove)
+			continue;
+
+		base->isQueuedForRemove = false;
+		losDelta.emplace_back(base, li);
+		li = nullptr;
+	}
+
+	losAdd.erase(std::remove(losAdd.begin(), losAdd.end(), nullptr), losAdd.end());
+
+	for (SLosInstance* li: losDeleted) {
+		if (std::exchange(li->isQueuedForRemove, false))
+			losRemove.push_back(li);
+	}
+
 	// remove sight
 	//FIXME multithread?
 	for (SLosInstance* li: losRemove) {
@@ -590,6 +659,12 @@ void ILosType::Update()
 		LosAdd(li);
 	}
 
+	// move sight; the old instances' squares are still intact here
+	for (const auto& [oldInstance, newInstance]: losDelta) {
+		assert(newInstance->refCount > 0);
+		LosDelta(oldInstance, newInstance);
+	}
+
 	// delete / move to cache unused instances
 	if (algoType == LOS_ALGO_RAYCAST) {
 		while (!losCache.empty() && ((losCache.size() + losDeleted.size()) > CACHE_SIZE)) {
@@ -5,6 +5,7 @@
 
 #include <vector>
 #include <deque>
+#include <utility>
 
 #include "Map/Ground.h"
 #include "Sim/Misc/LosMap.h"
@@ -45,9 +46,11 @@ struct SLosInstance
 		, refCount(0)
 		, hashNum(-1)
 		, status(NONE)
+		, deltaBase(nullptr)
 		, isCached(false)
 		, isQueuedForUpdate(false)
 		, isQueuedForTerraform(false)
+		, isQueuedForRemove(false)
 	{}
 	void Init(int radius, int allyteam, int2 basePos, float baseHeight, int hashNum);
 
@@ -76,9 +79,15 @@ public:
 	};
 	int status;
 
+	// instance that is removed in the same update and differs only by a
+	// one-square shift of basePos; the LOS map is then updated with the
+	// difference between both footprints instead of a full remove + add
+	SLosInstance* deltaBase;
+
 	bool isCached;
 	bool isQueuedForUpdate;
 	bool isQueuedForTerraform;
+	bool isQueuedForRemove;
 };
 
 
@@ -138,6 +147,7 @@ private:
 
 	void LosAdd(SLosInstance* instance);
 	void LosRemove(SLosInstance* instance);
+	void LosDelta(SLosInstance* oldInstance, SLosInstance* newInstance);
 
 	void RefInstance(SLosInstance* instance);
 	void UnrefInstance(SLosInstance* instance);
@@ -191,6 +201,7 @@ private:
 	std::vector<SLosInstance*> losAdd;
 	std::vector<SLosInstance*> losDeleted;
 	std::vector<SLosInstance*> losRecalc;
+	std::vector< std::pair<SLosInstance*, SLosInstance*> > losDelta;
 
 	static constexpr int CACHE_SIZE = 4096;
 };
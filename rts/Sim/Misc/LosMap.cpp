@@ -19,6 +19,7 @@ static std::array<std::vector<float>, ThreadPool::MAX_THREADS> RADIUS_ISQRT_TABL
 
 static std::array<std::vector<float>, ThreadPool::MAX_THREADS> RAYCAST_ANGLE_TABLES;
 static std::array<std::vector< char>, ThreadPool::MAX_THREADS> LOSRAY_SQUARE_TABLES; // visible squares per instance
+static std::array<std::vector<  int>, ThreadPool::MAX_THREADS> CIRCLE_WIDTH_TABLES;
 
 
 static float isqrtTableLookup(unsigned r, int threadNum)
@@ -437,33 +438,149 @@ void CLosMap::AddRaycast(SLosInstance* instance, int amount)
 
 	// inform ReadMap when squares enter LoS
 	const bool visibleInstanceSquares = (instance->allyteam >= 0 && (instance->allyteam == gu->myAllyTeam || gu->spectatingFullView));
+	const bool updateUnsyncedHeightMap = sendReadmapEvents && visibleInstanceSquares && (amount > 0);
+
+	for (const SLosInstance::RLE rle: losSquares) {
+		AddSquares(rle.start, rle.length, amount, updateUnsyncedHeightMap);
+	}
+}
+
+
+void CLosMap::MoveCircle(const SLosInstance* oldInstance, const SLosInstance* newInstance)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	assert(oldInstance->radius == newInstance->radius);
+
+	const int radius = newInstance->radius;
+	const int2 oldPos = oldInstance->basePos;
+	const int2 newPos = newInstance->basePos;
+
+	// half-width of each line of the circle, indexed by y + radius
+	std::vector<int>& lineWidths = CIRCLE_WIDTH_TABLES[ThreadPool::GetThreadNum()];
+
+	lineWidths.clear();
+	lineWidths.resize(2 * radius + 1, -1);
+
+	MidpointCircleAlgoPerLine(radius, [&](int width, int y) { lineWidths[y + radius] = width; });
+
+	const auto GetLineSpan = [&](int2 pos, int y) -> int2 {
+		const int dy = y - pos.y;
+
+		if (dy < -radius || dy > radius)
+			return {0, 0};
+
+		const int width = lineWidths[dy + radius];
+		return {std::clamp(pos.x - width, 0, size.x), std::clamp(pos.x + width + 1, 0, size.x)};
+	};
+
+	const int sy = std::max(std::min(oldPos.y, newPos.y) - radius, 0);
+	const int ey = std::min(std::max(oldPos.y, newPos.y) + radius + 1, size.y);
+
+	for (int y = sy; y < ey; ++y) {
+		const int2 oldSpan = GetLineSpan(oldPos, y);
+		const int2 newSpan = GetLineSpan(newPos, y);
+
+		unsigned short* row = &losmap[y * size.x];
+
+		// old \ new loses coverage, new \ old gains it
+		for (int x = oldSpan.x, e = std::min(oldSpan.y, newSpan.x); x < e; ++x) { row[x] -= 1; }
+		for (int x = std::max(oldSpan.x, newSpan.y), e = oldSpan.y; x < e; ++x) { row[x] -= 1; }
+		for (int x = newSpan.x, e = std::min(newSpan.y, oldSpan.x); x < e; ++x) { row[x] += 1; }
+		for (int x = std::max(newSpan.x, oldSpan.y), e = newSpan.y; x < e; ++x) { row[x] += 1; }
+	}
+}
+
+
+void CLosMap::MoveRaycast(const SLosInstance* oldInstance, const SLosInstance* newInstance)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	assert(oldInstance->allyteam == newInstance->allyteam);
+
+	const bool visibleInstanceSquares = (newInstance->allyteam >= 0 && (newInstance->allyteam == gu->myAllyTeam || gu->spectatingFullView));
 	const bool updateUnsyncedHeightMap = sendReadmapEvents && visibleInstanceSquares;
 
-	if ((amount > 0) && updateUnsyncedHeightMap) {
-		for (const SLosInstance::RLE rle: losSquares) {
-			for (int idx = rle.start, len = rle.length; len > 0; --len, ++idx) {
-				losmap[idx] += amount;
+	// both run lists are sorted by start index, walk them in parallel and
+	// only touch the squares covered by exactly one of the two instances
+	const auto& oldSquares = oldInstance->squares;
+	const auto& newSquares = newInstance->squares;
 
-				// skip if this los-square did not *enter* LOS
-				if (losmap[idx] != amount)
-					continue;
+	size_t oldIdx = 0;
+	size_t newIdx = 0;
 
-				const int2 lm = IdxToCoord(idx, size.x);
-				const int2 p1 = (lm             ) * LOS2HEIGHT;
-				const int2 p2 = (lm + int2(1, 1)) * LOS2HEIGHT;
-				const int2 p3 = {std::min(p2.x, mapDims.mapxm1), std::min(p2.y, mapDims.mapym1)};
+	int2 oldRun = {0, 0};
+	int2 newRun = {0, 0};
 
-				readMap->UpdateLOS(SRectangle(p1.x, p1.y,  p3.x, p3.y));
-			}
+	const auto NextRun = [](const std::vector<SLosInstance::RLE>& runs, size_t& idx, int2& run) {
+		// skips the EMPTY_RLE marker as well
+		while (idx < runs.size() && runs[idx].length == 0)
+			++idx;
+
+		if (idx >= runs.size())
+			return false;
+
+		run = {runs[idx].start, runs[idx].start + int(runs[idx].length)};
+		++idx;
+		return true;
+	};
+
+	bool haveOld = NextRun(oldSquares, oldIdx, oldRun);
+	bool haveNew = NextRun(newSquares, newIdx, newRun);
+
+	while (haveOld || haveNew) {
+		if (haveOld && (!haveNew || oldRun.y <= newRun.x)) {
+			AddSquares(oldRun.x, oldRun.y - oldRun.x, -1, false);
+			haveOld = NextRun(oldSquares, oldIdx, oldRun);
+			continue;
+		}
+		if (haveNew && (!haveOld || newRun.y <= oldRun.x)) {
+			AddSquares(newRun.x, newRun.y - newRun.x, 1, updateUnsyncedHeightMap);
+			haveNew = NextRun(newSquares, newIdx, newRun);
+			continue;
 		}
 
-		return;
+		// runs overlap; handle the leading part of whichever starts first
+		if (oldRun.x < newRun.x) {
+			AddSquares(oldRun.x, newRun.x - oldRun.x, -1, false);
+			oldRun.x = newRun.x;
+		} else if (newRun.x < oldRun.x) {
+			AddSquares(newRun.x, oldRun.x - newRun.x, 1, updateUnsyncedHeightMap);
+			newRun.x = oldRun.x;
+		}
+
+		// common part stays unchanged
+		oldRun.x = newRun.x = std::min(oldRun.y, newRun.y);
+
+		if (oldRun.x == oldRun.y)
+			haveOld = NextRun(oldSquares, oldIdx, oldRun);
+		if (newRun.x == newRun.y)
+			haveNew = NextRun(newSquares, newIdx, newRun);
 	}
+}
 
-	for (const SLosInstance::RLE rle: losSquares) {
-		for (int idx = rle.start, len = rle.length; len > 0; --len, ++idx) {
+
+inline void CLosMap::AddSquares(int idx, int len, int amount, bool updateUnsyncedHeightMap)
+{
+	if (!updateUnsyncedHeightMap) {
+		for (; len > 0; --len, ++idx) {
 			losmap[idx] += amount;
 		}
+
+		return;
+	}
+
+	for (; len > 0; --len, ++idx) {
+		losmap[idx] += amount;
+
+		// skip if this los-square did not *enter* LOS
+		if (losmap[idx] != amount)
+			continue;
+
+		const int2 lm = IdxToCoord(idx, size.x);
+		const int2 p1 = (lm             ) * LOS2HEIGHT;
+		const int2 p2 = (lm + int2(1, 1)) * LOS2HEIGHT;
+		const int2 p3 = {std::min(p2.x, mapDims.mapxm1), std::min(p2.y, mapDims.mapym1)};
+
+		readMap->UpdateLOS(SRectangle(p1.x, p1.y,  p3.x, p3.y));
 	}
 }
 
@@ -43,6 +43,10 @@ public:
 	/// arbitrary area, for losMap, non-circular radar maps, ...
 	void PrepareRaycast(SLosInstance* instance) const;
 
+	/// moves the coverage of <oldInstance> to <newInstance> (same radius), only touching squares that differ
+	void MoveCircle(const SLosInstance* oldInstance, const SLosInstance* newInstance);
+	void MoveRaycast(const SLosInstance* oldInstance, const SLosInstance* newInstance);
+
 public:
 	int At(int2 p) const {
 		p.x = std::clamp(p.x, 0, size.x - 1);
@@ -54,6 +58,8 @@ public:
 	const unsigned short& front() const { return (losmap.front()); }
 
 private:
+	void AddSquares(int idx, int len, int amount, bool updateUnsyncedHeightMap);
+
 	void LosAdd(SLosInstance* instance) const;
 	void UnsafeLosAdd(SLosInstance* instance) const;
 	void SafeLosAdd(SLosInstance* instance) const;
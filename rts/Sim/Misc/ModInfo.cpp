@@ -119,11 +119,17 @@ void CModInfo::ResetState()
 		qtRefreshPathMinDist = 512.f;
 		qtMaxNodesSearchedRelativeToMapOpenNodes = 0.25;
 		qtLowerQualityPaths = false;
+		qtAbstractGraph = false;
 
 		enableSmoothMesh = true;
 		smoothMeshResDivider = 2;
 		smoothMeshSmoothRadius = 40;
 		quadFieldQuadSizeInElmos = 128;
+		quadFieldFlatStorage = false;
+		weaponTargetAcquisitionMT = false;
+		projectileCollisionMT = false;
+		unitLosStatusMT = false;
+		batchMapDamageRecalc = false;
 
 		SLuaAllocLimit::MAX_ALLOC_BYTES = SLuaAllocLimit::MAX_ALLOC_BYTES_DEFAULT;
 
@@ -178,12 +184,18 @@ void CModInfo::Init(const std::string& modFileName)
 		qtRefreshPathMinDist = system.GetFloat("qtRefreshPathMinDist", qtRefreshPathMinDist);
 		qtMaxNodesSearchedRelativeToMapOpenNodes = system.GetFloat("qtMaxNodesSearchedRelativeToMapOpenNodes", qtMaxNodesSearchedRelativeToMapOpenNodes);
 		qtLowerQualityPaths = system.GetBool("qtLowerQualityPaths", qtLowerQualityPaths);
+		qtAbstractGraph = system.GetBool("qtAbstractGraph", qtAbstractGraph);
 
 		enableSmoothMesh = system.GetBool("enableSmoothMesh", enableSmoothMesh);
 		smoothMeshResDivider = system.GetInt("smoothMeshResDivider", smoothMeshResDivider);
 		smoothMeshSmoothRadius = system.GetInt("smoothMeshSmoothRadius", smoothMeshSmoothRadius);
 
 		quadFieldQuadSizeInElmos = system.GetInt("quadFieldQuadSizeInElmos", quadFieldQuadSizeInElmos);
+		quadFieldFlatStorage = system.GetBool("quadFieldFlatStorage", quadFieldFlatStorage);
+		weaponTargetAcquisitionMT = system.GetBool("weaponTargetAcquisitionMT", weaponTargetAcquisitionMT);
+		projectileCollisionMT = system.GetBool("projectileCollisionMT", projectileCollisionMT);
+		unitLosStatusMT = system.GetBool("unitLosStatusMT", unitLosStatusMT);
+		batchMapDamageRecalc = system.GetBool("batchMapDamageRecalc", batchMapDamageRecalc);
 
 		// Specify in megabytes: 1 << 20 = (1024 * 1024)
 		SLuaAllocLimit::MAX_ALLOC_BYTES = static_cast<decltype(SLuaAllocLimit::MAX_ALLOC_BYTES)>(system.GetInt("LuaAllocLimit", SLuaAllocLimit::MAX_ALLOC_BYTES >> 20u)) << 20u;
@@ -217,6 +217,11 @@ public:
 	/// Enable to reduce CPU usage, but also reduce quality of resultant paths.
 	bool qtLowerQualityPaths;
 
+	/// Enable to plan long QTPFS searches on a coarse graph of map regions first, then
+	/// restrict the detailed search to the clusters along that route. Reduces CPU usage
+	/// for long paths, but paths may be slightly longer than the unrestricted optimum.
+	bool qtAbstractGraph;
+
 	float pfRawDistMult;
 	float pfUpdateRateScale;
 
@@ -232,6 +237,29 @@ public:
 	int smoothMeshSmoothRadius;
 
 	int quadFieldQuadSizeInElmos;
+	/// Store the quadfield's objects in one cell-sorted array per object type instead of separate
+	/// vectors per quad. Changes the order objects are returned in, hence synced.
+	bool quadFieldFlatStorage;
+
+	/// Gather and score auto-target candidates of slow-updated units in parallel before running
+	/// their weapon callins serially. Deterministic, but targets are picked from the state at the
+	/// start of the slow-update phase so results differ from the default serial path.
+	bool weaponTargetAcquisitionMT;
+
+	/// Intersect projectiles with nearby units and features in parallel before applying their
+	/// collisions serially in projectile order. Deterministic, but hits are tested against the
+	/// positions at the start of the collision phase so results may differ from the serial path.
+	bool projectileCollisionMT;
+
+	/// Evaluate the LOS and radar status of all units for all allyteams in parallel, then apply
+	/// the changed ones serially in unit order. Lua moving or cloaking other units from within a
+	/// LOS callin is only seen by those units the next frame, so results may differ from serial.
+	bool unitLosStatusMT;
+
+	/// Recalculate the terrain of all explosions that finish in the same frame together, once the
+	/// heights of every explosion of that frame have been applied, instead of right after each one.
+	/// Later explosions' height changes are then already visible to the recalculation of earlier ones.
+	bool batchMapDamageRecalc;
 
 	bool allowTake;
 	bool allowEnginePlayerlist;
@@ -29,6 +29,12 @@ CR_REG_METADATA(CQuadField, (
 	CR_MEMBER(quadSizeZ),
 	CR_MEMBER(invQuadSize),
 
+	CR_MEMBER(flatUnits),
+	CR_MEMBER(flatFeatures),
+	CR_MEMBER(flatProjectiles),
+	CR_MEMBER(flatRepulsers),
+	CR_MEMBER(flatStorage),
+
 	CR_IGNORED(tempUnits),
 	CR_IGNORED(tempFeatures),
 	CR_IGNORED(tempProjectiles),
@@ -47,6 +53,27 @@ CR_REG_METADATA_SUB(CQuadField, Quad, (
 	CR_POSTLOAD(PostLoad)
 ))
 
+#define CR_BIND_CELL_ARRAY(T) \
+	CR_BIND_TEMPLATE(QuadFieldCellArray<T>, ) \
+	CR_REG_METADATA_TEMPLATE(QuadFieldCellArray<T>, ( \
+		CR_MEMBER(items), \
+		CR_IGNORED(spareItems), \
+		CR_MEMBER(cellBegins), \
+		CR_MEMBER(cellLimits), \
+		CR_IGNORED(spareLimits), \
+		CR_MEMBER(groupEnds), \
+		CR_MEMBER(numCells), \
+		CR_MEMBER(numGroups), \
+		CR_MEMBER(numFreeSlots) \
+	))
+
+CR_BIND_CELL_ARRAY(CUnit*)
+CR_BIND_CELL_ARRAY(CFeature*)
+CR_BIND_CELL_ARRAY(CProjectile*)
+CR_BIND_CELL_ARRAY(CPlasmaRepulser*)
+
+#undef CR_BIND_CELL_ARRAY
+
 
 CQuadField quadField;
 
@@ -110,7 +137,7 @@ void CQuadField::Quad::PostLoad()
 #endif
 }
 
-void CQuadField::Init(int2 mapDims, int quadSize)
+void CQuadField::Init(int2 mapDims, int quadSize, bool flatStorage_)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	quadSizeX = quadSize;
@@ -127,6 +154,17 @@ void CQuadField::Init(int2 mapDims, int quadSize)
 
 	baseQuads.resize(numQuadsX * numQuadsZ);
 
+	if ((flatStorage = flatStorage_)) {
+	#ifndef UNIT_TEST
+		flatUnits.Init(numQuadsX * numQuadsZ, teamHandler.ActiveAllyTeams());
+	#else
+		flatUnits.Init(numQuadsX * numQuadsZ, 1);
+	#endif
+		flatFeatures.Init(numQuadsX * numQuadsZ, 1);
+		flatProjectiles.Init(numQuadsX * numQuadsZ, 1);
+		flatRepulsers.Init(numQuadsX * numQuadsZ, 1);
+	}
+
 	size_t threadCount = ThreadPool::GetNumThreads();
 
 	for (size_t i = 0; i < threadCount; ++i) {
@@ -151,6 +189,11 @@ void CQuadField::Kill()
 		quad.Clear();
 	}
 
+	flatUnits.Kill();
+	flatFeatures.Kill();
+	flatProjectiles.Kill();
+	flatRepulsers.Kill();
+
 	for (auto cache : tempUnits)
 		cache.ReleaseAll();
 
@@ -167,6 +210,19 @@ void CQuadField::Kill()
 }
 
 
+void CQuadField::Update()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (!flatStorage)
+		return;
+
+	flatUnits.Update();
+	flatFeatures.Update();
+	flatProjectiles.Update();
+	flatRepulsers.Update();
+}
+
+
 int2 CQuadField::WorldPosToQuadField(const float3 p) const
 {
 	return int2(
@@ -422,6 +478,89 @@ void CQuadField::GetQuadsOnWideRay(QuadFieldQuery& qfq, const float3& start, con
 
 
 #ifndef UNIT_TEST
+void CQuadField::AddUnitToQuad(int qi, CUnit* unit)
+{
+	if (flatStorage) {
+		flatUnits.Insert(qi, unit->allyteam, unit);
+		return;
+	}
+
+	spring::VectorInsertUnique(baseQuads[qi].units, unit, false);
+	spring::VectorInsertUnique(baseQuads[qi].teamUnits[unit->allyteam], unit, false);
+}
+
+void CQuadField::RemoveUnitFromQuad(int qi, CUnit* unit)
+{
+	if (flatStorage) {
+		flatUnits.Erase(qi, unit->allyteam, unit);
+		return;
+	}
+
+	spring::VectorErase(baseQuads[qi].units, unit);
+	spring::VectorErase(baseQuads[qi].teamUnits[unit->allyteam], unit);
+}
+
+void CQuadField::AddFeatureToQuad(int qi, CFeature* feature)
+{
+	if (flatStorage) {
+		flatFeatures.Insert(qi, 0, feature);
+		return;
+	}
+
+	spring::VectorInsertUnique(baseQuads[qi].features, feature, false);
+}
+
+void CQuadField::RemoveFeatureFromQuad(int qi, CFeature* feature)
+{
+	if (flatStorage) {
+		flatFeatures.Erase(qi, 0, feature);
+		return;
+	}
+
+	spring::VectorErase(baseQuads[qi].features, feature);
+}
+
+void CQuadField::AddProjectileToQuad(int qi, CProjectile* projectile)
+{
+	if (flatStorage) {
+		flatProjectiles.Insert(qi, 0, projectile);
+		return;
+	}
+
+	spring::VectorInsertUnique(baseQuads[qi].projectiles, projectile, false);
+}
+
+void CQuadField::RemoveProjectileFromQuad(int qi, CProjectile* projectile)
+{
+	if (flatStorage) {
+		flatProjectiles.Erase(qi, 0, projectile);
+		return;
+	}
+
+	spring::VectorErase(baseQuads[qi].projectiles, projectile);
+}
+
+void CQuadField::AddRepulserToQuad(int qi, CPlasmaRepulser* repulser)
+{
+	if (flatStorage) {
+		flatRepulsers.Insert(qi, 0, repulser);
+		return;
+	}
+
+	spring::VectorInsertUnique(baseQuads[qi].repulsers, repulser, false);
+}
+
+void CQuadField::RemoveRepulserFromQuad(int qi, CPlasmaRepulser* repulser)
+{
+	if (flatStorage) {
+		flatRepulsers.Erase(qi, 0, repulser);
+		return;
+	}
+
+	spring::VectorErase(baseQuads[qi].repulsers, repulser);
+}
+
+
 bool CQuadField::InsertUnitIf(CUnit* unit, const float3& wpos)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -438,8 +577,7 @@ bool CQuadField::InsertUnitIf(CUnit* unit, const float3& wpos)
 	if (!spring::VectorInsertUnique(unit->quads, wposQuadIdx, true))
 		return false;
 
-	spring::VectorInsertUnique(baseQuads[wposQuadIdx].units, unit, false);
-	spring::VectorInsertUnique(baseQuads[wposQuadIdx].teamUnits[unit->allyteam], unit, false);
+	AddUnitToQuad(wposQuadIdx, unit);
 	return true;
 }
 
@@ -469,8 +607,7 @@ bool CQuadField::RemoveUnitIf(CUnit* unit, const float3& wpos)
 	if (!spring::VectorErase(unit->quads, wposQuadIdx))
 		return false;
 
-	spring::VectorErase(baseQuads[wposQuadIdx].units, unit);
-	spring::VectorErase(baseQuads[wposQuadIdx].teamUnits[unit->allyteam], unit);
+	RemoveUnitFromQuad(wposQuadIdx, unit);
 	return true;
 }
 #endif
@@ -491,13 +628,11 @@ void CQuadField::MovedUnit(CUnit* unit)
 	}
 
 	for (const int qi: unit->quads) {
-		spring::VectorErase(baseQuads[qi].units, unit);
-		spring::VectorErase(baseQuads[qi].teamUnits[unit->allyteam], unit);
+		RemoveUnitFromQuad(qi, unit);
 	}
 
 	for (const int qi: *qfQuery.quads) {
-		spring::VectorInsertUnique(baseQuads[qi].units, unit, false);
-		spring::VectorInsertUnique(baseQuads[qi].teamUnits[unit->allyteam], unit, false);
+		AddUnitToQuad(qi, unit);
 	}
 
 	unit->quads = std::move(*qfQuery.quads);
@@ -507,8 +642,7 @@ void CQuadField::RemoveUnit(CUnit* unit)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	for (const int qi: unit->quads) {
-		spring::VectorErase(baseQuads[qi].units, unit);
-		spring::VectorErase(baseQuads[qi].teamUnits[unit->allyteam], unit);
+		RemoveUnitFromQuad(qi, unit);
 	}
 
 	unit->quads.clear();
@@ -540,11 +674,11 @@ void CQuadField::MovedRepulser(CPlasmaRepulser* repulser)
 	}
 
 	for (const int qi: repulserQuads) {
-		spring::VectorErase(baseQuads[qi].repulsers, repulser);
+		RemoveRepulserFromQuad(qi, repulser);
 	}
 
 	for (const int qi: *qfQuery.quads) {
-		spring::VectorInsertUnique(baseQuads[qi].repulsers, repulser, false);
+		AddRepulserToQuad(qi, repulser);
 	}
 
 	repulser->SetQuads(std::move(*qfQuery.quads));
@@ -554,7 +688,7 @@ void CQuadField::RemoveRepulser(CPlasmaRepulser* repulser)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	for (const int qi: repulser->GetQuads()) {
-		spring::VectorErase(baseQuads[qi].repulsers, repulser);
+		RemoveRepulserFromQuad(qi, repulser);
 	}
 
 	repulser->ClearQuads();
@@ -576,7 +710,7 @@ void CQuadField::AddFeature(CFeature* feature)
 	GetQuads(qfQuery, feature->pos, feature->radius);
 
 	for (const int qi: *qfQuery.quads) {
-		spring::VectorInsertUnique(baseQuads[qi].features, feature, false);
+		AddFeatureToQuad(qi, feature);
 	}
 }
 
@@ -587,7 +721,7 @@ void CQuadField::RemoveFeature(CFeature* feature)
 	GetQuads(qfQuery, feature->pos, feature->radius);
 
 	for (const int qi: *qfQuery.quads) {
-		spring::VectorErase(baseQuads[qi].features, feature);
+		RemoveFeatureFromQuad(qi, feature);
 	}
 
 	#ifdef DEBUG_QUADFIELD
@@ -627,13 +761,13 @@ void CQuadField::AddProjectile(CProjectile* p)
 		GetQuadsOnRay(qfQuery, p->pos, p->dir, p->speed.w);
 
 		for (const int qi: *qfQuery.quads) {
-			spring::VectorInsertUnique(baseQuads[qi].projectiles, p, false);
+			AddProjectileToQuad(qi, p);
 		}
 
 		p->quads = std::move(*qfQuery.quads);
 	} else {
 		int newQuad = WorldPosToQuadFieldIdx(p->pos);
-		spring::VectorInsertUnique(baseQuads[newQuad].projectiles, p, false);
+		AddProjectileToQuad(newQuad, p);
 		p->quads.clear();
 		p->quads.push_back(newQuad);
 	}
@@ -645,7 +779,7 @@ void CQuadField::RemoveProjectile(CProjectile* p)
 	assert(p->synced);
 
 	for (const int qi: p->quads) {
-		spring::VectorErase(baseQuads[qi].projectiles, p);
+		RemoveProjectileFromQuad(qi, p);
 	}
 
 	p->quads.clear();
@@ -666,7 +800,7 @@ void CQuadField::GetUnits(QuadFieldQuery& qfq, const float3& pos, float radius)
 	qfq.units = tempUnits[curThread].ReserveVector();
 
 	for (const int qi: *qfQuery.quads) {
-		for (CUnit* u: baseQuads[qi].units) {
+		for (CUnit* u: GetQuadUnits(qi)) {
 			if (u->mtTempNum[curThread] == tempNum)
 				continue;
 
@@ -689,7 +823,7 @@ void CQuadField::GetUnitsExact(QuadFieldQuery& qfq, const float3& pos, float rad
 	qfq.units = tempUnits[curThread].ReserveVector();
 
 	for (const int qi: *qfQuery.quads) {
-		for (CUnit* u: baseQuads[qi].units) {
+		for (CUnit* u: GetQuadUnits(qi)) {
 			if (u->mtTempNum[curThread] == tempNum)
 				continue;
 
@@ -722,7 +856,7 @@ void CQuadField::GetUnitsExact(QuadFieldQuery& qfq, const float3& mins, const fl
 	qfq.units = tempUnits[curThread].ReserveVector();
 
 	for (const int qi: *qfQuery.quads) {
-		for (CUnit* unit: baseQuads[qi].units) {
+		for (CUnit* unit: GetQuadUnits(qi)) {
 
 			if (unit->mtTempNum[curThread] == tempNum)
 				continue;
@@ -754,7 +888,7 @@ void CQuadField::GetFeaturesExact(QuadFieldQuery& qfq, const float3& pos, float
 	qfq.features = tempFeatures[curThread].ReserveVector();
 
 	for (const int qi: *qfQuery.quads) {
-		for (CFeature* f: baseQuads[qi].features) {
+		for (CFeature* f: GetQuadFeatures(qi)) {
 			if (f->mtTempNum[curThread] == tempNum)
 				continue;
 
@@ -787,7 +921,7 @@ void CQuadField::GetFeaturesExact(QuadFieldQuery& qfq, const float3& mins, const
 	qfq.features = tempFeatures[curThread].ReserveVector();
 
 	for (const int qi: *qfQuery.quads) {
-		for (CFeature* feature: baseQuads[qi].features) {
+		for (CFeature* feature: GetQuadFeatures(qi)) {
 			if (feature->mtTempNum[curThread] == tempNum)
 				continue;
 
@@ -817,7 +951,7 @@ void CQuadField::GetProjectilesExact(QuadFieldQuery& qfq, const float3& pos, flo
 	qfq.projectiles = tempProjectiles.ReserveVector();
 
 	for (const int qi: *qfQuery.quads) {
-		for (CProjectile* p: baseQuads[qi].projectiles) {
+		for (CProjectile* p: GetQuadProjectiles(qi)) {
 			if (p->tempNum == tempNum)
 				continue;
 
@@ -842,7 +976,7 @@ void CQuadField::GetProjectilesExact(QuadFieldQuery& qfq, const float3& mins, co
 	qfq.projectiles = tempProjectiles.ReserveVector();
 
 	for (const int qi: *qfQuery.quads) {
-		for (CProjectile* p: baseQuads[qi].projectiles) {
+		for (CProjectile* p: GetQuadProjectiles(qi)) {
 			if (p->tempNum == tempNum)
 				continue;
 
@@ -880,7 +1014,7 @@ void CQuadField::GetSolidsExact(
 	
 
 	for (const int qi: *qfQuery.quads) {
-		for (CUnit* u: baseQuads[qi].units) {
+		for (CUnit* u: GetQuadUnits(qi)) {
 			if (u->mtTempNum[curThread] == tempNum)
 				continue;
 
@@ -896,7 +1030,7 @@ void CQuadField::GetSolidsExact(
 			qfq.solids->push_back(u);
 		}
 
-		for (CFeature* f: baseQuads[qi].features) {
+		for (CFeature* f: GetQuadFeatures(qi)) {
 			if (f->mtTempNum[curThread] == tempNum)
 				continue;
 
@@ -929,7 +1063,7 @@ bool CQuadField::NoSolidsExact(
 	const int tempNum = gs->GetTempNum();
 
 	for (const int qi: *qfQuery.quads) {
-		for (CUnit* u: baseQuads[qi].units) {
+		for (CUnit* u: GetQuadUnits(qi)) {
 			if (u->tempNum == tempNum)
 				continue;
 
@@ -945,7 +1079,7 @@ bool CQuadField::NoSolidsExact(
 			return false;
 		}
 
-		for (CFeature* f: baseQuads[qi].features) {
+		for (CFeature* f: GetQuadFeatures(qi)) {
 			if (f->tempNum == tempNum)
 				continue;
 
@@ -982,7 +1116,7 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 	// start counting from the previous object-cache sizes
 
 	for (const int qi: *qfQuery.quads) {
-		const Quad& quad = baseQuads[qi];
+		const QuadView quad = GetQuad(qi);
 
 		for (CUnit* u: quad.units) {
 			// prevent double adding
@@ -1034,4 +1168,69 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 		}
 	}
 }
+
+void CQuadField::GetUnitsAndFeaturesColVol(
+	int thread,
+	const float3& pos,
+	const float radius,
+	std::vector<CUnit*>& units,
+	std::vector<CFeature*>& features,
+	std::vector<CPlasmaRepulser*>& repulsers
+) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	const int tempNum = gs->GetMtTempNum(thread);
+	const size_t numRepulsers = repulsers.size();
+
+	QuadFieldQuery qfQuery;
+	qfQuery.threadOwner = thread;
+	GetQuads(qfQuery, pos, radius);
+
+	for (const int qi: *qfQuery.quads) {
+		const QuadView quad = GetQuad(qi);
+
+		for (CUnit* u: quad.units) {
+			if (u->mtTempNum[thread] == tempNum)
+				continue;
+
+			u->mtTempNum[thread] = tempNum;
+
+			const auto* colvol = &u->collisionVolume;
+			const float totRad = radius + colvol->GetBoundingRadius();
+
+			if (pos.SqDistance(colvol->GetWorldSpacePos(u)) >= (totRad * totRad))
+				continue;
+
+			units.push_back(u);
+		}
+
+		for (CFeature* f: quad.features) {
+			if (f->mtTempNum[thread] == tempNum)
+				continue;
+
+			f->mtTempNum[thread] = tempNum;
+
+			const auto* colvol = &f->collisionVolume;
+			const float totRad = radius + colvol->GetBoundingRadius();
+
+			if (pos.SqDistance(colvol->GetWorldSpacePos(f)) >= (totRad * totRad))
+				continue;
+
+			features.push_back(f);
+		}
+
+		// repulsers are weapons and have no per-thread marker, but there are few of them
+		for (CPlasmaRepulser* r: quad.repulsers) {
+			if (std::find(repulsers.begin() + numRepulsers, repulsers.end(), r) != repulsers.end())
+				continue;
+
+			const auto* colvol = &r->collisionVolume;
+			const float totRad = radius + colvol->GetBoundingRadius();
+
+			if (pos.SqDistance(r->weaponMuzzlePos) >= (totRad * totRad))
+				continue;
+
+			repulsers.push_back(r);
+		}
+	}
+}
 #endif // UNIT_TEST
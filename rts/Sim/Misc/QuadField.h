@@ -5,8 +5,10 @@
 
 #include <algorithm>
 #include <array>
+#include <span>
 #include <vector>
 
+#include "QuadFieldCellArray.h"
 #include "System/Misc/NonCopyable.h"
 #include "System/Threading/ThreadPool.h"
 #include "System/creg/creg_cond.h"
@@ -90,8 +92,10 @@ public:
 	static void Resize(int quadSize);
 	*/
 
-	void Init(int2 mapDims, int quadSize);
+	void Init(int2 mapDims, int quadSize, bool flatStorage = false);
 	void Kill();
+	/// called once per frame, compacts the flat storage when needed
+	void Update();
 
 	void GetQuads(QuadFieldQuery& qfq, float3 pos, float radius);
 	void GetQuadsRectangle(QuadFieldQuery& qfq, const float3& mins, const float3& maxs);
@@ -105,6 +109,19 @@ public:
 		std::vector<CFeature*>& features,
 		std::vector<CPlasmaRepulser*>* repulsers = nullptr
 	);
+	/**
+	 * Thread-safe variant for use from within for_mt, <thread> being the
+	 * caller's ThreadPool::GetThreadNum(). Repulsers are appended to those
+	 * already in <repulsers>, duplicates are only filtered among the new ones.
+	 */
+	void GetUnitsAndFeaturesColVol(
+		int thread,
+		const float3& pos,
+		const float radius,
+		std::vector<CUnit*>& units,
+		std::vector<CFeature*>& features,
+		std::vector<CPlasmaRepulser*>& repulsers
+	);
 
 	/**
 	 * Returns all units within @c radius of @c pos,
@@ -217,14 +234,52 @@ public:
 		std::vector<CPlasmaRepulser*> repulsers;
 	};
 
-	const Quad& GetQuad(unsigned i) const {
+	/**
+	 * Read-only view of the objects in a quad, the same for either storage
+	 * backend; only valid until the quadfield is next modified
+	 */
+	struct QuadView {
+		struct TeamUnits {
+			std::span<CUnit* const> operator [] (int allyTeam) const { return qf->GetQuadTeamUnits(quadIdx, allyTeam); }
+
+			const CQuadField* qf;
+			int quadIdx;
+		};
+
+		std::span<CUnit* const> units;
+		std::span<CFeature* const> features;
+		std::span<CProjectile* const> projectiles;
+		std::span<CPlasmaRepulser* const> repulsers;
+
+		TeamUnits teamUnits;
+	};
+
+	QuadView GetQuad(unsigned i) const {
 		assert(i < baseQuads.size());
-		return baseQuads[i];
+		return {GetQuadUnits(i), GetQuadFeatures(i), GetQuadProjectiles(i), GetQuadRepulsers(i), {this, int(i)}};
 	}
-	const Quad& GetQuadAt(unsigned x, unsigned z) const {
+	QuadView GetQuadAt(unsigned x, unsigned z) const {
 		assert(unsigned(numQuadsX * z + x) < baseQuads.size());
-		return baseQuads[numQuadsX * z + x];
+		return GetQuad(numQuadsX * z + x);
+	}
+
+	std::span<CUnit* const> GetQuadUnits(int qi) const {
+		return (flatStorage? flatUnits.Cell(qi): std::span<CUnit* const>(baseQuads[qi].units));
+	}
+	std::span<CUnit* const> GetQuadTeamUnits(int qi, int allyTeam) const {
+		return (flatStorage? flatUnits.Group(qi, allyTeam): std::span<CUnit* const>(baseQuads[qi].teamUnits[allyTeam]));
+	}
+	std::span<CFeature* const> GetQuadFeatures(int qi) const {
+		return (flatStorage? flatFeatures.Cell(qi): std::span<CFeature* const>(baseQuads[qi].features));
 	}
+	std::span<CProjectile* const> GetQuadProjectiles(int qi) const {
+		return (flatStorage? flatProjectiles.Cell(qi): std::span<CProjectile* const>(baseQuads[qi].projectiles));
+	}
+	std::span<CPlasmaRepulser* const> GetQuadRepulsers(int qi) const {
+		return (flatStorage? flatRepulsers.Cell(qi): std::span<CPlasmaRepulser* const>(baseQuads[qi].repulsers));
+	}
+
+	bool UsingFlatStorage() const { return flatStorage; }
 
 
 	int GetNumQuadsX() const { return numQuadsX; }
@@ -239,9 +294,27 @@ private:
 	int2 WorldPosToQuadField(const float3 p) const;
 	int WorldPosToQuadFieldIdx(const float3 p) const;
 
+	void AddUnitToQuad(int qi, CUnit* unit);
+	void RemoveUnitFromQuad(int qi, CUnit* unit);
+	void AddFeatureToQuad(int qi, CFeature* feature);
+	void RemoveFeatureFromQuad(int qi, CFeature* feature);
+	void AddProjectileToQuad(int qi, CProjectile* projectile);
+	void RemoveProjectileFromQuad(int qi, CProjectile* projectile);
+	void AddRepulserToQuad(int qi, CPlasmaRepulser* repulser);
+	void RemoveRepulserFromQuad(int qi, CPlasmaRepulser* repulser);
+
 private:
 	std::vector<Quad> baseQuads;
 
+	// alternative storage used instead of baseQuads if flatStorage is set,
+	// units are grouped by allyteam
+	QuadFieldCellArray<CUnit*> flatUnits;
+	QuadFieldCellArray<CFeature*> flatFeatures;
+	QuadFieldCellArray<CProjectile*> flatProjectiles;
+	QuadFieldCellArray<CPlasmaRepulser*> flatRepulsers;
+
+	bool flatStorage = false;
+
 	// preallocated vectors for Get*Exact functions
 	std::array< QueryVectorCache<CUnit*>, ThreadPool::MAX_THREADS >  tempUnits;
 	std::array< QueryVectorCache<CFeature*>, ThreadPool::MAX_THREADS >  tempFeatures;
@@ -0,0 +1,208 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef QUAD_FIELD_CELL_ARRAY_H
+#define QUAD_FIELD_CELL_ARRAY_H
+
+#include <algorithm>
+#include <cassert>
+#include <span>
+#include <vector>
+
+#include "System/Threading/ThreadPool.h"
+#include "System/creg/creg_cond.h"
+
+/**
+ * @brief objects of one type stored per quadfield cell in a single array
+ *
+ * Cells occupy contiguous ranges of <items> (CSR-style), each split into
+ * <numGroups> sub-ranges (e.g. one per allyteam) followed by some unused
+ * slack. Inserting into a cell shifts the rest of the cell by one slot and
+ * erasing closes the gap, so cells stay contiguous and ordered without any
+ * per-cell allocations. A cell without slack left is moved to the end of
+ * the array with twice the capacity, and once the holes left behind make
+ * up a quarter of the array Update() repacks all cells in order with fresh
+ * slack.
+ */
+template<typename T>
+class QuadFieldCellArray {
+	CR_DECLARE_STRUCT(QuadFieldCellArray)
+
+public:
+	void Init(int numCells_, int numGroups_) {
+		numCells = numCells_;
+		numGroups = std::max(numGroups_, 1);
+		numFreeSlots = 0;
+
+		items.assign(numCells * MIN_CELL_SLACK, T());
+		cellBegins.resize(numCells);
+		cellLimits.resize(numCells);
+		groupEnds.resize(numCells * numGroups);
+
+		for (int c = 0; c < numCells; ++c) {
+			cellBegins[c] = c * MIN_CELL_SLACK;
+			cellLimits[c] = cellBegins[c] + MIN_CELL_SLACK;
+
+			std::fill(groupEnds.begin() + c * numGroups, groupEnds.begin() + (c + 1) * numGroups, cellBegins[c]);
+		}
+	}
+
+	void Kill() {
+		// keep the memory around for reloading
+		items.clear();
+		spareItems.clear();
+		cellBegins.clear();
+		cellLimits.clear();
+		groupEnds.clear();
+
+		numCells = 0;
+		numFreeSlots = 0;
+	}
+
+	/// all objects in cell <c>, ordered by group
+	std::span<const T> Cell(int c) const {
+		assert(c >= 0 && c < numCells);
+		return {items.data() + cellBegins[c], items.data() + CellEnd(c)};
+	}
+	/// objects in cell <c> belonging to group <g>
+	std::span<const T> Group(int c, int g) const {
+		assert(c >= 0 && c < numCells);
+		assert(g >= 0 && g < numGroups);
+		return {items.data() + GroupBegin(c, g), items.data() + groupEnds[c * numGroups + g]};
+	}
+
+	void Insert(int c, int g, T t) {
+		assert(std::find(Group(c, g).begin(), Group(c, g).end(), t) == Group(c, g).end());
+
+		if (CellEnd(c) == cellLimits[c])
+			Relocate(c);
+
+		// move the groups after <g> back by one slot, keeping their order
+		int* ends = &groupEnds[c * numGroups];
+		const auto pos = items.begin() + ends[g];
+		const auto end = items.begin() + ends[numGroups - 1];
+
+		std::copy_backward(pos, end, end + 1);
+		*pos = t;
+
+		for (int i = g; i < numGroups; ++i) {
+			ends[i] += 1;
+		}
+	}
+
+	bool Erase(int c, int g, T t) {
+		int* ends = &groupEnds[c * numGroups];
+		const auto beg = items.begin() + GroupBegin(c, g);
+		const auto end = items.begin() + ends[g];
+		const auto pos = std::find(beg, end, t);
+
+		if (pos == end)
+			return false;
+
+		const auto cellEnd = items.begin() + ends[numGroups - 1];
+
+		std::copy(pos + 1, cellEnd, pos);
+		// slack must not hold stale pointers, creg serializes it
+		*(cellEnd - 1) = T();
+
+		for (int i = g; i < numGroups; ++i) {
+			ends[i] -= 1;
+		}
+
+		return true;
+	}
+
+	/// repacks the cells if too many had to be relocated since the last repack
+	void Update() {
+		if ((numFreeSlots * 4) < int(items.size()))
+			return;
+
+		Repack();
+	}
+
+	size_t GetNumCells() const { return numCells; }
+	size_t GetCapacity() const { return items.size(); }
+
+private:
+	static constexpr int MIN_CELL_SLACK = 4;
+
+	static int CellCapacity(int size) { return (size + std::max(size / 2, MIN_CELL_SLACK)); }
+
+	int GroupBegin(int c, int g) const { return ((g == 0)? cellBegins[c]: groupEnds[c * numGroups + g - 1]); }
+	int CellEnd(int c) const { return groupEnds[c * numGroups + numGroups - 1]; }
+
+	/// moves cell <c> to the end of the array with twice its capacity
+	void Relocate(int c) {
+		const int cellSize = CellEnd(c) - cellBegins[c];
+		const int newBegin = items.size();
+		const int shift = newBegin - cellBegins[c];
+
+		numFreeSlots += (cellLimits[c] - cellBegins[c]);
+
+		items.resize(newBegin + CellCapacity(cellSize * 2), T());
+
+		const auto src = items.begin() + cellBegins[c];
+
+		std::copy(src, src + cellSize, items.begin() + newBegin);
+		std::fill(src, src + cellSize, T());
+
+		for (int g = 0; g < numGroups; ++g) {
+			groupEnds[c * numGroups + g] += shift;
+		}
+
+		cellBegins[c] = newBegin;
+		cellLimits[c] = items.size();
+	}
+
+	/**
+	 * Counting sort of the items by cell; they are already grouped, so this
+	 * reduces to a prefix-sum over the new cell capacities followed by
+	 * copying every cell (in parallel) to its new offset.
+	 */
+	void Repack() {
+		spareLimits.resize(numCells);
+
+		for (int c = 0, offset = 0; c < numCells; ++c) {
+			offset += CellCapacity(CellEnd(c) - cellBegins[c]);
+			spareLimits[c] = offset;
+		}
+
+		spareItems.resize(spareLimits[numCells - 1]);
+
+		for_mt_chunk(0, numCells, [&](int c) {
+			const int newBegin = (c == 0)? 0: spareLimits[c - 1];
+			const int shift = newBegin - cellBegins[c];
+			const auto end = std::copy(items.begin() + cellBegins[c], items.begin() + CellEnd(c), spareItems.begin() + newBegin);
+
+			// slack must not hold stale pointers, creg serializes it
+			std::fill(end, spareItems.begin() + spareLimits[c], T());
+
+			for (int g = 0; g < numGroups; ++g) {
+				groupEnds[c * numGroups + g] += shift;
+			}
+
+			cellBegins[c] = newBegin;
+		}, 64);
+
+		items.swap(spareItems);
+		cellLimits.swap(spareLimits);
+
+		numFreeSlots = 0;
+	}
+
+private:
+	std::vector<T> items;
+	std::vector<T> spareItems;
+
+	/// first and one-past-last slot of each cell
+	std::vector<int> cellBegins;
+	std::vector<int> cellLimits;
+	std::vector<int> spareLimits;
+	/// one-past-last slot of each group, numCells * numGroups entries
+	std::vector<int> groupEnds;
+
+	int numCells = 0;
+	int numGroups = 1;
+	int numFreeSlots = 0;
+};
+
+#endif
@@ -5,6 +5,7 @@
 #include <limits>
 
 #include "SmoothHeightMesh.h"
+#include "SmoothHeightMeshFilters.h"
 
 #include "Map/Ground.h"
 #include "Map/ReadMap.h"
@@ -20,14 +21,6 @@
 
 using namespace SmoothHeightMeshNamespace;
 
-#if 0
-#define SMOOTH_MESH_DEBUG_MAXIMA
-#endif
-
-#if 0
-#define SMOOTH_MESH_DEBUG_BLUR
-#endif
-
 #if 0
 #define SMOOTH_MESH_DEBUG_GENERAL
 #endif
@@ -102,10 +95,7 @@ void SmoothHeightMesh::InitDataStructures() {
 	mesh.resize(maxx * maxy, 0.0f);
 	tempMesh.resize(maxx * maxy, 0.0f);
 	origMesh.resize(maxx * maxy, 0.0f);
-	colsMaxima.clear();
-	colsMaxima.resize(maxx, -std::numeric_limits<float>::max());
-	maximaRows.clear();
-	maximaRows.resize(maxx, -1);
+	groundMesh.resize(maxx * maxy, 0.0f);
 }
 
 void SmoothHeightMesh::Kill() {
@@ -119,6 +109,7 @@ void SmoothHeightMesh::Kill() {
 	maximaMesh.clear();
 	mesh.clear();
 	origMesh.clear();
+	groundMesh.clear();
 }
 
 float SmoothHeightMesh::GetHeight(float x, float y)
@@ -164,276 +155,15 @@ inline static float GetRealGroundHeight(int x, int y, int resolution) {
 	return heightMap[baseIndex];
 }
 
-inline static void FindMaximumColumnHeights(
-	const int2 map,
-	const int y,
-	const int minx,
-	const int maxx,
-	const int winSize,
-	const int resolution,
-	std::vector<float>& colsMaxima,
-	std::vector<int>& maximaRows
-) {
-	RECOIL_DETAILED_TRACY_ZONE;
-	// initialize the algorithm: find the maximum
-	// height per column and the corresponding row
-
-	const int miny = std::max(y - winSize, 0);
-	const int maxy = std::min(y + winSize, map.y - 1);
-
-	for (int y1 = miny; y1 <= maxy; ++y1) {
-		for (int x = minx; x <= maxx; ++x)  {
-			const float curh = GetRealGroundHeight(x, y1, resolution);
-
-			if (curh >= colsMaxima[x]) {
-				colsMaxima[x] = curh;
-				maximaRows[x] = y1;
-			}
-		}
-	}
-
-#ifdef SMOOTH_MESH_DEBUG_MAXIMA
-	for (int x = minx; x <= maxx; ++x)
-		LOG("%s: y:%d col:%d row:%d max: %f", __func__, y, x, maximaRows[x], colsMaxima[x]);
-#endif
-}
-
-
-inline static void FindRadialMaximum(
-	const int2 map,
-	int y,
-	int minx,
-	int maxx,
-	int winSize,
-	float resolution,
-	const std::vector<float>& colsMaxima,
-	      std::vector<float>& mesh
-) {
+void SmoothHeightMesh::UpdateGroundMesh(int2 min, int2 max) {
 	RECOIL_DETAILED_TRACY_ZONE;
-	for (int x = minx; x <= maxx; ++x) {
-		float maxRowHeight = -std::numeric_limits<float>::max();
-
-		// find current maximum within radius smoothRadius
-		// (in every column stack) along the current row
-		const int startx = std::max(x - winSize, 0);
-		const int endx = std::min(x + winSize, map.x - 1);
-
-		// This may mean the last SSE max function compares some values have already been compared
-		// This is harmless and avoids needlessly messy SSE code here
-		const int endIdx = endx - 3;
-
-		// Main loop for finding maximum height values
-		__m128 best = _mm_loadu_ps(&colsMaxima[startx]);
-		for (int i = startx + 4; i < endIdx; i += 4) {
-			__m128 next = _mm_loadu_ps(&colsMaxima[i]);
-			best = _mm_max_ps(best, next);
-		}
-
-		// Check the last few height values
-		{
-			__m128 next = _mm_loadu_ps(&colsMaxima[endIdx]);
-			best = _mm_max_ps(best, next);
+	for_mt_chunk(min.y, max.y + 1, [&](const int y) {
+		for (int x = min.x; x <= max.x; ++x) {
+			groundMesh[x + y * maxx] = GetRealGroundHeight(x, y, resolution);
 		}
-
-		// This is an SSE horizontal compare
-		{
-			// split the four values into sets of two and compare
-			__m128 bestAlt = _mm_movehl_ps(best, best);
-			best = _mm_max_ps(best, bestAlt);
-
-			// split the two values and compare
-			bestAlt = _mm_shuffle_ps(best, best, _MM_SHUFFLE(0, 0, 0, 1));
-			best = _mm_max_ss(best, bestAlt);
-			_mm_store_ss(&maxRowHeight, best);
-		}
-
-		mesh[x + y * map.x] = maxRowHeight;
-
-#ifdef SMOOTH_MESH_DEBUG_MAXIMA
-		LOG("%s: y:%d x:%d local max: %f", __func__, y, x, maxRowHeight);
-#endif
-	}
-}
-
-
-inline static void AdvanceMaximas(
-	const int2 map,
-	const int y,
-	const int minx,
-	const int maxx,
-	const int winSize,
-	const int resolution,
-	std::vector<float>& colsMaxima,
-	std::vector<int>& maximaRows
-) {
-	RECOIL_DETAILED_TRACY_ZONE;
-	// fix remaining maximums after a pass
-	const int miny = std::max(y - winSize, 0);
-	const int virtualRow = y + winSize;
-	const int maxy = std::min(virtualRow, map.y - 1);
-
-	for (int x = minx; x <= maxx; ++x) {
-		if (maximaRows[x] < miny) {
-			// find a new maximum if the old one left the window
-			colsMaxima[x] = -std::numeric_limits<float>::max();
-
-			for (int y1 = miny; y1 <= maxy; ++y1) {
-				const float h = GetRealGroundHeight(x, y1, resolution);
-
-				if (h >= colsMaxima[x]) {
-					colsMaxima[x] = h;
-					maximaRows[x] = y1;
-				}
-			}
-		} else if (virtualRow < map.y) {
-			// else, just check if a new maximum has entered the window
-			const float h = GetRealGroundHeight(x, maxy, resolution);
-
-			if (h >= colsMaxima[x]) {
-				colsMaxima[x] = h;
-				maximaRows[x] = maxy;
-			}
-		}
-
-#ifdef SMOOTH_MESH_DEBUG_MAXIMA
-		LOG("%s: y:%d x:%d column max: %f", __func__, y, x, colsMaxima[x]);
-#endif
-
-		assert(maximaRows[x] <= maxy);
-		assert(maximaRows[x] >= y - winSize);
-	}
+	}, 16);
 }
 
-
-inline static void BlurHorizontal(
-	const int2 mapSize,
-	const int2 min,
-	const int2 max,
-	const int blurSize,
-	const int resolution,
-	const std::vector<float>& mesh,
-	      std::vector<float>& smoothed
-) {
-	RECOIL_DETAILED_TRACY_ZONE;
-	const int lineSize = mapSize.x;
-	const int mapMaxX = mapSize.x - 1;
-
-	for (int y = min.y; y <= max.y; ++y)
-	{
-		float avg = 0.0f;
-		float lv = 0;
-		float rv = 0;
-		float weight = 1.f / ((float)(blurSize*2 + 1));
-		int li = min.x - blurSize;
-		int ri = min.x + blurSize;
-
-		// linear blending allows us to add up all the values to average for the first point
-		// the rest of the points can be determined by taking the average after removing the
-		// last oldest value and adding the next value.
-		for (int x1 = li; x1 <= ri; ++x1) {
-		 	avg += mesh[std::max(0, std::min(x1, mapMaxX)) + y * lineSize];
-		}
-		// ri should point to the next value to add to the averages
-		ri++;
-
-		for (int x = min.x; x <= max.x; ++x)
-		{
-			// Remove the oldest height value (lv) and add the newest height value (rv)
-			avg += (-lv) + rv;
-			const float gh = GetRealGroundHeight(x, y, resolution);
-			smoothed[x + y * lineSize] = std::max(gh, avg*weight);
-
-			// Get the values to add/remove for next iteration
-			lv = mesh[std::max(0, std::min(li, mapMaxX)) + y * lineSize];
-			rv = mesh[            std::min(ri, mapMaxX)  + y * lineSize];
-			li++; ri++;
-
-#ifdef SMOOTH_MESH_DEBUG_BLUR
-			LOG ( "%s: x: %d, y: %d, avg: %f (%f) (g: %f) (max h: %f)"
-				, __func__, x, y, avg, avg*weight, gh, readMap->GetCurrMaxHeight());
-#endif
-		}
-	}
-}
-
-inline static void BlurVertical(
-	const int2 mapSize,
-	const int2 min,
-	const int2 max,
-	const int blurSize,
-	const int resolution,
-	const std::vector<float>& mesh,
-	      std::vector<float>& smoothed
-) {
-	RECOIL_DETAILED_TRACY_ZONE;
-	// See BlurHorizontal for all the detailed comments.
-
-	const int lineSize = mapSize.x;
-	const int mapMaxY = mapSize.y - 1;
-
-	for (int x = min.x; x <= max.x; ++x)
-	{
-		float avg = 0.0f;
-		float lv = 0;
-		float rv = 0;
-		float weight = 1.f / ((float)(blurSize*2 + 1));
-		int li = min.y - blurSize;
-		int ri = min.y + blurSize;
-		for (int y1 = li; y1 <= ri; ++y1) {
-			avg += mesh[x + std::max(0, std::min(y1, mapMaxY)) * lineSize];
-		}
-		ri++;
-
-#ifdef SMOOTH_MESH_DEBUG_BLUR
-		LOG("%s: starting average is: %f (%f) (w: %f)", __func__, avg, avg*weight, weight);
-#endif
-
-		for (int y = min.y; y <= max.y; ++y)
-		{
-			avg += (-lv) + rv;
-			const float gh = GetRealGroundHeight(x, y, resolution);
-			smoothed[x + y * lineSize] = std::max(gh, avg*weight);
-
-			lv = mesh[ x + std::max(0, std::min(li, mapMaxY)) * lineSize];
-			rv = mesh[ x +             std::min(ri, mapMaxY)  * lineSize];
-			li++; ri++;
-
-#ifdef SMOOTH_MESH_DEBUG_BLUR
-			LOG("%s: x: %d, y: %d, avg: %f (%f) (g: %f)", __func__, x, y, avg, avg*weight, gh);
-			LOG("%s: for next line -%f +%f", __func__, lv, rv);
-#endif
-		}
-	}
-}
-
-
-inline static void CheckInvariants(
-	int y,
-	int maxx,
-	int maxy,
-	int winSize,
-	int resolution,
-	const std::vector<float>& colsMaxima,
-	const std::vector<int>& maximaRows
-) {
-	RECOIL_DETAILED_TRACY_ZONE;
-	// check invariants - only for initial mesh creationgit reset HEAD~
-	if (y <= maxy) {
-		for (int x = 0; x <= maxx; ++x) {
-			assert(maximaRows[x] > y - winSize);
-			assert(maximaRows[x] <= maxy);
-			assert(colsMaxima[x] <= readMap->GetCurrMaxHeight() + 1.f);
-			assert(colsMaxima[x] >= readMap->GetCurrMinHeight() - 1.f);
-		}
-	}
-	for (int y1 = std::max(0, (y - winSize) + 1); y1 <= std::min(maxy, y + winSize + 1); ++y1) {
-		for (int x1 = 0; x1 <= maxx; ++x1) {
-			assert(GetRealGroundHeight(x1, y1, resolution) <= colsMaxima[x1] + 1.f);
-		}
-	}
-}
-
-
 void SmoothHeightMesh::MapChanged(int x1, int y1, int x2, int y2) {
 	RECOIL_DETAILED_TRACY_ZONE;
 
@@ -538,18 +268,9 @@ LOG("%s: quad area in world space (%f,%f) (%f,%f)", __func__
 	);
 #endif
 
-	for (int i = min.x; i <= max.x; ++i)
-		colsMaxima[i] = -std::numeric_limits<float>::max();
-
-	for (int i = min.x; i <= max.x; ++i)
-		maximaRows[i] = -1;
-
-	FindMaximumColumnHeights(map, damageMin.y, min.x, max.x, winSize, resolution, colsMaxima, maximaRows);
-
-	for (int y = damageMin.y; y <= damageMax.y; ++y) {
-		FindRadialMaximum(map, y, damageMin.x, damageMax.x, winSize, resolution, colsMaxima, maximaMesh);
-		AdvanceMaximas(map, y+1, min.x, max.x, winSize, resolution, colsMaxima, maximaRows);
-	}
+	// [min, max] is exactly the area read by the windows around the damage
+	UpdateGroundMesh(min, max);
+	MaxFilter(groundMesh.data(), maximaMesh.data(), map, damageMin, damageMax, winSize);
 }
 
 
@@ -607,12 +328,15 @@ void SmoothHeightMesh::UpdateSmoothMesh() {
 		);
 #endif
 
+		// the terrain may have changed again since the maxima were updated
+		UpdateGroundMesh(damageMin, damageMax);
+
 		if (doHorizontalBlur) {
-			BlurHorizontal(map, damageMin, damageMax, blurSize, resolution, maximaMesh, tempMesh);
+			BlurHorizontal(maximaMesh.data(), groundMesh.data(), tempMesh.data(), map, damageMin, damageMax, blurSize);
 			mapChangeTrack.verticalBlurQueue.push(damagedAreaIndex);
 		}
 		else {
-			BlurVertical(map, damageMin, damageMax, blurSize, resolution, tempMesh, mesh);
+			BlurVertical(tempMesh.data(), groundMesh.data(), mesh.data(), map, damageMin, damageMax, blurSize);
 			CopyMeshPart(map.x, damageMin, damageMax, mesh, tempMesh);
 		}
 	}
@@ -631,19 +355,11 @@ void SmoothHeightMesh::MakeSmoothMesh() {
 	int2 max{maxx-1, maxy-1};
 	int2 map{maxx, maxy};
 
- 	FindMaximumColumnHeights(map, 0, 0, max.x, winSize, resolution, colsMaxima, maximaRows);
-
-	for (int y = 0; y <= max.y; ++y) {
-		FindRadialMaximum(map, y, 0, max.x, winSize, resolution, colsMaxima, maximaMesh);
-		AdvanceMaximas(map, y+1, 0, max.x, winSize, resolution, colsMaxima, maximaRows);
-
-#ifdef _DEBUG
-		CheckInvariants(y, max.x, max.y, winSize, resolution, colsMaxima, maximaRows);
-#endif
-	}
+	UpdateGroundMesh(min, max);
 
-	BlurHorizontal(map, min, max, blurSize, resolution, maximaMesh, tempMesh);
-	BlurVertical(map, min, max, blurSize, resolution, tempMesh, mesh);
+	MaxFilter(groundMesh.data(), maximaMesh.data(), map, min, max, winSize);
+	BlurHorizontal(maximaMesh.data(), groundMesh.data(), tempMesh.data(), map, min, max, blurSize);
+	BlurVertical(tempMesh.data(), groundMesh.data(), mesh.data(), map, min, max, blurSize);
 
 	// <mesh> now contains the final smoothed heightmap, save it in origMesh
 	std::copy(mesh.begin(), mesh.end(), origMesh.begin());
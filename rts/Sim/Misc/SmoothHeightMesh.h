@@ -65,6 +65,7 @@ private:
 	void InitMapChangeTracking();
 	void InitDataStructures();
 	void UpdateSmoothMeshMaximas(int2 damageMin, int2 damageMax);
+	void UpdateGroundMesh(int2 min, int2 max);
 
 	bool enabled = true;
 
@@ -80,9 +81,8 @@ private:
 	std::vector<float> mesh;
 	std::vector<float> tempMesh;
 	std::vector<float> origMesh;
-
-	std::vector<float> colsMaxima;
-	std::vector<int> maximaRows;
+	/// heightmap sampled at mesh resolution, refreshed before each filter pass
+	std::vector<float> groundMesh;
 
 	MapChangeTrack mapChangeTrack;
 };
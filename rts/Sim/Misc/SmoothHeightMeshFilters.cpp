@@ -0,0 +1,271 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "SmoothHeightMeshFilters.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <xmmintrin.h>
+
+#include "System/Threading/ThreadPool.h"
+
+#include "System/Misc/TracyDefs.h"
+
+
+namespace SmoothHeightMeshNamespace {
+
+// columns per job in the vertical passes, multiple of the SIMD width
+static constexpr int COLUMN_CHUNK_SIZE = 64;
+// rows per job in the horizontal passes
+static constexpr int MIN_ROW_CHUNK_SIZE = 16;
+
+static constexpr float NEG_INF_HEIGHT = -std::numeric_limits<float>::max();
+
+static const float negInfRow[COLUMN_CHUNK_SIZE] = {
+	NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT,
+	NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT,
+	NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT,
+	NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT,
+	NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT,
+	NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT,
+	NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT,
+	NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT, NEG_INF_HEIGHT,
+};
+
+
+static inline void CopyLanes(const float* a, float* out, int n) { std::copy(a, a + n, out); }
+static inline void MaxLanes(const float* a, const float* b, float* out, int n)
+{
+	int i = 0;
+
+	for (; i <= (n - 4); i += 4) {
+		_mm_storeu_ps(out + i, _mm_max_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+	}
+	for (; i < n; ++i) {
+		out[i] = std::max(a[i], b[i]);
+	}
+}
+
+
+/*
+ * van Herk/Gil-Werman running maximum over windows of k = 2*w+1 values:
+ * the (padded) input is cut into blocks of k, g holds the maxima from the
+ * start of each block and h those up to its end, so every window is covered
+ * by the suffix of one block and the prefix of the next and costs a single
+ * comparison regardless of its size.
+ *
+ * Works on <numLanes> independent sequences at once; <Input(j)> returns the
+ * lanes of padded position j. Writes <n> outputs of <numLanes> values each,
+ * output i being the maximum over padded positions [i, i + k - 1].
+ */
+template<typename Input>
+static void MaxFilterLanes(Input&& input, float* out, int outStride, int n, int w, int numLanes, std::vector<float>& g, std::vector<float>& h)
+{
+	const int k = 2 * w + 1;
+	const int m = n + 2 * w;
+
+	g.resize(m * numLanes);
+	h.resize(m * numLanes);
+
+	for (int j = 0; j < m; ++j) {
+		float* gj = &g[j * numLanes];
+
+		if ((j % k) == 0) {
+			CopyLanes(input(j), gj, numLanes);
+		} else {
+			MaxLanes(gj - numLanes, input(j), gj, numLanes);
+		}
+	}
+
+	for (int j = m - 1; j >= 0; --j) {
+		float* hj = &h[j * numLanes];
+
+		if ((j % k) == (k - 1) || j == (m - 1)) {
+			CopyLanes(input(j), hj, numLanes);
+		} else {
+			MaxLanes(hj + numLanes, input(j), hj, numLanes);
+		}
+	}
+
+	for (int i = 0; i < n; ++i) {
+		MaxLanes(&h[i * numLanes], &g[(i + k - 1) * numLanes], out + i * outStride, numLanes);
+	}
+}
+
+
+void MaxFilter(const float* src, float* dst, int2 size, int2 min, int2 max, int winSize)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+
+	const int w = std::max(winSize, 0);
+
+	// columns whose maxima are needed by the horizontal pass
+	const int cx1 = std::max(min.x - w, 0);
+	const int cx2 = std::min(max.x + w, size.x - 1);
+	const int numCols = cx2 - cx1 + 1;
+	const int numRows = max.y - min.y + 1;
+
+	if (numCols <= 0 || numRows <= 0)
+		return;
+
+	static thread_local std::vector<float> colMaxima;
+	colMaxima.resize(numCols * numRows);
+
+	std::vector<float>& colMax = colMaxima;
+
+	// vertical pass, SIMD across adjacent columns
+	const int numColChunks = (numCols + COLUMN_CHUNK_SIZE - 1) / COLUMN_CHUNK_SIZE;
+
+	for_mt(0, numColChunks, [&](const int chunk) {
+		static thread_local std::vector<float> g;
+		static thread_local std::vector<float> h;
+
+		const int c0 = cx1 + chunk * COLUMN_CHUNK_SIZE;
+		const int c1 = std::min(c0 + COLUMN_CHUNK_SIZE, cx2 + 1);
+
+		const auto input = [&](int j) {
+			const int y = min.y - w + j;
+
+			if (y < 0 || y >= size.y)
+				return &negInfRow[0];
+
+			return (src + y * size.x + c0);
+		};
+
+		MaxFilterLanes(input, &colMax[c0 - cx1], numCols, numRows, w, c1 - c0, g, h);
+	});
+
+	// horizontal pass, one row per job
+	const int numOutCols = max.x - min.x + 1;
+
+	for_mt_chunk(0, numRows, [&](const int row) {
+		static thread_local std::vector<float> g;
+		static thread_local std::vector<float> h;
+
+		const float* colMaxRow = &colMax[row * numCols];
+
+		const auto input = [&](int j) {
+			const int x = min.x - w + j;
+
+			if (x < 0 || x >= size.x)
+				return &negInfRow[0];
+
+			return (colMaxRow + (x - cx1));
+		};
+
+		MaxFilterLanes(input, dst + (min.y + row) * size.x + min.x, 1, numOutCols, w, 1, g, h);
+	}, MIN_ROW_CHUNK_SIZE);
+}
+
+
+void BlurHorizontal(const float* src, const float* ground, float* dst, int2 size, int2 min, int2 max, int blurSize)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+
+	const int lineSize = size.x;
+	const int mapMaxX = size.x - 1;
+
+	// the running sum is order-dependent, so every row is still summed in
+	// sequence; only whole rows are distributed across threads
+	for_mt_chunk(min.y, max.y + 1, [&](const int y) {
+		float avg = 0.0f;
+		float lv = 0;
+		float rv = 0;
+		float weight = 1.f / ((float)(blurSize*2 + 1));
+		int li = min.x - blurSize;
+		int ri = min.x + blurSize;
+
+		// linear blending allows us to add up all the values to average for the first point
+		// the rest of the points can be determined by taking the average after removing the
+		// last oldest value and adding the next value.
+		for (int x1 = li; x1 <= ri; ++x1) {
+			avg += src[std::max(0, std::min(x1, mapMaxX)) + y * lineSize];
+		}
+		// ri should point to the next value to add to the averages
+		ri++;
+
+		for (int x = min.x; x <= max.x; ++x) {
+			// Remove the oldest height value (lv) and add the newest height value (rv)
+			avg += (-lv) + rv;
+			dst[x + y * lineSize] = std::max(ground[x + y * lineSize], avg*weight);
+
+			// Get the values to add/remove for next iteration
+			lv = src[std::max(0, std::min(li, mapMaxX)) + y * lineSize];
+			rv = src[            std::min(ri, mapMaxX)  + y * lineSize];
+			li++; ri++;
+		}
+	}, MIN_ROW_CHUNK_SIZE);
+}
+
+void BlurVertical(const float* src, const float* ground, float* dst, int2 size, int2 min, int2 max, int blurSize)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+
+	const int lineSize = size.x;
+	const int mapMaxY = size.y - 1;
+	const int numCols = max.x - min.x + 1;
+	const int numColChunks = (numCols + COLUMN_CHUNK_SIZE - 1) / COLUMN_CHUNK_SIZE;
+
+	// columns are independent and adjacent in memory, so four of them run
+	// in lock-step; every lane performs exactly the operations of the scalar
+	// loop in BlurHorizontal (x - y == x + (-y) in IEEE arithmetic, and
+	// _mm_max_ps(v, g) returns g on ties just like std::max(g, v) does)
+	for_mt(0, numColChunks, [&](const int chunk) {
+		const int c0 = min.x + chunk * COLUMN_CHUNK_SIZE;
+		const int c1 = std::min(c0 + COLUMN_CHUNK_SIZE, max.x + 1);
+
+		const float weight = 1.f / ((float)(blurSize*2 + 1));
+
+		int x = c0;
+
+		for (; x <= (c1 - 4); x += 4) {
+			const __m128 w4 = _mm_set1_ps(weight);
+
+			__m128 avg = _mm_setzero_ps();
+			__m128 lv = _mm_setzero_ps();
+			__m128 rv = _mm_setzero_ps();
+
+			int li = min.y - blurSize;
+			int ri = min.y + blurSize;
+
+			for (int y1 = li; y1 <= ri; ++y1) {
+				avg = _mm_add_ps(avg, _mm_loadu_ps(&src[x + std::max(0, std::min(y1, mapMaxY)) * lineSize]));
+			}
+			ri++;
+
+			for (int y = min.y; y <= max.y; ++y) {
+				avg = _mm_add_ps(avg, _mm_sub_ps(rv, lv));
+				_mm_storeu_ps(&dst[x + y * lineSize], _mm_max_ps(_mm_mul_ps(avg, w4), _mm_loadu_ps(&ground[x + y * lineSize])));
+
+				lv = _mm_loadu_ps(&src[x + std::max(0, std::min(li, mapMaxY)) * lineSize]);
+				rv = _mm_loadu_ps(&src[x +             std::min(ri, mapMaxY)  * lineSize]);
+				li++; ri++;
+			}
+		}
+
+		for (; x < c1; ++x) {
+			float avg = 0.0f;
+			float lv = 0;
+			float rv = 0;
+			int li = min.y - blurSize;
+			int ri = min.y + blurSize;
+
+			for (int y1 = li; y1 <= ri; ++y1) {
+				avg += src[x + std::max(0, std::min(y1, mapMaxY)) * lineSize];
+			}
+			ri++;
+
+			for (int y = min.y; y <= max.y; ++y) {
+				avg += (-lv) + rv;
+				dst[x + y * lineSize] = std::max(ground[x + y * lineSize], avg*weight);
+
+				lv = src[x + std::max(0, std::min(li, mapMaxY)) * lineSize];
+				rv = src[x +             std::min(ri, mapMaxY)  * lineSize];
+				li++; ri++;
+			}
+		}
+	});
+}
+
+}
@@ -0,0 +1,25 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef SMOOTH_HEIGHT_MESH_FILTERS_H
+#define SMOOTH_HEIGHT_MESH_FILTERS_H
+
+#include "System/type2.h"
+
+/**
+ * Filters used to build the smooth height mesh, working on row-major
+ * arrays of <size.x * size.y> samples. Each writes the inclusive area
+ * [min, max] of <dst> and reads whatever lies within its window of that
+ * area (clipped to the mesh). Results are bit-identical to the original
+ * sliding-window implementations, which is required since the mesh is
+ * synced.
+ */
+namespace SmoothHeightMeshNamespace {
+	/// maximum of <src> within the (2*winSize+1)^2 square around each sample
+	void MaxFilter(const float* src, float* dst, int2 size, int2 min, int2 max, int winSize);
+
+	/// box blur of <src> along x or y with radius blurSize, never lower than <ground>
+	void BlurHorizontal(const float* src, const float* ground, float* dst, int2 size, int2 min, int2 max, int blurSize);
+	void BlurVertical(const float* src, const float* ground, float* dst, int2 size, int2 min, int2 max, int blurSize);
+}
+
+#endif
@@ -0,0 +1,365 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <limits>
+
+#include "AbstractGraph.h"
+#include "Node.h"
+#include "NodeLayer.h"
+
+#include "Sim/Misc/GlobalConstants.h"
+#include "System/Misc/TracyDefs.h"
+
+static_assert((QTPFS_ABSTRACT_CLUSTER_SIZE % QTPFS_MAX_NODE_SIZE) == 0, "nodes must not straddle abstract clusters");
+
+
+static bool IsRegionNode(const QTPFS::INode* node) {
+	return (!node->AllSquaresImpassable() && !node->IsExitOnly());
+}
+
+
+void QTPFS::AbstractGraph::Init(int mapx, int mapz) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	Clear();
+
+	mapxsize = mapx;
+	mapzsize = mapz;
+	xclusters = (mapx + QTPFS_ABSTRACT_CLUSTER_SIZE - 1) / QTPFS_ABSTRACT_CLUSTER_SIZE;
+	zclusters = (mapz + QTPFS_ABSTRACT_CLUSTER_SIZE - 1) / QTPFS_ABSTRACT_CLUSTER_SIZE;
+
+	clusters.resize(xclusters * zclusters);
+	regionOffsets.resize(clusters.size(), 0);
+
+	anyDirty = true;
+}
+
+void QTPFS::AbstractGraph::Clear() {
+	clusters.clear();
+	regionOffsets.clear();
+	regionClusters.clear();
+	tmpNodes.clear();
+	fillStack.clear();
+
+	xclusters = 0;
+	zclusters = 0;
+	mapxsize = 0;
+	mapzsize = 0;
+	numRegions = 0;
+	anyDirty = false;
+}
+
+
+void QTPFS::AbstractGraph::MarkDirty(const SRectangle& r) {
+	if (!IsInitialized())
+		return;
+
+	const int cx1 = std::clamp(r.x1    , 0, mapxsize - 1) / QTPFS_ABSTRACT_CLUSTER_SIZE;
+	const int cz1 = std::clamp(r.z1    , 0, mapzsize - 1) / QTPFS_ABSTRACT_CLUSTER_SIZE;
+	const int cx2 = std::clamp(r.x2 - 1, 0, mapxsize - 1) / QTPFS_ABSTRACT_CLUSTER_SIZE;
+	const int cz2 = std::clamp(r.z2 - 1, 0, mapzsize - 1) / QTPFS_ABSTRACT_CLUSTER_SIZE;
+
+	for (int cz = cz1; cz <= cz2; ++cz) {
+		for (int cx = cx1; cx <= cx2; ++cx) {
+			clusters[cz * xclusters + cx].dirty = true;
+		}
+	}
+
+	anyDirty = true;
+}
+
+void QTPFS::AbstractGraph::Update(NodeLayer& nodeLayer) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (!anyDirty)
+		return;
+
+	// all dirty clusters must have their regions rebuilt before any links
+	// are made, links refer to the (new) regions on both sides of a border
+	for (int i = 0, n = clusters.size(); i < n; ++i) {
+		if (!clusters[i].dirty)
+			continue;
+
+		BuildCluster(nodeLayer, i);
+
+		const int cx = i % xclusters;
+		const int cz = i / xclusters;
+
+		for (int z = std::max(cz - 1, 0); z <= std::min(cz + 1, zclusters - 1); ++z) {
+			for (int x = std::max(cx - 1, 0); x <= std::min(cx + 1, xclusters - 1); ++x) {
+				clusters[z * xclusters + x].relink = true;
+			}
+		}
+	}
+
+	for (int i = 0, n = clusters.size(); i < n; ++i) {
+		if (!clusters[i].relink)
+			continue;
+
+		LinkCluster(nodeLayer, i);
+
+		clusters[i].dirty = false;
+		clusters[i].relink = false;
+	}
+
+	UpdateRegionOffsets();
+	anyDirty = false;
+}
+
+
+void QTPFS::AbstractGraph::BuildCluster(NodeLayer& nodeLayer, int clusterIdx) {
+	Cluster& cluster = clusters[clusterIdx];
+
+	cluster.nodeRegions.clear();
+	cluster.regions.clear();
+
+	nodeLayer.GetNodesInArea(GetClusterRect(clusterIdx), tmpNodes);
+
+	for (const INode* node: tmpNodes) {
+		if (!IsRegionNode(node))
+			continue;
+
+		cluster.nodeRegions.emplace_back(node->GetIndex(), -1);
+	}
+
+	std::sort(cluster.nodeRegions.begin(), cluster.nodeRegions.end());
+
+	const auto FindNodeSlot = [&cluster](unsigned int nodeIndex) {
+		const auto pred = [](const std::pair<unsigned int, int>& a, unsigned int b) { return (a.first < b); };
+		const auto iter = std::lower_bound(cluster.nodeRegions.begin(), cluster.nodeRegions.end(), nodeIndex, pred);
+
+		if (iter == cluster.nodeRegions.end() || iter->first != nodeIndex)
+			return -1;
+
+		return int(iter - cluster.nodeRegions.begin());
+	};
+
+	// flood-fill the cluster's open nodes; nodes outside of it are never in nodeRegions
+	for (int i = 0, n = cluster.nodeRegions.size(); i < n; ++i) {
+		if (cluster.nodeRegions[i].second >= 0)
+			continue;
+
+		const int regionIdx = cluster.regions.size();
+
+		float3 centreSum;
+		float costSum = 0.0f;
+		float areaSum = 0.0f;
+
+		fillStack.clear();
+		fillStack.push_back(i);
+		cluster.nodeRegions[i].second = regionIdx;
+
+		while (!fillStack.empty()) {
+			const INode* node = nodeLayer.GetPoolNode(cluster.nodeRegions[fillStack.back()].first);
+			const float area = node->area();
+
+			fillStack.pop_back();
+
+			centreSum += float3((node->xmin() + node->xmax()) * 0.5f * SQUARE_SIZE, 0.0f, (node->zmin() + node->zmax()) * 0.5f * SQUARE_SIZE) * area;
+			costSum += node->GetMoveCost() * area;
+			areaSum += area;
+
+			for (const auto& neighbour: node->GetNeighbours()) {
+				const int slot = FindNodeSlot(neighbour.nodeId);
+
+				if (slot < 0 || cluster.nodeRegions[slot].second >= 0)
+					continue;
+
+				cluster.nodeRegions[slot].second = regionIdx;
+				fillStack.push_back(slot);
+			}
+		}
+
+		Region& region = cluster.regions.emplace_back();
+		region.centre = centreSum / areaSum;
+		region.moveCost = costSum / areaSum;
+	}
+}
+
+void QTPFS::AbstractGraph::LinkCluster(NodeLayer& nodeLayer, int clusterIdx) {
+	Cluster& cluster = clusters[clusterIdx];
+
+	for (Region& region: cluster.regions) {
+		region.edges.clear();
+	}
+
+	for (const auto& [nodeIndex, regionIdx]: cluster.nodeRegions) {
+		const INode* node = nodeLayer.GetPoolNode(nodeIndex);
+		Region& region = cluster.regions[regionIdx];
+
+		for (const auto& neighbour: node->GetNeighbours()) {
+			const INode* ngbNode = nodeLayer.GetPoolNode(neighbour.nodeId);
+			const int ngbClusterIdx = GetClusterIndex(ngbNode->xmin(), ngbNode->zmin());
+
+			if (ngbClusterIdx == clusterIdx)
+				continue;
+
+			const int ngbRegionIdx = GetLocalRegion(ngbClusterIdx, neighbour.nodeId);
+
+			if (ngbRegionIdx < 0)
+				continue;
+
+			const auto sameEdge = [&](const Edge& e) { return (e.cluster == ngbClusterIdx && e.region == ngbRegionIdx); };
+
+			if (std::find_if(region.edges.begin(), region.edges.end(), sameEdge) != region.edges.end())
+				continue;
+
+			const Region& ngbRegion = clusters[ngbClusterIdx].regions[ngbRegionIdx];
+			const float dist = region.centre.distance(ngbRegion.centre);
+
+			region.edges.push_back({ngbClusterIdx, ngbRegionIdx, dist * (region.moveCost + ngbRegion.moveCost) * 0.5f});
+		}
+	}
+}
+
+void QTPFS::AbstractGraph::UpdateRegionOffsets() {
+	numRegions = 0;
+	regionClusters.clear();
+
+	for (int i = 0, n = clusters.size(); i < n; ++i) {
+		regionOffsets[i] = numRegions;
+		numRegions += clusters[i].regions.size();
+
+		regionClusters.resize(numRegions, i);
+	}
+}
+
+
+int QTPFS::AbstractGraph::GetLocalRegion(int clusterIdx, unsigned int nodeIndex) const {
+	const auto& nodeRegions = clusters[clusterIdx].nodeRegions;
+
+	const auto pred = [](const std::pair<unsigned int, int>& a, unsigned int b) { return (a.first < b); };
+	const auto iter = std::lower_bound(nodeRegions.begin(), nodeRegions.end(), nodeIndex, pred);
+
+	if (iter == nodeRegions.end() || iter->first != nodeIndex)
+		return -1;
+
+	return iter->second;
+}
+
+int QTPFS::AbstractGraph::GetNodeRegion(const INode* node) const {
+	if (!IsInitialized() || anyDirty)
+		return -1;
+
+	const int clusterIdx = GetClusterIndex(node->xmin(), node->zmin());
+	const int regionIdx = GetLocalRegion(clusterIdx, node->GetIndex());
+
+	if (regionIdx < 0)
+		return -1;
+
+	return (regionOffsets[clusterIdx] + regionIdx);
+}
+
+int QTPFS::AbstractGraph::GetClusterDistance(const INode* a, const INode* b) const {
+	const int dx = (a->xmin() / QTPFS_ABSTRACT_CLUSTER_SIZE) - (b->xmin() / QTPFS_ABSTRACT_CLUSTER_SIZE);
+	const int dz = (a->zmin() / QTPFS_ABSTRACT_CLUSTER_SIZE) - (b->zmin() / QTPFS_ABSTRACT_CLUSTER_SIZE);
+
+	return std::max(std::abs(dx), std::abs(dz));
+}
+
+SRectangle QTPFS::AbstractGraph::GetClusterRect(int clusterIdx) const {
+	const int x1 = (clusterIdx % xclusters) * QTPFS_ABSTRACT_CLUSTER_SIZE;
+	const int z1 = (clusterIdx / xclusters) * QTPFS_ABSTRACT_CLUSTER_SIZE;
+
+	return {x1, z1, std::min(x1 + QTPFS_ABSTRACT_CLUSTER_SIZE, mapxsize), std::min(z1 + QTPFS_ABSTRACT_CLUSTER_SIZE, mapzsize)};
+}
+
+
+bool QTPFS::AbstractGraph::FindCorridor(int srcRegion, int tgtRegion, float hCostMult, SearchThreadData& threadData) const {
+	RECOIL_DETAILED_TRACY_ZONE;
+	assert(srcRegion >= 0 && srcRegion < numRegions);
+	assert(tgtRegion >= 0 && tgtRegion < numRegions);
+
+	auto& costs = threadData.abstractCosts;
+	auto& prevs = threadData.abstractPrevRegions;
+	auto& openRegions = threadData.abstractOpenRegions;
+
+	costs.assign(numRegions, std::numeric_limits<float>::infinity());
+	prevs.assign(numRegions, -1);
+
+	while (!openRegions.empty())
+		openRegions.pop();
+
+	const auto GetRegion = [this](int globalIdx) -> const Region& {
+		const int clusterIdx = regionClusters[globalIdx];
+		return clusters[clusterIdx].regions[globalIdx - regionOffsets[clusterIdx]];
+	};
+
+	const float3& tgtCentre = GetRegion(tgtRegion).centre;
+
+	costs[srcRegion] = 0.0f;
+	openRegions.emplace(srcRegion, GetRegion(srcRegion).centre.distance(tgtCentre) * hCostMult);
+
+	while (!openRegions.empty()) {
+		const SearchQueueNode curOpenRegion = openRegions.top();
+		const int curRegionIdx = curOpenRegion.nodeIndex;
+
+		openRegions.pop();
+
+		if (curRegionIdx == tgtRegion)
+			break;
+
+		const Region& curRegion = GetRegion(curRegionIdx);
+
+		// stale entry, the region was reached more cheaply after it was queued
+		if (curOpenRegion.heapPriority > costs[curRegionIdx] + curRegion.centre.distance(tgtCentre) * hCostMult)
+			continue;
+
+		for (const Edge& edge: curRegion.edges) {
+			const int nxtRegionIdx = regionOffsets[edge.cluster] + edge.region;
+			const float gCost = costs[curRegionIdx] + edge.cost;
+
+			if (gCost >= costs[nxtRegionIdx])
+				continue;
+
+			costs[nxtRegionIdx] = gCost;
+			prevs[nxtRegionIdx] = curRegionIdx;
+
+			openRegions.emplace(nxtRegionIdx, gCost + GetRegion(nxtRegionIdx).centre.distance(tgtCentre) * hCostMult);
+		}
+	}
+
+	if (prevs[tgtRegion] < 0 && tgtRegion != srcRegion)
+		return false;
+
+	auto& corridor = threadData.corridorClusters;
+	corridor.clear();
+	corridor.resize(clusters.size(), 0);
+
+	for (int regionIdx = tgtRegion; regionIdx >= 0; regionIdx = prevs[regionIdx]) {
+		const int cx = regionClusters[regionIdx] % xclusters;
+		const int cz = regionClusters[regionIdx] / xclusters;
+
+		const int x1 = std::max(cx - QTPFS_ABSTRACT_CORRIDOR_MARGIN, 0);
+		const int z1 = std::max(cz - QTPFS_ABSTRACT_CORRIDOR_MARGIN, 0);
+		const int x2 = std::min(cx + QTPFS_ABSTRACT_CORRIDOR_MARGIN, xclusters - 1);
+		const int z2 = std::min(cz + QTPFS_ABSTRACT_CORRIDOR_MARGIN, zclusters - 1);
+
+		for (int z = z1; z <= z2; ++z) {
+			for (int x = x1; x <= x2; ++x) {
+				corridor[z * xclusters + x] = 1;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+std::uint64_t QTPFS::AbstractGraph::GetMemFootPrint() const {
+	std::uint64_t memFootPrint = sizeof(AbstractGraph);
+
+	for (const Cluster& cluster: clusters) {
+		memFootPrint += sizeof(Cluster);
+		memFootPrint += cluster.nodeRegions.size() * sizeof(decltype(cluster.nodeRegions)::value_type);
+
+		for (const Region& region: cluster.regions) {
+			memFootPrint += sizeof(Region);
+			memFootPrint += region.edges.size() * sizeof(Edge);
+		}
+	}
+
+	memFootPrint += regionOffsets.size() * sizeof(decltype(regionOffsets)::value_type);
+	memFootPrint += regionClusters.size() * sizeof(decltype(regionClusters)::value_type);
+	return memFootPrint;
+}
@@ -0,0 +1,99 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef QTPFS_ABSTRACT_GRAPH_H_
+#define QTPFS_ABSTRACT_GRAPH_H_
+
+#include <cinttypes>
+#include <utility>
+#include <vector>
+
+#include "PathDefines.h"
+#include "PathThreads.h"
+
+#include "System/float3.h"
+#include "System/Rectangle.h"
+
+namespace QTPFS {
+	struct INode;
+	struct NodeLayer;
+
+	// Coarse graph over a node-layer for long distance searches (HPA*-style).
+	//
+	// The map is cut into square clusters of QTPFS_ABSTRACT_CLUSTER_SIZE squares; each
+	// cluster holds one region per connected group of open (not closed, not exit-only)
+	// leaf nodes inside it. Regions of neighbouring clusters are linked when any of their
+	// nodes are. Searching this graph yields the corridor of clusters a detailed search
+	// can be restricted to. Clusters are rebuilt lazily after the layer is re-tesselated.
+	struct AbstractGraph {
+	public:
+		struct Edge {
+			int cluster;
+			int region;
+			float cost;
+		};
+
+		struct Region {
+			float3 centre;
+			float moveCost = 0.0f;
+			std::vector<Edge> edges;
+		};
+
+		struct Cluster {
+			// (node index, local region index), sorted by node index
+			std::vector< std::pair<unsigned int, int> > nodeRegions;
+			std::vector<Region> regions;
+			bool dirty = true;
+			bool relink = true;
+		};
+
+		void Init(int mapx, int mapz);
+		void Clear();
+
+		bool IsInitialized() const { return (!clusters.empty()); }
+
+		// <r> is in squares; clusters touching it are rebuilt with their neighbours' links
+		void MarkDirty(const SRectangle& r);
+		void Update(NodeLayer& nodeLayer);
+
+		int GetClusterIndex(int x, int z) const { return ((z / QTPFS_ABSTRACT_CLUSTER_SIZE) * xclusters + (x / QTPFS_ABSTRACT_CLUSTER_SIZE)); }
+		int GetClusterDistance(const INode* a, const INode* b) const;
+
+		// returns -1 if the node is not part of any region
+		int GetNodeRegion(const INode* node) const;
+
+		// plans a route from srcRegion to tgtRegion and marks the clusters it passes
+		// (grown by QTPFS_ABSTRACT_CORRIDOR_MARGIN) in threadData.corridorClusters
+		bool FindCorridor(int srcRegion, int tgtRegion, float hCostMult, SearchThreadData& threadData) const;
+
+		std::uint64_t GetMemFootPrint() const;
+
+	private:
+		void BuildCluster(NodeLayer& nodeLayer, int clusterIdx);
+		void LinkCluster(NodeLayer& nodeLayer, int clusterIdx);
+		void UpdateRegionOffsets();
+
+		int GetLocalRegion(int clusterIdx, unsigned int nodeIndex) const;
+
+		SRectangle GetClusterRect(int clusterIdx) const;
+
+	private:
+		std::vector<Cluster> clusters;
+
+		// global region index of each cluster's first region, and the reverse mapping
+		std::vector<int> regionOffsets;
+		std::vector<int> regionClusters;
+
+		std::vector<INode*> tmpNodes;
+		std::vector<int> fillStack;
+
+		int xclusters = 0;
+		int zclusters = 0;
+		int mapxsize = 0;
+		int mapzsize = 0;
+		int numRegions = 0;
+
+		bool anyDirty = false;
+	};
+}
+
+#endif
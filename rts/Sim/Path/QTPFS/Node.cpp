@@ -12,6 +12,7 @@
 #include "PathDefines.h"
 #include "PathManager.h"
 #include "PathThreads.h"
+#include "Utils/NodeLayerCacheUtils.h"
 
 #include "Map/MapInfo.h"
 #include "Map/ReadMap.h"
@@ -713,6 +714,43 @@ void QTPFS::QTNode::Serialize(std::fstream& fStream, NodeLayer& nodeLayer, unsig
 }
 
 
+void QTPFS::QTNode::WriteCache(std::vector<std::uint8_t>& buffer) const {
+	const std::uint32_t numNeighbours = neighbours.size();
+
+	WriteCacheValue(buffer, nodeNumber);
+	WriteCacheValue(buffer, index);
+	WriteCacheValue(buffer, points);
+	WriteCacheValue(buffer, moveCostAvg);
+	WriteCacheValue(buffer, childBaseIndex);
+	WriteCacheValue(buffer, numNeighbours);
+	WriteCacheValues(buffer, neighbours.data(), neighbours.size());
+}
+
+bool QTPFS::QTNode::ReadCache(const std::uint8_t*& data, const std::uint8_t* dataEnd) {
+	std::uint32_t numNeighbours = 0;
+
+	if (!ReadCacheValue(data, dataEnd, nodeNumber))
+		return false;
+	if (!ReadCacheValue(data, dataEnd, index))
+		return false;
+	if (!ReadCacheValue(data, dataEnd, points))
+		return false;
+	if (!ReadCacheValue(data, dataEnd, moveCostAvg))
+		return false;
+	if (!ReadCacheValue(data, dataEnd, childBaseIndex))
+		return false;
+	if (!ReadCacheValue(data, dataEnd, numNeighbours))
+		return false;
+
+	// reject garbage counts before allocating
+	if (size_t(dataEnd - data) / sizeof(NeighbourPoints) < numNeighbours)
+		return false;
+
+	neighbours.resize(numNeighbours);
+	return (ReadCacheValues(data, dataEnd, neighbours.data(), neighbours.size()));
+}
+
+
 // this is *either* called from ::GetNeighbors when the conservative
 // update-scheme is enabled, *or* from PM::ExecQueuedNodeLayerUpdates
 // (never both)
@@ -22,6 +22,7 @@ inline int __bsfd (int mask)
 #include "NodeLayer.h"
 #include "PathManager.h"
 #include "Node.h"
+#include "Utils/NodeLayerCacheUtils.h"
 
 #include "Map/MapInfo.h"
 #include "Sim/Misc/ModInfo.h"
@@ -86,6 +87,105 @@ void QTPFS::NodeLayer::Clear() {
 }
 
 
+void QTPFS::NodeLayer::WriteCache(std::vector<std::uint8_t>& buffer) const {
+	RECOIL_DETAILED_TRACY_ZONE;
+	// the free-list starts out as [N-1, ..., 1, 0] and is only popped from
+	// and pushed onto at the back, so most of it can be stored as a length
+	std::uint32_t numInitialIndcs = 0;
+
+	while (numInitialIndcs < nodeIndcs.size() && nodeIndcs[numInitialIndcs] == (POOL_TOTAL_SIZE - 1 - numInitialIndcs))
+		numInitialIndcs++;
+
+	const std::uint32_t numIndcs = nodeIndcs.size();
+
+	WriteCacheValue(buffer, numLeafNodes);
+	WriteCacheValue(buffer, updateCounter);
+	WriteCacheValue(buffer, numOpenNodes);
+	WriteCacheValue(buffer, numClosedNodes);
+	WriteCacheValue(buffer, maxNodesAlloced);
+	WriteCacheValue(buffer, numRootNodes);
+	WriteCacheValue(buffer, rootNodeSize);
+	WriteCacheValue(buffer, rootMask);
+
+	WriteCacheValue(buffer, numIndcs);
+	WriteCacheValue(buffer, numInitialIndcs);
+	WriteCacheValues(buffer, nodeIndcs.data() + numInitialIndcs, numIndcs - numInitialIndcs);
+
+	for (int32_t nodeIndex = 0; nodeIndex < maxNodesAlloced; nodeIndex++) {
+		GetPoolNode(nodeIndex)->WriteCache(buffer);
+	}
+}
+
+bool QTPFS::NodeLayer::ReadCache(const std::uint8_t* data, const std::uint8_t* dataEnd) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	int32_t cachedNumRootNodes = 0;
+	int32_t cachedRootNodeSize = 0;
+	uint32_t cachedRootMask = 0;
+
+	std::uint32_t numIndcs = 0;
+	std::uint32_t numInitialIndcs = 0;
+
+	bool ok = true;
+
+	ok = ok && ReadCacheValue(data, dataEnd, numLeafNodes);
+	ok = ok && ReadCacheValue(data, dataEnd, updateCounter);
+	ok = ok && ReadCacheValue(data, dataEnd, numOpenNodes);
+	ok = ok && ReadCacheValue(data, dataEnd, numClosedNodes);
+	ok = ok && ReadCacheValue(data, dataEnd, maxNodesAlloced);
+	ok = ok && ReadCacheValue(data, dataEnd, cachedNumRootNodes);
+	ok = ok && ReadCacheValue(data, dataEnd, cachedRootNodeSize);
+	ok = ok && ReadCacheValue(data, dataEnd, cachedRootMask);
+	ok = ok && ReadCacheValue(data, dataEnd, numIndcs);
+	ok = ok && ReadCacheValue(data, dataEnd, numInitialIndcs);
+
+	// the root layout is not stored, it must match what InitNodeLayer produced
+	ok = ok && (cachedNumRootNodes == numRootNodes);
+	ok = ok && (cachedRootNodeSize == rootNodeSize);
+	ok = ok && (cachedRootMask == rootMask);
+	ok = ok && (maxNodesAlloced >= numRootNodes && maxNodesAlloced <= int32_t(POOL_TOTAL_SIZE));
+	ok = ok && (numIndcs <= POOL_TOTAL_SIZE && numInitialIndcs <= numIndcs);
+
+	if (!ok)
+		return false;
+
+	nodeIndcs.resize(numIndcs);
+
+	for (std::uint32_t i = 0; i < numInitialIndcs; i++) {
+		nodeIndcs[i] = POOL_TOTAL_SIZE - 1 - i;
+	}
+
+	if (!ReadCacheValues(data, dataEnd, nodeIndcs.data() + numInitialIndcs, numIndcs - numInitialIndcs))
+		return false;
+
+	for (int32_t nodeIndex = 0; nodeIndex < maxNodesAlloced; nodeIndex += POOL_CHUNK_SIZE) {
+		if (poolNodes[nodeIndex / POOL_CHUNK_SIZE].empty())
+			poolNodes[nodeIndex / POOL_CHUNK_SIZE].resize(POOL_CHUNK_SIZE);
+	}
+
+	for (int32_t nodeIndex = 0; nodeIndex < maxNodesAlloced; nodeIndex++) {
+		if (!GetPoolNode(nodeIndex)->ReadCache(data, dataEnd))
+			return false;
+	}
+
+	// trailing bytes mean the layout did not match
+	return (data == dataEnd);
+}
+
+void QTPFS::NodeLayer::ClearPoolNodes() {
+	RECOIL_DETAILED_TRACY_ZONE;
+	for (auto& poolChunk: poolNodes) {
+		poolChunk.clear();
+	}
+
+	// back to the state of a never-initialized layer
+	numLeafNodes = 0;
+	updateCounter = 0;
+	numOpenNodes = 0;
+	numClosedNodes = 0;
+	maxNodesAlloced = 0;
+}
+
+
 bool QTPFS::NodeLayer::Update(UpdateThreadData& threadData) {
 	RECOIL_DETAILED_TRACY_ZONE;
 	// assert((luSpeedMods == nullptr && luBlockBits == nullptr) || (luSpeedMods != nullptr && luBlockBits != nullptr));
@@ -11,6 +11,7 @@
 #include <cinttypes>
 
 #include "System/Rectangle.h"
+#include "AbstractGraph.h"
 #include "Node.h"
 #include "PathDefines.h"
 #include "PathThreads.h"
@@ -141,6 +142,7 @@ namespace QTPFS {
 			}
 
 			memFootPrint += (nodeIndcs.size() * sizeof(decltype(nodeIndcs)::value_type));
+			memFootPrint += abstractGraph.GetMemFootPrint();
 			return memFootPrint;
 		}
 
@@ -159,12 +161,22 @@ namespace QTPFS {
 			return layerNumber;
 		}
 
+		// serializes the tesselated tree (all pool nodes, the free-list and the
+		// node counters) so that a later ReadCache restores an identical layer;
+		// ReadCache expects Init and root-node allocation to have run already
+		void WriteCache(std::vector<std::uint8_t>& buffer) const;
+		bool ReadCache(const std::uint8_t* data, const std::uint8_t* dataEnd);
+		void ClearPoolNodes();
+
 		void GetNodesInArea(const SRectangle& areaToSearch, std::vector<INode*>& nodesFound);
 		INode* GetNearestNodeInArea(const SRectangle& areaToSearch, int2 referencePoint, std::vector<INode*>& openNodes);
 		INode* GetNodeThatEncasesPowerOfTwoArea(const SRectangle& areaToEncase);
 
 		bool UseShortestPath() { return useShortestPath; }
 
+		      AbstractGraph& GetAbstractGraph()       { return abstractGraph; }
+		const AbstractGraph& GetAbstractGraph() const { return abstractGraph; }
+
 	private:
 		std::vector<QTNode> poolNodes[16];
 		std::vector<unsigned int> nodeIndcs;
@@ -175,6 +187,8 @@ namespace QTPFS {
 		std::vector<SpeedModType> curSpeedMods;
 		std::vector<SpeedBinType> curSpeedBins;
 
+		AbstractGraph abstractGraph;
+
 public:
 		static constexpr unsigned int NUM_POOL_CHUNKS = sizeof(poolNodes) / sizeof(poolNodes[0]);
 		static constexpr unsigned int POOL_TOTAL_SIZE = (1024 * 1024) / 2;
@@ -37,6 +37,13 @@ static constexpr uint32_t QTPFS_PARTIAL_SHARE_PATH_MAX_SIZE = 32;
 
 static constexpr uint32_t QTPFS_MAP_DAMAGE_SIZE = 16;
 
+// must be a multiple of QTPFS_MAX_NODE_SIZE so that no node straddles two clusters
+static constexpr int QTPFS_ABSTRACT_CLUSTER_SIZE = 128;
+// searches between clusters at least this far apart are planned on the abstract graph
+static constexpr int QTPFS_ABSTRACT_MIN_CLUSTER_DISTANCE = 2;
+// number of clusters the abstract corridor is grown by on each side
+static constexpr int QTPFS_ABSTRACT_CORRIDOR_MARGIN = 1;
+
 // Though there are four quads per level, having nothing is like a 5th state. So 3 bits, not 2, is needed per level.
 static constexpr uint32_t QTPFS_NODE_NUMBER_SHIFT_STEP = 3;
 
@@ -7,7 +7,10 @@
 #include <algorithm>
 #include <chrono>
 #include <cinttypes>
+#include <cstdio>
+#include <cstring>
 #include <deque>
+#include <fstream>
 #include <functional>
 
 #include "System/Threading/ThreadPool.h"
@@ -21,16 +24,25 @@
 #include "Game/GameSetup.h"
 #include "Game/LoadScreen.h"
 #include "Map/MapInfo.h"
+#include "Map/ReadMap.h"
 
+#include "Sim/Features/Feature.h"
+#include "Sim/Features/FeatureHandler.h"
 #include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/GroundBlockingObjectMap.h"
 #include "Sim/Misc/ModInfo.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
 #include "Sim/MoveTypes/MoveMath/MoveMath.h"
 #include "Sim/Objects/SolidObject.h"
+#include "Sim/Units/UnitHandler.h"
 #include "System/Config/ConfigHandler.h"
+#include "System/CRC.h"
 #include "System/FileSystem/ArchiveScanner.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileSystem.h"
+#include "System/FileSystem/MappedFile.h"
 #include "System/Log/ILog.h"
 #include "System/Platform/Threading.h"
 #include "System/Rectangle.h"
@@ -57,6 +69,7 @@
 #define MAP_RECTANGLE SRectangle(0, 0,  mapDims.mapx, mapDims.mapy)
 
 CONFIG(int, PathingThreadCount).defaultValue(0).safemodeValue(1).minimumValue(0);
+CONFIG(bool, QTPFSNodeLayerCache).defaultValue(false).safemodeValue(false).description("Cache the initial QTPFS node-layer tesselation on disk and reuse it on later loads of the same map and game.");
 
 namespace QTPFS {
 	struct PMLoadScreen {
@@ -127,6 +140,72 @@ namespace QTPFS {
 		return ((numThreads == 0)? numCores: numThreads);
 	}
 
+	// bump whenever the tesselation code or the cache layout changes
+	static constexpr std::uint32_t NODE_LAYER_CACHE_VERSION = 1;
+	static constexpr char NODE_LAYER_CACHE_MAGIC[8] = "QTPFSNL";
+
+	struct NodeLayerCacheHeader {
+		char magic[sizeof(NODE_LAYER_CACHE_MAGIC)];
+		std::uint32_t version;
+		std::uint32_t cacheHash;
+		std::uint32_t pfsCheckSum;
+		std::uint32_t numLayers;
+
+		sha512::raw_digest mapCheckSum;
+		sha512::raw_digest modCheckSum;
+	};
+
+	struct NodeLayerCacheEntry {
+		std::uint64_t offset;
+		std::uint64_t size;
+	};
+
+	static std::string GetNodeLayerCacheDir() {
+		return (FileSystem::GetCacheDir() + FileSystemAbstraction::GetNativePathSeparator() + "paths" + FileSystemAbstraction::GetNativePathSeparator());
+	}
+
+	static std::string GetNodeLayerCacheFileName(const std::string& mapName, std::uint32_t cacheHash) {
+		return (GetNodeLayerCacheDir() + mapName + ".qtpfs-" + IntToString(cacheHash, "%08x") + ".dat");
+	}
+
+	// everything the initial tesselation depends on besides the map and game
+	// archives; objects placed by Lua before we load are covered through the
+	// blocking-map and per-feature state
+	static std::uint32_t CalcNodeLayerCacheHash(int rootSize) {
+		RECOIL_DETAILED_TRACY_ZONE;
+		const auto& qtpfsConsts = mapInfo->pfs.qtpfs_constants;
+
+		CRC crc;
+		crc << NODE_LAYER_CACHE_VERSION;
+		crc << mapDims.mapx << mapDims.mapy << rootSize;
+		crc << readMap->CalcHeightmapChecksum();
+		crc << readMap->CalcTypemapChecksum();
+		crc << moveDefHandler.GetCheckSum();
+		crc << groundBlockingObjectMap.CalcChecksum();
+
+		crc << qtpfsConsts.minNodeSizeX << qtpfsConsts.minNodeSizeZ << qtpfsConsts.maxNodeDepth;
+		crc << qtpfsConsts.numSpeedModBins << qtpfsConsts.minSpeedModVal << qtpfsConsts.maxSpeedModVal;
+
+		// feature iteration order is not stable, combine per-feature sums
+		std::uint32_t featureSum = 0;
+
+		for (const int featureID: featureHandler.GetActiveFeatureIDs()) {
+			const CFeature* f = featureHandler.GetFeature(featureID);
+
+			CRC fcrc;
+			fcrc << featureID;
+			fcrc << f->pos.x << f->pos.y << f->pos.z << f->height;
+			fcrc << f->mapPos.x << f->mapPos.y << f->xsize << f->zsize;
+			fcrc << uint32_t(f->physicalState) << uint32_t(f->collidableState);
+			fcrc << uint32_t(f->crushable) << f->crushResistance;
+
+			featureSum ^= fcrc.GetDigest();
+		}
+
+		crc << featureSum;
+		return crc.GetDigest();
+	}
+
 	unsigned int PathManager::LAYERS_PER_UPDATE;
 	unsigned int PathManager::MAX_TEAM_SEARCHES;
 }
@@ -322,30 +401,45 @@ void QTPFS::PathManager::Load() {
 		sha512::dump_digest(mapCheckSum, mapCheckSumHex);
 		sha512::dump_digest(modCheckSum, modCheckSumHex);
 
-		InitNodeLayersThreaded(MAP_RECTANGLE);
+		// units (mobile or not) carry too much state to key the cache on
+		const bool useNodeLayerCache = configHandler->GetBool("QTPFSNodeLayerCache") && unitHandler.GetActiveUnits().empty();
+		const std::uint32_t cacheHash = useNodeLayerCache? CalcNodeLayerCacheHash(rootSize): 0;
+		const std::string cacheFileName = GetNodeLayerCacheFileName(gameSetup->mapName, cacheHash);
+
+		if (!useNodeLayerCache || !ReadNodeLayerCache(cacheFileName, cacheHash, mapCheckSum, modCheckSum)) {
+			InitNodeLayersThreaded(MAP_RECTANGLE);
+
+			// NOTE:
+			//   should be sufficient in theory, because if either
+			//   the map or the mod changes then the checksum does
+			//   (should!) as well and we get a cache-miss
+			//   this value is also combined with the tree-sums to
+			//   make it depend on the tesselation code specifics
+			// FIXME:
+			//   assumption is invalid now (Lua inits before we do)
+			// temporary measure until the false-positives around map files is solved.
+				// ((mapCheckSum[0] << 24) | (mapCheckSum[1] << 16) | (mapCheckSum[2] << 8) | (mapCheckSum[3] << 0)) ^
+				// ((modCheckSum[0] << 24) | (modCheckSum[1] << 16) | (modCheckSum[2] << 8) | (modCheckSum[3] << 0));
+			pfsCheckSum = CalcNodeLayersCheckSum();
+
+			if (useNodeLayerCache)
+				WriteNodeLayerCache(cacheFileName, cacheHash, mapCheckSum, modCheckSum);
+		}
+
+		if (modInfo.qtAbstractGraph) {
+			for_mt(0, nodeLayers.size(), [this](const int layerNum) {
+				auto& nodeLayer = nodeLayers[layerNum];
+
+				nodeLayer.GetAbstractGraph().Init(mapDims.mapx, mapDims.mapy);
+				nodeLayer.GetAbstractGraph().Update(nodeLayer);
+			});
+		}
+
 		PathSpeedModInfoSystem::Init();
 		RemoveDeadPathsSystem::Init();
 		RequeuePathsSystem::Init();
 
-		// NOTE:
-		//   should be sufficient in theory, because if either
-		//   the map or the mod changes then the checksum does
-		//   (should!) as well and we get a cache-miss
-		//   this value is also combined with the tree-sums to
-		//   make it depend on the tesselation code specifics
-		// FIXME:
-		//   assumption is invalid now (Lua inits before we do)
-		pfsCheckSum = 0;
-		// temporary measure until the false-positives around map files is solved.
-			// ((mapCheckSum[0] << 24) | (mapCheckSum[1] << 16) | (mapCheckSum[2] << 8) | (mapCheckSum[3] << 0)) ^
-			// ((modCheckSum[0] << 24) | (modCheckSum[1] << 16) | (modCheckSum[2] << 8) | (modCheckSum[3] << 0));
-
 		for (unsigned int layerNum = 0; layerNum < nodeLayers.size(); layerNum++) {
-			auto& nodeLayer = nodeLayers[layerNum];
-			for (int i = 0; i < nodeLayer.GetRootNodeCount(); ++i){
-				auto curRootNode = nodeLayer.GetPoolNode(i);
-				pfsCheckSum ^= curRootNode->GetCheckSum(nodeLayers[layerNum]);
-			}
 			maxAllocedNodes = std::max(nodeLayers[layerNum].GetMaxNodesAlloced(), maxAllocedNodes);
 		}
 
@@ -467,6 +561,177 @@ void QTPFS::PathManager::InitNodeLayersThreaded(const SRectangle& rect) {
 	streflop::streflop_init<streflop::Simple>();
 }
 
+std::uint32_t QTPFS::PathManager::CalcNodeLayersCheckSum() const {
+	RECOIL_DETAILED_TRACY_ZONE;
+	std::uint32_t checkSum = 0;
+
+	for (unsigned int layerNum = 0; layerNum < nodeLayers.size(); layerNum++) {
+		const auto& nodeLayer = nodeLayers[layerNum];
+		for (int i = 0; i < nodeLayer.GetRootNodeCount(); ++i){
+			auto curRootNode = nodeLayer.GetPoolNode(i);
+			checkSum ^= curRootNode->GetCheckSum(nodeLayers[layerNum]);
+		}
+	}
+
+	return checkSum;
+}
+
+bool QTPFS::PathManager::ReadNodeLayerCache(
+	const std::string& cacheFileName,
+	std::uint32_t cacheHash,
+	const sha512::raw_digest& mapCheckSum,
+	const sha512::raw_digest& modCheckSum
+) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	const std::string cacheFilePath = dataDirsAccess.LocateFile(cacheFileName);
+
+	LOG("[QTPFS::%s] hash=%08x file=\"%s\" (exists=%d)", __func__, cacheHash, cacheFilePath.c_str(), FileSystem::FileExists(cacheFilePath));
+
+	if (!FileSystem::FileExists(cacheFilePath))
+		return false;
+
+	CMappedFile cacheFile(cacheFilePath);
+
+	auto rejectCacheFile = [&](const char* reason) {
+		LOG_L(L_WARNING, "[QTPFS::%s] discarding node-layer cache \"%s\" (%s)", __func__, cacheFilePath.c_str(), reason);
+
+		for (auto& nodeLayer: nodeLayers) {
+			nodeLayer.ClearPoolNodes();
+		}
+
+		cacheFile.Close();
+		FileSystem::Remove(cacheFilePath);
+		return false;
+	};
+
+	if (!cacheFile.IsOpen())
+		return false;
+
+	const std::uint8_t* fileData = cacheFile.GetData();
+	const size_t fileSize = cacheFile.GetSize();
+
+	NodeLayerCacheHeader header;
+	std::vector<NodeLayerCacheEntry> entries(nodeLayers.size());
+
+	const size_t headerSize = sizeof(header) + entries.size() * sizeof(NodeLayerCacheEntry);
+
+	if (fileSize < headerSize)
+		return (rejectCacheFile("truncated header"));
+
+	std::memcpy(&header, fileData, sizeof(header));
+	std::memcpy(entries.data(), fileData + sizeof(header), entries.size() * sizeof(NodeLayerCacheEntry));
+
+	if (std::memcmp(header.magic, NODE_LAYER_CACHE_MAGIC, sizeof(header.magic)) != 0 || header.version != NODE_LAYER_CACHE_VERSION)
+		return (rejectCacheFile("version mismatch"));
+	if (header.cacheHash != cacheHash || header.numLayers != nodeLayers.size())
+		return (rejectCacheFile("stale"));
+	if (header.mapCheckSum != mapCheckSum || header.modCheckSum != modCheckSum)
+		return (rejectCacheFile("archive checksum mismatch"));
+
+	for (const NodeLayerCacheEntry& entry: entries) {
+		if (entry.offset < headerSize || entry.offset > fileSize || entry.size > (fileSize - entry.offset))
+			return (rejectCacheFile("corrupt layer table"));
+	}
+
+	{
+		char loadMsg[512] = {'\0'};
+		const char* fmtString = "[PathManager::%s] reading %u cached node-layers";
+		snprintf(loadMsg, sizeof(loadMsg), fmtString, __func__, nodeLayers.size());
+		pmLoadScreen.AddMessage(loadMsg);
+	}
+
+	std::vector<std::uint8_t> layersRead(nodeLayers.size(), 0);
+
+	for_mt(0, nodeLayers.size(), [&](const int layerNum) {
+		const std::uint8_t* layerData = fileData + entries[layerNum].offset;
+
+		InitNodeLayer(layerNum, MAP_RECTANGLE);
+		layersRead[layerNum] = nodeLayers[layerNum].ReadCache(layerData, layerData + entries[layerNum].size);
+	});
+
+	if (std::find(layersRead.begin(), layersRead.end(), 0) != layersRead.end())
+		return (rejectCacheFile("corrupt node-layer data"));
+
+	// the tree-sums cover every node reachable from the roots
+	if ((pfsCheckSum = CalcNodeLayersCheckSum()) != header.pfsCheckSum)
+		return (rejectCacheFile("pfs-checksum mismatch"));
+
+	// same as the per-layer UpdateNodeLayer calls would have done
+	for (unsigned int layerNum = 0; layerNum < nodeLayers.size(); layerNum++) {
+		pathCache.SetLayerPathCount(layerNum, INITIAL_PATH_RESERVE);
+	}
+
+	return true;
+}
+
+bool QTPFS::PathManager::WriteNodeLayerCache(
+	const std::string& cacheFileName,
+	std::uint32_t cacheHash,
+	const sha512::raw_digest& mapCheckSum,
+	const sha512::raw_digest& modCheckSum
+) const {
+	RECOIL_DETAILED_TRACY_ZONE;
+	// we need this directory to exist
+	if (!FileSystem::CreateDirectory(GetNodeLayerCacheDir()))
+		return false;
+
+	const std::string cacheFilePath = dataDirsAccess.LocateFile(cacheFileName, FileQueryFlags::WRITE);
+	const std::string tempFilePath = cacheFilePath + ".tmp";
+
+	LOG("[QTPFS::%s] hash=%08x file=\"%s\"", __func__, cacheHash, cacheFilePath.c_str());
+
+	std::vector< std::vector<std::uint8_t> > layerBuffers(nodeLayers.size());
+
+	for_mt(0, nodeLayers.size(), [&](const int layerNum) {
+		nodeLayers[layerNum].WriteCache(layerBuffers[layerNum]);
+	});
+
+	NodeLayerCacheHeader header;
+	std::vector<NodeLayerCacheEntry> entries(nodeLayers.size());
+
+	std::memcpy(header.magic, NODE_LAYER_CACHE_MAGIC, sizeof(header.magic));
+	header.version = NODE_LAYER_CACHE_VERSION;
+	header.cacheHash = cacheHash;
+	header.pfsCheckSum = pfsCheckSum;
+	header.numLayers = nodeLayers.size();
+	header.mapCheckSum = mapCheckSum;
+	header.modCheckSum = modCheckSum;
+
+	std::uint64_t offset = sizeof(header) + entries.size() * sizeof(NodeLayerCacheEntry);
+
+	for (size_t layerNum = 0; layerNum < nodeLayers.size(); layerNum++) {
+		entries[layerNum] = {offset, layerBuffers[layerNum].size()};
+		offset += layerBuffers[layerNum].size();
+	}
+
+	{
+		// write to a temporary first so concurrent readers never see a partial file
+		std::ofstream cacheFile(tempFilePath, std::ios::binary | std::ios::trunc);
+
+		cacheFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		cacheFile.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(NodeLayerCacheEntry));
+
+		for (const auto& layerBuffer: layerBuffers) {
+			cacheFile.write(reinterpret_cast<const char*>(layerBuffer.data()), layerBuffer.size());
+		}
+
+		if (!cacheFile.good()) {
+			cacheFile.close();
+			FileSystem::Remove(tempFilePath);
+			return false;
+		}
+	}
+
+	FileSystem::Remove(cacheFilePath);
+
+	if (std::rename(tempFilePath.c_str(), cacheFilePath.c_str()) != 0) {
+		FileSystem::Remove(tempFilePath);
+		return false;
+	}
+
+	return true;
+}
+
 void QTPFS::PathManager::InitRootSize(const SRectangle& r) {
 	RECOIL_DETAILED_TRACY_ZONE;
 	// setup the root node system
@@ -638,6 +903,9 @@ void QTPFS::PathManager::UpdateNodeLayer(unsigned int layerNum, const SRectangle
 		#ifndef QTPFS_CONSERVATIVE_NEIGHBOR_CACHE_UPDATES
 		nodeLayers[layerNum].ExecNodeNeighborCacheUpdates(ur, updateThreadData[currentThread]);
 		#endif
+
+		// links of nodes just outside the re-tesselated area change as well
+		nodeLayer.GetAbstractGraph().MarkDirty(SRectangle(ur.x1 - 1, ur.z1 - 1, ur.x2 + 1, ur.z2 + 1));
 	}
 }
 
@@ -718,6 +986,8 @@ void QTPFS::PathManager::Update() {
 			int layerNum = nodeLayerUpdatePriorityOrder[index];
 			int blocksToUpdate = numBlocksToUpdate(layerNum);
 			for (int i = 0; i < blocksToUpdate; ++i) { UpdateNodeLayer(layerNum, rect, curThread); }
+
+			nodeLayers[layerNum].GetAbstractGraph().Update(nodeLayers[layerNum]);
 		});
 
 		// Mark all dirty paths so that they can be recalculated
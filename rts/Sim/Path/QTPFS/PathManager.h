@@ -11,6 +11,7 @@
 #include "PathCache.h"
 #include "PathSearch.h"
 #include "System/UnorderedMap.hpp"
+#include "System/Sync/SHA512.hpp"
 
 struct MoveDef;
 struct SRectangle;
@@ -117,6 +118,21 @@ namespace QTPFS {
 		typedef std::vector<PathSearch*>::iterator PathSearchVectIt;
 
 		void InitNodeLayersThreaded(const SRectangle& rect);
+		std::uint32_t CalcNodeLayersCheckSum() const;
+
+		// on-disk cache of the initial tesselation, see NodeLayer::WriteCache
+		bool ReadNodeLayerCache(
+			const std::string& cacheFileName,
+			std::uint32_t cacheHash,
+			const sha512::raw_digest& mapCheckSum,
+			const sha512::raw_digest& modCheckSum
+		);
+		bool WriteNodeLayerCache(
+			const std::string& cacheFileName,
+			std::uint32_t cacheHash,
+			const sha512::raw_digest& mapCheckSum,
+			const sha512::raw_digest& modCheckSum
+		) const;
 		void InitNodeLayer(unsigned int layerNum, const SRectangle& r);
 		void InitRootSize(const SRectangle& r);
 		void UpdateNodeLayer(unsigned int layerNum, const SRectangle& r, int currentThread);
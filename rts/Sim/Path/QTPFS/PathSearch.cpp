@@ -590,6 +590,34 @@ void QTPFS::PathSearch::InitStartingSearchNodes() {
 	}
 }
 
+bool QTPFS::PathSearch::PlanAbstractCorridor() {
+	RECOIL_DETAILED_TRACY_ZONE;
+	const AbstractGraph& abstractGraph = nodeLayer->GetAbstractGraph();
+
+	if (!modInfo.qtAbstractGraph || !abstractGraph.IsInitialized())
+		return false;
+
+	// these either do not span the whole route or do not end in a known node
+	if (doPathRepair || doPartialSearch || badGoal || rawPathCheck)
+		return false;
+
+	const INode* srcNode = nodeLayer->GetPoolNode(directionalSearchData[SearchThreadData::SEARCH_FORWARD ].srcSearchNode->GetIndex());
+	const INode* tgtNode = nodeLayer->GetPoolNode(directionalSearchData[SearchThreadData::SEARCH_BACKWARD].srcSearchNode->GetIndex());
+
+	if (abstractGraph.GetClusterDistance(srcNode, tgtNode) < QTPFS_ABSTRACT_MIN_CLUSTER_DISTANCE)
+		return false;
+
+	const int srcRegion = abstractGraph.GetNodeRegion(srcNode);
+	const int tgtRegion = abstractGraph.GetNodeRegion(tgtNode);
+
+	if (srcRegion < 0 || tgtRegion < 0)
+		return false;
+
+	// disconnected regions fall back to a regular search, which
+	// produces the usual incomplete path towards the goal
+	return (abstractGraph.FindCorridor(srcRegion, tgtRegion, hCostMult, *searchThreadData));
+}
+
 void QTPFS::PathSearch::UpdateHcostMult() {
 	RECOIL_DETAILED_TRACY_ZONE;
 	auto& comp = systemGlobals.GetSystemComponent<PathSpeedModInfoSystemComponent>();
@@ -708,6 +736,7 @@ bool QTPFS::PathSearch::ExecutePathSearch() {
 	int dirThatFinishedTheSearch = 0;
 
 	disallowNodeRevisit = modInfo.qtLowerQualityPaths;
+	useAbstractCorridor = PlanAbstractCorridor();
 
 	auto nodeIsTemp = [](const SearchNode& curSearchNode) {
 		return (curSearchNode.GetPathCost(NODE_PATH_COST_H) == std::numeric_limits<float>::infinity());
@@ -1403,6 +1432,14 @@ void QTPFS::PathSearch::IterateNodeNeighbors(const INode* curNode, unsigned int
 		//   nightmare), while in the second we would get low-quality paths (player
 		//   nightmare)
 		int nxtNodesId = nxtNodes[i].nodeId;
+
+		if (useAbstractCorridor) {
+			const INode* nxtNode = nodeLayer->GetPoolNode(nxtNodesId);
+			const int clusterIdx = nodeLayer->GetAbstractGraph().GetClusterIndex(nxtNode->xmin(), nxtNode->zmin());
+
+			if (searchThreadData->corridorClusters[clusterIdx] == 0)
+				continue;
+		}
 		
 		// LOG("%s: target node search from %d to %d", __func__
 		// 		, curNode->GetIndex()
@@ -175,6 +175,7 @@ namespace QTPFS {
 		int SmoothPathPoints(const INode* nn0, const INode* nn1, const float3& p0, const float3& p1, const float3& p2, float3& result) const;
 
 		void InitStartingSearchNodes();
+		bool PlanAbstractCorridor();
 		void UpdateHcostMult();
 		void RemoveOutdatedOpenNodesFromQueue(int searchDir);
 		bool IsNodeActive(const SearchNode& curSearchNode) const;
@@ -246,6 +247,7 @@ namespace QTPFS {
 		bool havePartPath;
 		bool badGoal;
 		bool disallowNodeRevisit = false;
+		bool useAbstractCorridor = false;
 
 public:
 		bool rawPathCheck = false;
@@ -2,6 +2,7 @@
 #define PATH_THREADS_H__
 
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <queue>
 #include <vector>
@@ -123,6 +124,12 @@ namespace QTPFS {
         std::vector<INode*> tmpNodesStore;
         int threadId = 0;
 
+        // scratch space for AbstractGraph::FindCorridor
+        std::vector<float> abstractCosts;
+        std::vector<int> abstractPrevRegions;
+        SearchPriorityQueue abstractOpenRegions;
+        std::vector<std::uint8_t> corridorClusters;
+
 		SearchThreadData(size_t nodeCount, int curThreadId)
 			// : allSearchedNodes(nodeCount)
             /*,*/ : threadId(curThreadId)
@@ -151,6 +158,9 @@ namespace QTPFS {
                 memFootPrint += openNodes[i].size() * sizeof(std::remove_reference_t<decltype(openNodes[0])>::value_type);
             }
             memFootPrint += tmpNodesStore.size() * sizeof(decltype(tmpNodesStore)::value_type);
+            memFootPrint += abstractCosts.size() * sizeof(decltype(abstractCosts)::value_type);
+            memFootPrint += abstractPrevRegions.size() * sizeof(decltype(abstractPrevRegions)::value_type);
+            memFootPrint += corridorClusters.size() * sizeof(decltype(corridorClusters)::value_type);
 
             return memFootPrint;
         }
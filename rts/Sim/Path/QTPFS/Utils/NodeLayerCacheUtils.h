@@ -0,0 +1,52 @@
+#ifndef NODE_LAYER_CACHE_UTILS_H_
+#define NODE_LAYER_CACHE_UTILS_H_
+
+#include <cinttypes>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+
+namespace QTPFS {
+
+	// raw (host-endian) helpers for the node-layer cache file; readers
+	// advance <data> and fail without side-effects when out of bytes
+
+	template<typename T>
+	void WriteCacheValues(std::vector<std::uint8_t>& buffer, const T* values, size_t count) {
+		static_assert(std::is_trivially_copyable_v<T>);
+
+		const size_t offset = buffer.size();
+		buffer.resize(offset + sizeof(T) * count);
+
+		if (count > 0)
+			std::memcpy(buffer.data() + offset, values, sizeof(T) * count);
+	}
+
+	template<typename T>
+	void WriteCacheValue(std::vector<std::uint8_t>& buffer, const T& value) {
+		WriteCacheValues(buffer, &value, 1);
+	}
+
+	template<typename T>
+	bool ReadCacheValues(const std::uint8_t*& data, const std::uint8_t* dataEnd, T* values, size_t count) {
+		static_assert(std::is_trivially_copyable_v<T>);
+
+		if (size_t(dataEnd - data) / sizeof(T) < count)
+			return false;
+
+		if (count > 0)
+			std::memcpy(values, data, sizeof(T) * count);
+
+		data += (sizeof(T) * count);
+		return true;
+	}
+
+	template<typename T>
+	bool ReadCacheValue(const std::uint8_t*& data, const std::uint8_t* dataEnd, T& value) {
+		return ReadCacheValues(data, dataEnd, &value, 1);
+	}
+
+}
+
+#endif
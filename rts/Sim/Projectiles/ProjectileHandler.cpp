@@ -15,6 +15,7 @@
 #include "Sim/Misc/CollisionHandler.h"
 #include "Sim/Misc/CollisionVolume.h"
 #include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/ModInfo.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Rendering/Env/Particles/Classes/NanoProjectile.h"
@@ -371,6 +372,9 @@ void CProjectileHandler::AddProjectile(CProjectile* p)
 	if (p->synced) {
 		ASSERT_SYNCED(freeIDs.size());
 		ASSERT_SYNCED(p->id);
+
+		SYNC_SUBSYSTEM(SUBSYS_PROJECTILES, p->id);
+		SYNC_SUBSYSTEM(SUBSYS_PROJECTILES, p->pos);
 	}
 
 	CreateProjectile(p);
@@ -422,6 +426,22 @@ static bool CheckProjectileCollisionFlags(const CProjectile* p, const CUnit* u)
 }
 
 
+template<typename T>
+static void ApplyObjectCollision(CProjectile* p, T* object, const CollisionQuery& cq, const float3 ppos0)
+{
+	if (cq.GetHitPiece() != nullptr)
+		object->SetLastHitPiece(cq.GetHitPiece(), gs->frameNum, p->synced);
+
+	if (!cq.InsideHit()) {
+		p->SetPosition(cq.GetHitPos());
+		p->Collision(object);
+		p->SetPosition(ppos0);
+	} else {
+		p->Collision(object);
+	}
+}
+
+
 void CProjectileHandler::CheckUnitCollisions(
 	CProjectile* p,
 	std::vector<CUnit*>& tempUnits,
@@ -447,17 +467,7 @@ void CProjectileHandler::CheckUnitCollisions(
 			continue;
 
 		if (CCollisionHandler::DetectHit(unit, unit->GetTransformMatrix(true), ppos0, ppos1, &cq)) {
-			if (cq.GetHitPiece() != nullptr)
-				unit->SetLastHitPiece(cq.GetHitPiece(), gs->frameNum, p->synced);
-
-			if (!cq.InsideHit()) {
-				p->SetPosition(cq.GetHitPos());
-				p->Collision(unit);
-				p->SetPosition(ppos0);
-			} else {
-				p->Collision(unit);
-			}
-
+			ApplyObjectCollision(p, unit, cq, ppos0);
 			break;
 		}
 	}
@@ -486,17 +496,7 @@ void CProjectileHandler::CheckFeatureCollisions(
 			continue;
 
 		if (CCollisionHandler::DetectHit(feature, feature->GetTransformMatrix(true), ppos0, ppos1, &cq)) {
-			if (cq.GetHitPiece() != nullptr)
-				feature->SetLastHitPiece(cq.GetHitPiece(), gs->frameNum, p->synced);
-
-			if (!cq.InsideHit()) {
-				p->SetPosition(cq.GetHitPos());
-				p->Collision(feature);
-				p->SetPosition(ppos0);
-			} else {
-				p->Collision(feature);
-			}
-
+			ApplyObjectCollision(p, feature, cq, ppos0);
 			break;
 		}
 	}
@@ -557,6 +557,180 @@ void CProjectileHandler::CheckShieldCollisions(
 	}
 }
 
+// unit or feature that a projectile hit (or might hit) at the start of the
+// collision phase, in the order the quadfield returned them
+struct PreparedCollision {
+	CSolidObject* object;
+	CollisionQuery cq;
+
+	// piece matrices are updated lazily, so piece-tree volumes
+	// can not be tested from multiple threads and are deferred
+	bool deferred;
+};
+
+struct PreparedProjectileCollisions {
+	int thread;
+
+	// ranges into the per-thread buffers below
+	uint32_t repulsersBeg;
+	uint32_t repulsersEnd;
+	uint32_t unitsBeg;
+	uint32_t unitsEnd; // == featuresBeg
+	uint32_t featuresEnd;
+};
+
+struct PreparedCollisionBuffers {
+	std::vector<CUnit*> units;
+	std::vector<CFeature*> features;
+
+	std::vector<CPlasmaRepulser*> repulsers;
+	std::vector<PreparedCollision> collisions;
+};
+
+static std::vector<PreparedProjectileCollisions> preparedProjectileCollisions;
+static std::array<PreparedCollisionBuffers, ThreadPool::MAX_THREADS> preparedCollisionBuffers;
+
+
+size_t CProjectileHandler::PrepareUnitFeatureCollisions(bool synced)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+
+	if (!modInfo.projectileCollisionMT)
+		return 0;
+
+	const size_t numProjectiles = projectiles[synced].size();
+
+	preparedProjectileCollisions.resize(numProjectiles);
+
+	for (PreparedCollisionBuffers& buffers: preparedCollisionBuffers) {
+		buffers.repulsers.clear();
+		buffers.collisions.clear();
+	}
+
+	// the quadfield queries and the intersection tests against regular volumes
+	// are free of side-effects; everything that depends on (or changes) state
+	// that earlier collisions in the same frame can modify is left to the
+	// serial pass in CheckPreparedCollisions
+	for_mt_chunk(0, numProjectiles, [&](const int i) {
+		const int thread = ThreadPool::GetThreadNum();
+
+		CProjectile* p = projectiles[synced][i];
+		PreparedCollisionBuffers& buffers = preparedCollisionBuffers[thread];
+		PreparedProjectileCollisions& ppc = preparedProjectileCollisions[i];
+
+		ppc.thread = thread;
+		ppc.repulsersBeg = buffers.repulsers.size();
+		ppc.unitsBeg = buffers.collisions.size();
+
+		if (p->checkCol && !p->deleteMe) {
+			const float3 ppos0 = p->pos;
+			const float3 ppos1 = p->pos + p->speed;
+
+			buffers.units.clear();
+			buffers.features.clear();
+
+			quadField.GetUnitsAndFeaturesColVol(thread, p->pos, p->speed.w + p->radius, buffers.units, buffers.features, buffers.repulsers);
+
+			const auto PrepareCollision = [&](CSolidObject* object) {
+				PreparedCollision pc = {object, {}, object->collisionVolume.DefaultToPieceTree()};
+
+				if (pc.deferred || CCollisionHandler::DetectHit(object, object->GetTransformMatrix(true), ppos0, ppos1, &pc.cq))
+					buffers.collisions.push_back(pc);
+			};
+
+			const CUnit* owner = p->owner();
+
+			for (CUnit* unit: buffers.units) {
+				if (unit == owner)
+					continue;
+
+				PrepareCollision(unit);
+			}
+
+			ppc.unitsEnd = buffers.collisions.size();
+
+			if ((p->GetCollisionFlags() & Collision::NOFEATURES) == 0) {
+				for (CFeature* feature: buffers.features) {
+					PrepareCollision(feature);
+				}
+			}
+		} else {
+			ppc.unitsEnd = buffers.collisions.size();
+		}
+
+		ppc.repulsersEnd = buffers.repulsers.size();
+		ppc.featuresEnd = buffers.collisions.size();
+	}, 64);
+
+	return numProjectiles;
+}
+
+void CProjectileHandler::CheckPreparedCollisions(
+	CProjectile* p,
+	size_t idx,
+	const float3 ppos0,
+	const float3 ppos1
+) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	static std::vector<CPlasmaRepulser*> tempRepulsers;
+
+	const PreparedProjectileCollisions& ppc = preparedProjectileCollisions[idx];
+	const PreparedCollisionBuffers& buffers = preparedCollisionBuffers[ppc.thread];
+
+	// shields change state when intercepting, always test them here
+	tempRepulsers.assign(buffers.repulsers.begin() + ppc.repulsersBeg, buffers.repulsers.begin() + ppc.repulsersEnd);
+	CheckShieldCollisions(p, tempRepulsers, ppos0, ppos1);
+
+	// apply the first hit whose object passes the (state-dependent) filters
+	// of CheckUnitCollisions and CheckFeatureCollisions at this point
+	const auto ApplyPreparedCollision = [&](auto* object, const PreparedCollision& pc) {
+		if (!pc.deferred) {
+			ApplyObjectCollision(p, object, pc.cq, ppos0);
+			return true;
+		}
+
+		CollisionQuery cq;
+
+		if (!CCollisionHandler::DetectHit(object, object->GetTransformMatrix(true), ppos0, ppos1, &cq))
+			return false;
+
+		ApplyObjectCollision(p, object, cq, ppos0);
+		return true;
+	};
+
+	if (!p->checkCol)
+		return;
+
+	for (uint32_t i = ppc.unitsBeg; i < ppc.unitsEnd; ++i) {
+		const PreparedCollision& pc = buffers.collisions[i];
+		CUnit* unit = static_cast<CUnit*>(pc.object);
+
+		if (!unit->HasCollidableStateBit(CSolidObject::CSTATE_BIT_PROJECTILES))
+			continue;
+		if (!CheckProjectileCollisionFlags(p, unit))
+			continue;
+
+		if (ApplyPreparedCollision(unit, pc))
+			break;
+	}
+
+	if (!p->checkCol)
+		return;
+	if ((p->GetCollisionFlags() & Collision::NOFEATURES) != 0)
+		return;
+
+	for (uint32_t i = ppc.unitsEnd; i < ppc.featuresEnd; ++i) {
+		const PreparedCollision& pc = buffers.collisions[i];
+		CFeature* feature = static_cast<CFeature*>(pc.object);
+
+		if (!feature->HasCollidableStateBit(CSolidObject::CSTATE_BIT_PROJECTILES))
+			continue;
+
+		if (ApplyPreparedCollision(feature, pc))
+			break;
+	}
+}
+
 void CProjectileHandler::CheckUnitFeatureCollisions(bool synced)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -564,6 +738,8 @@ void CProjectileHandler::CheckUnitFeatureCollisions(bool synced)
 	static std::vector<CFeature*> tempFeatures;
 	static std::vector<CPlasmaRepulser*> tempRepulsers;
 
+	const size_t numPrepared = PrepareUnitFeatureCollisions(synced);
+
 	//can't use iterators here, because instructions inside the loop modify projectiles[synced]
 	for (size_t i = 0; i < projectiles[synced].size(); ++i) {
 		CProjectile* p = projectiles[synced][i];
@@ -575,6 +751,12 @@ void CProjectileHandler::CheckUnitFeatureCollisions(bool synced)
 		const float3 ppos1 = p->pos + p->speed;
 		// const float3 ppos1 = p->pos + p->dir * (p->speed.w + p->radius);
 
+		// projectiles created by collisions during this loop were not prepared
+		if (i < numPrepared) {
+			CheckPreparedCollisions(p, i, ppos0, ppos1);
+			continue;
+		}
+
 		quadField.GetUnitsAndFeaturesColVol(p->pos, p->speed.w + p->radius, tempUnits, tempFeatures, &tempRepulsers);
 
 		CheckShieldCollisions (p, tempRepulsers, ppos0, ppos1); tempRepulsers.clear();
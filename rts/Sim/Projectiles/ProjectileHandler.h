@@ -46,7 +46,9 @@ public:
 	void CheckUnitCollisions(CProjectile*, std::vector<CUnit*>&, const float3, const float3);
 	void CheckFeatureCollisions(CProjectile*, std::vector<CFeature*>&, const float3, const float3);
 	void CheckShieldCollisions(CProjectile*, std::vector<CPlasmaRepulser*>&, const float3, const float3);
+	void CheckPreparedCollisions(CProjectile*, size_t, const float3, const float3);
 	void CheckUnitFeatureCollisions(bool synced);
+	size_t PrepareUnitFeatureCollisions(bool synced);
 	void CheckGroundCollisions(bool synced);
 	void CheckCollisions();
 
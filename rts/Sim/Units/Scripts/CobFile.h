@@ -8,6 +8,7 @@
 #include <string>
 
 #include "Lua/LuaHashString.h"
+#include "CobProgram.h"
 #include "CobScriptNames.h"
 #include "System/UnorderedMap.hpp"
 
@@ -32,6 +33,7 @@ public:
 		sounds = std::move(f.sounds);
 		luaScripts = std::move(f.luaScripts);
 		scriptMap = std::move(f.scriptMap);
+		program = std::move(f.program);
 
 		name = std::move(f.name);
 		return *this;
@@ -39,6 +41,8 @@ public:
 
 	int GetFunctionId(const std::string& name);
 
+	const CobInstruction* GetInstruction(int offset) { return program.GetInstruction(code, offset); }
+
 public:
 	int numStaticVars = 0;
 
@@ -52,6 +56,8 @@ public:
 	std::vector<int> sounds;
 	std::vector<LuaHashString> luaScripts;
 	spring::unordered_map<std::string, int> scriptMap;
+	/// decoded form of <code> that threads execute
+	CCobProgram program;
 
 	std::string name;
 };
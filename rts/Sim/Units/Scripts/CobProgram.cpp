@@ -0,0 +1,329 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "CobProgram.h"
+
+#include "System/Misc/TracyDefs.h"
+
+
+static bool DecodeOpcode(int opcode, int& op, int& numOperands)
+{
+	switch (opcode) {
+		#define COB_DECODE_CASE(name, value, operands, instrOp) case CobOpcode::name: { op = COB_OP_##instrOp; numOperands = operands; } return true;
+		COB_BYTECODE_OPS(COB_DECODE_CASE)
+		#undef COB_DECODE_CASE
+		default: {
+		} break;
+	}
+
+	return false;
+}
+
+struct CompareInstructionOps {
+	int constant;
+	int jump;
+	int constantJump;
+};
+
+static bool GetCompareInstructionOps(int op, CompareInstructionOps& ops)
+{
+	switch (op) {
+		#define COB_COMPARE_CASE(name, cmp) case COB_OP_##name: { ops = {COB_OP_##name##_CONSTANT, COB_OP_##name##_JUMP, COB_OP_##name##_CONSTANT_JUMP}; } return true;
+		COB_COMPARE_OPS(COB_COMPARE_CASE)
+		#undef COB_COMPARE_CASE
+		default: {
+		} break;
+	}
+
+	return false;
+}
+
+static int GetConstantInstructionOp(int op)
+{
+	switch (op) {
+		#define COB_CONSTANT_CASE(name, binop) case COB_OP_##name: return COB_OP_##name##_CONSTANT;
+		COB_CONSTANT_OPS(COB_CONSTANT_CASE)
+		#undef COB_CONSTANT_CASE
+		default: {
+		} break;
+	}
+
+	return -1;
+}
+
+
+
+void CCobProgram::Init(
+	const std::vector<int>& code,
+	const std::vector<std::string>& scriptNames,
+	const std::vector<int>& scriptOffsets,
+	const std::vector<int>& scriptLengths
+) {
+	RECOIL_DETAILED_TRACY_ZONE;
+
+	instructions.clear();
+	lazyBlocks.clear();
+
+	offsetInstrs.clear();
+	offsetInstrs.resize(code.size(), nullptr);
+	offsetIndices.clear();
+	offsetIndices.resize(code.size(), -1);
+
+	functions.clear();
+	functions.resize(scriptNames.size());
+
+	for (size_t i = 0, n = scriptNames.size(); i < n; ++i) {
+		functions[i].offset = scriptOffsets[i];
+		functions[i].empty = (scriptLengths[i] == 0);
+		functions[i].lua = (scriptNames[i].find("lua_") == 0);
+	}
+
+	const auto DecodeLoadBlock = [&](int offset) {
+		const size_t first = instructions.size();
+
+		DecodeBlock(code, offset, instructions);
+
+		for (size_t i = 0, n = blockOffsets.size(); i < n; ++i) {
+			if (blockOffsets[i] < 0)
+				continue;
+
+			offsetIndices[blockOffsets[i]] = static_cast<int>(first + i);
+		}
+	};
+
+	// decode from every entry point, then from every jump target not covered by
+	// those sweeps (targets inside operands); instructions appended by the latter
+	// are scanned as well
+	for (const int offset: scriptOffsets) {
+		if (static_cast<size_t>(offset) >= code.size() || IsDecoded(offset))
+			continue;
+
+		DecodeLoadBlock(offset);
+	}
+
+	for (size_t i = 0; i < instructions.size(); ++i) {
+		const int offset = instructions[i].jumpPC;
+
+		if (static_cast<size_t>(offset) >= code.size() || IsDecoded(offset))
+			continue;
+
+		DecodeLoadBlock(offset);
+	}
+
+	FuseBlock(instructions, 0);
+
+	// <instructions> is final, resolve offsets to pointers
+	for (size_t i = 0, n = offsetIndices.size(); i < n; ++i) {
+		if (offsetIndices[i] < 0)
+			continue;
+
+		offsetInstrs[i] = &instructions[offsetIndices[i]];
+	}
+	for (CobInstruction& instr: instructions) {
+		if (static_cast<size_t>(instr.jumpPC) >= offsetInstrs.size())
+			continue;
+
+		instr.target = offsetInstrs[instr.jumpPC];
+	}
+
+	offsetIndices = {};
+}
+
+const CobInstruction* CCobProgram::DecodeInstruction(const std::vector<int>& code, int offset)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+
+	// fail like fetching an opcode from outside the code always did (mantis #5981)
+	if (static_cast<size_t>(offset) >= code.size() || offsetInstrs.size() != code.size())
+		(void) code.at(offset);
+
+	std::vector<CobInstruction>& block = lazyBlocks.emplace_back();
+
+	DecodeBlock(code, offset, block);
+	FuseBlock(block, 0);
+
+	for (size_t i = 0, n = blockOffsets.size(); i < n; ++i) {
+		if (blockOffsets[i] < 0)
+			continue;
+
+		offsetInstrs[blockOffsets[i]] = &block[i];
+	}
+
+	// targets that are still undecoded stay null and are looked up when taken
+	for (CobInstruction& instr: block) {
+		if (static_cast<size_t>(instr.jumpPC) >= offsetInstrs.size())
+			continue;
+
+		instr.target = offsetInstrs[instr.jumpPC];
+	}
+
+	return offsetInstrs[offset];
+}
+
+
+void CCobProgram::DecodeBlock(const std::vector<int>& code, int offset, std::vector<CobInstruction>& block)
+{
+	const int codeSize = static_cast<int>(code.size());
+
+	blockOffsets.clear();
+
+	// decode straight-line code until running into an already decoded offset,
+	// an unknown opcode or the end of the code; blocks always end in one of
+	// the terminators GOTO, UNKNOWN or OUT_OF_RANGE so no instruction has to
+	// check for falling off its block
+	for (int pc = offset; ; ) {
+		CobInstruction instr;
+
+		if (pc >= codeSize) {
+			instr.op = COB_OP_OUT_OF_RANGE;
+			instr.pc = codeSize;
+
+			block.push_back(instr);
+			blockOffsets.push_back(-1);
+			break;
+		}
+
+		if (IsDecoded(pc)) {
+			instr.op = COB_OP_GOTO;
+			instr.pc = pc;
+			instr.jumpPC = pc;
+
+			block.push_back(instr);
+			blockOffsets.push_back(-1);
+			break;
+		}
+
+		const int opcode = code[pc];
+
+		int numOperands = 0;
+
+		if (!DecodeOpcode(opcode, instr.op, numOperands)) {
+			instr.op = COB_OP_UNKNOWN;
+			instr.pc = pc + 1;
+			instr.a = opcode;
+
+			block.push_back(instr);
+			blockOffsets.push_back(pc);
+			break;
+		}
+
+		if ((pc + numOperands) >= codeSize) {
+			instr.op = COB_OP_OUT_OF_RANGE;
+			instr.pc = codeSize;
+
+			block.push_back(instr);
+			blockOffsets.push_back(pc);
+			break;
+		}
+
+		instr.pc = pc + 1 + numOperands;
+		instr.a = (numOperands > 0)? code[pc + 1]: 0;
+		instr.b = (numOperands > 1)? code[pc + 2]: 0;
+
+		switch (opcode) {
+			case CobOpcode::CALL:
+			case CobOpcode::REAL_CALL:
+			case CobOpcode::START: {
+				// calls to invalid or zero-length functions are skipped
+				if (static_cast<size_t>(instr.a) >= functions.size()) {
+					instr.op = COB_OP_NOP;
+					break;
+				}
+
+				const Function& func = functions[instr.a];
+
+				// CALL used to be rewritten into LUA_CALL or REAL_CALL on first execution
+				if (opcode == CobOpcode::CALL && func.lua) {
+					instr.op = COB_OP_LUA_CALL;
+					break;
+				}
+				if (func.empty) {
+					instr.op = COB_OP_NOP;
+					break;
+				}
+				if (opcode != CobOpcode::START)
+					instr.jumpPC = func.offset;
+			} break;
+			case CobOpcode::JUMP:
+			case CobOpcode::JUMP_NOT_EQUAL: {
+				instr.jumpPC = instr.a;
+			} break;
+			default: {
+			} break;
+		}
+
+		block.push_back(instr);
+		blockOffsets.push_back(pc);
+
+		pc = instr.pc;
+	}
+}
+
+void CCobProgram::FuseBlock(std::vector<CobInstruction>& block, size_t first) const
+{
+	// superinstructions only combine pure stack operations, nothing can observe
+	// the pc between their parts; the replaced slots behind the head are kept
+	for (size_t i = first, n = block.size(); (i + 1) < n; ) {
+		CobInstruction& head = block[i];
+
+		const CobInstruction& next = block[i + 1];
+		const CobInstruction* last = ((i + 2) < n)? &block[i + 2]: nullptr;
+
+		CompareInstructionOps cmpOps;
+
+		if (head.op == COB_OP_PUSH_CONSTANT) {
+			if (GetCompareInstructionOps(next.op, cmpOps)) {
+				if (last != nullptr && last->op == COB_OP_JUMP_NOT_EQUAL) {
+					head.op = cmpOps.constantJump;
+					head.pc = last->pc;
+					head.jumpPC = last->jumpPC;
+					i += 3;
+					continue;
+				}
+
+				head.op = cmpOps.constant;
+				head.pc = next.pc;
+				i += 2;
+				continue;
+			}
+
+			const int constOp = GetConstantInstructionOp(next.op);
+
+			if (constOp >= 0) {
+				head.op = constOp;
+				head.pc = next.pc;
+				i += 2;
+				continue;
+			}
+
+			if (next.op == COB_OP_PUSH_CONSTANT) {
+				head.op = COB_OP_PUSH_CONSTANT_2;
+				head.pc = next.pc;
+				head.b = next.a;
+				i += 2;
+				continue;
+			}
+		}
+
+		if (GetCompareInstructionOps(head.op, cmpOps) && next.op == COB_OP_JUMP_NOT_EQUAL) {
+			head.op = cmpOps.jump;
+			head.pc = next.pc;
+			head.jumpPC = next.jumpPC;
+			i += 2;
+			continue;
+		}
+
+		i += 1;
+	}
+}
+
+
+size_t CCobProgram::GetNumInstructions() const
+{
+	size_t n = instructions.size();
+
+	for (const auto& block: lazyBlocks) {
+		n += block.size();
+	}
+
+	return n;
+}
@@ -0,0 +1,228 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef COB_PROGRAM_H
+#define COB_PROGRAM_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Command documentation from http://visualta.tauniverse.com/Downloads/cob-commands.txt
+// And some information from basm0.8 source (basm ops.txt)
+//
+// OP(name, opcode, number of operand words, decoded instruction)
+#define COB_BYTECODE_OPS(OP) \
+	/* Model interaction */ \
+	OP(MOVE,                 0x10001000, 2, MOVE                ) \
+	OP(TURN,                 0x10002000, 2, TURN                ) \
+	OP(SPIN,                 0x10003000, 2, SPIN                ) \
+	OP(STOP_SPIN,            0x10004000, 2, STOP_SPIN           ) \
+	OP(SHOW,                 0x10005000, 1, SHOW                ) \
+	OP(HIDE,                 0x10006000, 1, HIDE                ) \
+	OP(CACHE,                0x10007000, 1, NOP                 ) \
+	OP(DONT_CACHE,           0x10008000, 1, NOP                 ) \
+	OP(MOVE_NOW,             0x1000B000, 2, MOVE_NOW            ) \
+	OP(TURN_NOW,             0x1000C000, 2, TURN_NOW            ) \
+	OP(SHADE,                0x1000D000, 1, NOP                 ) \
+	OP(DONT_SHADE,           0x1000E000, 1, NOP                 ) \
+	OP(EMIT_SFX,             0x1000F000, 1, EMIT_SFX            ) \
+	/* Blocking operations */ \
+	OP(WAIT_TURN,            0x10011000, 2, WAIT_TURN           ) \
+	OP(WAIT_MOVE,            0x10012000, 2, WAIT_MOVE           ) \
+	OP(SLEEP,                0x10013000, 0, SLEEP               ) \
+	/* Stack manipulation */ \
+	OP(PUSH_CONSTANT,        0x10021001, 1, PUSH_CONSTANT       ) \
+	OP(PUSH_LOCAL_VAR,       0x10021002, 1, PUSH_LOCAL_VAR      ) \
+	OP(PUSH_STATIC,          0x10021004, 1, PUSH_STATIC         ) \
+	OP(CREATE_LOCAL_VAR,     0x10022000, 0, CREATE_LOCAL_VAR    ) \
+	OP(POP_LOCAL_VAR,        0x10023002, 1, POP_LOCAL_VAR       ) \
+	OP(POP_STATIC,           0x10023004, 1, POP_STATIC          ) \
+	OP(POP_STACK,            0x10024000, 0, POP_STACK           ) /* Not sure what this is supposed to do */ \
+	/* Arithmetic operations */ \
+	OP(ADD,                  0x10031000, 0, ADD                 ) \
+	OP(SUB,                  0x10032000, 0, SUB                 ) \
+	OP(MUL,                  0x10033000, 0, MUL                 ) \
+	OP(DIV,                  0x10034000, 0, DIV                 ) \
+	OP(MOD,                  0x10034001, 0, MOD                 ) /* spring specific */ \
+	OP(BITWISE_AND,          0x10035000, 0, BITWISE_AND         ) \
+	OP(BITWISE_OR,           0x10036000, 0, BITWISE_OR          ) \
+	OP(BITWISE_XOR,          0x10037000, 0, BITWISE_XOR         ) \
+	OP(BITWISE_NOT,          0x10038000, 0, BITWISE_NOT         ) \
+	/* Native function calls */ \
+	OP(RAND,                 0x10041000, 0, RAND                ) \
+	OP(GET_UNIT_VALUE,       0x10042000, 0, GET_UNIT_VALUE      ) \
+	OP(GET,                  0x10043000, 0, GET                 ) \
+	/* Comparison */ \
+	OP(SET_LESS,             0x10051000, 0, SET_LESS            ) \
+	OP(SET_LESS_OR_EQUAL,    0x10052000, 0, SET_LESS_OR_EQUAL   ) \
+	OP(SET_GREATER,          0x10053000, 0, SET_GREATER         ) \
+	OP(SET_GREATER_OR_EQUAL, 0x10054000, 0, SET_GREATER_OR_EQUAL) \
+	OP(SET_EQUAL,            0x10055000, 0, SET_EQUAL           ) \
+	OP(SET_NOT_EQUAL,        0x10056000, 0, SET_NOT_EQUAL       ) \
+	OP(LOGICAL_AND,          0x10057000, 0, LOGICAL_AND         ) \
+	OP(LOGICAL_OR,           0x10058000, 0, LOGICAL_OR          ) \
+	OP(LOGICAL_XOR,          0x10059000, 0, LOGICAL_XOR         ) \
+	OP(LOGICAL_NOT,          0x1005A000, 0, LOGICAL_NOT         ) \
+	/* Flow control */ \
+	OP(START,                0x10061000, 2, START               ) \
+	OP(CALL,                 0x10062000, 2, REAL_CALL           ) /* resolved to REAL_CALL or LUA_CALL when decoded */ \
+	OP(REAL_CALL,            0x10062001, 2, REAL_CALL           ) /* spring custom */ \
+	OP(LUA_CALL,             0x10062002, 2, LUA_CALL            ) /* spring custom */ \
+	OP(JUMP,                 0x10064000, 1, JUMP                ) \
+	OP(RETURN,               0x10065000, 0, RETURN              ) \
+	OP(JUMP_NOT_EQUAL,       0x10066000, 1, JUMP_NOT_EQUAL      ) \
+	OP(SIGNAL,               0x10067000, 0, SIGNAL              ) \
+	OP(SET_SIGNAL_MASK,      0x10068000, 0, SET_SIGNAL_MASK     ) \
+	/* Piece destruction */ \
+	OP(EXPLODE,              0x10071000, 1, EXPLODE             ) \
+	OP(PLAY_SOUND,           0x10072000, 1, PLAY_SOUND          ) \
+	/* Special functions */ \
+	OP(SET,                  0x10082000, 0, SET                 ) \
+	OP(ATTACH,               0x10083000, 0, ATTACH              ) \
+	OP(DROP,                 0x10084000, 0, DROP                )
+
+// comparisons that are fused with a preceding PUSH_CONSTANT and/or a following JUMP_NOT_EQUAL
+#define COB_COMPARE_OPS(OP) \
+	OP(SET_LESS,             < ) \
+	OP(SET_LESS_OR_EQUAL,    <=) \
+	OP(SET_GREATER,          > ) \
+	OP(SET_GREATER_OR_EQUAL, >=) \
+	OP(SET_EQUAL,            ==) \
+	OP(SET_NOT_EQUAL,        !=)
+
+// binary operators that are fused with a preceding PUSH_CONSTANT
+#define COB_CONSTANT_OPS(OP) \
+	OP(ADD,         +) \
+	OP(SUB,         -) \
+	OP(MUL,         *) \
+	OP(BITWISE_AND, &) \
+	OP(BITWISE_OR,  |)
+
+#define COB_COMPARE_INSTRUCTION_OPS(OP) \
+	OP(SET_LESS) OP(SET_LESS_CONSTANT) OP(SET_LESS_JUMP) OP(SET_LESS_CONSTANT_JUMP) \
+	OP(SET_LESS_OR_EQUAL) OP(SET_LESS_OR_EQUAL_CONSTANT) OP(SET_LESS_OR_EQUAL_JUMP) OP(SET_LESS_OR_EQUAL_CONSTANT_JUMP) \
+	OP(SET_GREATER) OP(SET_GREATER_CONSTANT) OP(SET_GREATER_JUMP) OP(SET_GREATER_CONSTANT_JUMP) \
+	OP(SET_GREATER_OR_EQUAL) OP(SET_GREATER_OR_EQUAL_CONSTANT) OP(SET_GREATER_OR_EQUAL_JUMP) OP(SET_GREATER_OR_EQUAL_CONSTANT_JUMP) \
+	OP(SET_EQUAL) OP(SET_EQUAL_CONSTANT) OP(SET_EQUAL_JUMP) OP(SET_EQUAL_CONSTANT_JUMP) \
+	OP(SET_NOT_EQUAL) OP(SET_NOT_EQUAL_CONSTANT) OP(SET_NOT_EQUAL_JUMP) OP(SET_NOT_EQUAL_CONSTANT_JUMP)
+
+// every op the decoded instruction stream can contain
+#define COB_INSTRUCTION_OPS(OP) \
+	OP(MOVE) OP(TURN) OP(SPIN) OP(STOP_SPIN) OP(SHOW) OP(HIDE) OP(MOVE_NOW) OP(TURN_NOW) OP(EMIT_SFX) \
+	OP(WAIT_TURN) OP(WAIT_MOVE) OP(SLEEP) \
+	OP(PUSH_CONSTANT) OP(PUSH_LOCAL_VAR) OP(PUSH_STATIC) OP(CREATE_LOCAL_VAR) OP(POP_LOCAL_VAR) OP(POP_STATIC) OP(POP_STACK) \
+	OP(ADD) OP(SUB) OP(MUL) OP(DIV) OP(MOD) OP(BITWISE_AND) OP(BITWISE_OR) OP(BITWISE_XOR) OP(BITWISE_NOT) \
+	OP(RAND) OP(GET_UNIT_VALUE) OP(GET) \
+	COB_COMPARE_INSTRUCTION_OPS(OP) \
+	OP(LOGICAL_AND) OP(LOGICAL_OR) OP(LOGICAL_XOR) OP(LOGICAL_NOT) \
+	OP(START) OP(REAL_CALL) OP(LUA_CALL) OP(JUMP) OP(RETURN) OP(JUMP_NOT_EQUAL) OP(SIGNAL) OP(SET_SIGNAL_MASK) \
+	OP(EXPLODE) OP(PLAY_SOUND) \
+	OP(SET) OP(ATTACH) OP(DROP) \
+	/* superinstructions */ \
+	OP(PUSH_CONSTANT_2) \
+	OP(ADD_CONSTANT) OP(SUB_CONSTANT) OP(MUL_CONSTANT) OP(BITWISE_AND_CONSTANT) OP(BITWISE_OR_CONSTANT) \
+	/* decoder-generated */ \
+	OP(NOP) OP(GOTO) OP(UNKNOWN) OP(OUT_OF_RANGE)
+
+
+namespace CobOpcode {
+	#define COB_OPCODE_VALUE(name, opcode, numOperands, instrOp) static constexpr int name = opcode;
+	COB_BYTECODE_OPS(COB_OPCODE_VALUE)
+	#undef COB_OPCODE_VALUE
+}
+
+enum CobInstructionOp {
+	#define COB_INSTRUCTION_ENUM(name) COB_OP_##name,
+	COB_INSTRUCTION_OPS(COB_INSTRUCTION_ENUM)
+	#undef COB_INSTRUCTION_ENUM
+	COB_OP_COUNT
+};
+
+
+/**
+ * One decoded COB instruction, possibly standing in for a sequence of
+ * bytecode instructions (superinstruction). Fused instructions occupy
+ * the slots of the instructions they replace: the slots behind them
+ * keep their original decoding so jumps into the sequence still work.
+ */
+struct CobInstruction {
+	// decoded jump, call or GOTO target; null if not decoded (yet)
+	const CobInstruction* target = nullptr;
+
+	int op = COB_OP_UNKNOWN;
+	// code offset behind this instruction, what the bytecode pc would be after executing it
+	int pc = 0;
+
+	int a = 0;
+	int b = 0;
+
+	// code offset of <target>, -1 if none
+	int jumpPC = -1;
+};
+
+
+/**
+ * Pre-decoded form of a COB file's code. Every reachable code offset (script
+ * entry points, jump targets) maps to an instruction, so threads can keep
+ * their pc as a plain code offset for savegames and resume at any of them.
+ * Offsets not reachable through the code itself (e.g. from old savegames)
+ * are decoded on demand.
+ */
+class CCobProgram
+{
+public:
+	void Init(
+		const std::vector<int>& code,
+		const std::vector<std::string>& scriptNames,
+		const std::vector<int>& scriptOffsets,
+		const std::vector<int>& scriptLengths
+	);
+
+	/**
+	 * Returns the instruction starting at <offset>; throws like a
+	 * direct code.at(offset) if <offset> is outside of the code.
+	 */
+	const CobInstruction* GetInstruction(const std::vector<int>& code, int offset) {
+		if (static_cast<size_t>(offset) < offsetInstrs.size() && offsetInstrs[offset] != nullptr)
+			return offsetInstrs[offset];
+
+		return DecodeInstruction(code, offset);
+	}
+
+	size_t GetNumInstructions() const;
+
+private:
+	const CobInstruction* DecodeInstruction(const std::vector<int>& code, int offset);
+
+	void DecodeBlock(const std::vector<int>& code, int offset, std::vector<CobInstruction>& block);
+	void FuseBlock(std::vector<CobInstruction>& block, size_t first) const;
+
+	bool IsDecoded(int offset) const {
+		return (offsetInstrs[offset] != nullptr || (!offsetIndices.empty() && offsetIndices[offset] >= 0));
+	}
+
+private:
+	// decoded at load-time
+	std::vector<CobInstruction> instructions;
+	// decoded on demand; separate blocks so pointers into them stay valid
+	std::vector< std::vector<CobInstruction> > lazyBlocks;
+
+	// code offset -> instruction starting there
+	std::vector<const CobInstruction*> offsetInstrs;
+	// code offset -> index into <instructions>, only used during Init
+	std::vector<int> offsetIndices;
+	// start offsets of the instructions emitted by the last DecodeBlock call, -1 if none
+	std::vector<int> blockOffsets;
+
+	struct Function {
+		int offset = 0;
+		// CALL and START skip zero-length functions
+		bool empty = false;
+		// CALL resolves to LUA_CALL for lua_ functions
+		bool lua = false;
+	};
+
+	std::vector<Function> functions;
+};
+
+#endif // COB_PROGRAM_H
@@ -103,7 +103,6 @@ CCobThread& CCobThread::operator = (CCobThread&& t) {
 
 	callStack = std::move(t.callStack);
 	dataStack = std::move(t.dataStack);
-	// execTrace = std::move(t.execTrace);
 
 	state = t.state;
 	cbType = t.cbType;
@@ -130,7 +129,6 @@ CCobThread& CCobThread::operator = (const CCobThread& t) {
 
 	callStack = t.callStack;
 	dataStack = t.dataStack;
-	// execTrace = t.execTrace;
 
 	state = t.state;
 	cbType = t.cbType;
@@ -226,86 +224,6 @@ void CCobThread::InitStack(unsigned int n, CCobThread* t)
 
 
 
-// Command documentation from http://visualta.tauniverse.com/Downloads/cob-commands.txt
-// And some information from basm0.8 source (basm ops.txt)
-
-// Model interaction
-static constexpr int MOVE       = 0x10001000;
-static constexpr int TURN       = 0x10002000;
-static constexpr int SPIN       = 0x10003000;
-static constexpr int STOP_SPIN  = 0x10004000;
-static constexpr int SHOW       = 0x10005000;
-static constexpr int HIDE       = 0x10006000;
-static constexpr int CACHE      = 0x10007000;
-static constexpr int DONT_CACHE = 0x10008000;
-static constexpr int MOVE_NOW   = 0x1000B000;
-static constexpr int TURN_NOW   = 0x1000C000;
-static constexpr int SHADE      = 0x1000D000;
-static constexpr int DONT_SHADE = 0x1000E000;
-static constexpr int EMIT_SFX   = 0x1000F000;
-
-// Blocking operations
-static constexpr int WAIT_TURN  = 0x10011000;
-static constexpr int WAIT_MOVE  = 0x10012000;
-static constexpr int SLEEP      = 0x10013000;
-
-// Stack manipulation
-static constexpr int PUSH_CONSTANT    = 0x10021001;
-static constexpr int PUSH_LOCAL_VAR   = 0x10021002;
-static constexpr int PUSH_STATIC      = 0x10021004;
-static constexpr int CREATE_LOCAL_VAR = 0x10022000;
-static constexpr int POP_LOCAL_VAR    = 0x10023002;
-static constexpr int POP_STATIC       = 0x10023004;
-static constexpr int POP_STACK        = 0x10024000; ///< Not sure what this is supposed to do
-
-// Arithmetic operations
-static constexpr int ADD         = 0x10031000;
-static constexpr int SUB         = 0x10032000;
-static constexpr int MUL         = 0x10033000;
-static constexpr int DIV         = 0x10034000;
-static constexpr int MOD		  = 0x10034001; ///< spring specific
-static constexpr int BITWISE_AND = 0x10035000;
-static constexpr int BITWISE_OR  = 0x10036000;
-static constexpr int BITWISE_XOR = 0x10037000;
-static constexpr int BITWISE_NOT = 0x10038000;
-
-// Native function calls
-static constexpr int RAND           = 0x10041000;
-static constexpr int GET_UNIT_VALUE = 0x10042000;
-static constexpr int GET            = 0x10043000;
-
-// Comparison
-static constexpr int SET_LESS             = 0x10051000;
-static constexpr int SET_LESS_OR_EQUAL    = 0x10052000;
-static constexpr int SET_GREATER          = 0x10053000;
-static constexpr int SET_GREATER_OR_EQUAL = 0x10054000;
-static constexpr int SET_EQUAL            = 0x10055000;
-static constexpr int SET_NOT_EQUAL        = 0x10056000;
-static constexpr int LOGICAL_AND          = 0x10057000;
-static constexpr int LOGICAL_OR           = 0x10058000;
-static constexpr int LOGICAL_XOR          = 0x10059000;
-static constexpr int LOGICAL_NOT          = 0x1005A000;
-
-// Flow control
-static constexpr int START           = 0x10061000;
-static constexpr int CALL            = 0x10062000; ///< converted when executed
-static constexpr int REAL_CALL       = 0x10062001; ///< spring custom
-static constexpr int LUA_CALL        = 0x10062002; ///< spring custom
-static constexpr int JUMP            = 0x10064000;
-static constexpr int RETURN          = 0x10065000;
-static constexpr int JUMP_NOT_EQUAL  = 0x10066000;
-static constexpr int SIGNAL          = 0x10067000;
-static constexpr int SET_SIGNAL_MASK = 0x10068000;
-
-// Piece destruction
-static constexpr int EXPLODE    = 0x10071000;
-static constexpr int PLAY_SOUND = 0x10072000;
-
-// Special functions
-static constexpr int SET    = 0x10082000;
-static constexpr int ATTACH = 0x10083000;
-static constexpr int DROP   = 0x10084000;
-
 // Indices for SET, GET, and GET_UNIT_VALUE for LUA return values
 static constexpr int LUA0 = 110; // (LUA0 returns the lua call status, 0 or 1)
 static constexpr int LUA1 = 111;
@@ -318,91 +236,502 @@ static constexpr int LUA7 = 117;
 static constexpr int LUA8 = 118;
 static constexpr int LUA9 = 119;
 
-#if 0
-#define GET_LONG_PC() (cobFile->code[pc++])
+
+// threaded dispatch over the decoded instruction stream (see CobProgram.h)
+// where the compiler supports labels as values, a plain switch otherwise;
+// defining COB_SWITCH_INTERPRETER instead runs the original interpreter
+// directly over the bytecode, kept as reference until the decoded one is
+// covered by tests running real threads
+#ifndef COB_SWITCH_INTERPRETER
+
+#if defined(__GNUC__)
+	#define COB_COMPUTED_GOTO
+#endif
+
+#ifdef COB_COMPUTED_GOTO
+	#define COB_TARGET(name) cob_op_##name:
+	#define COB_DISPATCH() goto *dispatchTable[ip->op]
+	#define COB_DISPATCH_BEGIN() COB_DISPATCH();
+	#define COB_DISPATCH_END()
 #else
-// mantis #5981
-#define GET_LONG_PC() (cobFile->code.at(pc++))
+	#define COB_TARGET(name) case COB_OP_##name:
+	#define COB_DISPATCH() goto dispatch
+	#define COB_DISPATCH_BEGIN() dispatch: switch (ip->op) {
+	#define COB_DISPATCH_END() default: { assert(false); } break; }
 #endif
 
+// continue with the instruction <n> slots ahead (superinstructions span several)
+#define COB_NEXT(n) do { ip += (n); COB_DISPATCH(); } while (false)
+// same, after calling out of the interpreter; callouts can change our state,
+// e.g. kill this thread through CCobInstance::Signal
+#define COB_NEXT_CHECKED() do { if (state != Run) return (state != Dead); ip += 1; COB_DISPATCH(); } while (false)
+// take the jump or call target of the current instruction
+#define COB_JUMP() do { ip = (ip->target != nullptr)? ip->target: cobFile->GetInstruction(ip->jumpPC); COB_DISPATCH(); } while (false)
 
-#if 0
-static const char* GetOpcodeName(int opcode)
+
+bool CCobThread::Tick()
 {
-	switch (opcode) {
-		case MOVE: return "move";
-		case TURN: return "turn";
-		case SPIN: return "spin";
-		case STOP_SPIN: return "stop-spin";
-		case SHOW: return "show";
-		case HIDE: return "hide";
-		case CACHE: return "cache";
-		case DONT_CACHE: return "dont-cache";
-		case TURN_NOW: return "turn-now";
-		case MOVE_NOW: return "move-now";
-		case SHADE: return "shade";
-		case DONT_SHADE: return "dont-shade";
-		case EMIT_SFX: return "sfx";
-
-		case WAIT_TURN: return "wait-for-turn";
-		case WAIT_MOVE: return "wait-for-move";
-		case SLEEP: return "sleep";
-
-		case PUSH_CONSTANT: return "pushc";
-		case PUSH_LOCAL_VAR: return "pushl";
-		case PUSH_STATIC: return "pushs";
-		case CREATE_LOCAL_VAR: return "clv";
-		case POP_LOCAL_VAR: return "popl";
-		case POP_STATIC: return "pops";
-		case POP_STACK: return "pop-stack";
-
-		case ADD: return "add";
-		case SUB: return "sub";
-		case MUL: return "mul";
-		case DIV: return "div";
-		case MOD: return "mod";
-		case BITWISE_AND: return "and";
-		case BITWISE_OR: return "or";
-		case BITWISE_XOR: return "xor";
-		case BITWISE_NOT: return "not";
-
-		case RAND: return "rand";
-		case GET_UNIT_VALUE: return "getuv";
-		case GET: return "get";
-
-		case SET_LESS: return "setl";
-		case SET_LESS_OR_EQUAL: return "setle";
-		case SET_GREATER: return "setg";
-		case SET_GREATER_OR_EQUAL: return "setge";
-		case SET_EQUAL: return "sete";
-		case SET_NOT_EQUAL: return "setne";
-		case LOGICAL_AND: return "land";
-		case LOGICAL_OR: return "lor";
-		case LOGICAL_XOR: return "lxor";
-		case LOGICAL_NOT: return "neg";
-
-		case START: return "start";
-		case CALL: return "call";
-		case REAL_CALL: return "call";
-		case LUA_CALL: return "lua_call";
-		case JUMP: return "jmp";
-		case RETURN: return "return";
-		case JUMP_NOT_EQUAL: return "jne";
-		case SIGNAL: return "signal";
-		case SET_SIGNAL_MASK: return "mask";
-
-		case EXPLODE: return "explode";
-		case PLAY_SOUND: return "play-sound";
-
-		case SET: return "set";
-		case ATTACH: return "attach";
-		case DROP: return "drop";
+	assert(state != Sleep);
+	assert(cobInst != nullptr);
+
+	if (IsDead())
+		return false;
+
+	ZoneScoped;
+
+	state = Run;
+
+	#ifdef COB_COMPUTED_GOTO
+	static const void* dispatchTable[COB_OP_COUNT] = {
+		#define COB_DISPATCH_LABEL(name) &&cob_op_##name,
+		COB_INSTRUCTION_OPS(COB_DISPATCH_LABEL)
+		#undef COB_DISPATCH_LABEL
+	};
+	#endif
+
+	// <pc> is only synced with <ip> before calling out of the interpreter and
+	// whenever the thread stops running; pure stack operations do not need it
+	const CobInstruction* ip = cobFile->GetInstruction(pc);
+
+	int r1, r2, r3, r4, r5, r6;
+
+	COB_DISPATCH_BEGIN()
+
+	COB_TARGET(PUSH_CONSTANT) {
+		PushDataStack(ip->a);
+	} COB_NEXT(1);
+	COB_TARGET(PUSH_CONSTANT_2) {
+		PushDataStack(ip->a);
+		PushDataStack(ip->b);
+	} COB_NEXT(2);
+	COB_TARGET(SLEEP) {
+		r1 = PopDataStack();
+		pc = ip->pc;
+		wakeTime = cobEngine->GetCurrTime() + r1;
+		state = Sleep;
+
+		cobEngine->ScheduleThread(this);
+		return true;
 	}
+	COB_TARGET(SPIN) {
+		r3 = PopDataStack();         // speed
+		r4 = PopDataStack();         // accel
+		pc = ip->pc;
+		cobInst->Spin(ip->a, ip->b, r3, r4);
+	} COB_NEXT_CHECKED();
+	COB_TARGET(STOP_SPIN) {
+		r3 = PopDataStack();         // decel
+		pc = ip->pc;
+		cobInst->StopSpin(ip->a, ip->b, r3);
+	} COB_NEXT_CHECKED();
+	COB_TARGET(RETURN) {
+		retCode = PopDataStack();
+		pc = ip->pc;
+
+		if (LocalReturnAddr() == -1) {
+			state = Dead;
+
+			// leave values intact on stack in case caller wants to check them
+			// callStackSize -= 1;
+			return false;
+		}
+
+		// return to caller
+		pc = LocalReturnAddr();
+		if (dataStack.size() > LocalStackFrame())
+			dataStack.resize(LocalStackFrame());
+
+		callStack.pop_back();
+
+		ip = cobFile->GetInstruction(pc);
+	} COB_DISPATCH();
+
+
+	// SHADE, DONT_SHADE, CACHE, DONT_CACHE and calls to zero-length functions
+	COB_TARGET(NOP) {
+	} COB_NEXT(1);
+
+
+	COB_TARGET(REAL_CALL) {
+		CallInfo& ci = PushCallStackRef();
+		ci.functionId = ip->a;
+		ci.returnAddr = ip->pc;
+		ci.stackTop = dataStack.size() - ip->b;
+
+		paramCount = ip->b;
+
+		// call cobFile->scriptNames[ip->a]
+	} COB_JUMP();
+	COB_TARGET(LUA_CALL) {
+		pc = ip->pc;
+		LuaCall(ip->a, ip->b);
+	} COB_NEXT_CHECKED();
+
+
+	COB_TARGET(POP_STATIC) {
+		r2 = PopDataStack();
+
+		if (static_cast<size_t>(ip->a) < cobInst->staticVars.size())
+			cobInst->staticVars[ip->a] = r2;
+	} COB_NEXT(1);
+	COB_TARGET(POP_STACK) {
+		PopDataStack();
+	} COB_NEXT(1);
+
+
+	COB_TARGET(START) {
+		pc = ip->pc;
+
+		CCobThread t(cobInst);
 
-	return "unknown";
+		t.SetID(cobEngine->GenThreadID());
+		t.InitStack(ip->b, this);
+		t.Start(ip->a, signalMask, {{0}}, true);
+
+		// calling AddThread directly might move <this>, defer it
+		cobEngine->QueueAddThread(std::move(t));
+	} COB_NEXT_CHECKED();
+
+	COB_TARGET(CREATE_LOCAL_VAR) {
+		if (paramCount == 0) {
+			PushDataStack(0);
+		} else {
+			paramCount--;
+		}
+	} COB_NEXT(1);
+	COB_TARGET(GET_UNIT_VALUE) {
+		r1 = PopDataStack();
+		if ((r1 >= LUA0) && (r1 <= LUA9)) {
+			PushDataStack(luaArgs[r1 - LUA0]);
+			COB_NEXT(1);
+		}
+		pc = ip->pc;
+		r1 = cobInst->GetUnitVal(r1, 0, 0, 0, 0);
+		PushDataStack(r1);
+	} COB_NEXT_CHECKED();
+
+
+	COB_TARGET(JUMP_NOT_EQUAL) {
+		r2 = PopDataStack();
+
+		if (r2 == 0)
+			COB_JUMP();
+	} COB_NEXT(1);
+	COB_TARGET(JUMP) {
+		// this seem to be an error in the docs..
+		//r2 = cobFile->scriptOffsets[LocalFunctionID()] + r1;
+	} COB_JUMP();
+	COB_TARGET(GOTO) {
+		// end of a decoded block, continue in the block that covers this offset
+	} COB_JUMP();
+
+
+	COB_TARGET(POP_LOCAL_VAR) {
+		r2 = PopDataStack();
+		dataStack[LocalStackFrame() + ip->a] = r2;
+	} COB_NEXT(1);
+	COB_TARGET(PUSH_LOCAL_VAR) {
+		r2 = dataStack[LocalStackFrame() + ip->a];
+		PushDataStack(r2);
+	} COB_NEXT(1);
+
+
+	COB_TARGET(BITWISE_XOR) {
+		r1 = PopDataStack();
+		r2 = PopDataStack();
+		PushDataStack(r1 ^ r2);
+	} COB_NEXT(1);
+	COB_TARGET(BITWISE_NOT) {
+		r1 = PopDataStack();
+		PushDataStack(~r1);
+	} COB_NEXT(1);
+
+	// NB: the constant is always the right-hand (top) operand
+	#define COB_CONSTANT_TARGETS(name, binop)  \
+	COB_TARGET(name) {                         \
+		r2 = PopDataStack();                   \
+		r1 = PopDataStack();                   \
+		PushDataStack(r1 binop r2);            \
+	} COB_NEXT(1);                             \
+	COB_TARGET(name##_CONSTANT) {              \
+		r1 = PopDataStack();                   \
+		PushDataStack(r1 binop ip->a);         \
+	} COB_NEXT(2);
+
+	COB_CONSTANT_OPS(COB_CONSTANT_TARGETS)
+	#undef COB_CONSTANT_TARGETS
+
+	COB_TARGET(EXPLODE) {
+		r2 = PopDataStack();
+		pc = ip->pc;
+		cobInst->Explode(ip->a, r2);
+	} COB_NEXT_CHECKED();
+
+	COB_TARGET(PLAY_SOUND) {
+		r2 = PopDataStack();
+		pc = ip->pc;
+		cobInst->PlayUnitSound(ip->a, r2);
+	} COB_NEXT_CHECKED();
+
+	COB_TARGET(PUSH_STATIC) {
+		if (static_cast<size_t>(ip->a) < cobInst->staticVars.size())
+			PushDataStack(cobInst->staticVars[ip->a]);
+	} COB_NEXT(1);
+
+	// JUMP_NOT_EQUAL takes the branch if the comparison yields 0
+	#define COB_COMPARE_TARGETS(name, cmp)     \
+	COB_TARGET(name) {                         \
+		r2 = PopDataStack();                   \
+		r1 = PopDataStack();                   \
+		PushDataStack(int(r1 cmp r2));         \
+	} COB_NEXT(1);                             \
+	COB_TARGET(name##_CONSTANT) {              \
+		r1 = PopDataStack();                   \
+		PushDataStack(int(r1 cmp ip->a));      \
+	} COB_NEXT(2);                             \
+	COB_TARGET(name##_JUMP) {                  \
+		r2 = PopDataStack();                   \
+		r1 = PopDataStack();                   \
+		if (!(r1 cmp r2))                      \
+			COB_JUMP();                        \
+	} COB_NEXT(2);                             \
+	COB_TARGET(name##_CONSTANT_JUMP) {         \
+		r1 = PopDataStack();                   \
+		if (!(r1 cmp ip->a))                   \
+			COB_JUMP();                        \
+	} COB_NEXT(3);
+
+	COB_COMPARE_OPS(COB_COMPARE_TARGETS)
+	#undef COB_COMPARE_TARGETS
+
+	COB_TARGET(RAND) {
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+		r3 = gsRNG.NextInt(r2 - r1 + 1) + r1;
+		PushDataStack(r3);
+	} COB_NEXT(1);
+	COB_TARGET(EMIT_SFX) {
+		r1 = PopDataStack();
+		pc = ip->pc;
+		cobInst->EmitSfx(r1, ip->a);
+	} COB_NEXT_CHECKED();
+
+
+	COB_TARGET(SIGNAL) {
+		r1 = PopDataStack();
+		pc = ip->pc;
+		cobInst->Signal(r1);
+	} COB_NEXT_CHECKED();
+	COB_TARGET(SET_SIGNAL_MASK) {
+		r1 = PopDataStack();
+		signalMask = r1;
+	} COB_NEXT(1);
+
+
+	COB_TARGET(TURN) {
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+		pc = ip->pc;
+
+		cobInst->Turn(ip->a, ip->b, r1, r2);
+	} COB_NEXT_CHECKED();
+	COB_TARGET(GET) {
+		r5 = PopDataStack();
+		r4 = PopDataStack();
+		r3 = PopDataStack();
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+		if ((r1 >= LUA0) && (r1 <= LUA9)) {
+			PushDataStack(luaArgs[r1 - LUA0]);
+			COB_NEXT(1);
+		}
+		pc = ip->pc;
+		r6 = cobInst->GetUnitVal(r1, r2, r3, r4, r5);
+		PushDataStack(r6);
+	} COB_NEXT_CHECKED();
+
+	COB_TARGET(DIV) {
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+
+		if (r2 != 0) {
+			r3 = r1 / r2;
+		} else {
+			r3 = 1000; // infinity!
+			pc = ip->pc;
+			ShowError("division by zero");
+		}
+		PushDataStack(r3);
+	} COB_NEXT(1);
+	COB_TARGET(MOD) {
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+
+		if (r2 != 0) {
+			PushDataStack(r1 % r2);
+		} else {
+			PushDataStack(0);
+			pc = ip->pc;
+			ShowError("modulo division by zero");
+		}
+	} COB_NEXT(1);
+
+
+	COB_TARGET(MOVE) {
+		r4 = PopDataStack();
+		r3 = PopDataStack();
+		pc = ip->pc;
+		cobInst->Move(ip->a, ip->b, r3, r4);
+	} COB_NEXT_CHECKED();
+	COB_TARGET(MOVE_NOW) {
+		r3 = PopDataStack();
+		pc = ip->pc;
+		cobInst->MoveNow(ip->a, ip->b, r3);
+	} COB_NEXT_CHECKED();
+	COB_TARGET(TURN_NOW) {
+		r3 = PopDataStack();
+		pc = ip->pc;
+		cobInst->TurnNow(ip->a, ip->b, r3);
+	} COB_NEXT_CHECKED();
+
+
+	COB_TARGET(WAIT_TURN) {
+		pc = ip->pc;
+
+		if (cobInst->NeedsWait(CCobInstance::ATurn, ip->a, ip->b)) {
+			state = WaitTurn;
+			waitPiece = ip->a;
+			waitAxis = ip->b;
+			return true;
+		}
+	} COB_NEXT_CHECKED();
+	COB_TARGET(WAIT_MOVE) {
+		pc = ip->pc;
+
+		if (cobInst->NeedsWait(CCobInstance::AMove, ip->a, ip->b)) {
+			state = WaitMove;
+			waitPiece = ip->a;
+			waitAxis = ip->b;
+			return true;
+		}
+	} COB_NEXT_CHECKED();
+
+
+	COB_TARGET(SET) {
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+
+		if ((r1 >= LUA0) && (r1 <= LUA9)) {
+			luaArgs[r1 - LUA0] = r2;
+			COB_NEXT(1);
+		}
+
+		pc = ip->pc;
+		cobInst->SetUnitVal(r1, r2);
+	} COB_NEXT_CHECKED();
+
+
+	COB_TARGET(ATTACH) {
+		r3 = PopDataStack();
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+		pc = ip->pc;
+		cobInst->AttachUnit(r2, r1);
+	} COB_NEXT_CHECKED();
+	COB_TARGET(DROP) {
+		r1 = PopDataStack();
+		pc = ip->pc;
+		cobInst->DropUnit(r1);
+	} COB_NEXT_CHECKED();
+
+	// like bitwise ops, but only on values 1 and 0
+	COB_TARGET(LOGICAL_NOT) {
+		r1 = PopDataStack();
+		PushDataStack(int(r1 == 0));
+	} COB_NEXT(1);
+	COB_TARGET(LOGICAL_AND) {
+		r1 = PopDataStack();
+		r2 = PopDataStack();
+		PushDataStack(int(r1 && r2));
+	} COB_NEXT(1);
+	COB_TARGET(LOGICAL_OR) {
+		r1 = PopDataStack();
+		r2 = PopDataStack();
+		PushDataStack(int(r1 || r2));
+	} COB_NEXT(1);
+	COB_TARGET(LOGICAL_XOR) {
+		r1 = PopDataStack();
+		r2 = PopDataStack();
+		PushDataStack(int((!!r1) ^ (!!r2)));
+	} COB_NEXT(1);
+
+
+	COB_TARGET(HIDE) {
+		pc = ip->pc;
+		cobInst->SetVisibility(ip->a, false);
+	} COB_NEXT_CHECKED();
+
+	COB_TARGET(SHOW) {
+		int i;
+		for (i = 0; i < MAX_WEAPONS_PER_UNIT; ++i)
+			if (LocalFunctionID() == cobFile->scriptIndex[COBFN_FirePrimary + COBFN_Weapon_Funcs * i])
+				break;
+
+		pc = ip->pc;
+
+		// if true, we are in a Fire-script and should show a special flare effect
+		if (i < MAX_WEAPONS_PER_UNIT) {
+			cobInst->ShowFlare(ip->a);
+		} else {
+			cobInst->SetVisibility(ip->a, true);
+		}
+	} COB_NEXT_CHECKED();
+
+	COB_TARGET(OUT_OF_RANGE) {
+		// fetching past the end of the code threw here before it was decoded (mantis #5981)
+		pc = ip->pc;
+		(void) cobFile->code.at(pc);
+
+		state = Dead;
+		return false;
+	}
+
+	COB_TARGET(UNKNOWN) {
+		pc = ip->pc;
+
+		const char* name = cobFile->name.c_str();
+		const char* func = cobFile->scriptNames[LocalFunctionID()].c_str();
+
+		LOG_L(L_ERROR, "[COBThread::%s] unknown opcode %x (in %s:%s at %x)", __func__, ip->a, name, func, pc - 1);
+
+		state = Dead;
+		return false;
+	}
+
+	COB_DISPATCH_END()
+
+	// only reachable through the switch fallback
+	return (state != Dead);
 }
-#endif
 
+#undef COB_JUMP
+#undef COB_NEXT_CHECKED
+#undef COB_NEXT
+#undef COB_DISPATCH_END
+#undef COB_DISPATCH_BEGIN
+#undef COB_DISPATCH
+#undef COB_TARGET
+
+#else
+
+using namespace CobOpcode;
+
+#if 0
+#define GET_LONG_PC() (cobFile->code[pc++])
+#else
+// mantis #5981
+#define GET_LONG_PC() (cobFile->code.at(pc++))
+#endif
 
 bool CCobThread::Tick()
 {
@@ -488,7 +817,9 @@ bool CCobThread::Tick()
 
 				if (cobFile->scriptNames[r1].find("lua_") == 0) {
 					cobFile->code[pc - 1] = LUA_CALL;
-					LuaCall();
+					r1 = GET_LONG_PC();
+					r2 = GET_LONG_PC();
+					LuaCall(r1, r2);
 					break;
 				}
 
@@ -515,7 +846,9 @@ bool CCobThread::Tick()
 				pc = cobFile->scriptOffsets[r1];
 			} break;
 			case LUA_CALL: {
-				LuaCall();
+				r1 = GET_LONG_PC();
+				r2 = GET_LONG_PC();
+				LuaCall(r1, r2);
 			} break;
 
 
@@ -895,6 +1228,10 @@ bool CCobThread::Tick()
 	return (state != Dead);
 }
 
+#undef GET_LONG_PC
+
+#endif // COB_SWITCH_INTERPRETER
+
 void CCobThread::ShowError(const char* msg)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -913,26 +1250,24 @@ void CCobThread::ShowError(const char* msg)
 }
 
 
-void CCobThread::LuaCall()
+void CCobThread::LuaCall(int scriptId, int numArgs)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	const int r1 = GET_LONG_PC(); // script id
-	const int r2 = GET_LONG_PC(); // arg count
 
 	// setup the parameter array
 	const int size = static_cast<int>(dataStack.size());
-	const int argCount = std::min(r2, MAX_LUA_COB_ARGS);
-	const int start = std::max(0, size - r2);
+	const int argCount = std::min(numArgs, MAX_LUA_COB_ARGS);
+	const int start = std::max(0, size - numArgs);
 	const int end = std::min(size, start + argCount);
 
 	for (int a = 0, i = start; i < end; i++) {
 		luaArgs[a++] = dataStack[i];
 	}
 
-	if (r2 >= size) {
+	if (numArgs >= size) {
 		dataStack.clear();
 	} else {
-		dataStack.resize(size - r2);
+		dataStack.resize(size - numArgs);
 	}
 
 	if (!luaRules) {
@@ -941,13 +1276,13 @@ void CCobThread::LuaCall()
 	}
 
 	// check script index validity
-	if (static_cast<size_t>(r1) >= cobFile->luaScripts.size()) {
+	if (static_cast<size_t>(scriptId) >= cobFile->luaScripts.size()) {
 		luaArgs[0] = 0; // failure
 		return;
 	}
 
 	int argsCount = argCount;
-	luaRules->Cob2Lua(cobFile->luaScripts[r1], cobInst->GetUnit(), argsCount, luaArgs);
+	luaRules->Cob2Lua(cobFile->luaScripts[scriptId], cobInst->GetUnit(), argsCount, luaArgs);
 	retCode = luaArgs[0];
 }
 
@@ -105,7 +105,7 @@ protected:
 		int stackTop = -1;
 	};
 
-	void LuaCall();
+	void LuaCall(int scriptId, int numArgs);
 
 	void PushCallStack(CallInfo v) { callStack.push_back(v); }
 	void PushDataStack(int v) { dataStack.push_back(v); }
@@ -144,7 +144,6 @@ protected:
 
 	std::vector<CallInfo> callStack;
 	std::vector<int> dataStack;
-	// std::vector<int> execTrace;
 
 	State state = Init;
 
@@ -866,6 +866,10 @@ void CUnit::SetLosStatus(int at, unsigned short newStatus)
 	losStatus[at] |= newStatus;
 
 	if (diffBits) {
+		SYNC_SUBSYSTEM(SUBSYS_LOS, id);
+		SYNC_SUBSYSTEM(SUBSYS_LOS, at);
+		SYNC_SUBSYSTEM(SUBSYS_LOS, newStatus);
+
 		if (diffBits & LOS_INLOS) {
 			if (newStatus & LOS_INLOS) {
 				eventHandler.UnitEnteredLos(this, at);
@@ -898,7 +902,7 @@ void CUnit::SetLosStatus(int at, unsigned short newStatus)
 }
 
 
-unsigned short CUnit::CalcLosStatus(int at)
+unsigned short CUnit::CalcLosStatus(int at) const
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	const unsigned short currStatus = losStatus[at];
@@ -11,6 +11,7 @@
 #include "UnitTypes/Factory.h"
 
 #include "CommandAI/BuilderCAI.h"
+#include "Game/GameHelper.h"
 #include "Sim/Ecs/Registry.h"
 #include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/ModInfo.h"
@@ -223,6 +224,9 @@ bool CUnitHandler::AddUnit(CUnit* unit)
 
 	InsertActiveUnit(unit);
 
+	SYNC_SUBSYSTEM(SUBSYS_UNITS, unit->id);
+	SYNC_SUBSYSTEM(SUBSYS_UNITS, unit->pos);
+
 	teamHandler.Team(unit->team)->AddUnit(unit, CTeam::AddBuilt);
 
 	// 0 is not a valid UnitDef id, so just use unitsByDefs[team][0]
@@ -303,6 +307,8 @@ void CUnitHandler::DeleteUnit(CUnit* delUnit)
 	const int delUnitTeam = delUnit->team;
 	const int delUnitType = delUnit->unitDef->id;
 
+	SYNC_SUBSYSTEM(SUBSYS_UNITS, delUnit->id);
+
 	teamHandler.Team(delUnitTeam)->RemoveUnit(delUnit, CTeam::RemoveDied);
 
 	if (activeSlowUpdateUnit > std::distance(activeUnits.begin(), it))
@@ -339,8 +345,45 @@ void CUnitHandler::UpdateUnitMoveTypes()
 void CUnitHandler::UpdateUnitLosStates()
 {
 	ZoneScopedC(tracy::Color::Goldenrod);
-	for (CUnit* unit: activeUnits) {
-		for (int at = 0; at < teamHandler.ActiveAllyTeams(); ++at) {
+
+	if (!modInfo.unitLosStatusMT) {
+		for (CUnit* unit: activeUnits) {
+			for (int at = 0; at < teamHandler.ActiveAllyTeams(); ++at) {
+				unit->UpdateLosStatus(at);
+			}
+		}
+
+		return;
+	}
+
+	// new status of every unit for every allyteam, [unit * numAllyTeams + allyTeam]
+	static std::vector<uint8_t> losStates;
+
+	const int numUnits = activeUnits.size();
+	const int numAllyTeams = teamHandler.ActiveAllyTeams();
+
+	losStates.resize(numUnits * numAllyTeams);
+
+	// only reads the LOS and radar maps and the units' own state
+	for_mt_chunk(0, numUnits, [&](const int i) {
+		const CUnit* unit = activeUnits[i];
+
+		for (int at = 0; at < numAllyTeams; ++at) {
+			losStates[i * numAllyTeams + at] = unit->CalcLosStatus(at);
+		}
+	}, 32);
+
+	// apply in the same order as above, so the callins are also run in that order;
+	// a status that no longer matches either changed or was modified by an earlier
+	// callin and is recomputed, as is done for every unit in the serial path
+	// (units created by callins are appended and already have a valid status)
+	for (int i = 0; i < numUnits; ++i) {
+		CUnit* unit = activeUnits[i];
+
+		for (int at = 0; at < numAllyTeams; ++at) {
+			if (losStates[i * numAllyTeams + at] == unit->losStatus[at])
+				continue;
+
 			unit->UpdateLosStatus(at);
 		}
 	}
@@ -368,6 +411,10 @@ void CUnitHandler::SlowUpdateUnits()
 
 	static std::vector<CUnit*> updateBoundingVolumeList;
 	updateBoundingVolumeList.clear();
+	{
+		// no-op unless the weaponTargetAcquisitionMT modrule is set
+		helper->PrepareWeaponTargets(activeUnits, idxBeg, idxEnd);
+	}
 	{
 		ZoneScopedN("Sim::Unit::SlowUpdateST");
 		for (size_t i = idxBeg; i < idxEnd; ++i) {
@@ -381,6 +428,8 @@ void CUnitHandler::SlowUpdateUnits()
 			if (!unit->isDead && unit->localModel.GetBoundariesNeedsRecalc())
 				updateBoundingVolumeList.emplace_back(unit);
 		}
+
+		helper->ClearPreparedWeaponTargets();
 	}
 	// Since the bounding volumes are calculated from the maximum piecematrix-offset piece vertices
 	// They dont have much of an effect if updated late-ish.
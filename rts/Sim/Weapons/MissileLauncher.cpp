@@ -215,7 +215,7 @@ bool CMissileLauncher::HaveFreeLineOfFire(const float3 srcPos, const float3 tgtP
 	const bool scanForNeutrals = ((avoidFlags & Collision::NONEUTRALS) == 0);
 	const bool scanForFeatures = ((avoidFlags & Collision::NOFEATURES) == 0);
 	for (const int quadIdx : *qfQuery.quads) {
-		const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
+		const CQuadField::QuadView quad = quadField.GetQuad(quadIdx);
 
 		// friendly units in this quad
 		if (scanForAllies) {
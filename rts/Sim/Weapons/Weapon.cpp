@@ -723,7 +723,7 @@ bool CWeapon::AutoTarget()
 	//   GenerateWeaponTargets sorts by INCREASING order of priority, so lower equals better
 	//   <targetPairs> is normally sorted such that all bad TargetCategory units live at the
 	//   end, but Lua can mess with the ordering arbitrarily
-	for (size_t i = 0, n = CGameHelper::GenerateWeaponTargets(this, avoidUnit, targetPairs); i < n; i++, assert(n == targetPairs.size())) {
+	for (size_t i = 0, n = helper->GeneratePreparedWeaponTargets(this, avoidUnit, targetPairs); i < n; i++, assert(n == targetPairs.size())) {
 		CUnit* unit = targetPairs[i].second;
 
 		// save the "best" bad target in case we have no other
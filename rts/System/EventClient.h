@@ -40,6 +40,31 @@ class LuaMaterial;
 #endif
 
 
+/**
+ * Arguments of synced UnitDamaged and ProjectileCreated call-ins, buffered
+ * during a sim-frame for the batched call-ins; attacker fields are -1 if
+ * there was none and weaponDefID is -1 for piece projectiles
+ */
+struct UnitDamagedEvent {
+	int unitID;
+	int unitDefID;
+	int unitTeam;
+	float damage;
+	bool paralyzer;
+	int weaponDefID;
+	int projectileID;
+	int attackerID;
+	int attackerDefID;
+	int attackerTeam;
+};
+
+struct ProjectileCreatedEvent {
+	int projectileID;
+	int ownerID;
+	int weaponDefID;
+};
+
+
 enum DbgTimingInfoType {
 	TIMING_VIDEO,
 	TIMING_SIM,
@@ -143,6 +168,7 @@ class CEventClient
 			int weaponDefID,
 			int projectileID,
 			bool paralyzer) {}
+		virtual void UnitDamagedBatch(const std::vector<UnitDamagedEvent>& events) {}
 		virtual void UnitStunned(const CUnit* unit, bool stunned) {}
 		virtual void UnitExperience(const CUnit* unit, float oldExperience) {}
 		virtual void UnitHarvestStorageFull(const CUnit* unit) {}
@@ -192,6 +218,7 @@ class CEventClient
 		virtual void RenderFeatureDestroyed(const CFeature* feature) {}
 
 		virtual void ProjectileCreated(const CProjectile* proj) {}
+		virtual void ProjectileCreatedBatch(const std::vector<ProjectileCreatedEvent>& events) {}
 		virtual void ProjectileDestroyed(const CProjectile* proj) {}
 
 		virtual void RenderProjectileCreated(const CProjectile* proj) {}
@@ -4,6 +4,8 @@
 
 #include "Lua/LuaCallInCheck.h"
 #include "Lua/LuaOpenGL.h"  // FIXME -- should be moved
+#include "Sim/Projectiles/WeaponProjectiles/WeaponProjectile.h"
+#include "Sim/Weapons/WeaponDef.h"
 
 #include "System/Config/ConfigHandler.h"
 #include "System/Platform/Threading.h"
@@ -35,6 +37,9 @@ void CEventHandler::ResetState()
 {
 	mouseOwner = nullptr;
 
+	unitDamagedEvents.clear();
+	projectileCreatedEvents.clear();
+
 	eventMap.clear();
 	eventMap.reserve(64);
 	handles.clear();
@@ -152,6 +157,8 @@ bool CEventHandler::InsertEvent(CEventClient* ec, const std::string& ciName)
 
 	if (ec->GetSynced() && iter->second.HasPropBit(UNSYNCED_BIT))
 		return false;
+	if (!ec->GetSynced() && iter->second.HasPropBit(SYNCED_BIT))
+		return false;
 
 	ListInsert(*iter->second.GetList(), ec);
 	return true;
@@ -171,6 +178,41 @@ bool CEventHandler::RemoveEvent(CEventClient* ec, const std::string& ciName)
 }
 
 
+/******************************************************************************/
+
+void CEventHandler::AddUnitDamagedEvent(const CUnit* unit, const CUnit* attacker, float damage, int weaponDefID, int projectileID, bool paralyzer)
+{
+	UnitDamagedEvent& e = unitDamagedEvents.emplace_back();
+
+	e.unitID = unit->id;
+	e.unitDefID = unit->unitDef->id;
+	e.unitTeam = unit->team;
+	e.damage = damage;
+	e.paralyzer = paralyzer;
+	e.weaponDefID = weaponDefID;
+	e.projectileID = projectileID;
+	e.attackerID = (attacker != nullptr)? attacker->id: -1;
+	e.attackerDefID = (attacker != nullptr)? attacker->unitDef->id: -1;
+	e.attackerTeam = (attacker != nullptr)? attacker->team: -1;
+}
+
+void CEventHandler::AddProjectileCreatedEvent(const CProjectile* proj)
+{
+	// same subset as seen by synced ProjectileCreated call-ins
+	if (!proj->synced || (!proj->weapon && !proj->piece))
+		return;
+
+	const WeaponDef* wd = proj->weapon? static_cast<const CWeaponProjectile*>(proj)->GetWeaponDef(): nullptr;
+
+	if (proj->weapon && wd == nullptr)
+		return;
+
+	const CUnit* owner = proj->owner();
+
+	projectileCreatedEvents.push_back({proj->id, (owner != nullptr)? owner->id: -1, (wd != nullptr)? wd->id: -1});
+}
+
+
 /******************************************************************************/
 
 void CEventHandler::ListInsert(EventClientList& ecList, CEventClient* ec)
@@ -561,6 +603,30 @@ void CEventHandler::GameFramePost(int gameFrame)
 	ITERATE_EVENTCLIENTLIST(GameFramePost, gameFrame);
 }
 
+void CEventHandler::DeliverBatchedEvents()
+{
+	ZoneScoped;
+
+	// swap the buffers out first, call-ins can damage units or spawn projectiles
+	if (!unitDamagedEvents.empty()) {
+		unitDamagedBatch.swap(unitDamagedEvents);
+		unitDamagedEvents.clear();
+
+		ITERATE_EVENTCLIENTLIST(UnitDamagedBatch, unitDamagedBatch);
+
+		unitDamagedBatch.clear();
+	}
+
+	if (!projectileCreatedEvents.empty()) {
+		projectileCreatedBatch.swap(projectileCreatedEvents);
+		projectileCreatedEvents.clear();
+
+		ITERATE_EVENTCLIENTLIST(ProjectileCreatedBatch, projectileCreatedBatch);
+
+		projectileCreatedBatch.clear();
+	}
+}
+
 void CEventHandler::GameProgress(int gameFrame)
 {
 	ZoneScoped;
@@ -311,6 +311,14 @@ class CEventHandler
 		void DbgTimingInfo(DbgTimingInfoType type, const spring_time start, const spring_time end);
 		void Pong(uint8_t pingTag, const spring_time pktSendTime, const spring_time pktRecvTime);
 		void MetalMapChanged(const int x, const int z);
+
+		/**
+		 * Delivers the UnitDamaged and ProjectileCreated events buffered
+		 * since the last call to the synced clients of their batched
+		 * call-ins, in the order they occurred. Events raised by those
+		 * call-ins are delivered by the next call.
+		 */
+		void DeliverBatchedEvents();
 		/// @}
 
 	private:
@@ -319,7 +327,8 @@ class CEventHandler
 		enum EventPropertyBits {
 			MANAGED_BIT  = (1 << 0), // managed by eventHandler
 			UNSYNCED_BIT = (1 << 1), // delivers unsynced information
-			CONTROL_BIT  = (1 << 2)  // controls synced information
+			CONTROL_BIT  = (1 << 2), // controls synced information
+			SYNCED_BIT   = (1 << 3)  // only delivered to synced clients
 		};
 
 		class EventInfo {
@@ -349,9 +358,17 @@ class CEventHandler
 		void ListInsert(EventClientList& ciList, CEventClient* ec);
 		void ListRemove(EventClientList& ciList, CEventClient* ec);
 
+		void AddUnitDamagedEvent(const CUnit* unit, const CUnit* attacker, float damage, int weaponDefID, int projectileID, bool paralyzer);
+		void AddProjectileCreatedEvent(const CProjectile* proj);
+
 	private:
 		CEventClient* mouseOwner;
 
+		std::vector<UnitDamagedEvent> unitDamagedEvents;
+		std::vector<UnitDamagedEvent> unitDamagedBatch;
+		std::vector<ProjectileCreatedEvent> projectileCreatedEvents;
+		std::vector<ProjectileCreatedEvent> projectileCreatedBatch;
+
 	private:
 		EventMap eventMap;
 
@@ -549,6 +566,9 @@ inline void CEventHandler::UnitDamaged(
 	bool paralyzer)
 {
 	ITERATE_UNIT_ALLYTEAM_EVENTCLIENTLIST(UnitDamaged, unit, attacker, damage, weaponDefID, projectileID, paralyzer)
+
+	if (!listUnitDamagedBatch.empty())
+		AddUnitDamagedEvent(unit, attacker, damage, weaponDefID, projectileID, paralyzer);
 }
 
 inline void CEventHandler::UnitStunned(
@@ -675,6 +695,9 @@ inline void CEventHandler::ProjectileCreated(const CProjectile* proj, int allyTe
 			ec->ProjectileCreated(proj);
 		}
 	}
+
+	if (!listProjectileCreatedBatch.empty())
+		AddProjectileCreatedEvent(proj);
 }
 
 
@@ -979,8 +979,11 @@ bool CArchiveScanner::GetArchiveChecksum(const std::string& archiveName, Archive
 		// just a file, can MT
 		numParallelFileReads = isOnSpinningDisk ? NUM_PARALLEL_FILE_READS_SD : ThreadPool::GetNumThreads();
 	} break;
-	case ARCHIVE_TYPE_SDZ: [[fallthrough]]; // mutex locked, not thread safe, makes no sense to throw more threads on it
-	case ARCHIVE_TYPE_SD7: [[fallthrough]]; // mutex locked, not thread safe, makes no sense to throw more threads on it
+	case ARCHIVE_TYPE_SDZ: [[fallthrough]]; // one zip handle per concurrent reader, can MT
+	case ARCHIVE_TYPE_SD7: { // one stream per concurrent reader, solid blocks are kept on one thread below
+		auto isOnSpinningDisk = FileSystem::IsPathOnSpinningDisk(archiveName);
+		numParallelFileReads = isOnSpinningDisk ? NUM_PARALLEL_FILE_READS_SD : ThreadPool::GetNumThreads();
+	} break;
 	default: // just default to 1 thread
 		numParallelFileReads = 1;
 		break;
@@ -1015,25 +1018,51 @@ bool CArchiveScanner::GetArchiveChecksum(const std::string& archiveName, Archive
 	// sort by filename
 	std::stable_sort(fileNames.begin(), fileNames.end());
 
+	// files of the same solid block are hashed in sequence by one task
+	// so the block is only decompressed once, (block, file index) pairs
+	std::vector<std::pair<unsigned int, size_t>> blockFiles;
+	std::vector<size_t> blockBegins;
+
+	blockFiles.reserve(fileNames.size());
+
+	for (size_t i = 0; i < fileNames.size(); ++i) {
+		blockFiles.emplace_back(ar->GetSolidBlockIndex(ar->FindFile(fileNames[i])), i);
+	}
+
+	std::sort(blockFiles.begin(), blockFiles.end());
+
+	for (size_t i = 0; i < blockFiles.size(); ++i) {
+		if (i == 0 || blockFiles[i].first != blockFiles[i - 1].first)
+			blockBegins.push_back(i);
+	}
+
+	blockBegins.push_back(blockFiles.size());
+
 	std::counting_semaphore sem(numParallelFileReads);
 
-	auto ComputeHashesTask = [&ar, &fileNames, &fileHashes, &sem, this](size_t fidx) -> void {
-		const auto& fileName = fileNames[fidx];
-		auto& fileHash = fileHashes[fidx];
+	auto ComputeHashesTask = [&ar, &fileNames, &fileHashes, &blockFiles, &blockBegins, &sem, this](size_t bidx) -> void {
 		auto& fileBuffer = fileBuffers[ThreadPool::GetThreadNum()];
-		fileBuffer.clear();
 
 		sem.acquire();
-		numFilesHashed.fetch_add(static_cast<uint32_t>(ar->CalcHash(ar->FindFile(fileName), fileHash.data(), fileBuffer)));
+
+		for (size_t i = blockBegins[bidx]; i < blockBegins[bidx + 1]; ++i) {
+			const size_t fidx = blockFiles[i].second;
+			const auto& fileName = fileNames[fidx];
+			auto& fileHash = fileHashes[fidx];
+
+			fileBuffer.clear();
+			numFilesHashed.fetch_add(static_cast<uint32_t>(ar->CalcHash(ar->FindFile(fileName), fileHash.data(), fileBuffer)));
+		}
+
 		sem.release();
 	};
 
 
 #if !defined(DEDICATED) && !defined(UNITSYNC)
 	std::vector<std::shared_future<void>> tasks;
-	tasks.reserve(fileNames.size());
+	tasks.reserve(blockBegins.size() - 1);
 
-	for (size_t i = 0; i < fileNames.size(); ++i) {
+	for (size_t i = 0; i < (blockBegins.size() - 1); ++i) {
 		tasks.emplace_back(ThreadPool::Enqueue(ComputeHashesTask, i));
 	}
 
@@ -1047,7 +1076,7 @@ bool CArchiveScanner::GetArchiveChecksum(const std::string& archiveName, Archive
 		spring_sleep(spring_msecs(1));
 	}
 #else
-	for_mt(0, fileNames.size(), [&](const int i) {
+	for_mt(0, blockBegins.size() - 1, [&](const int i) {
 		ComputeHashesTask(i);
 	});
 #endif
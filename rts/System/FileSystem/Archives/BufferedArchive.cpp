@@ -20,45 +20,109 @@ bool CBufferedArchive::GetFile(unsigned int fid, std::vector<std::uint8_t>& buff
 {
 	assert(IsFileId(fid));
 
+	const bool useCache = (globalConfig.vfsCacheArchiveFiles && !noCache);
+
 	int ret = 0;
+	bool populate = false;
+
+	{
+		std::scoped_lock lck(cacheLock);
+
+		// NumFiles is virtual, can't do this in ctor
+		if (fileCache.empty() && useCache)
+			fileCache.resize(NumFiles());
+
+		if (!fileCache.empty()) {
+			FileBuffer& fb = fileCache[fid];
+
+			fb.numAccessed++;
+
+			if (fb.prefetched) {
+				fb.prefetched = false;
+				fb.populated = false;
+
+				buffer.swap(fb.data);
+				fb.data = {};
+				return fb.exists;
+			}
 
-	if (!globalConfig.vfsCacheArchiveFiles || noCache) {
-		if ((ret = GetFileImpl(fid, buffer)) != 1)
+			if (useCache) {
+				if (fb.populated) {
+					if (!fb.exists) {
+						LOG_L(L_WARNING, "[BufferedArchive::%s(fid=%u)][!fb.exists] name=%s size=" _STPF_, __func__, fid, archiveFile.c_str(), fb.data.size());
+						return false;
+					}
+
+					// TODO: zero-copy access
+					buffer.assign(fb.data.begin(), fb.data.end());
+					return true;
+				}
+
+				// most files are only accessed once, don't bother with those
+				populate = (fb.numAccessed > 1);
+			}
+		}
+	}
+
+	// extract without holding the lock so other threads can do the same
+	const bool exists = ((ret = GetFileImpl(fid, buffer)) == 1);
+
+	if (!useCache) {
+		if (!exists)
 			LOG_L(L_WARNING, "[BufferedArchive::%s(fid=%u)][noCache=%d,vfsCache=%d] name=%s ret=%d size=" _STPF_, __func__, fid, static_cast<int>(noCache), static_cast<int>(globalConfig.vfsCacheArchiveFiles), archiveFile.c_str(), ret, buffer.size());
 
-		return (ret == 1);
+		return exists;
 	}
 
-	// NumFiles is virtual, can't do this in ctor
-	if (fileCache.empty())
-		fileCache.resize(NumFiles());
+	if (!populate)
+		return exists;
 
-	FileBuffer& fb = fileCache.at(fid);
+	std::scoped_lock lck(cacheLock);
+	FileBuffer& fb = fileCache[fid];
 
-	fb.numAccessed++;
 	if (!fb.populated) {
-		if (fb.numAccessed > 1) {
-			fb.exists = ((ret = GetFileImpl(fid, fb.data)) == 1);
-			fb.populated = true;
+		fb.exists = exists;
+		fb.populated = true;
 
-			cacheSize += fb.data.size();
-			fileCount += fb.exists;
-		}
-		else { // most files are only accessed once, don't bother with those
-			ret = GetFileImpl(fid, buffer);
-			return (ret == 1);
-		}
+		if (exists)
+			fb.data.assign(buffer.begin(), buffer.end());
+
+		cacheSize += fb.data.size();
+		fileCount += fb.exists;
 	}
 
-	if (!fb.exists) {
+	if (!exists)
 		LOG_L(L_WARNING, "[BufferedArchive::%s(fid=%u)][!fb.exists] name=%s ret=%d size=" _STPF_, __func__, fid, archiveFile.c_str(), ret, fb.data.size());
-		return false;
+
+	return exists;
+}
+
+void CBufferedArchive::PrefetchFile(unsigned int fid)
+{
+	assert(IsFileId(fid));
+
+	{
+		std::scoped_lock lck(cacheLock);
+
+		if (fileCache.empty())
+			fileCache.resize(NumFiles());
+
+		if (fileCache[fid].populated)
+			return;
 	}
 
-	if (buffer.size() != fb.data.size())
-		buffer.resize(fb.data.size());
+	std::vector<std::uint8_t> buffer;
+	const bool exists = (GetFileImpl(fid, buffer) == 1);
+
+	std::scoped_lock lck(cacheLock);
+	FileBuffer& fb = fileCache[fid];
+
+	// read or prefetched by another thread in the meantime
+	if (fb.populated)
+		return;
 
-	// TODO: zero-copy access
-	std::copy(fb.data.begin(), fb.data.end(), buffer.begin());
-	return true;
+	fb.exists = exists;
+	fb.populated = true;
+	fb.prefetched = true;
+	fb.data = std::move(buffer);
 }
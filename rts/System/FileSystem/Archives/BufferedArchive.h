@@ -7,8 +7,9 @@
 #include "System/Threading/SpringThreading.h"
 
 /**
- * Provides a helper implementation for archive types that can only uncompress
- * one file to memory at a time.
+ * Provides a helper implementation for archive types that uncompress whole
+ * files to memory. GetFileImpl must support concurrent calls, the cache is
+ * guarded here.
  */
 class CBufferedArchive : public IArchive
 {
@@ -22,6 +23,7 @@ public:
 	virtual int GetType() const override { return ARCHIVE_TYPE_BUF; }
 
 	bool GetFile(unsigned int fid, std::vector<std::uint8_t>& buffer) override;
+	void PrefetchFile(unsigned int fid) override;
 
 protected:
 	virtual int GetFileImpl(unsigned int fid, std::vector<std::uint8_t>& buffer) = 0;
@@ -36,6 +38,7 @@ protected:
 
 		uint32_t numAccessed = 0;
 		bool populated = false; // files may be empty (0 bytes)
+		bool prefetched = false; // released after the first read
 		bool exists = false;
 
 		std::vector<std::uint8_t> data;
@@ -44,6 +47,8 @@ protected:
 	// indexed by file-id
 	std::vector<FileBuffer> fileCache;
 private:
+	spring::mutex cacheLock;
+
 	uint32_t cacheSize = 0;
 	uint32_t fileCount = 0;
 
@@ -121,6 +121,19 @@ public:
 	 * @return true if archive type can be packed solid (which is VERY slow when reading)
 	 */
 	virtual bool CheckForSolid() const { return false; }
+	/**
+	 * Returns the index of the (solid) block a file is compressed in. Files
+	 * of the same block are cheapest to read in sequence by a single thread.
+	 * Archives without solid blocks return the file ID itself.
+	 */
+	virtual unsigned int GetSolidBlockIndex(unsigned int fid) const { return fid; }
+
+	/**
+	 * Decompresses a file ahead of the GetFile call for it, can be called
+	 * from multiple threads at once. A prefetched file is kept in memory
+	 * until it has been read once.
+	 */
+	virtual void PrefetchFile(unsigned int fid) {}
 	/**
 	 * Fetches the (SHA512) hash of a file by its ID.
 	 */
@@ -73,7 +73,6 @@ static std::optional<std::string> GetFileName(const CSzArEx* db, int i)
 	uint16_t utf16Buffer[bufferSize];
 	char tempBuffer[bufferSize];
 
-	// caller has archiveLock
 	const size_t utf16len = SzArEx_GetFileNameUtf16(db, i, nullptr);
 	if (utf16len >= bufferSize)
 		return std::nullopt;
@@ -115,19 +114,14 @@ static inline const char* GetErrorStr(int err)
 	return "Unknown error";
 }
 
-CSevenZipArchive::CSevenZipArchive(const std::string& name)
-	: CBufferedArchive(name, false)
-	, allocImp({SzAlloc, SzFree})
-	, allocTempImp({SzAllocTemp, SzFreeTemp})
+bool CSevenZipArchive::Reader::Open(const std::string& name, ISzAlloc* allocImp)
 {
-	std::scoped_lock lck(archiveLock);
-
 	constexpr const size_t kInputBufSize = (size_t)1 << 18;
 
 	const WRes wres = InFile_Open(&archiveStream.file, name.c_str());
 	if (wres) {
 		LOG_L(L_ERROR, "[%s] error opening \"%s\": %s (%i)", __func__, name.c_str(), Platform::GetLastErrorAsString(wres).c_str(), (int)wres);
-		return;
+		return false;
 	}
 
 	FileInStream_CreateVTable(&archiveStream);
@@ -135,16 +129,48 @@ CSevenZipArchive::CSevenZipArchive(const std::string& name)
 
 	LookToRead2_CreateVTable(&lookStream, false);
 	lookStream.realStream = &archiveStream.vt;
-	lookStream.buf = static_cast<Byte*>(ISzAlloc_Alloc(&allocImp, kInputBufSize));
+	lookStream.buf = static_cast<Byte*>(ISzAlloc_Alloc(allocImp, kInputBufSize));
 	assert(lookStream.buf != NULL);
 	lookStream.bufSize = kInputBufSize;
 	LookToRead2_Init(&lookStream);
+	return true;
+}
 
-	CRC::InitTable();
+void CSevenZipArchive::Reader::Close(ISzAlloc* allocImp)
+{
+	if (outBuffer != nullptr)
+		IAlloc_Free(allocImp, outBuffer);
+
+	ISzAlloc_Free(allocImp, lookStream.buf);
+	File_Close(&archiveStream.file);
+}
+
+
+CSevenZipArchive::CSevenZipArchive(const std::string& name)
+	: CBufferedArchive(name, false)
+	, allocImp({SzAlloc, SzFree})
+	, allocTempImp({SzAllocTemp, SzFreeTemp})
+{
+	{
+		// archives can be opened concurrently (e.g. by the scanner)
+		static spring::mutex crcTableLock;
+		std::scoped_lock lck(crcTableLock);
+		CRC::InitTable();
+	}
 
 	SzArEx_Init(&db);
 
-	const SRes res = SzArEx_Open(&db, &lookStream.vt, &allocImp, &allocTempImp);
+	// the reader used to parse the database serves the first extraction
+	Reader* reader = readers.emplace_back(std::make_unique<Reader>()).get();
+
+	if (!reader->Open(name, &allocImp)) {
+		readers.clear();
+		return;
+	}
+
+	spareReaders.push_back(reader);
+
+	const SRes res = SzArEx_Open(&db, &reader->lookStream.vt, &allocImp, &allocTempImp);
 	if (res == SZ_OK) {
 		isOpen = true;
 	} else {
@@ -179,34 +205,89 @@ CSevenZipArchive::CSevenZipArchive(const std::string& name)
 
 CSevenZipArchive::~CSevenZipArchive()
 {
-	std::scoped_lock lck(archiveLock);
+	std::scoped_lock lck(readerLock);
 
-	if (outBuffer != nullptr) {
-		IAlloc_Free(&allocImp, outBuffer);
-	}
-	if (isOpen) {
-		File_Close(&archiveStream.file);
+	// all extractions must have finished by now
+	assert(spareReaders.size() == readers.size());
+
+	for (const auto& reader: readers) {
+		reader->Close(&allocImp);
 	}
-	ISzAlloc_Free(&allocImp, lookStream.buf);
+
+	readers.clear();
+	spareReaders.clear();
+
 	SzArEx_Free(&db, &allocImp);
 }
 
+
+CSevenZipArchive::Reader* CSevenZipArchive::AcquireReader(UInt32 blockIndex)
+{
+	{
+		std::scoped_lock lck(readerLock);
+
+		if (!spareReaders.empty()) {
+			// prefer the reader that already holds the block, solid
+			// blocks are expensive to decompress and often large
+			const auto pred = [&](const Reader* r) { return (r->blockIndex == blockIndex); };
+			const auto iter = std::find_if(spareReaders.begin(), spareReaders.end(), pred);
+			const auto last = spareReaders.end() - 1;
+
+			if (iter != spareReaders.end())
+				std::iter_swap(iter, last);
+
+			Reader* reader = *last;
+			spareReaders.pop_back();
+			return reader;
+		}
+	}
+
+	auto reader = std::make_unique<Reader>();
+
+	if (!reader->Open(archiveFile, &allocImp))
+		return nullptr;
+
+	std::scoped_lock lck(readerLock);
+	return (readers.emplace_back(std::move(reader)).get());
+}
+
+void CSevenZipArchive::ReleaseReader(Reader* reader)
+{
+	std::scoped_lock lck(readerLock);
+	spareReaders.push_back(reader);
+}
+
+
+unsigned int CSevenZipArchive::GetSolidBlockIndex(unsigned int fid) const
+{
+	assert(IsFileId(fid));
+	return db.FileToFolder[fileEntries[fid].fp];
+}
+
 int CSevenZipArchive::GetFileImpl(unsigned int fid, std::vector<std::uint8_t>& buffer)
 {
-	std::scoped_lock lck(archiveLock);
 	assert(IsFileId(fid));
 
+	Reader* reader = AcquireReader(GetSolidBlockIndex(fid));
+
+	if (reader == nullptr)
+		return 0;
+
 	size_t offset = 0;
 	size_t outSizeProcessed = 0;
 
-	if (SzArEx_Extract(&db, &lookStream.vt, fileEntries[fid].fp, &blockIndex, &outBuffer,
-	                   &outBufferSize, &offset, &outSizeProcessed, &allocImp, &allocTempImp) != SZ_OK)
+	if (SzArEx_Extract(&db, &reader->lookStream.vt, fileEntries[fid].fp, &reader->blockIndex, &reader->outBuffer,
+	                   &reader->outBufferSize, &offset, &outSizeProcessed, &allocImp, &allocTempImp) != SZ_OK) {
+		ReleaseReader(reader);
 		return 0;
+	}
 
 	buffer.resize(outSizeProcessed);
 	if (outSizeProcessed > 0) {
-		memcpy(buffer.data(), reinterpret_cast<char*>(outBuffer) + offset, outSizeProcessed);
+		memcpy(buffer.data(), reinterpret_cast<char*>(reader->outBuffer) + offset, outSizeProcessed);
 	}
+
+	ReleaseReader(reader);
 	return 1;
 }
 
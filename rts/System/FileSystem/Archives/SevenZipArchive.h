@@ -8,6 +8,7 @@
 
 #include "IArchiveFactory.h"
 #include "BufferedArchive.h"
+#include <memory>
 #include <vector>
 #include <string>
 #include "IArchive.h"
@@ -42,8 +43,32 @@ public:
 	int GetFileImpl(unsigned int fid, std::vector<std::uint8_t>& buffer) override;
 	void FileInfo(unsigned int fid, std::string& name, int& size) const override;
 
+	unsigned int GetSolidBlockIndex(unsigned int fid) const override;
+
+private:
+	/**
+	 * Independent stream over the archive file plus the last block it
+	 * decompressed, the parsed archive database itself is only read
+	 * during extraction and shared by all readers.
+	 */
+	struct Reader {
+		bool Open(const std::string& name, ISzAlloc* allocImp);
+		void Close(ISzAlloc* allocImp);
+
+		UInt32 blockIndex = 0xFFFFFFFF;
+		size_t outBufferSize = 0;
+		Byte* outBuffer = nullptr;
+
+		CFileInStream archiveStream;
+		CLookToRead2 lookStream;
+	};
+
+	Reader* AcquireReader(UInt32 blockIndex);
+	void ReleaseReader(Reader* reader);
+
 private:
-	static inline spring::mutex archiveLock;
+	// guards <readers> and <spareReaders>, blocks are extracted without holding it
+	spring::mutex readerLock;
 
 	// actual data is in BufferedArchive
 	struct FileEntry {
@@ -57,13 +82,11 @@ private:
 
 	std::vector<FileEntry> fileEntries;
 
-	UInt32 blockIndex = 0xFFFFFFFF;
-	size_t outBufferSize = 0;
-	Byte* outBuffer = nullptr;
+	// readers point into themselves (lookStream -> archiveStream), hence by pointer
+	std::vector<std::unique_ptr<Reader>> readers;
+	std::vector<Reader*> spareReaders;
 
-	CFileInStream archiveStream;
 	CSzArEx db;
-	CLookToRead2 lookStream;
 	ISzAlloc allocImp;
 	ISzAlloc allocTempImp;
 
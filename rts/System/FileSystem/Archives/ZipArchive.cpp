@@ -19,8 +19,6 @@ IArchive* CZipArchiveFactory::DoCreateArchive(const std::string& filePath) const
 
 CZipArchive::CZipArchive(const std::string& archiveName): CBufferedArchive(archiveName)
 {
-	std::scoped_lock lck(archiveLock);
-
 	if ((zip = unzOpen(archiveName.c_str())) == nullptr) {
 		LOG_L(L_ERROR, "[%s] error opening \"%s\"", __func__, archiveName.c_str());
 		return;
@@ -59,16 +57,56 @@ CZipArchive::CZipArchive(const std::string& archiveName): CBufferedArchive(archi
 		lcNameIndex.emplace(StringToLower(fd.origName), fileEntries.size());
 		fileEntries.emplace_back(std::move(fd));
 	}
+
+	// the handle used for indexing serves the first extraction
+	spareHandles.push_back(zip);
+	numHandles = 1;
 }
 
 CZipArchive::~CZipArchive()
 {
-	std::scoped_lock lck(archiveLock);
+	std::scoped_lock lck(handleLock);
+
+	// all extractions must have finished by now
+	assert(spareHandles.size() == numHandles);
 
-	if (zip != nullptr) {
-		unzClose(zip);
-		zip = nullptr;
+	for (unzFile handle: spareHandles) {
+		unzClose(handle);
 	}
+
+	spareHandles.clear();
+	zip = nullptr;
+}
+
+
+unzFile CZipArchive::AcquireHandle()
+{
+	{
+		std::scoped_lock lck(handleLock);
+
+		if (!spareHandles.empty()) {
+			unzFile handle = spareHandles.back();
+			spareHandles.pop_back();
+			return handle;
+		}
+	}
+
+	// every concurrent caller gets its own handle, the directory
+	// is parsed again but that is cheap compared to inflating
+	unzFile handle = unzOpen(archiveFile.c_str());
+
+	if (handle != nullptr) {
+		std::scoped_lock lck(handleLock);
+		numHandles += 1;
+	}
+
+	return handle;
+}
+
+void CZipArchive::ReleaseHandle(unzFile handle)
+{
+	std::scoped_lock lck(handleLock);
+	spareHandles.push_back(handle);
 }
 
 
@@ -82,40 +120,45 @@ void CZipArchive::FileInfo(unsigned int fid, std::string& name, int& size) const
 
 
 // To simplify things, files are always read completely into memory from
-// the zip-file, since zlib does not provide any way of reading more
-// than one file at a time
+// the zip-file, since zlib does not provide any way of reading more than
+// one file at a time per handle; concurrent reads use separate handles
 int CZipArchive::GetFileImpl(unsigned int fid, std::vector<std::uint8_t>& buffer)
 {
-	std::scoped_lock lck(archiveLock);
-
 	// Prevent opening files on missing/invalid archives
 	if (zip == nullptr)
 		return -4;
 
-	// assert(archiveLock.locked());
 	assert(IsFileId(fid));
 
-	unzGoToFilePos(zip, &fileEntries[fid].fp);
+	unzFile handle = AcquireHandle();
+
+	if (handle == nullptr)
+		return -4;
+
+	unzGoToFilePos(handle, &fileEntries[fid].fp);
 
 	unz_file_info fi;
-	unzGetCurrentFileInfo(zip, &fi, nullptr, 0, nullptr, 0, nullptr, 0);
+	unzGetCurrentFileInfo(handle, &fi, nullptr, 0, nullptr, 0, nullptr, 0);
 
-	if (unzOpenCurrentFile(zip) != UNZ_OK)
+	if (unzOpenCurrentFile(handle) != UNZ_OK) {
+		ReleaseHandle(handle);
 		return -3;
+	}
 
 	buffer.clear();
 	buffer.resize(fi.uncompressed_size);
 
 	int ret = 1;
 
-	if (!buffer.empty() && unzReadCurrentFile(zip, buffer.data(), buffer.size()) != buffer.size())
+	if (!buffer.empty() && unzReadCurrentFile(handle, buffer.data(), buffer.size()) != buffer.size())
 		ret -= 2;
-	if (unzCloseCurrentFile(zip) == UNZ_CRCERROR)
+	if (unzCloseCurrentFile(handle) == UNZ_CRCERROR)
 		ret -= 1;
 
+	ReleaseHandle(handle);
+
 	if (ret != 1)
 		buffer.clear();
 
 	return ret;
 }
-
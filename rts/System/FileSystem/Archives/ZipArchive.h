@@ -48,10 +48,20 @@ public:
 	#endif
 
 private:
-	static inline spring::mutex archiveLock;
+	unzFile AcquireHandle();
+	void ReleaseHandle(unzFile handle);
+
+private:
+	// guards <spareHandles>, files are extracted without holding it
+	spring::mutex handleLock;
 
 	unzFile zip;
 
+	// additional handles to the same file for concurrent GetFileImpl
+	// calls, each with its own decompression state; opened on demand
+	std::vector<unzFile> spareHandles;
+	size_t numHandles = 0;
+
 	// actual data is in BufferedArchive
 	struct FileEntry {
 		unz_file_pos fp;
@@ -3,6 +3,7 @@
 
 #include "FileHandler.h"
 
+#include <array>
 #include <string>
 #include <vector>
 #include <fstream>
@@ -166,6 +167,39 @@ bool CFileHandler::FileExists(const std::string& filePath, const std::string& mo
 }
 
 
+void CFileHandler::PrefetchFiles(const std::vector<std::string>& filePaths, const std::string& modes)
+{
+#ifndef TOOLS
+	if (vfsHandler == nullptr)
+		return;
+
+	std::array<std::vector<std::string>, CVFSHandler::Section::Count> sectionFiles;
+
+	// only files that Open would find in the VFS, in the same order
+	for (const std::string& filePath: filePaths) {
+		for (char c: modes) {
+			const CVFSHandler::Section section = CVFSHandler::GetModeSection(c);
+
+			if ((section != CVFSHandler::Section::Error) && vfsHandler->FileExists(filePath, section) == 1) {
+				sectionFiles[section].push_back(filePath);
+				break;
+			}
+
+			if ((c == SPRING_VFS_RAW[0]) && FileSystem::FileExists(dataDirsAccess.LocateFile(filePath)))
+				break;
+		}
+	}
+
+	for (size_t section = 0; section < sectionFiles.size(); ++section) {
+		if (sectionFiles[section].empty())
+			continue;
+
+		vfsHandler->PrefetchFiles(sectionFiles[section], CVFSHandler::Section(section));
+	}
+#endif
+}
+
+
 int CFileHandler::Read(void* buf, int length)
 {
 	if (ifs.is_open()) {
@@ -35,6 +35,8 @@ public:
 	void Seek(int pos, std::ios_base::seekdir where = std::ios_base::beg);
 
 	static bool FileExists(const std::string& filePath, const std::string& modes);
+	// decompresses the VFS files among <filePaths> ahead of opening them
+	static void PrefetchFiles(const std::vector<std::string>& filePaths, const std::string& modes);
 	// true if any of TryReadFrom{RawFS,PWD,VFS} succeed
 	bool FileExists() const { return (fileSize >= 0); }
 	// true if (and only if) TryReadFromVFS succeeds
@@ -0,0 +1,135 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifndef _WIN32
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#else
+	#include <windows.h>
+#endif
+
+#include "System/Misc/TracyDefs.h"
+
+
+CMappedFile& CMappedFile::operator = (CMappedFile&& mf) noexcept
+{
+	if (this == &mf)
+		return *this;
+
+	Close();
+
+	std::swap(data, mf.data);
+	std::swap(size, mf.size);
+
+	#ifdef _WIN32
+	std::swap(fileHandle, mf.fileHandle);
+	std::swap(mapHandle, mf.mapHandle);
+	#else
+	std::swap(fileDesc, mf.fileDesc);
+	#endif
+
+	return *this;
+}
+
+
+#ifndef _WIN32
+
+bool CMappedFile::Open(const std::string& filePath)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	Close();
+
+	if ((fileDesc = open(filePath.c_str(), O_RDONLY)) < 0)
+		return false;
+
+	struct stat info;
+
+	// an empty file can not be mapped
+	if (fstat(fileDesc, &info) != 0 || info.st_size <= 0) {
+		Close();
+		return false;
+	}
+
+	void* view = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fileDesc, 0);
+
+	if (view == MAP_FAILED) {
+		Close();
+		return false;
+	}
+
+	data = static_cast<const std::uint8_t*>(view);
+	size = info.st_size;
+	return true;
+}
+
+void CMappedFile::Close()
+{
+	if (data != nullptr)
+		munmap(const_cast<std::uint8_t*>(data), size);
+	if (fileDesc >= 0)
+		close(fileDesc);
+
+	data = nullptr;
+	size = 0;
+	fileDesc = -1;
+}
+
+#else
+
+bool CMappedFile::Open(const std::string& filePath)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	Close();
+
+	HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	fileHandle = file;
+
+	LARGE_INTEGER fileSize;
+
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0) {
+		Close();
+		return false;
+	}
+
+	if ((mapHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr)) == nullptr) {
+		Close();
+		return false;
+	}
+
+	const void* view = MapViewOfFile(mapHandle, FILE_MAP_READ, 0, 0, 0);
+
+	if (view == nullptr) {
+		Close();
+		return false;
+	}
+
+	data = static_cast<const std::uint8_t*>(view);
+	size = static_cast<size_t>(fileSize.QuadPart);
+	return true;
+}
+
+void CMappedFile::Close()
+{
+	if (data != nullptr)
+		UnmapViewOfFile(data);
+	if (mapHandle != nullptr)
+		CloseHandle(mapHandle);
+	if (fileHandle != nullptr)
+		CloseHandle(fileHandle);
+
+	data = nullptr;
+	size = 0;
+	mapHandle = nullptr;
+	fileHandle = nullptr;
+}
+
+#endif
@@ -0,0 +1,47 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _MAPPED_FILE_H
+#define _MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Read-only memory-mapped view of a file on the raw filesystem.
+ * The whole file is mapped; the view stays valid until Close()
+ * is called or the object is destroyed.
+ */
+class CMappedFile
+{
+public:
+	CMappedFile() = default;
+	CMappedFile(const std::string& filePath) { Open(filePath); }
+	CMappedFile(const CMappedFile&) = delete;
+	CMappedFile(CMappedFile&& mf) noexcept { *this = std::move(mf); }
+	~CMappedFile() { Close(); }
+
+	CMappedFile& operator = (const CMappedFile&) = delete;
+	CMappedFile& operator = (CMappedFile&& mf) noexcept;
+
+	bool Open(const std::string& filePath);
+	void Close();
+
+	bool IsOpen() const { return (data != nullptr); }
+
+	const std::uint8_t* GetData() const { return data; }
+	size_t GetSize() const { return size; }
+
+private:
+	const std::uint8_t* data = nullptr;
+	size_t size = 0;
+
+	#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mapHandle = nullptr;
+	#else
+	int fileDesc = -1;
+	#endif
+};
+
+#endif // _MAPPED_FILE_H
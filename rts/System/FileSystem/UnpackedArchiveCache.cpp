@@ -0,0 +1,346 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "UnpackedArchiveCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "ArchiveScanner.h"
+#include "DataDirsAccess.h"
+#include "FileQueryFlags.h"
+#include "FileSystem.h"
+#include "MappedFile.h"
+#include "Archives/BufferedArchive.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/Log/ILog.h"
+#include "System/StringUtil.h"
+
+
+CONFIG(bool, VFSUnpackedArchiveCache).defaultValue(false).safemodeValue(false).description("Keep the files extracted from compressed archives in the cache directory and memory-map them on later loads of the same archive instead of decompressing them again.");
+
+
+static constexpr std::uint32_t UNPACKED_INDEX_VERSION = 1;
+static constexpr char UNPACKED_INDEX_MAGIC[8] = "SPRUAIX";
+
+// smaller files decompress faster than a blob can be opened and mapped
+static constexpr std::uint64_t MIN_CACHED_FILE_SIZE = 4096;
+
+struct UnpackedIndexHeader {
+	char magic[sizeof(UNPACKED_INDEX_MAGIC)];
+	std::uint32_t version;
+	std::uint32_t numFiles;
+};
+
+// followed by the file name
+struct UnpackedIndexEntry {
+	sha512::raw_digest hash;
+	std::uint64_t size;
+	std::uint64_t nameSize;
+};
+
+
+static void WriteTempFile(const std::string& filePath, const std::string& tempFilePath, const auto& writeFunc)
+{
+	{
+		// write to a temporary first so concurrent readers never see a partial file
+		std::ofstream file(tempFilePath, std::ios::binary | std::ios::trunc);
+
+		writeFunc(file);
+
+		if (!file.good()) {
+			file.close();
+			FileSystem::Remove(tempFilePath);
+			return;
+		}
+	}
+
+	if (std::rename(tempFilePath.c_str(), filePath.c_str()) != 0)
+		FileSystem::Remove(tempFilePath);
+}
+
+
+
+CUnpackedArchiveCache::CUnpackedArchiveCache()
+{
+	if (configHandler == nullptr)
+		return;
+
+	enabled = configHandler->GetBool("VFSUnpackedArchiveCache");
+}
+
+
+void CUnpackedArchiveCache::Clear()
+{
+	std::lock_guard<decltype(mutex)> lck(mutex);
+
+	for (const auto& pair: archives) {
+		if (pair.second.dirty)
+			WriteIndex(pair.first, pair.second);
+	}
+
+	archives.clear();
+}
+
+void CUnpackedArchiveCache::RemoveArchive(const IArchive* ar)
+{
+	std::lock_guard<decltype(mutex)> lck(mutex);
+
+	const auto iter = archives.find(ar);
+
+	if (iter == archives.end())
+		return;
+
+	if (iter->second.dirty)
+		WriteIndex(iter->first, iter->second);
+
+	archives.erase(iter);
+}
+
+
+CUnpackedArchiveCache::CachedArchive* CUnpackedArchiveCache::GetArchive(const IArchive* ar)
+{
+	const auto iter = archives.find(ar);
+
+	if (iter != archives.end())
+		return &iter->second;
+
+	CachedArchive& ca = archives[ar];
+
+	// directory archives are not compressed
+	if (dynamic_cast<const CBufferedArchive*>(ar) == nullptr)
+		return &ca;
+
+	if (cacheDir.empty()) {
+		const std::string sep(1, FileSystem::GetNativePathSeparator());
+		const std::string dir = FileSystem::GetCacheDir() + sep + "unpacked" + sep;
+
+		cacheDir = dataDirsAccess.LocateDir(dir, FileQueryFlags::WRITE | FileQueryFlags::CREATE_DIRS);
+	}
+
+	// computed once per archive version, stored by the scanner afterwards
+	const sha512::raw_digest checksum = archiveScanner->GetArchiveSingleChecksumBytes(ar->GetArchiveFile());
+
+	if (checksum == sha512::raw_digest{})
+		return &ca;
+
+	sha512::hex_digest hexChecksum;
+	sha512::dump_digest(checksum, hexChecksum);
+
+	ca.indexFilePath = cacheDir + hexChecksum.data() + ".idx";
+	ca.files.resize(ar->NumFiles());
+
+	ReadIndex(ar, ca);
+	return &ca;
+}
+
+std::string CUnpackedArchiveCache::GetBlobFilePath(const sha512::raw_digest& hash) const
+{
+	sha512::hex_digest hexHash;
+	sha512::dump_digest(hash, hexHash);
+
+	return (cacheDir + hexHash.data() + ".bin");
+}
+
+
+bool CUnpackedArchiveCache::HasFile(const IArchive* ar, unsigned int fid)
+{
+	if (!enabled)
+		return false;
+
+	std::lock_guard<decltype(mutex)> lck(mutex);
+
+	const CachedArchive* ca = GetArchive(ar);
+	return (fid < ca->files.size() && ca->files[fid].valid);
+}
+
+bool CUnpackedArchiveCache::GetFile(const IArchive* ar, unsigned int fid, std::vector<std::uint8_t>& buffer)
+{
+	if (!enabled)
+		return false;
+
+	CachedFile cf;
+
+	{
+		std::lock_guard<decltype(mutex)> lck(mutex);
+
+		const CachedArchive* ca = GetArchive(ar);
+
+		if (fid >= ca->files.size() || !ca->files[fid].valid)
+			return false;
+
+		cf = ca->files[fid];
+	}
+
+	const std::string blobFilePath = GetBlobFilePath(cf.hash);
+
+	CMappedFile blobFile(blobFilePath);
+
+	// blobs are shared between instances and archives, never trust one that does not match its name
+	const auto IsBlobValid = [&]() {
+		if (!blobFile.IsOpen() || blobFile.GetSize() != cf.size)
+			return false;
+
+		sha512::raw_digest blobHash;
+		sha512::calc_digest(blobFile.GetData(), blobFile.GetSize(), blobHash.data());
+		return (blobHash == cf.hash);
+	};
+
+	if (!IsBlobValid()) {
+		LOG_L(L_WARNING, "[UnpackedArchiveCache::%s] discarding cached file \"%s\" of \"%s\"", __func__, blobFilePath.c_str(), ar->GetArchiveFile().c_str());
+
+		blobFile.Close();
+		FileSystem::Remove(blobFilePath);
+
+		std::lock_guard<decltype(mutex)> lck(mutex);
+		CachedArchive* ca = GetArchive(ar);
+
+		ca->files[fid].valid = false;
+		ca->dirty = true;
+		return false;
+	}
+
+	buffer.assign(blobFile.GetData(), blobFile.GetData() + blobFile.GetSize());
+	return true;
+}
+
+void CUnpackedArchiveCache::AddFile(const IArchive* ar, unsigned int fid, const std::vector<std::uint8_t>& buffer)
+{
+	if (!enabled || buffer.size() < MIN_CACHED_FILE_SIZE)
+		return;
+
+	{
+		std::lock_guard<decltype(mutex)> lck(mutex);
+
+		const CachedArchive* ca = GetArchive(ar);
+
+		if (fid >= ca->files.size() || ca->files[fid].valid)
+			return;
+	}
+
+	CachedFile cf;
+	cf.size = buffer.size();
+	cf.valid = true;
+
+	sha512::calc_digest(buffer.data(), buffer.size(), cf.hash.data());
+
+	const std::string blobFilePath = GetBlobFilePath(cf.hash);
+
+	// identical contents might already be stored for another archive
+	if (FileSystem::GetFileSize(blobFilePath) != buffer.size()) {
+		WriteTempFile(blobFilePath, blobFilePath + ".tmp", [&](std::ofstream& file) {
+			file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+		});
+
+		if (FileSystem::GetFileSize(blobFilePath) != buffer.size())
+			return;
+	}
+
+	std::lock_guard<decltype(mutex)> lck(mutex);
+	CachedArchive* ca = GetArchive(ar);
+
+	ca->files[fid] = cf;
+	ca->dirty = true;
+}
+
+
+bool CUnpackedArchiveCache::ReadIndex(const IArchive* ar, CachedArchive& ca) const
+{
+	if (!FileSystem::FileExists(ca.indexFilePath))
+		return false;
+
+	CMappedFile indexFile(ca.indexFilePath);
+
+	auto rejectIndexFile = [&](const char* reason) {
+		LOG_L(L_WARNING, "[UnpackedArchiveCache::%s] discarding index \"%s\" of \"%s\" (%s)", __func__, ca.indexFilePath.c_str(), ar->GetArchiveFile().c_str(), reason);
+
+		for (CachedFile& cf: ca.files) {
+			cf.valid = false;
+		}
+
+		indexFile.Close();
+		FileSystem::Remove(ca.indexFilePath);
+		return false;
+	};
+
+	if (!indexFile.IsOpen())
+		return false;
+
+	const std::uint8_t* fileData = indexFile.GetData();
+	const size_t fileSize = indexFile.GetSize();
+
+	UnpackedIndexHeader header;
+
+	if (fileSize < sizeof(header))
+		return (rejectIndexFile("truncated header"));
+
+	std::memcpy(&header, fileData, sizeof(header));
+
+	if (std::memcmp(header.magic, UNPACKED_INDEX_MAGIC, sizeof(header.magic)) != 0 || header.version != UNPACKED_INDEX_VERSION)
+		return (rejectIndexFile("version mismatch"));
+
+	size_t offset = sizeof(header);
+
+	for (std::uint32_t n = 0; n < header.numFiles; n++) {
+		UnpackedIndexEntry entry;
+
+		if ((fileSize - offset) < sizeof(entry))
+			return (rejectIndexFile("truncated entry"));
+
+		std::memcpy(&entry, fileData + offset, sizeof(entry));
+		offset += sizeof(entry);
+
+		if ((fileSize - offset) < entry.nameSize)
+			return (rejectIndexFile("truncated entry"));
+
+		const std::string fileName(reinterpret_cast<const char*>(fileData + offset), entry.nameSize);
+		const unsigned int fid = ar->FindFile(fileName);
+
+		offset += entry.nameSize;
+
+		// same checksum implies same contents, so this means the index is broken
+		if (fid >= ca.files.size() || entry.size != std::uint64_t(ar->FileInfo(fid).second))
+			return (rejectIndexFile("file mismatch"));
+
+		ca.files[fid].hash = entry.hash;
+		ca.files[fid].size = entry.size;
+		ca.files[fid].valid = true;
+	}
+
+	return true;
+}
+
+bool CUnpackedArchiveCache::WriteIndex(const IArchive* ar, const CachedArchive& ca) const
+{
+	if (ca.indexFilePath.empty())
+		return false;
+
+	UnpackedIndexHeader header;
+
+	std::memcpy(header.magic, UNPACKED_INDEX_MAGIC, sizeof(header.magic));
+	header.version = UNPACKED_INDEX_VERSION;
+	header.numFiles = 0;
+
+	for (const CachedFile& cf: ca.files) {
+		header.numFiles += cf.valid;
+	}
+
+	WriteTempFile(ca.indexFilePath, ca.indexFilePath + ".tmp", [&](std::ofstream& file) {
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		for (unsigned int fid = 0; fid < ca.files.size(); fid++) {
+			const CachedFile& cf = ca.files[fid];
+
+			if (!cf.valid)
+				continue;
+
+			const std::string fileName = StringToLower(ar->FileInfo(fid).first);
+			const UnpackedIndexEntry entry = {cf.hash, cf.size, fileName.size()};
+
+			file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+			file.write(fileName.data(), fileName.size());
+		}
+	});
+
+	return (FileSystem::FileExists(ca.indexFilePath));
+}
@@ -0,0 +1,77 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _UNPACKED_ARCHIVE_CACHE_H
+#define _UNPACKED_ARCHIVE_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "System/Sync/SHA512.hpp"
+#include "System/Threading/SpringThreading.h"
+#include "System/UnorderedMap.hpp"
+
+class IArchive;
+
+/**
+ * On-disk cache of the files extracted from compressed archives.
+ * Each file is stored once under <CacheDir>/unpacked/ as a blob named by
+ * the SHA512 of its contents, and an index per archive checksum maps the
+ * files of that archive to their blobs. Later loads of the same archive
+ * version, by this or any other engine instance sharing the data-dir,
+ * copy from a read-only mapping of the blob instead of decompressing the
+ * file again; the mapped pages live in the shared page-cache rather than
+ * in a per-process heap copy.
+ */
+class CUnpackedArchiveCache
+{
+public:
+	CUnpackedArchiveCache();
+	~CUnpackedArchiveCache() { Clear(); }
+
+	bool IsEnabled() const { return enabled; }
+
+	/**
+	 * @return true if file <fid> of <ar> was cached and has been copied
+	 *   into <buffer>
+	 */
+	bool GetFile(const IArchive* ar, unsigned int fid, std::vector<std::uint8_t>& buffer);
+	bool HasFile(const IArchive* ar, unsigned int fid);
+
+	/// stores file <fid> of <ar> after it has been decompressed
+	void AddFile(const IArchive* ar, unsigned int fid, const std::vector<std::uint8_t>& buffer);
+
+	/// writes the index of <ar> if it changed; call before deleting the archive
+	void RemoveArchive(const IArchive* ar);
+	void Clear();
+
+private:
+	struct CachedFile {
+		sha512::raw_digest hash;
+		std::uint64_t size = 0;
+		bool valid = false;
+	};
+
+	struct CachedArchive {
+		std::string indexFilePath;
+		std::vector<CachedFile> files;
+
+		bool dirty = false;
+	};
+
+	CachedArchive* GetArchive(const IArchive* ar);
+	std::string GetBlobFilePath(const sha512::raw_digest& hash) const;
+
+	bool ReadIndex(const IArchive* ar, CachedArchive& ca) const;
+	bool WriteIndex(const IArchive* ar, const CachedArchive& ca) const;
+
+private:
+	spring::unordered_map<const IArchive*, CachedArchive> archives;
+	spring::mutex mutex;
+
+	std::string cacheDir;
+
+	bool enabled = false;
+};
+
+#endif // _UNPACKED_ARCHIVE_CACHE_H
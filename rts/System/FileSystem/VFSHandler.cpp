@@ -5,6 +5,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <tuple>
 
 #include "ArchiveLoader.h"
 #include "ArchiveScanner.h"
@@ -12,6 +13,7 @@
 #include "System/FileSystem/Archives/IArchive.h"
 #include "System/FileSystem/Archives/DirArchive.h"
 #include "System/Threading/SpringThreading.h"
+#include "System/Threading/ThreadPool.h"
 #include "System/Exceptions.h"
 #include "System/Log/ILog.h"
 #include "System/SafeUtil.h"
@@ -152,8 +154,10 @@ bool CVFSHandler::AddArchive(const std::string& archiveName, bool overwrite)
 
 	LOG_L(L_INFO, "[%s::%s<this=%p>(arName=\"%s\", overwrite=%s)] section=%d cached=%d", vfsName, __func__, this, archiveName.c_str(), overwrite ? "true" : "false", rawSection, ar != nullptr);
 
-	if (dynamic_cast<CDirArchive*>(ar) != nullptr)
+	if (dynamic_cast<CDirArchive*>(ar) != nullptr) {
+		unpackedCache.RemoveArchive(ar);
 		spring::SafeDelete(ar);
+	}
 
 	if (ar == nullptr) {
 		archives[tmpSection].erase(archivePath);
@@ -274,6 +278,8 @@ bool CVFSHandler::RemoveArchive(const std::string& archiveName)
 	}
 
 
+	unpackedCache.RemoveArchive(ar);
+
 	delete ar;
 	archives[section].erase(archivePath);
 	return true;
@@ -304,6 +310,7 @@ void CVFSHandler::DeleteArchives(Section section)
 
 	for (const auto& p: archives[section]) {
 		LOG_L(L_INFO, "\tarchive=%s (%p)", (p.first).c_str(), p.second);
+		unpackedCache.RemoveArchive(p.second);
 		delete p.second;
 	}
 
@@ -454,8 +461,76 @@ int CVFSHandler::LoadFile(const std::string& filePath, std::vector<std::uint8_t>
 	if (fileData.ar == nullptr)
 		return -1;
 
-	// 0 or 1
-	return (fileData.ar->GetFile(normalizedPath, buffer));
+	if (!unpackedCache.IsEnabled()) {
+		// 0 or 1
+		return (fileData.ar->GetFile(normalizedPath, buffer));
+	}
+
+	const unsigned int fid = fileData.ar->FindFile(normalizedPath);
+
+	if (!fileData.ar->IsFileId(fid))
+		return 0;
+
+	if (unpackedCache.GetFile(fileData.ar, fid, buffer))
+		return 1;
+
+	if (!fileData.ar->GetFile(fid, buffer))
+		return 0;
+
+	unpackedCache.AddFile(fileData.ar, fid, buffer);
+	return 1;
+}
+
+void CVFSHandler::PrefetchFiles(const std::vector<std::string>& filePaths, Section section)
+{
+	LOG_L(L_DEBUG, "[%s::%s<this=%p>(#filePaths=%u, section=%d)]", vfsName, __func__, this, uint32_t(filePaths.size()), section);
+
+	struct PrefetchEntry {
+		bool operator < (const PrefetchEntry& e) const { return (std::tie(ar, block, fid) < std::tie(e.ar, e.block, e.fid)); }
+		bool operator == (const PrefetchEntry& e) const { return (ar == e.ar && fid == e.fid); }
+
+		IArchive* ar;
+		unsigned int block;
+		unsigned int fid;
+	};
+
+	std::vector<PrefetchEntry> entries;
+	std::vector<size_t> blockBegins;
+
+	entries.reserve(filePaths.size());
+
+	for (const std::string& filePath: filePaths) {
+		const std::string& normalizedPath = GetNormalizedPath(filePath);
+		const FileData& fileData = GetFileData(normalizedPath, section);
+
+		if (fileData.ar == nullptr)
+			continue;
+
+		const unsigned int fid = fileData.ar->FindFile(normalizedPath);
+
+		// LoadFile will map these from the cache
+		if (unpackedCache.HasFile(fileData.ar, fid))
+			continue;
+
+		entries.push_back({fileData.ar, fileData.ar->GetSolidBlockIndex(fid), fid});
+	}
+
+	std::sort(entries.begin(), entries.end());
+	entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+
+	for (size_t i = 0; i < entries.size(); ++i) {
+		if (i == 0 || entries[i].ar != entries[i - 1].ar || entries[i].block != entries[i - 1].block)
+			blockBegins.push_back(i);
+	}
+
+	blockBegins.push_back(entries.size());
+
+	// one job per (solid) block so each is only decompressed once
+	for_mt_chunk(0, blockBegins.size() - 1, [&](const int b) {
+		for (size_t i = blockBegins[b]; i < blockBegins[b + 1]; ++i) {
+			entries[i].ar->PrefetchFile(entries[i].fid);
+		}
+	});
 }
 
 int CVFSHandler::FileExists(const std::string& filePath, Section section)
@@ -8,6 +8,7 @@
 #include <vector>
 #include <cinttypes>
 
+#include "UnpackedArchiveCache.h"
 #include "System/UnorderedMap.hpp"
 
 class IArchive;
@@ -104,6 +105,15 @@ public:
 	 */
 	int LoadFile(const std::string& filePath, std::vector<std::uint8_t>& buffer, Section section);
 
+	/**
+	 * Decompresses files ahead of the LoadFile calls for them, in parallel
+	 * where their archives allow it. Meant for loaders that know the files
+	 * they are going to read up front.
+	 * @param filePaths raw file paths, case-insensitive; those that do not
+	 *   exist in the VFS are ignored
+	 */
+	void PrefetchFiles(const std::vector<std::string>& filePaths, Section section);
+
 
 	/**
 	 * Returns all the files in the given (virtual) directory without the
@@ -172,6 +182,8 @@ private:
 	std::array<std::vector<FileEntry>, Section::Count> files;
 	std::array<spring::unordered_map<std::string, IArchive*>, Section::Count> archives;
 
+	CUnpackedArchiveCache unpackedCache;
+
 	const char* vfsName = "";
 
 	bool insertAllowed = true;
@@ -28,6 +28,10 @@ CONFIG(int, MaximumTransmissionUnit)
 	.defaultValue(1400)
 	.minimumValue(400);
 
+CONFIG(bool, NetworkCompression)
+	.defaultValue(false)
+	.description("Compress outgoing network packets if the other end supports it. Saves upstream bandwidth on servers with many clients at the cost of some CPU time.");
+
 CONFIG(int, LinkOutgoingBandwidth)
 	.defaultValue(64 * 1024)
 	.minimumValue(0);
@@ -61,6 +65,7 @@ CONFIG(bool, LuaWritableConfigFile).defaultValue(true);
 CONFIG(bool, VFSCacheArchiveFiles).defaultValue(true);
 
 CONFIG(bool, DumpGameStateOnDesync).defaultValue(true).description("Enable writing clientgamestate and servergamestate dumps when a desync is detected");
+CONFIG(int, SyncSubsystemChecksumInterval).defaultValue(0).minimumValue(0).description("Send per-subsystem sync checksums to the server every N frames, so it can report which subsystem diverged first. 0 sends them only when the server requests them after a desync.");
 
 CONFIG(float, MinSimDrawBalance).defaultValue(0.15f).description("Percent of the time for simulation is minimum spend for drawing. E.g. if set to 0.15 then 15% of the total cpu time is exclusively reserved for drawing.");
 CONFIG(int, MinDrawFPS).defaultValue(2).description("Defines how many frames per second should minimally be rendered. To reach this number we will delay simframes.");
@@ -76,6 +81,7 @@ void GlobalConfig::Init()
 	networkTimeout = configHandler->GetInt("NetworkTimeout");
 	reconnectTimeout = configHandler->GetInt("ReconnectTimeout");
 	mtu = configHandler->GetInt("MaximumTransmissionUnit");
+	networkCompression = configHandler->GetBool("NetworkCompression");
 
 	linkOutgoingBandwidth = configHandler->GetInt("LinkOutgoingBandwidth");
 	linkIncomingSustainedBandwidth = configHandler->GetInt("LinkIncomingSustainedBandwidth");
@@ -95,6 +101,7 @@ void GlobalConfig::Init()
 	vfsCacheArchiveFiles = configHandler->GetBool("VFSCacheArchiveFiles");
 
 	dumpGameStateOnDesync = configHandler->GetBool("DumpGameStateOnDesync");
+	syncSubsystemChecksumInterval = configHandler->GetInt("SyncSubsystemChecksumInterval");
 
 	minSimDrawBalance = configHandler->GetFloat("MinSimDrawBalance");
 	minDrawFPS = configHandler->GetInt("MinDrawFPS");
@@ -46,6 +46,13 @@ public:
 	 */
 	unsigned mtu = 1400;
 
+	/**
+	 * @brief networkCompression
+	 *
+	 * Whether outgoing packets are deflated when the other end supports it
+	 */
+	bool networkCompression = false;
+
 
 	/**
 	 * @brief linkBandwidth
@@ -114,6 +121,15 @@ public:
 	 */
 	bool dumpGameStateOnDesync = false;
 
+	/**
+	 * @brief syncSubsystemChecksumInterval
+	 *
+	 * Every how many frames per-subsystem sync checksums are sent to the
+	 * server, which reports the subsystem that diverged first. 0 means they
+	 * are only sent when the server asks for them after detecting a desync.
+	 */
+	int syncSubsystemChecksumInterval = 0;
+
 
 	/**
 	 * @brief teamHighlight
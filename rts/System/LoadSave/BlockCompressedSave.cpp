@@ -0,0 +1,250 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "BlockCompressedSave.h"
+
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <zlib.h>
+
+#include "System/Platform/byteorder.h"
+#include "System/Threading/ThreadPool.h"
+
+#define BLOCK_SAVE_FILE_ID "SSBZ"
+#define BLOCK_SAVE_VERSION 1
+
+
+void CChunkedOutputBuf::SetPos(size_t pos)
+{
+	const size_t idx = pos / CHUNK_SIZE;
+
+	// a position at the very end may start a new chunk
+	if (idx >= chunks.size())
+		chunks.emplace_back(new char[CHUNK_SIZE]);
+
+	chunkIdx = idx;
+
+	setp(chunks[idx].get(), chunks[idx].get() + CHUNK_SIZE);
+	pbump(int(pos - idx * CHUNK_SIZE));
+}
+
+CChunkedOutputBuf::int_type CChunkedOutputBuf::overflow(int_type c)
+{
+	// put area is exhausted (or not yet set up), continue in the next chunk
+	size = GetSize();
+	SetPos(GetPos());
+
+	if (traits_type::eq_int_type(c, traits_type::eof()))
+		return traits_type::not_eof(c);
+
+	*pptr() = traits_type::to_char_type(c);
+	pbump(1);
+	return c;
+}
+
+std::streamsize CChunkedOutputBuf::xsputn(const char* s, std::streamsize n)
+{
+	for (std::streamsize i = 0; i < n; ) {
+		if (pptr() == epptr())
+			overflow(traits_type::eof());
+
+		const std::streamsize k = std::min(n - i, std::streamsize(epptr() - pptr()));
+
+		std::memcpy(pptr(), s + i, k);
+		pbump(int(k));
+
+		i += k;
+	}
+
+	return n;
+}
+
+CChunkedOutputBuf::pos_type CChunkedOutputBuf::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+	if ((which & std::ios_base::out) == 0)
+		return pos_type(off_type(-1));
+
+	// tellp; by far the most common call
+	if (off == 0 && dir == std::ios_base::cur)
+		return pos_type(off_type(GetPos()));
+
+	size = GetSize();
+
+	off_type pos = off;
+
+	switch (dir) {
+		case std::ios_base::cur: { pos += GetPos(); } break;
+		case std::ios_base::end: { pos += size    ; } break;
+		default: {} break;
+	}
+
+	if (pos < 0 || size_t(pos) > size)
+		return pos_type(off_type(-1));
+
+	SetPos(pos);
+	return pos_type(pos);
+}
+
+CChunkedOutputBuf::pos_type CChunkedOutputBuf::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+	return (seekoff(off_type(pos), std::ios_base::beg, which));
+}
+
+
+
+namespace BlockCompressedSave {
+	struct FileHeader {
+		char magic[4];
+		std::uint32_t version;
+		std::uint32_t blockSize;
+		std::uint32_t numBlocks;
+
+		void SwapBytes() {
+			swabDWordInPlace(version);
+			swabDWordInPlace(blockSize);
+			swabDWordInPlace(numBlocks);
+		}
+	};
+
+	// followed by the blocks, in order
+	struct BlockEntry {
+		std::uint32_t rawSize;
+		std::uint32_t packedSize;
+
+		void SwapBytes() {
+			swabDWordInPlace(rawSize);
+			swabDWordInPlace(packedSize);
+		}
+	};
+
+	static_assert(sizeof(FileHeader) == 16, "");
+	static_assert(sizeof(BlockEntry) ==  8, "");
+
+
+	bool HasMagic(const std::uint8_t* data, size_t size)
+	{
+		return (size >= sizeof(FileHeader) && std::memcmp(data, BLOCK_SAVE_FILE_ID, 4) == 0);
+	}
+
+
+	std::vector<std::uint8_t> Compress(const CChunkedOutputBuf& buf, int level)
+	{
+		const size_t numBlocks = buf.GetNumChunks();
+
+		std::vector< std::vector<std::uint8_t> > blocks(numBlocks);
+		std::atomic<bool> failed = {false};
+
+		for_mt(0, numBlocks, [&](const int i) {
+			const size_t rawSize = buf.GetChunkSize(i);
+
+			uLongf packedSize = compressBound(rawSize);
+			blocks[i].resize(packedSize);
+
+			if (compress2(blocks[i].data(), &packedSize, reinterpret_cast<const Bytef*>(buf.GetChunkData(i)), rawSize, level) != Z_OK) {
+				failed = true;
+				return;
+			}
+
+			blocks[i].resize(packedSize);
+		});
+
+		if (failed)
+			throw std::runtime_error("[BlockCompressedSave::Compress] zlib error");
+
+		size_t fileSize = sizeof(FileHeader) + numBlocks * sizeof(BlockEntry);
+
+		for (const auto& block: blocks)
+			fileSize += block.size();
+
+		std::vector<std::uint8_t> file(fileSize);
+		std::uint8_t* dst = file.data();
+
+		FileHeader fh;
+		std::memcpy(fh.magic, BLOCK_SAVE_FILE_ID, 4);
+		fh.version = BLOCK_SAVE_VERSION;
+		fh.blockSize = CChunkedOutputBuf::CHUNK_SIZE;
+		fh.numBlocks = numBlocks;
+		fh.SwapBytes();
+
+		std::memcpy(dst, &fh, sizeof(fh));
+		dst += sizeof(fh);
+
+		for (size_t i = 0; i < numBlocks; i++) {
+			BlockEntry be = {std::uint32_t(buf.GetChunkSize(i)), std::uint32_t(blocks[i].size())};
+			be.SwapBytes();
+
+			std::memcpy(dst, &be, sizeof(be));
+			dst += sizeof(be);
+		}
+
+		for (auto& block: blocks) {
+			std::memcpy(dst, block.data(), block.size());
+			dst += block.size();
+
+			// release as we go, keeps the peak close to one copy of the packed data
+			std::vector<std::uint8_t>().swap(block);
+		}
+
+		return file;
+	}
+
+
+	bool Decompress(const std::uint8_t* data, size_t size, std::string& out)
+	{
+		if (!HasMagic(data, size))
+			return false;
+
+		FileHeader fh;
+		std::memcpy(&fh, data, sizeof(fh));
+		fh.SwapBytes();
+
+		if (fh.version != BLOCK_SAVE_VERSION)
+			return false;
+		// the writer always uses this size; anything else would not bound the allocation below
+		if (fh.blockSize != CChunkedOutputBuf::CHUNK_SIZE)
+			return false;
+		if ((size - sizeof(fh)) / sizeof(BlockEntry) < fh.numBlocks)
+			return false;
+
+		std::vector<BlockEntry> entries(fh.numBlocks);
+		// {raw, packed} offset of each block
+		std::vector< std::pair<size_t, size_t> > offsets(fh.numBlocks);
+
+		size_t rawOffset = 0;
+		size_t packedOffset = sizeof(fh) + fh.numBlocks * sizeof(BlockEntry);
+
+		for (size_t i = 0; i < entries.size(); i++) {
+			std::memcpy(&entries[i], data + sizeof(fh) + i * sizeof(BlockEntry), sizeof(BlockEntry));
+			entries[i].SwapBytes();
+
+			// bounds the total allocation by numBlocks * CHUNK_SIZE
+			if (entries[i].rawSize > fh.blockSize)
+				return false;
+
+			offsets[i] = {rawOffset, packedOffset};
+
+			rawOffset += entries[i].rawSize;
+			packedOffset += entries[i].packedSize;
+		}
+
+		if (packedOffset > size)
+			return false;
+
+		out.clear();
+		out.resize(rawOffset);
+
+		std::atomic<bool> failed = {false};
+
+		for_mt(0, entries.size(), [&](const int i) {
+			uLongf rawSize = entries[i].rawSize;
+
+			auto* dst = reinterpret_cast<Bytef*>(&out[offsets[i].first]);
+			const auto* src = data + offsets[i].second;
+
+			if (uncompress(dst, &rawSize, src, entries[i].packedSize) != Z_OK || rawSize != entries[i].rawSize)
+				failed = true;
+		});
+
+		return (!failed);
+	}
+};
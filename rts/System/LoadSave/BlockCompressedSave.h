@@ -0,0 +1,64 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef BLOCK_COMPRESSED_SAVE_H
+#define BLOCK_COMPRESSED_SAVE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+/**
+ * Output buffer for savegame data which grows in fixed-size chunks rather
+ * than reallocating (and copying) one contiguous block like std::stringbuf.
+ * Seeking is allowed anywhere within the written range since SavePackage
+ * patches its header after the objects have been written.
+ * Each chunk becomes one independently compressed block of the save-file.
+ */
+class CChunkedOutputBuf : public std::streambuf
+{
+public:
+	static constexpr size_t CHUNK_SIZE = 1 << 20;
+
+	size_t GetSize() const { return std::max(size, GetPos()); }
+	size_t GetNumChunks() const { return ((GetSize() + CHUNK_SIZE - 1) / CHUNK_SIZE); }
+	size_t GetChunkSize(size_t i) const { return std::min(CHUNK_SIZE, GetSize() - i * CHUNK_SIZE); }
+
+	const char* GetChunkData(size_t i) const { return chunks[i].get(); }
+
+protected:
+	int_type overflow(int_type c) override;
+	std::streamsize xsputn(const char* s, std::streamsize n) override;
+
+	pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+	pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+
+private:
+	size_t GetPos() const { return (chunks.empty()? 0: (chunkIdx * CHUNK_SIZE + (pptr() - pbase()))); }
+	void SetPos(size_t pos);
+
+private:
+	std::vector<std::unique_ptr<char[]>> chunks;
+
+	// chunk backing the current put area
+	size_t chunkIdx = 0;
+	// high-water mark, excludes bytes written into the current put area
+	size_t size = 0;
+};
+
+
+/**
+ * Framed save-file format: a small header, a table of {raw, packed} sizes
+ * and the zlib-compressed blocks, so that both saving and loading can
+ * (de)compress all blocks in parallel. Legacy saves are one gzip stream.
+ */
+namespace BlockCompressedSave {
+	bool HasMagic(const std::uint8_t* data, size_t size);
+
+	std::vector<std::uint8_t> Compress(const CChunkedOutputBuf& buf, int level);
+	bool Decompress(const std::uint8_t* data, size_t size, std::string& out);
+};
+
+#endif // BLOCK_COMPRESSED_SAVE_H
@@ -1,11 +1,12 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <fstream>
 #include <sstream>
-#include <zlib.h>
 
 #include "ExternalAI/SkirmishAIHandler.h"
 #include "ExternalAI/EngineOutHandler.h"
 #include "CregLoadSaveHandler.h"
+#include "BlockCompressedSave.h"
 #include "Map/ReadMap.h"
 #include "Game/Game.h"
 #include "Game/GameSetup.h"
@@ -42,6 +43,7 @@
 #include "System/SafeUtil.h"
 #include "System/Platform/errorhandler.h"
 #include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileHandler.h"
 #include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/GZFileHandler.h"
 #include "System/Threading/ThreadPool.h"
@@ -225,7 +227,7 @@ static void ReadString(std::istream& s, std::string& str)
 }
 
 
-static void SaveLuaState(CSplitLuaHandle* handle, creg::COutputStreamSerializer& os, std::stringstream& oss)
+static void SaveLuaState(CSplitLuaHandle* handle, creg::COutputStreamSerializer& os, std::ostream& oss)
 {
 	CLuaStateCollector lsc;
 	lsc.Read(handle);
@@ -261,7 +263,8 @@ void CCregLoadSaveHandler::SaveGame(const std::string& path)
 	selectedUnitsHandler.ClearSelected();
 
 	try {
-		std::stringstream oss;
+		CChunkedOutputBuf obuf;
+		std::ostream oss(&obuf);
 
 		// write our own header. SavePackage() will add its own
 		WriteString(oss, SpringVersion::GetSync());
@@ -304,23 +307,24 @@ void CCregLoadSaveHandler::SaveGame(const std::string& path)
 		}
 
 		{
-			gzFile file = gzopen(dataDirsAccess.LocateFile(path, FileQueryFlags::WRITE).c_str(), "wb5");
+			std::ofstream file(dataDirsAccess.LocateFile(path, FileQueryFlags::WRITE), std::ios::out | std::ios::binary);
 
-			if (file == nullptr) {
+			if (!file.is_open()) {
 				LOG_L(L_ERROR, "[LSH::%s] could not open save-file", __func__);
 				return;
 			}
 
-			std::string data = oss.str();
-			std::function<void(gzFile, std::string&&)> func = [](gzFile file, std::string&& data) {
-				gzwrite(file, data.c_str(), data.size());
-				gzflush(file, Z_FINISH);
-				gzclose(file);
+			// compress all chunks in parallel, only the disk write is left to a background job
+			std::vector<std::uint8_t> data = BlockCompressedSave::Compress(obuf, 5);
+			PrintSize("File", data.size());
+
+			std::function<void(std::ofstream&&, std::vector<std::uint8_t>&&)> func = [](std::ofstream&& file, std::vector<std::uint8_t>&& data) {
+				file.write(reinterpret_cast<const char*>(data.data()), data.size());
+				file.close();
 			};
 
-			// gzFile is just a plain typedef (struct gzFile_s {}* gzFile), can be copied
 			// need to keep a reference to the future around or its destructor will block
-			ThreadPool::AddExtJob(std::move(std::async(std::launch::async, std::move(func), file, std::move(data))));
+			ThreadPool::AddExtJob(std::move(std::async(std::launch::async, std::move(func), std::move(file), std::move(data))));
 		}
 
 		//FIXME add lua state
@@ -340,19 +344,57 @@ void CCregLoadSaveHandler::SaveGame(const std::string& path)
 #endif //USING_CREG
 }
 
+/// fills iss if path refers to a save in the block-compressed format, sets corrupt if it could not be unpacked
+bool CCregLoadSaveHandler::LoadBlockCompressedSave(const std::string& path, bool& corrupt)
+{
+	corrupt = false;
+
+	CFileHandler saveFile(path, SPRING_VFS_RAW_FIRST);
+
+	std::vector<std::uint8_t> data(std::max(saveFile.FileSize(), 0));
+	std::string rawData;
+
+	if (data.empty())
+		return false;
+	if (saveFile.Read(data.data(), 4) != 4 || !BlockCompressedSave::HasMagic(data.data(), data.size()))
+		return false;
+	if (saveFile.Read(data.data() + 4, data.size() - 4) != int(data.size() - 4))
+		return false;
+
+	if (!BlockCompressedSave::Decompress(data.data(), data.size(), rawData)) {
+		LOG_L(L_ERROR, "[LSH::%s] corrupt save-file \"%s\"", __func__, path.c_str());
+		corrupt = true;
+		return true;
+	}
+
+	iss.str(std::move(rawData));
+	return true;
+}
+
 /// loads the data (map&mod-name,setup-script) needed by PreGame
 bool CCregLoadSaveHandler::LoadGameStartInfo(const std::string& path)
 {
-	CGZFileHandler saveFile(dataDirsAccess.LocateFile(FindSaveFile(path)), SPRING_VFS_RAW_FIRST);
+	const std::string filePath = dataDirsAccess.LocateFile(FindSaveFile(path));
 
 	std::stringbuf* sbuf = iss.rdbuf();
 	std::string saveVersion;
 	std::string syncVersion = SpringVersion::GetSync();
 
-	char buf[4096];
-	int len;
-	while ((len = saveFile.Read(buf, sizeof(buf))) > 0)
-		sbuf->sputn(buf, len);
+	bool corruptSave = false;
+
+	if (!LoadBlockCompressedSave(filePath, corruptSave)) {
+		// legacy format, one gzip stream
+		CGZFileHandler saveFile(filePath, SPRING_VFS_RAW_FIRST);
+
+		char buf[4096];
+		int len;
+		while ((len = saveFile.Read(buf, sizeof(buf))) > 0)
+			sbuf->sputn(buf, len);
+	}
+
+	// leaves scriptText empty, so not even LoadBadSaves can start from this
+	if (corruptSave)
+		return false;
 
 	ReadString(iss, saveVersion);
 
@@ -18,6 +18,9 @@ public:
 	void LoadAIData() override;
 	void SaveGame(const std::string& path) override;
 
+protected:
+	bool LoadBlockCompressedSave(const std::string& path, bool& corrupt);
+
 protected:
 	std::stringstream iss;
 };
@@ -15,6 +15,8 @@ CONFIG(bool, DisableDemoVersionCheck).defaultValue(false).description("Allow to
 #include "System/Log/ILog.h"
 #include "System/Net/RawPacket.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <array>
 #include <climits>
 #include <stdexcept>
@@ -200,3 +202,91 @@ void CDemoReader::LoadStats()
 
 	playbackDemo->Seek(curPos);
 }
+
+
+bool CDemoReader::LoadKeyFrameIndex()
+{
+	keyFrames.clear();
+	keyFramePeriod = 0;
+
+	// only written when the demo was closed properly
+	if (fileHeader.demoStreamSize == 0)
+		return false;
+
+	// the index directly follows the statistics
+	const std::int64_t streamEnd = std::int64_t(fileHeader.headerSize) + fileHeader.scriptSize + fileHeader.demoStreamSize;
+	const std::int64_t statsEnd = streamEnd + fileHeader.winningAllyTeamsSize + fileHeader.playerStatSize + fileHeader.teamStatSize;
+
+	if ((playbackDemoSize - statsEnd) < std::int64_t(sizeof(DemoKeyFrameIndexFooter)))
+		return false;
+
+	const int curPos = playbackDemo->GetPos();
+
+	DemoKeyFrameIndexFooter footer;
+
+	playbackDemo->Seek(playbackDemoSize - sizeof(footer));
+	playbackDemo->Read(reinterpret_cast<char*>(&footer), sizeof(footer));
+	footer.swab();
+
+	// 64-bit so a corrupt footer can not wrap around into a plausible position
+	const std::int64_t indexSize = std::int64_t(footer.numKeyFrames) * footer.keyFrameSize;
+	const std::int64_t indexPos = statsEnd;
+
+	const bool validMagic = (memcmp(footer.magic, DEMOFILE_KEYFRAME_INDEX_MAGIC, sizeof(DEMOFILE_KEYFRAME_INDEX_MAGIC)) == 0);
+	const bool validSizes = (footer.numKeyFrames > 0 && footer.keyFrameSize >= int(sizeof(DemoKeyFrame)) && (indexPos + indexSize + std::int64_t(sizeof(footer))) == playbackDemoSize);
+
+	if (!validMagic || !validSizes) {
+		playbackDemo->Seek(curPos);
+		return false;
+	}
+
+	keyFrames.reserve(footer.numKeyFrames);
+	keyFramePeriod = footer.keyFramePeriod;
+
+	// entries written by later versions may be larger
+	for (int i = 0; i < footer.numKeyFrames; ++i) {
+		DemoKeyFrame& keyFrame = keyFrames.emplace_back();
+
+		playbackDemo->Seek(int(indexPos + std::int64_t(i) * footer.keyFrameSize));
+		playbackDemo->Read(reinterpret_cast<char*>(&keyFrame), sizeof(DemoKeyFrame));
+		keyFrame.swab();
+	}
+
+	playbackDemo->Seek(curPos);
+	return true;
+}
+
+const DemoKeyFrame* CDemoReader::GetKeyFrame(int frameNum) const
+{
+	const auto pred = [](int frameNum, const DemoKeyFrame& keyFrame) { return (frameNum < keyFrame.frameNum); };
+	const auto iter = std::upper_bound(keyFrames.begin(), keyFrames.end(), frameNum, pred);
+
+	if (iter == keyFrames.begin())
+		return nullptr;
+
+	return &*(iter - 1);
+}
+
+bool CDemoReader::SeekToKeyFrame(const DemoKeyFrame& keyFrame, float curTime)
+{
+	const int streamPos = fileHeader.headerSize + fileHeader.scriptSize;
+
+	if (keyFrame.streamOffset < 0 || keyFrame.streamOffset >= fileHeader.demoStreamSize)
+		return false;
+
+	DemoStreamChunkHeader keyChunkHeader;
+
+	playbackDemo->Seek(streamPos + keyFrame.streamOffset);
+
+	if (playbackDemo->Read(reinterpret_cast<char*>(&keyChunkHeader), sizeof(keyChunkHeader)) < sizeof(keyChunkHeader))
+		return false;
+
+	chunkHeader = keyChunkHeader;
+	chunkHeader.swab();
+
+	// same bookkeeping as the constructor does for the first chunk
+	demoTimeOffset = curTime - chunkHeader.modGameTime - 0.1f;
+	nextDemoReadTime = curTime - 0.01f;
+	bytesRemaining = fileHeader.demoStreamSize - keyFrame.streamOffset;
+	return true;
+}
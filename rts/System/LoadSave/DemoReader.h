@@ -55,6 +55,28 @@ public:
 	/// Not needed for normal demo watching
 	void LoadStats();
 
+	/**
+	@brief Read the optional keyframe index at the end of the demo
+	@return false if the demo has none (older or crashed demos)
+	*/
+	bool LoadKeyFrameIndex();
+
+	const std::vector<DemoKeyFrame>& GetKeyFrames() const { return keyFrames; }
+	int GetKeyFramePeriod() const { return keyFramePeriod; }
+
+	/**
+	@brief Find the last indexed keyframe at or before a frame
+	@return the keyframe or nullptr if there is none (call LoadKeyFrameIndex first)
+	*/
+	const DemoKeyFrame* GetKeyFrame(int frameNum) const;
+
+	/**
+	@brief Continue reading the demo stream at a keyframe
+	The next GetData(curTime) call returns the keyframe's frame message,
+	later chunks are timed relative to curTime as after construction.
+	*/
+	bool SeekToKeyFrame(const DemoKeyFrame& keyFrame, float curTime);
+
 private:
 	CFileHandler* playbackDemo;
 
@@ -62,6 +84,7 @@ private:
 	float nextDemoReadTime;
 	int bytesRemaining;
 	int playbackDemoSize;
+	int keyFramePeriod = 0;
 
 	DemoStreamChunkHeader chunkHeader;
 
@@ -70,6 +93,7 @@ private:
 	std::vector<PlayerStatistics> playerStats; // one stat per player
 	std::vector< std::vector<TeamStatistics> > teamStats; // many stats per team
 	std::vector<unsigned char> winningAllyTeams;
+	std::vector<DemoKeyFrame> keyFrames;
 };
 
 #endif
@@ -8,6 +8,8 @@
 #include "DemoRecorder.h"
 #include "base64.h"
 #include "Game/GameVersion.h"
+#include "Net/Protocol/NetMessageTypes.h"
+#include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/TeamStatistics.h"
 #include "System/TimeUtil.h"
 #include "System/StringUtil.h"
@@ -31,6 +33,9 @@
 static std::string demoStreams[2];
 static spring::mutex demoMutex;
 
+// frames between two entries of the keyframe index
+static constexpr int KEYFRAME_PERIOD = GAME_SPEED * 10;
+
 
 CDemoRecorder::CDemoRecorder(const std::string& mapName, const std::string& modName, bool serverDemo): isServerDemo(serverDemo)
 {
@@ -52,6 +57,7 @@ CDemoRecorder::~CDemoRecorder()
 	WriteWinnerList();
 	WritePlayerStats();
 	WriteTeamStats();
+	WriteKeyFrameIndex();
 	WriteFileHeader(true);
 	WriteDemoFile();
 }
@@ -127,6 +133,14 @@ void CDemoRecorder::SaveToDemo(const unsigned char* buf, const unsigned length,
 {
 	DemoStreamChunkHeader chunkHeader;
 
+	if (length > 0 && (buf[0] == NETMSG_NEWFRAME || buf[0] == NETMSG_KEYFRAME) && ((++numFrames % KEYFRAME_PERIOD) == 0)) {
+		DemoKeyFrame& keyFrame = keyFrames.emplace_back();
+
+		keyFrame.frameNum = numFrames;
+		keyFrame.streamOffset = fileHeader.demoStreamSize;
+		keyFrame.modGameTime = modGameTime;
+	}
+
 	chunkHeader.modGameTime = modGameTime;
 	chunkHeader.length = length;
 	chunkHeader.swab();
@@ -311,3 +325,28 @@ void CDemoRecorder::WriteTeamStats()
 
 	teamStats.clear();
 }
+
+/** @brief Write the keyframe index and its footer at the end of the file. */
+void CDemoRecorder::WriteKeyFrameIndex()
+{
+	if (keyFrames.empty())
+		return;
+
+	DemoKeyFrameIndexFooter footer;
+
+	memset(&footer, 0, sizeof(footer));
+	strcpy(footer.magic, DEMOFILE_KEYFRAME_INDEX_MAGIC);
+	footer.numKeyFrames = keyFrames.size();
+	footer.keyFrameSize = sizeof(DemoKeyFrame);
+	footer.keyFramePeriod = KEYFRAME_PERIOD;
+
+	for (DemoKeyFrame& keyFrame: keyFrames) {
+		keyFrame.swab();
+		demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&keyFrame), sizeof(DemoKeyFrame));
+	}
+
+	footer.swab();
+	demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&footer), sizeof(footer));
+
+	keyFrames.clear();
+}
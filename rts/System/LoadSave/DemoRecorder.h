@@ -38,7 +38,9 @@ public:
 		std::swap(playerStats, r.playerStats);
 		std::swap(teamStats, r.teamStats);
 		std::swap(winningAllyTeams, r.winningAllyTeams);
+		std::swap(keyFrames, r.keyFrames);
 
+		std::swap(numFrames, r.numFrames);
 		std::swap(isServerDemo, r.isServerDemo);
 		return *this;
 	}
@@ -68,6 +70,7 @@ private:
 	void WritePlayerStats();
 	void WriteTeamStats();
 	void WriteWinnerList();
+	void WriteKeyFrameIndex();
 	void WriteDemoFile();
 
 private:
@@ -76,6 +79,10 @@ private:
 	std::vector<PlayerStatistics> playerStats;
 	std::vector< std::vector<TeamStatistics> > teamStats;
 	std::vector<unsigned char> winningAllyTeams;
+	std::vector<DemoKeyFrame> keyFrames;
+
+	// number of NETMSG_NEWFRAME's and NETMSG_KEYFRAME's saved so far
+	int numFrames = 0;
 
 	bool isServerDemo = false;
 };
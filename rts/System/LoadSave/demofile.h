@@ -40,6 +40,9 @@
  *         CTeam::Statistics for each team.
  *       - Array of all CTeam::Statistics (total number of items is the
  *         sum of the elements in the array of dwords).
+ *   - Optional keyframe index (see DemoKeyFrameIndexFooter), ending the file:
+ *     - Array of numKeyFrames DemoKeyFrame's
+ *     - DemoKeyFrameIndexFooter
  *
  * The header is designed to be extensible: it contains a version field and a
  * headerSize field to support this. The version field is a major version number
@@ -115,6 +118,53 @@ struct DemoStreamChunkHeader
 	}
 };
 
+/**
+ * @brief Spring demo keyframe index entry
+ *
+ * Points at the demo stream chunk holding every Nth NETMSG_NEWFRAME (or
+ * NETMSG_KEYFRAME), so readers can start reading the stream there instead
+ * of at its beginning.
+ */
+struct DemoKeyFrame
+{
+	int frameNum;                 ///< Number of frames simulated once this chunk's frame message is processed.
+	int streamOffset;             ///< Offset of the chunk's DemoStreamChunkHeader from the start of the demo stream.
+	float modGameTime;            ///< modGameTime of the chunk.
+
+	/// Change structure from host endian to little endian or vice versa.
+	void swab() {
+		swabDWordInPlace(frameNum);
+		swabDWordInPlace(streamOffset);
+		swabFloatInPlace(modGameTime);
+	}
+};
+
+/** The last 16 bytes of a demofile that has a keyframe index. */
+#define DEMOFILE_KEYFRAME_INDEX_MAGIC "demo keyframes"
+
+/**
+ * @brief Spring demo keyframe index footer
+ *
+ * The keyframe index is optional and trails everything DemoFileHeader
+ * describes, so readers that do not know about it are not affected. It is
+ * detected through the magic at the very end of the file; the entries are
+ * stored right in front of this footer. Demos of crashed games have none.
+ */
+struct DemoKeyFrameIndexFooter
+{
+	int numKeyFrames;             ///< Number of DemoKeyFrame's preceding this footer.
+	int keyFrameSize;             ///< sizeof(DemoKeyFrame)
+	int keyFramePeriod;           ///< Number of frames between keyframes.
+	char magic[16];               ///< DEMOFILE_KEYFRAME_INDEX_MAGIC
+
+	/// Change structure from host endian to little endian or vice versa.
+	void swab() {
+		swabDWordInPlace(numKeyFrames);
+		swabDWordInPlace(keyFrameSize);
+		swabDWordInPlace(keyFramePeriod);
+	}
+};
+
 #pragma pack(pop)
 
 #endif // DEMO_FILE_H
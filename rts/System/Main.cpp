@@ -18,6 +18,7 @@
 #include <clocale>
 #include <cstdlib>
 #include <cstdint>
+#include <cinttypes>
 
 #ifdef _WIN32
 	#include "lib/SOP/SOP.hpp" // NvOptimus
@@ -44,9 +45,9 @@ int Run(int argc, char* argv[])
 	Threading::DetectCores();
 	Threading::SetMainThread();
 
-	LOG("%s: thread affinity %x", __func__, Threading::GetAffinity());
+	LOG("%s: thread affinity %" PRIx64, __func__, Threading::GetAffinity());
 	SpringApp app(argc, argv);
-	LOG("%s: thread affinity %x", __func__, Threading::GetAffinity());
+	LOG("%s: thread affinity %" PRIx64, __func__, Threading::GetAffinity());
 	return (app.Run());
 }
 
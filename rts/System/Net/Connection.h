@@ -70,6 +70,8 @@ public:
 	virtual void Unmute() = 0;
 	virtual void Close(bool flush = false) = 0;
 	virtual void SetLossFactor(int factor) = 0;
+	/// the other end can decode compressed packets (whether any are sent is up to the connection)
+	virtual void SetPeerCompression(bool enable) = 0;
 
 	/**
 	 * @brief update internals
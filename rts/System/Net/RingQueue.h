@@ -0,0 +1,93 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _RING_QUEUE_H
+#define _RING_QUEUE_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace netcode
+{
+
+/**
+ * @brief FIFO over a power-of-two ring of slots
+ * Unlike std::deque it never frees storage when elements are popped, so a
+ * queue that has reached its working-set size stops allocating.
+ */
+template<typename T>
+class RingQueue
+{
+public:
+	bool empty() const { return (count == 0); }
+	size_t size() const { return count; }
+
+	      T& operator [] (size_t i)       { assert(i < count); return slots[(head + i) & (slots.size() - 1)]; }
+	const T& operator [] (size_t i) const { assert(i < count); return slots[(head + i) & (slots.size() - 1)]; }
+
+	      T& front()       { return (*this)[0]; }
+	const T& front() const { return (*this)[0]; }
+	      T& back()       { return (*this)[count - 1]; }
+	const T& back() const { return (*this)[count - 1]; }
+
+	template<typename... A>
+	T& emplace_back(A&&... a) {
+		if (count == slots.size())
+			Grow();
+
+		T& slot = slots[(head + count++) & (slots.size() - 1)];
+		return (slot = T(std::forward<A>(a)...));
+	}
+
+	void push_back(const T& t) { emplace_back(t); }
+	void push_back(T&& t) { emplace_back(std::move(t)); }
+
+	void pop_front() {
+		assert(count > 0);
+		// release whatever the slot holds (e.g. shared_ptr's) right away
+		slots[head] = T();
+		head = (head + 1) & (slots.size() - 1);
+		count -= 1;
+	}
+
+	void erase(size_t i) {
+		assert(i < count);
+
+		for (; (i + 1) < count; ++i) {
+			(*this)[i] = std::move((*this)[i + 1]);
+		}
+
+		(*this)[count - 1] = T();
+		count -= 1;
+	}
+
+	void clear() {
+		while (!empty()) {
+			pop_front();
+		}
+	}
+
+private:
+	void Grow() {
+		std::vector<T> newSlots(std::max(slots.size() * 2, size_t(16)));
+
+		for (size_t i = 0; i < count; ++i) {
+			newSlots[i] = std::move((*this)[i]);
+		}
+
+		slots.swap(newSlots);
+		head = 0;
+	}
+
+private:
+	std::vector<T> slots;
+
+	size_t head = 0;
+	size_t count = 0;
+};
+
+} // namespace netcode
+
+#endif // _RING_QUEUE_H
@@ -3,7 +3,9 @@
 #include "UDPConnection.h"
 
 #include <cinttypes>
+#include <cstring>
 
+#include <zlib.h>
 
 #include "Socket.h"
 #include "ProtocolDef.h"
@@ -96,8 +98,8 @@ public:
 		pos += sizeof(t);
 	}
 
-	void Unpack(std::vector<std::uint8_t>& t, unsigned unpackLength) {
-		std::copy(data + pos, data + pos + unpackLength, std::back_inserter(t));
+	void Unpack(std::uint8_t* t, unsigned unpackLength) {
+		std::memcpy(t, data + pos, unpackLength);
 		pos += unpackLength;
 	}
 
@@ -119,14 +121,18 @@ public:
 	}
 
 	template<typename T>
-	void Pack(T& t) {
+	void Pack(const T& t) {
 		const size_t pos = data.size();
 		data.resize(pos + sizeof(T));
 		*reinterpret_cast<T*>(&data[pos]) = t;
 	}
 
-	void Pack(std::vector<std::uint8_t>& _data) {
-		std::copy(_data.begin(), _data.end(), std::back_inserter(data));
+	void Pack(const std::vector<std::uint8_t>& _data) {
+		data.insert(data.end(), _data.begin(), _data.end());
+	}
+
+	void Pack(const std::uint8_t* _data, unsigned length) {
+		data.insert(data.end(), _data, _data + length);
 	}
 
 private:
@@ -134,21 +140,118 @@ private:
 };
 
 
+/*
+ * Packets are deflated independently of each other (losing one must not
+ * stall the rest), so a single stream per thread can serve all connections.
+ * Raw deflate without zlib header, packets carry their own checksum.
+ */
+class PacketDeflater
+{
+public:
+	PacketDeflater() { valid = (deflateInit2(&strm, Z_BEST_SPEED, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK); }
+	~PacketDeflater() {
+		if (valid)
+			deflateEnd(&strm);
+	}
+
+	/// writes the marker and deflated <src> into <dst>, returns false if that is not smaller
+	bool Deflate(const std::vector<std::uint8_t>& src, std::vector<std::uint8_t>& dst) {
+		if (!valid || deflateReset(&strm) != Z_OK)
+			return false;
+
+		dst.resize(sizeof(Packet::deflatedMarker) + deflateBound(&strm, src.size()));
+		std::memcpy(dst.data(), &Packet::deflatedMarker, sizeof(Packet::deflatedMarker));
+
+		strm.next_in = const_cast<Bytef*>(src.data());
+		strm.avail_in = src.size();
+		strm.next_out = dst.data() + sizeof(Packet::deflatedMarker);
+		strm.avail_out = dst.size() - sizeof(Packet::deflatedMarker);
+
+		if (deflate(&strm, Z_FINISH) != Z_STREAM_END)
+			return false;
+
+		dst.resize(sizeof(Packet::deflatedMarker) + strm.total_out);
+		return (dst.size() < src.size());
+	}
+
+private:
+	z_stream strm = {};
+	bool valid = false;
+};
+
+class PacketInflater
+{
+public:
+	PacketInflater() { valid = (inflateInit2(&strm, -MAX_WBITS) == Z_OK); }
+	~PacketInflater() {
+		if (valid)
+			inflateEnd(&strm);
+	}
+
+	bool Inflate(const std::uint8_t* src, unsigned length, std::vector<std::uint8_t>& dst) {
+		if (!valid || inflateReset(&strm) != Z_OK)
+			return false;
+
+		dst.resize(udpMaxPacketSize);
+
+		strm.next_in = const_cast<Bytef*>(src);
+		strm.avail_in = length;
+		strm.next_out = dst.data();
+		strm.avail_out = dst.size();
+
+		// larger than any packet we would send, or corrupt
+		if (inflate(&strm, Z_FINISH) != Z_STREAM_END)
+			return false;
+
+		dst.resize(strm.total_out);
+		return true;
+	}
+
+private:
+	z_stream strm = {};
+	bool valid = false;
+};
+
+
 
 void Chunk::UpdateChecksum(CRC& crc) const {
 
 	crc << chunkNumber;
 	crc << (unsigned int)chunkSize;
 
-	if (!data.empty()) {
-		crc.Update(&data[0], data.size());
+	if (chunkSize > 0) {
+		crc.Update(&data[0], chunkSize);
 	}
 }
 
 
 
-Packet::Packet(const unsigned char* data, unsigned length)
+bool Packet::Unpack(const unsigned char* data, unsigned length)
 {
+	Reset(0, 0);
+
+	deflatedSize = 0;
+
+	if (length >= sizeof(deflatedMarker)) {
+		std::int32_t marker;
+		std::memcpy(&marker, data, sizeof(marker));
+
+		if (marker == deflatedMarker) {
+			static thread_local PacketInflater inflater;
+
+			if (!inflater.Inflate(data + sizeof(marker), length - sizeof(marker), inflateBuffer))
+				return false;
+
+			deflatedSize = length;
+
+			data = inflateBuffer.data();
+			length = inflateBuffer.size();
+		}
+	}
+
+	if (length < headerSize)
+		return false;
+
 	Unpacker buf(data, length);
 	buf.Unpack(lastContinuous);
 	buf.Unpack(nakType);
@@ -168,20 +271,26 @@ Packet::Packet(const unsigned char* data, unsigned length)
 		}
 	}
 
-	chunks.reserve(buf.Remaining() / Chunk::headerSize);
+	// reserve up front, <chunks> points into <chunkBuffer>
+	chunkBuffer.clear();
+	chunkBuffer.reserve(buf.Remaining() / Chunk::headerSize);
 
 	while (buf.Remaining() > Chunk::headerSize) {
-		ChunkPtr temp(new Chunk);
-		buf.Unpack(temp->chunkNumber);
-		buf.Unpack(temp->chunkSize);
+		Chunk& chunk = chunkBuffer.emplace_back();
+		buf.Unpack(chunk.chunkNumber);
+		buf.Unpack(chunk.chunkSize);
 
 		// defective, ignore
-		if (buf.Remaining() < temp->chunkSize)
+		if (buf.Remaining() < chunk.chunkSize) {
+			chunkBuffer.pop_back();
 			break;
+		}
 
-		buf.Unpack(temp->data, temp->chunkSize);
-		chunks.push_back(temp);
+		buf.Unpack(chunk.data.data(), chunk.chunkSize);
+		chunks.push_back(&chunk);
 	}
+
+	return true;
 }
 
 
@@ -221,10 +330,10 @@ void Packet::Serialize(std::vector<std::uint8_t>& data)
 	buf.Pack(checksum);
 	buf.Pack(naks);
 
-	for (auto ci = chunks.begin(); ci != chunks.end(); ++ci) {
-		buf.Pack((*ci)->chunkNumber);
-		buf.Pack((*ci)->chunkSize);
-		buf.Pack((*ci)->data);
+	for (const Chunk* c: chunks) {
+		buf.Pack(c->chunkNumber);
+		buf.Pack(c->chunkSize);
+		buf.Pack(c->data.data(), c->chunkSize);
 	}
 }
 
@@ -277,6 +386,7 @@ void UDPConnection::Init()
 	#endif
 
 	lastInOrder = -1;
+	outgoingDataPos = 0;
 	waitingPackets.clear();
 	waitingPackets.reserve(256);
 	incomingChunkNums.clear();
@@ -306,6 +416,12 @@ void UDPConnection::Init()
 	resentChunks = 0;
 	sentPackets = 0;
 	recvPackets = 0;
+	sentDeflatedPackets = 0;
+	recvDeflatedPackets = 0;
+	sentInflatedSize = 0;
+	sentDeflatedSize = 0;
+	recvInflatedSize = 0;
+	recvDeflatedSize = 0;
 	droppedChunks = 0;
 	mtu = globalConfig.mtu;
 	reconnectTime = globalConfig.reconnectTimeout;
@@ -313,6 +429,7 @@ void UDPConnection::Init()
 	muted = true;
 	closed = false;
 	resend = false;
+	peerCompression = false;
 
 	#ifndef UNIT_TEST
 	logMessages = configHandler->GetBool("UDPConnectionLogDebugMessages");
@@ -340,7 +457,7 @@ void UDPConnection::InitConnection(ip::udp::endpoint address, std::shared_ptr<ip
 
 UDPConnection::~UDPConnection()
 {
-	fragmentBuffer.Delete();
+	fragmentBuffer.clear();
 	waitingPackets.clear();
 
 	Flush(true);
@@ -400,7 +517,7 @@ void UDPConnection::DeleteBufferPacketAt(unsigned index)
 		return;
 
 	numPings -= (msgQueue[index]->data[0] == NETMSG_PING);
-	msgQueue.erase(msgQueue.begin() + index);
+	msgQueue.erase(index);
 }
 
 void UDPConnection::Update()
@@ -459,10 +576,13 @@ void UDPConnection::Update()
 			if (bytesReceived < Packet::headerSize)
 				continue;
 
-			Packet data(&recvBuffer[0], bytesReceived);
+			if (!recvPacket.Unpack(&recvBuffer[0], bytesReceived)) {
+				LOG_L(L_ERROR, "[UDPConnection::%s] discarding undecodable deflated packet, LEN %u", __func__, unsigned(bytesReceived));
+				continue;
+			}
 
 			if (IsUsingAddress(udpEndPoint))
-				ProcessRawPacket(data);
+				ProcessRawPacket(recvPacket);
 
 			// not likely, but make sure we do not get stuck here
 			if ((spring_gettime() - curTime) > spring_msecs(10)) {
@@ -479,7 +599,7 @@ void UDPConnection::UpdateWaitingPackets()
 {
 	const auto beg = waitingPackets.begin();
 	const auto end = waitingPackets.end();
-	const auto pos = std::remove_if(beg, end, [](const std::pair<int, RawPacket>& p) { return ((p.second).length == 0); });
+	const auto pos = std::remove_if(beg, end, [](const std::pair<int, int>& p) { return (p.second < 0); });
 
 	// erase processed packets
 	waitingPackets.erase(pos, end);
@@ -508,7 +628,7 @@ void UDPConnection::UpdateResendRequests()
 		return;
 
 	{
-		const auto pred = [&](const std::pair<std::int32_t, ChunkPtr>& p) { return (erasedResendChunks.find(p.first) != erasedResendChunks.end()); };
+		const auto pred = [&](const std::pair<std::int32_t, int>& p) { return (erasedResendChunks.find(p.first) != erasedResendChunks.end()); };
 
 		const auto beg = resendRequested.begin();
 		const auto end = resendRequested.end();
@@ -529,7 +649,7 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 	#endif
 
 	lastPacketRecvTime = spring_gettime();
-	dataRecv += incoming.GetSize();
+	dataRecv += ((incoming.deflatedSize > 0)? incoming.deflatedSize: incoming.GetSize());
 	recvOverhead += Packet::headerSize;
 	recvPackets += 1;
 
@@ -541,8 +661,18 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 		return;
 	}
 
+	if (incoming.deflatedSize > 0) {
+		// deflated packets are only sent to ends that can inflate them, so we
+		// know the other side supports compression as well
+		peerCompression = true;
+
+		recvDeflatedPackets += 1;
+		recvInflatedSize += incoming.GetSize();
+		recvDeflatedSize += incoming.deflatedSize;
+	}
+
 	if (incoming.lastContinuous < 0 && lastInOrder >= 0 &&
-		(unackedChunks.empty() || unackedChunks[0]->chunkNumber > 0)) {
+		(unackedChunks.empty() || chunkPool[unackedChunks[0]].chunkNumber > 0)) {
 		LOG_L(L_WARNING, "\t[%s] discarding superfluous reconnection attempt", __func__);
 		return;
 	}
@@ -553,7 +683,7 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 
 	if (!unackedChunks.empty()) {
 		const int nextCont = incoming.lastContinuous + 1;
-		const int unAckDiff = unackedChunks[0]->chunkNumber - nextCont;
+		const int unAckDiff = chunkPool[unackedChunks[0]].chunkNumber - nextCont;
 
 		if (-256 <= unAckDiff && unAckDiff <= 256) {
 			if (incoming.nakType < 0) {
@@ -561,7 +691,7 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 					const int unAckPos = i + unAckDiff;
 
 					if (unAckPos >= 0 && unAckPos < unackedChunks.size()) {
-						assert(unackedChunks[unAckPos]->chunkNumber == nextCont + i);
+						assert(chunkPool[unackedChunks[unAckPos]].chunkNumber == nextCont + i);
 						RequestResend(unackedChunks[unAckPos], true);
 					}
 				}
@@ -575,13 +705,13 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 					while (unAckPos < (unAckDiff + incoming.naks[i])) {
 						// if there are gaps in the array, assume that further resends are not needed
 						if (unAckPos < unackedChunks.size())
-							erasedResendChunks.insert(unackedChunks[unAckPos]->chunkNumber);
+							erasedResendChunks.insert(chunkPool[unackedChunks[unAckPos]].chunkNumber);
 
 						++unAckPos;
 					}
 
 					if (unAckPos < unackedChunks.size()) {
-						assert(unackedChunks[unAckPos]->chunkNumber == (nextCont + incoming.naks[i]));
+						assert(chunkPool[unackedChunks[unAckPos]].chunkNumber == (nextCont + incoming.naks[i]));
 						RequestResend(unackedChunks[unAckPos], true);
 					}
 
@@ -594,13 +724,16 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 	}
 
 
-	for (const std::shared_ptr<netcode::Chunk>& c: incoming.chunks) {
+	for (const Chunk* c: incoming.chunks) {
 		if ((lastInOrder >= c->chunkNumber) || incomingChunkNums.find(c->chunkNumber) != incomingChunkNums.end()) {
 			++droppedChunks;
 			continue;
 		}
 
-		waitingPackets.emplace_back(c->chunkNumber, RawPacket(&c->data[0], c->data.size()));
+		const int chunkIdx = chunkPool.Alloc();
+
+		chunkPool[chunkIdx] = *c;
+		waitingPackets.emplace_back(c->chunkNumber, chunkIdx);
 		incomingChunkNums.insert(c->chunkNumber);
 	}
 
@@ -608,7 +741,7 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 	using P = decltype(waitingPackets)::value_type;
 
 	const auto cmpPred = [](const P& a, const P& b) { return (a.first < b.first); };
-	const auto binFind = [&](int cn) { return std::lower_bound(waitingPackets.begin(), waitingPackets.end(), P{cn, RawPacket{}}, cmpPred); };
+	const auto binFind = [&](int cn) { return std::lower_bound(waitingPackets.begin(), waitingPackets.end(), P{cn, -1}, cmpPred); };
 
 	std::sort(waitingPackets.begin(), waitingPackets.end(), cmpPred);
 
@@ -616,21 +749,23 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 	for (auto wpi = binFind(lastInOrder + 1); wpi != waitingPackets.end() && wpi->first == (lastInOrder + 1); ++wpi) {
 		waitBuffer.clear();
 
-		if (fragmentBuffer.data != nullptr) {
+		if (!fragmentBuffer.empty()) {
 			// combine with fragment buffer (packet reassembly)
-			waitBuffer.resize(fragmentBuffer.length);
-			waitBuffer.assign(fragmentBuffer.data, fragmentBuffer.data + fragmentBuffer.length);
-
-			fragmentBuffer.Delete();
+			waitBuffer.assign(fragmentBuffer.begin(), fragmentBuffer.end());
+			fragmentBuffer.clear();
 		}
 
-		std::copy(wpi->second.data, wpi->second.data + wpi->second.length, std::back_inserter(waitBuffer));
+		{
+			const Chunk& chunk = chunkPool[wpi->second];
+			waitBuffer.insert(waitBuffer.end(), chunk.data.begin(), chunk.data.begin() + chunk.chunkSize);
+		}
 
 		incomingChunkNums.erase(wpi->first);
 		// waitingPackets.erase(wpi);
 
 		// mark as processed
-		(wpi->second).Delete();
+		chunkPool.Free(wpi->second);
+		wpi->second = -1;
 
 		// next expected chunk-number
 		lastInOrder++;
@@ -644,7 +779,7 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 
 			// this returns false for zero/invalid pktLength
 			if (ProtocolDef::GetInstance()->IsValidLength(pktLength, msgLength)) {
-				msgQueue.emplace_back(new RawPacket(bufp, pktLength));
+				msgQueue.emplace_back(std::make_shared<const RawPacket>(bufp, pktLength));
 				std::shared_ptr<const RawPacket>& msgPacket = msgQueue.back();
 
 				#ifdef ENABLE_DEBUG_STATS
@@ -677,7 +812,7 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 			} else {
 				if (pktLength >= 0) {
 					// partial packet in buffer
-					fragmentBuffer = RawPacket(bufp, msgLength);
+					fragmentBuffer.assign(bufp, bufp + msgLength);
 					break;
 				}
 
@@ -708,8 +843,8 @@ void UDPConnection::Flush(const bool forced)
 	int outgoingLength = 0;
 
 	if (!waitMore) {
-		for (auto pi = outgoingData.begin(); (pi != outgoingData.end()) && (outgoingLength <= requiredLength); ++pi) {
-			outgoingLength += (*pi)->length;
+		for (size_t i = 0, n = outgoingData.size(); (i < n) && (outgoingLength <= requiredLength); ++i) {
+			outgoingLength += (outgoingData[i]->length - ((i == 0)? outgoingDataPos: 0));
 		}
 	}
 
@@ -728,7 +863,7 @@ void UDPConnection::Flush(const bool forced)
 			sendMore |= ((globalConfig.linkOutgoingBandwidth <= 0) || partialPacket || forced);
 
 			if (!outgoingData.empty() && sendMore) {
-				std::shared_ptr<const RawPacket>& packet = *(outgoingData.begin());
+				const std::shared_ptr<const RawPacket>& packet = outgoingData.front();
 
 				if (!partialPacket && !ProtocolDef::GetInstance()->IsValidPacket(packet->data, packet->length)) {
 					LOG_L(L_ERROR,
@@ -737,21 +872,22 @@ void UDPConnection::Flush(const bool forced)
 					);
 					outgoingData.pop_front();
 				} else {
-					const unsigned numBytes = std::min((unsigned)maxChunkSize - pos, packet->length);
+					const unsigned numBytes = std::min((unsigned)maxChunkSize - pos, packet->length - outgoingDataPos);
 
 					assert(packet->length > 0);
-					memcpy(buffer + pos, packet->data, numBytes);
+					memcpy(buffer + pos, packet->data + outgoingDataPos, numBytes);
 
 					pos += numBytes;
 					sentOverhead += Packet::headerSize;
 
 					outgoing.DataSent(numBytes, true);
 
-					if ((partialPacket = (numBytes != packet->length))) {
-						// partially transferred
-						packet.reset(new RawPacket(packet->data + numBytes, packet->length - numBytes));
+					if ((partialPacket = ((outgoingDataPos + numBytes) != packet->length))) {
+						// partially transferred, continue from here in the next chunk
+						outgoingDataPos += numBytes;
 					} else {
 						// full packet copied
+						outgoingDataPos = 0;
 						outgoingData.pop_front();
 					}
 				}
@@ -809,6 +945,8 @@ std::string UDPConnection::Statistics() const
 		"\t{%.3fx, %.3fx} relative protocol overhead {up, down}\n",
 		"\t%u incoming chunks dropped, %u outgoing chunks resent\n",
 		"\t%u incoming chunks processed\n",
+		"\t%u packets sent   deflated, %u -> %u bytes (%.3fx)\n",
+		"\t%u packets recv'd deflated, %u -> %u bytes (%.3fx)\n",
 	};
 
 	std::string msg = "[UDPConnection::Statistics]\n";
@@ -817,6 +955,8 @@ std::string UDPConnection::Statistics() const
 	msg += spring::format(fmts[2], spring::SafeDivide(sentOverhead * 1.0f, dataSent * 1.0f), spring::SafeDivide(recvOverhead * 1.0f, dataRecv * 1.0f));
 	msg += spring::format(fmts[3], droppedChunks, resentChunks);
 	msg += spring::format(fmts[4], lastInOrder + 1);
+	msg += spring::format(fmts[5], sentDeflatedPackets, sentInflatedSize, sentDeflatedSize, spring::SafeDivide(sentDeflatedSize * 1.0f, sentInflatedSize * 1.0f));
+	msg += spring::format(fmts[6], recvDeflatedPackets, recvInflatedSize, recvDeflatedSize, spring::SafeDivide(recvDeflatedSize * 1.0f, recvInflatedSize * 1.0f));
 	return msg;
 }
 
@@ -835,11 +975,15 @@ void UDPConnection::SetMTU(unsigned mtu2)
 void UDPConnection::CreateChunk(const unsigned char* data, const unsigned length, const int packetNum)
 {
 	assert((length > 0) && (length < 255));
-	ChunkPtr buf(new Chunk);
-	buf->chunkNumber = packetNum;
-	buf->chunkSize = length;
-	std::copy(data, data + length, std::back_inserter(buf->data));
-	newChunks.push_back(buf);
+
+	const int chunkIdx = chunkPool.Alloc();
+	Chunk& chunk = chunkPool[chunkIdx];
+
+	chunk.chunkNumber = packetNum;
+	chunk.chunkSize = length;
+	std::memcpy(chunk.data.data(), data, length);
+
+	newChunks.push_back(chunkIdx);
 	lastChunkCreatedTime = spring_gettime();
 }
 
@@ -897,7 +1041,7 @@ void UDPConnection::SendIfNecessary(bool flushed)
 		// resend last packet if we didn't get an ack within reasonable time
 		// and don't plan sending out a new chunk either
 		if (newChunks.empty())
-			RequestResend(*unackedChunks.rbegin(), false);
+			RequestResend(unackedChunks.back(), false);
 
 		lastUnackResentTime = curTime;
 	}
@@ -921,7 +1065,7 @@ void UDPConnection::SendIfNecessary(bool flushed)
 
 	// resend chunk size
 	const auto CalcResendSize = [&]() {
-		return ((UseMinLossFactor() || (rev == 0)) ? resFwdIter->second->GetSize() : ((rev == 1) ? resRevIter->second->GetSize() : resMidIter->second->GetSize()));
+		return chunkPool[(UseMinLossFactor() || (rev == 0)) ? resFwdIter->second : ((rev == 1) ? resRevIter->second : resMidIter->second)].GetSize();
 	};
 
 	if (!UseMinLossFactor()) {
@@ -953,7 +1097,10 @@ void UDPConnection::SendIfNecessary(bool flushed)
 
 
 	while (((outgoing.GetAverage() <= globalConfig.linkOutgoingBandwidth) || (globalConfig.linkOutgoingBandwidth <= 0))) {
-		Packet buf(lastInOrder, nak);
+		// chunks are referenced by pointer, nothing may be added to chunkPool until sent
+		Packet& buf = sendPacket;
+
+		buf.Reset(lastInOrder, nak);
 
 		if (nak > 0) {
 			buf.naks.resize(nak);
@@ -972,7 +1119,7 @@ void UDPConnection::SendIfNecessary(bool flushed)
 		while (true) {
 			// NB: if maxResend equals 0, then resendRequested is empty and iterators will be invalid
 			const bool canResend = (maxResend > 0) && ((buf.GetSize() + CalcResendSize()) <= mtu);
-			const bool canSendNew = !newChunks.empty() && ((buf.GetSize() + newChunks[0]->GetSize()) <= mtu);
+			const bool canSendNew = !newChunks.empty() && ((buf.GetSize() + chunkPool[newChunks[0]].GetSize()) <= mtu);
 
 			if (!canResend && !canSendNew)
 				break;
@@ -983,7 +1130,7 @@ void UDPConnection::SendIfNecessary(bool flushed)
 			if (resend && canResend) {
 				if (UseMinLossFactor()) {
 					if (erasedResendChunks.find(resFwdIter->first) == erasedResendChunks.end())
-						buf.chunks.push_back(resFwdIter->second);
+						buf.chunks.push_back(&chunkPool[resFwdIter->second]);
 
 					erasedResendChunks.insert((resFwdIter++)->first);
 				} else {
@@ -992,14 +1139,14 @@ void UDPConnection::SendIfNecessary(bool flushed)
 					// chunks, since this improves performance on high latency connections
 					switch (rev) {
 						case 0: {
-							buf.chunks.push_back((resFwdIter++)->second);
+							buf.chunks.push_back(&chunkPool[(resFwdIter++)->second]);
 						} break;
 						case 1: {
-							buf.chunks.push_back((resRevIter++)->second);
+							buf.chunks.push_back(&chunkPool[(resRevIter++)->second]);
 						} break;
 						case 2:
 						case 3: {
-							buf.chunks.push_back(resMidIter->second);
+							buf.chunks.push_back(&chunkPool[resMidIter->second]);
 
 							lastMidChunk = resMidIter->first;
 
@@ -1016,7 +1163,7 @@ void UDPConnection::SendIfNecessary(bool flushed)
 
 				sent = true;
 			} else if (!resend && canSendNew) {
-				buf.chunks.push_back(newChunks[0]);
+				buf.chunks.push_back(&chunkPool[newChunks[0]]);
 				unackedChunks.push_back(newChunks[0]);
 				newChunks.pop_front();
 				sent = true;
@@ -1050,6 +1197,19 @@ void UDPConnection::SendPacket(Packet& pkt)
 {
 	pkt.Serialize(sendBuffer);
 
+	if (peerCompression && globalConfig.networkCompression) {
+		static thread_local PacketDeflater deflater;
+
+		// small packets (acks, single frames) usually do not shrink and go out as-is
+		if (deflater.Deflate(sendBuffer, deflateBuffer)) {
+			sentDeflatedPackets += 1;
+			sentInflatedSize += sendBuffer.size();
+			sentDeflatedSize += deflateBuffer.size();
+
+			sendBuffer.swap(deflateBuffer);
+		}
+	}
+
 	outgoing.DataSent(sendBuffer.size());
 	lastPacketSendTime = spring_gettime();
 
@@ -1069,11 +1229,13 @@ void UDPConnection::SendPacket(Packet& pkt)
 
 void UDPConnection::AckChunks(int lastAck)
 {
-	while (!unackedChunks.empty() && (lastAck >= (*unackedChunks.begin())->chunkNumber)) {
+	while (!unackedChunks.empty() && (lastAck >= chunkPool[unackedChunks.front()].chunkNumber)) {
+		chunkPool.Free(unackedChunks.front());
 		unackedChunks.pop_front();
 	}
 
 	// resend requested and later acked, happens every now and then
+	// (the caller filters these before any freed chunk can be reused)
 	for (size_t i = 0, n = resendRequested.size(); i < n; i++) {
 		if (lastAck < resendRequested[i].first)
 			break;
@@ -1082,9 +1244,9 @@ void UDPConnection::AckChunks(int lastAck)
 	}
 }
 
-void UDPConnection::RequestResend(ChunkPtr ptr, bool noSort)
+void UDPConnection::RequestResend(int chunkIdx, bool noSort)
 {
-	resendRequested.emplace_back(ptr->chunkNumber, ptr);
+	resendRequested.emplace_back(chunkPool[chunkIdx].chunkNumber, chunkIdx);
 
 	if (noSort)
 		return;
@@ -4,10 +4,12 @@
 #define _UDP_CONNECTION_H
 
 #include <asio/ip/udp.hpp>
+#include <array>
+#include <cassert>
 #include <memory>
-#include <deque>
 
 #include "Connection.h"
+#include "RingQueue.h"
 #include "System/Misc/SpringTime.h"
 #include "System/UnorderedSet.hpp"
 
@@ -29,25 +31,72 @@ namespace netcode {
 class Chunk
 {
 public:
-	unsigned GetSize() const { return (data.size() + headerSize); }
+	unsigned GetSize() const { return (chunkSize + headerSize); }
 	void UpdateChecksum(CRC& crc) const;
 	static constexpr unsigned maxSize = 254;
 	static constexpr unsigned headerSize = 5;
-	std::int32_t chunkNumber;
-	std::uint8_t chunkSize;
-	std::vector<std::uint8_t> data;
+	std::int32_t chunkNumber = -1;
+	std::uint8_t chunkSize = 0;
+	std::array<std::uint8_t, maxSize> data;
+};
+
+/**
+ * @brief Slab of chunks addressed by index
+ * Slots are recycled through a free-list, so once the slab has grown to the
+ * connection's working set, creating and acking chunks does not allocate.
+ */
+class ChunkPool
+{
+public:
+	int Alloc() {
+		if (freeSlots.empty()) {
+			chunks.emplace_back();
+			return (chunks.size() - 1);
+		}
+
+		const int idx = freeSlots.back();
+		freeSlots.pop_back();
+		return idx;
+	}
+
+	void Free(int idx) {
+		assert(idx >= 0 && idx < chunks.size());
+		chunks[idx].chunkNumber = -1;
+		freeSlots.push_back(idx);
+	}
+
+	      Chunk& operator [] (int idx)       { return chunks[idx]; }
+	const Chunk& operator [] (int idx) const { return chunks[idx]; }
+
+	size_t GetNumUsed() const { return (chunks.size() - freeSlots.size()); }
+
+private:
+	std::vector<Chunk> chunks;
+	std::vector<int> freeSlots;
 };
-typedef std::shared_ptr<Chunk> ChunkPtr;
 
 
 class Packet
 {
 public:
 	static constexpr unsigned headerSize = 6;
-	Packet(const unsigned char* data, unsigned length);
-	Packet(int _lastCont, int _nakType) {
+	/// replaces lastContinuous (never below -1) in front of deflated packets
+	static constexpr std::int32_t deflatedMarker = -2;
+
+	Packet() = default;
+	Packet(const unsigned char* data, unsigned length) { Unpack(data, length); }
+	Packet(int _lastCont, int _nakType) { Reset(_lastCont, _nakType); }
+
+	/// parse a received packet, reusing the storage of earlier calls
+	/// returns false if it was deflated and could not be inflated
+	bool Unpack(const unsigned char* data, unsigned length);
+	void Reset(int _lastCont, int _nakType) {
 		lastContinuous = _lastCont;
 		nakType = _nakType;
+		checksum = 0;
+
+		naks.clear();
+		chunks.clear();
 	}
 
 	unsigned GetSize() const;
@@ -56,14 +105,23 @@ public:
 
 	void Serialize(std::vector<std::uint8_t>& data);
 
-	std::int32_t lastContinuous;
+	std::int32_t lastContinuous = 0;
 	/// if < 0, we lost -x packets since lastContinuous
 	/// if > 0, x = size of naks
-	std::int8_t nakType;
-	std::uint8_t checksum;
+	std::int8_t nakType = 0;
+	std::uint8_t checksum = 0;
+
+	/// size on the wire if the packet arrived deflated, 0 otherwise
+	unsigned deflatedSize = 0;
 
 	std::vector<std::uint8_t> naks;
-	std::vector<ChunkPtr> chunks;
+	/// views of the chunks, owned by chunkBuffer for received packets
+	/// and by the sending connection's ChunkPool otherwise
+	std::vector<const Chunk*> chunks;
+
+private:
+	std::vector<Chunk> chunkBuffer;
+	std::vector<std::uint8_t> inflateBuffer;
 };
 
 
@@ -73,6 +131,10 @@ public:
  * - 4 (int): last in order (tell the client we received all packages with
  *   packetNumber less or equal)
  * - 1 (unsigned char): nak (we missed x packets, starting with firstUnacked)
+ *
+ * Once the other end has announced it can decode them, packets that shrink
+ * are instead sent as Packet::deflatedMarker followed by the raw-deflated
+ * packet. A peer that sends deflated packets itself is assumed to accept them.
  */
 
 /**
@@ -131,6 +193,7 @@ public:
 	void Unmute() override { muted = false; }
 	void Close(bool flush) override;
 	void SetLossFactor(int factor) override;
+	void SetPeerCompression(bool enable) override { peerCompression = enable; }
 
 	const asio::ip::udp::endpoint& GetEndpoint() const { return addr; }
 
@@ -149,7 +212,7 @@ private:
 	void SendIfNecessary(bool flushed);
 	void AckChunks(int lastAck);
 
-	void RequestResend(ChunkPtr ptr, bool noSort);
+	void RequestResend(int chunkIdx, bool noSort);
 	void SendPacket(Packet& pkt);
 
 	void UpdateWaitingPackets();
@@ -179,33 +242,45 @@ private:
 	bool resend;
 	bool sharedSocket;
 	bool logMessages;
+	/// other end can inflate our packets
+	bool peerCompression;
 
 	int netLossFactor;
 	int reconnectTime;
 
 	/// outgoing stuff (pure data without header) waiting to be sent
-	std::deque< std::shared_ptr<const RawPacket> > outgoingData;
-	/// packets we have received but not yet read
-	std::vector< std::pair<int, RawPacket> > waitingPackets;
+	RingQueue< std::shared_ptr<const RawPacket> > outgoingData;
+	/// bytes of outgoingData.front() already put into chunks
+	unsigned int outgoingDataPos;
+
+	/// storage for all chunks referenced below (by index)
+	ChunkPool chunkPool;
+
+	/// chunks we have received but not yet read, as (chunk-number, pool-index)
+	std::vector< std::pair<int, int> > waitingPackets;
 	spring::unordered_set<int> incomingChunkNums;
 
 
 	/// Newly created and not yet sent
-	std::deque<ChunkPtr> newChunks;
+	RingQueue<int> newChunks;
 	/// packets the other side did not ack'ed until now
-	std::deque<ChunkPtr> unackedChunks;
+	RingQueue<int> unackedChunks;
 
-	/// Packets the other side missed
-	std::vector< std::pair<std::int32_t, ChunkPtr> > resendRequested;
+	/// Packets the other side missed, as (chunk-number, pool-index)
+	std::vector< std::pair<std::int32_t, int> > resendRequested;
 	spring::unordered_set<std::int32_t> erasedResendChunks;
 
 	/// complete packets we received but did not yet consume
-	std::deque< std::shared_ptr<const RawPacket> > msgQueue;
+	RingQueue< std::shared_ptr<const RawPacket> > msgQueue;
 
 	std::vector<std::uint8_t> sendBuffer;
+	std::vector<std::uint8_t> deflateBuffer;
 	std::vector<std::uint8_t> recvBuffer;
 	std::vector<std::uint8_t> waitBuffer;
 
+	Packet sendPacket;
+	Packet recvPacket;
+
 	std::vector<int> droppedPackets;
 
 	std::int32_t lastMidChunk;
@@ -222,7 +297,8 @@ private:
 	/// Our socket
 	std::shared_ptr<asio::ip::udp::socket> mySocket;
 
-	RawPacket fragmentBuffer;
+	/// partial message at the end of the last in-order chunk
+	std::vector<std::uint8_t> fragmentBuffer;
 
 	// Traffic statistics and stuff
 	#ifdef ENABLE_DEBUG_STATS
@@ -244,6 +320,11 @@ private:
 	unsigned int sentOverhead, recvOverhead;
 	unsigned int sentPackets, recvPackets;
 
+	/// number and {inflated, deflated} sizes of compressed packets
+	unsigned int sentDeflatedPackets, recvDeflatedPackets;
+	unsigned int sentInflatedSize, sentDeflatedSize;
+	unsigned int recvInflatedSize, recvDeflatedSize;
+
 	class BandwidthUsage {
 	public:
 		BandwidthUsage() = default;
@@ -134,7 +134,12 @@ void UDPListener::Update() {
 		if (bytesReceived < Packet::headerSize)
 			continue;
 
-		Packet data(&recvBuffer[0], bytesReceived);
+		Packet& data = recvPacket;
+
+		if (!data.Unpack(&recvBuffer[0], bytesReceived)) {
+			LOG_L(L_DEBUG, "[UDPListener::%s] dropping undecodable deflated packet from [%s]:%i", __func__, udpEndPoint.address().to_string().c_str(), udpEndPoint.port());
+			continue;
+		}
 
 		if (ci != connMap.end()) {
 			ci->second.lock()->ProcessRawPacket(data);
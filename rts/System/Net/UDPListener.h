@@ -3,6 +3,7 @@
 #ifndef _UDP_LISTENER_H
 #define _UDP_LISTENER_H
 
+#include "UDPConnection.h"
 #include "System/Misc/NonCopyable.h"
 #include <memory>
 #include <asio/ip/udp.hpp>
@@ -86,6 +87,7 @@ private:
 	std::shared_ptr<asio::ip::udp::socket> socket;
 
 	std::vector<std::uint8_t> recvBuffer;
+	Packet recvPacket;
 
 	/// all connections
 	std::map< asio::ip::udp::endpoint, std::weak_ptr<UDPConnection> > connMap;
@@ -67,6 +67,8 @@ public:
 		pos += (text.size() + 1);
 	}
 
+	size_t GetRemaining() const { return (pckt->length - std::min(pos, size_t(pckt->length))); }
+
 private:
 	std::shared_ptr<const RawPacket> pckt;
 	size_t pos;
@@ -14,7 +14,9 @@
 #include "System/Threading/SpringThreading.h"
 #include "System/UnorderedSet.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cinttypes>
 #include <tuple>
 
 
@@ -113,7 +115,7 @@ namespace springproc {
 	void CPUID::EnumerateCores() {
 		const auto oldAffinity = Threading::GetAffinity();
 
-		LOG("%s: thread affinity %x", __func__, Threading::GetAffinity());
+		LOG("%s: thread affinity %" PRIx64, __func__, Threading::GetAffinity());
 
 		availableProceesorAffinityMask = 0;
 		numLogicalCores = 0;
@@ -142,7 +144,7 @@ namespace springproc {
 		auto& [raw_array, system, badResult] = cpuID.Get();
 
 		Threading::SetAffinity(oldAffinity);
-		LOG("%s: thread affinity %x ...", __func__, Threading::GetAffinity());
+		LOG("%s: thread affinity %" PRIx64 " ...", __func__, Threading::GetAffinity());
 		if (badResult) {
 			LOG_L(L_WARNING, "[CpuId] error: %s", cpuid_error());
 			return;
@@ -174,8 +176,8 @@ namespace springproc {
 		availableProceesorAffinityMask = 1;
 		totalNumPackages = 1;
 
-		// affinity mask is a uint64_t, but spring uses uint32_t
-		assert(numLogicalCores <= MAX_PROCESSORS);
+		// affinity masks are uint64_t's, hosts with more cores only get the first MAX_PROCESSORS
+		const int numMaskedCores = std::min(numLogicalCores, MAX_PROCESSORS);
 
 		static_assert(sizeof(affinityMaskOfCores   ) == (MAX_PROCESSORS * sizeof(affinityMaskOfCores   [0])), "");
 		static_assert(sizeof(affinityMaskOfPackages) == (MAX_PROCESSORS * sizeof(affinityMaskOfPackages[0])), "");
@@ -184,11 +186,11 @@ namespace springproc {
 		memset(affinityMaskOfPackages, 0, sizeof(affinityMaskOfPackages));
 		memset(processorApicIds      , 0, sizeof(processorApicIds      ));
 
-		for (int i = 0; i<numLogicalCores; ++i)
-			availableProceesorAffinityMask |= 1 << i;
+		for (int i = 0; i < numMaskedCores; ++i)
+			availableProceesorAffinityMask |= (uint64_t(1) << i);
 
 		// failed to determine CPU anatomy, just set affinity mask to (-1)
-		for (int i = 0; i < numLogicalCores; i++) {
+		for (int i = 0; i < numMaskedCores; i++) {
 			affinityMaskOfCores[i] = affinityMaskOfPackages[i] = -1;
 		}
 	}
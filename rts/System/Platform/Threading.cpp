@@ -78,27 +78,27 @@ namespace Threading {
 	#if defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__)
 	#elif defined(_WIN32)
 	#else
-	static std::uint32_t CalcCoreAffinityMask(const cpu_set_t* cpuSet) {
-		std::uint32_t coreMask = 0;
+	static std::uint64_t CalcCoreAffinityMask(const cpu_set_t* cpuSet) {
+		std::uint64_t coreMask = 0;
 
-		// without the min(..., 32), `(1 << n)` could overflow
-		const int numCPUs = std::min(CPU_COUNT(&cpusSystem), 32);
+		// without the min(..., 64), `(1 << n)` could overflow
+		const int numCPUs = std::min(CPU_COUNT(&cpusSystem), 64);
 
 		for (int n = numCPUs - 1; n >= 0; --n) {
 			if (CPU_ISSET(n, cpuSet))
-				coreMask |= (1 << n);
+				coreMask |= (std::uint64_t(1) << n);
 		}
 
 		return coreMask;
 	}
 
-	static void SetWantedCoreAffinityMask(cpu_set_t* cpuDstSet, std::uint32_t coreMask) {
+	static void SetWantedCoreAffinityMask(cpu_set_t* cpuDstSet, std::uint64_t coreMask) {
 		CPU_ZERO(cpuDstSet);
 
-		const int numCPUs = std::min(CPU_COUNT(&cpusSystem), 32);
+		const int numCPUs = std::min(CPU_COUNT(&cpusSystem), 64);
 
 		for (int n = numCPUs - 1; n >= 0; --n) {
-			if ((coreMask & (1 << n)) != 0)
+			if ((coreMask & (std::uint64_t(1) << n)) != 0)
 				CPU_SET(n, cpuDstSet);
 		}
 
@@ -108,7 +108,7 @@ namespace Threading {
 
 
 
-	std::uint32_t GetAffinity()
+	std::uint64_t GetAffinity()
 	{
 	#if defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__)
 		// no-op
@@ -129,10 +129,10 @@ namespace Threading {
 	}
 
 
-	std::uint32_t SetAffinity(std::uint32_t coreMask, bool hard)
+	std::uint64_t SetAffinity(std::uint64_t coreMask, bool hard)
 	{
 		if (coreMask == 0)
-			return (~0);
+			return (~std::uint64_t(0));
 
 	#if defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__)
 		// no-op
@@ -153,7 +153,7 @@ namespace Threading {
 		}
 
 		// return final mask
-		return ((static_cast<std::uint32_t>(cpusWanted)) * (result > 0));
+		return ((static_cast<std::uint64_t>(cpusWanted)) * (result > 0));
 	#else
 		cpu_set_t cpusWanted;
 
@@ -168,27 +168,27 @@ namespace Threading {
 	#endif
 	}
 
-	void SetAffinityHelper(const char* threadName, std::uint32_t affinity) {
-		const std::uint32_t cpuMask = Threading::SetAffinity(affinity);
+	void SetAffinityHelper(const char* threadName, std::uint64_t affinity) {
+		const std::uint64_t cpuMask = Threading::SetAffinity(affinity);
 
-		if (cpuMask == ~0u) {
+		if (cpuMask == ~std::uint64_t(0)) {
 			LOG("[Threading] %s thread CPU affinity not set", threadName);
 			return;
 		}
 		if (cpuMask == 0) {
-			LOG_L(L_ERROR, "[Threading] %s thread CPU affinity mask failed: 0x%x", threadName, affinity);
+			LOG_L(L_ERROR, "[Threading] %s thread CPU affinity mask failed: 0x%" PRIx64, threadName, affinity);
 			return;
 		}
 		if (cpuMask != affinity) {
-			LOG("[Threading] %s thread CPU affinity mask set: 0x%x (config is %x)", threadName, cpuMask, affinity);
+			LOG("[Threading] %s thread CPU affinity mask set: 0x%" PRIx64 " (config is %" PRIx64 ")", threadName, cpuMask, affinity);
 			return;
 		}
 
-		LOG("[Threading] %s thread CPU affinity mask set: 0x%x", threadName, cpuMask);
+		LOG("[Threading] %s thread CPU affinity mask set: 0x%" PRIx64, threadName, cpuMask);
 	}
 
 
-	std::uint32_t GetAvailableCoresMask()
+	std::uint64_t GetAvailableCoresMask()
 	{
 	#if defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__)
 		// no-op
@@ -29,6 +29,7 @@
 #include "ExternalAI/AILibraryManager.h"
 #include "Game/CameraHandler.h"
 #include "Game/ClientSetup.h"
+#include "Game/DemoBatch.h"
 #include "Game/GameSetup.h"
 #include "Game/GameVersion.h"
 #include "Game/GameController.h"
@@ -152,6 +153,11 @@ DEFINE_string_EX(calc_checksum,      "calc-checksum",      "",    "Calculate nam
  * the same port number is heavily reused across many replays. Forcing onlyLocal solves this. */
 DEFINE_bool_EX  (onlyLocal,              "only-local",     false, "Force OnlyLocal mode (no network listening sockets). Use for parallelized watching of multiplayer replays");
 
+/* Replays every demo listed in a file (one path per line) back to back as fast as the sim runs, then quits.
+ * The team statistics of each demo are written as JSON into <batch-stats-dir>/<demo name>.json. Implies only-local. */
+DEFINE_string_EX(batch_demos,            "batch-demos",     "",          "Replay all demos listed in this file back to back and write their team statistics as JSON");
+DEFINE_string_EX(batch_stats_dir,        "batch-stats-dir", "demostats", "Directory (relative to the write-dir) --batch-demos writes statistics into");
+
 
 
 int spring::exitCode = spring::EXIT_CODE_SUCCESS;
@@ -567,7 +573,7 @@ void SpringApp::ParseCmdLine(int argc, char* argv[])
 
 	CTextureAtlas::SetDebug(FLAGS_textureatlas);
 
-	CGameSetup::forceOnlyLocal = FLAGS_onlyLocal;
+	CGameSetup::forceOnlyLocal = FLAGS_onlyLocal || !FLAGS_batch_demos.empty();
 
 	// if this fails, configHandler remains null
 	// logOutput's init depends on configHandler
@@ -695,6 +701,15 @@ void SpringApp::Startup()
 
 	luaMenuController = new CLuaMenuController(FLAGS_menu);
 
+	if (!FLAGS_batch_demos.empty()) {
+		if (!demoBatch.Init(FLAGS_batch_demos, FLAGS_batch_stats_dir))
+			throw content_error("no demos to replay in " + FLAGS_batch_demos);
+
+		// later demos are started by CDemoBatch through Reload
+		activeController = RunScript(demoBatch.GetStartScript());
+		return;
+	}
+
 	// no argument (either game is given or show selectmenu)
 	if (inputFile.empty()) {
 		clientSetup->isHost = true;
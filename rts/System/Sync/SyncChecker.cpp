@@ -12,10 +12,40 @@
 unsigned CSyncChecker::g_checksum;
 int CSyncChecker::inSyncedCode;
 
+decltype(CSyncChecker::g_subsysRolling) CSyncChecker::g_subsysRolling;
+decltype(CSyncChecker::g_subsysChecksums) CSyncChecker::g_subsysChecksums;
+decltype(CSyncChecker::g_subsysHistory) CSyncChecker::g_subsysHistory;
+
 
 void CSyncChecker::debugSyncCheckThreading()
 {
     assert(ThreadPool::GetThreadNum() == 0);
 }
 
+void CSyncChecker::EndFrame(int frameNum, std::uint64_t rngState)
+{
+	SubsystemDone(SUBSYS_FRAMEEND);
+
+	g_subsysChecksums[SUBSYS_RULESPARAMS] = g_subsysRolling[SUBSYS_RULESPARAMS];
+	g_subsysChecksums[SUBSYS_RNG] = spring::LiteHash(&rngState, sizeof(rngState), 0);
+
+	SubsystemFrame& sf = g_subsysHistory[frameNum % SUBSYS_HISTORY_SIZE];
+	sf.frameNum = frameNum;
+	sf.checksums = g_subsysChecksums;
+}
+
+bool CSyncChecker::GetSubsystemChecksums(int frameNum, std::vector<std::uint32_t>& checksums)
+{
+	if (frameNum < 0)
+		return false;
+
+	const SubsystemFrame& sf = g_subsysHistory[frameNum % SUBSYS_HISTORY_SIZE];
+
+	if (sf.frameNum != frameNum)
+		return false;
+
+	checksums.assign(sf.checksums.begin(), sf.checksums.end());
+	return true;
+}
+
 #endif // SYNCDEBUG
@@ -7,6 +7,10 @@
 
 #include "System/SpringHash.h"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
 #include <assert.h>
 
 /**
@@ -18,6 +22,37 @@
 class CSyncChecker {
 
 	public:
+		/**
+		 * Subsystems with their own checksum, in the order SimFrame reaches
+		 * them. Each stage entry is the running checksum at the end of that
+		 * stage mixed with the subsystem's own rolling hash of synced events
+		 * (units and features created or removed, projectiles spawned, LOS
+		 * changes), so in the first desynced frame the first differing entry
+		 * names the stage that diverged. RULESPARAMS is a rolling hash over
+		 * all rules-param writes, RNG is the state of the synced generator.
+		 */
+		enum Subsystem {
+			SUBSYS_GAMEFRAME   = 0, // GameFrame callins, helper and map damage
+			SUBSYS_UNITS       = 1,
+			SUBSYS_PATHING     = 2,
+			SUBSYS_PROJECTILES = 3,
+			SUBSYS_FEATURES    = 4,
+			SUBSYS_SCRIPTS     = 5, // quadfield and unit scripts
+			SUBSYS_LOS         = 6, // environmental resources and LOS
+			SUBSYS_FRAMEEND    = 7, // everything up to the end of the frame
+			SUBSYS_RULESPARAMS = 8,
+			SUBSYS_RNG         = 9,
+			SUBSYS_COUNT       = 10,
+		};
+
+		static const char* GetSubsystemName(unsigned int s) {
+			constexpr const char* names[SUBSYS_COUNT + 1] = {
+				"GameFrame", "Units", "Pathing", "Projectiles", "Features",
+				"Scripts", "LOS", "FrameEnd", "RulesParams", "RNG", "Unknown",
+			};
+			return names[std::min(s, unsigned(SUBSYS_COUNT))];
+		}
+
 		/**
 		 * Whether one thread (doesn't have to be the current thread!!!) is currently processing a SimFrame.
 		 */
@@ -29,7 +64,10 @@ class CSyncChecker {
 		 * Keeps a running checksum over all assignments to synced variables.
 		 */
 		static unsigned GetChecksum() { return g_checksum; }
-		static void NewFrame() { g_checksum = 0xfade1eaf; }
+		static void NewFrame() {
+			g_checksum = 0xfade1eaf;
+			g_subsysRolling.fill(0xfade1eaf);
+		}
 		static void debugSyncCheckThreading();
 		static void Sync(const void* p, unsigned size) {
 #ifdef DEBUG_SYNC_MT_CHECK
@@ -42,6 +80,29 @@ class CSyncChecker {
 			//LOG("[Sync::Checker] chksum=%u\n", g_checksum);
 		}
 
+		/**
+		 * Folds a synced event into the rolling hash of subsystem s; unlike
+		 * Sync this leaves the frame checksum sent to the server untouched.
+		 */
+		static void SyncSubsystem(Subsystem s, const void* p, unsigned size) {
+#ifdef DEBUG_SYNC_MT_CHECK
+			debugSyncCheckThreading();
+#endif
+			g_subsysRolling[s] = spring::LiteHash(p, size, g_subsysRolling[s]);
+		}
+		template<typename T> static void SyncSubsystem(Subsystem s, const T& x) { SyncSubsystem(s, &x, sizeof(T)); }
+
+		/// called at the end of the SimFrame stage(s) belonging to s
+		static void SubsystemDone(Subsystem s) {
+			g_subsysChecksums[s] = spring::LiteHash(&g_checksum, sizeof(g_checksum), g_subsysRolling[s]);
+		}
+
+		/// completes and stores the subsystem checksums of frameNum
+		static void EndFrame(int frameNum, std::uint64_t rngState);
+
+		/// false if frameNum is no longer (or not yet) in the history
+		static bool GetSubsystemChecksums(int frameNum, std::vector<std::uint32_t>& checksums);
+
 	private:
 
 		/**
@@ -49,6 +110,19 @@ class CSyncChecker {
 		 */
 		static unsigned g_checksum;
 
+		static std::array<unsigned, SUBSYS_COUNT> g_subsysRolling;
+		static std::array<unsigned, SUBSYS_COUNT> g_subsysChecksums;
+
+		// covers more than the server's SYNCCHECK_TIMEOUT
+		static constexpr unsigned SUBSYS_HISTORY_SIZE = 1024;
+
+		struct SubsystemFrame {
+			int frameNum = -1;
+			std::array<unsigned, SUBSYS_COUNT> checksums;
+		};
+
+		static std::array<SubsystemFrame, SUBSYS_HISTORY_SIZE> g_subsysHistory;
+
 		/**
 		 * @brief in synced code
 		 *
@@ -77,4 +77,12 @@ namespace Sync {
 #  define ASSERT_SYNCED(x)
 #endif
 
+#ifdef SYNCCHECK
+#  define SYNC_SUBSYSTEM(s, x) CSyncChecker::SyncSubsystem(CSyncChecker::s, x)
+#  define SYNC_SUBSYSTEM_DONE(s) CSyncChecker::SubsystemDone(CSyncChecker::s)
+#else
+#  define SYNC_SUBSYSTEM(s, x)
+#  define SYNC_SUBSYSTEM_DONE(s)
+#endif
+
 #endif
@@ -0,0 +1,167 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "TaskGraph.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "System/Threading/ThreadPool.h"
+#include "System/Log/ILog.h"
+
+#include "System/Misc/TracyDefs.h"
+
+
+int CTaskGraph::AddStage(const char* name, ResourceMask reads, ResourceMask writes, bool mainThread, std::function<void()>&& func)
+{
+	const int j = static_cast<int>(stages.size());
+
+	Stage& stage = stages.emplace_back();
+	stage.name = name;
+	stage.func = std::move(func);
+	stage.reads = reads;
+	stage.writes = writes;
+	stage.state = STAGE_PENDING;
+	stage.mainThread = mainThread;
+	stage.startSeq = 0;
+	stage.finishSeq = 0;
+
+	for (int i = 0; i < j; i++) {
+		if (Conflicts(i, j))
+			stage.deps.push_back(i);
+	}
+
+	return j;
+}
+
+
+void CTaskGraph::RunStage(Stage& stage)
+{
+	stage.startSeq = seqCounter.fetch_add(1);
+	stage.func();
+	stage.finishSeq = seqCounter.fetch_add(1);
+}
+
+bool CTaskGraph::IsFinished(int i)
+{
+	Stage& stage = stages[i];
+
+	if (stage.state == STAGE_LAUNCHED && stage.result.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+		stage.result.get();
+		stage.state = STAGE_FINISHED;
+	}
+
+	return (stage.state == STAGE_FINISHED);
+}
+
+void CTaskGraph::Finish(int i)
+{
+	Stage& stage = stages[i];
+
+	switch (stage.state) {
+		case STAGE_PENDING: {
+			// not launched yet, cheaper to run it here than to hand it off and wait
+			for (const int d: stage.deps) {
+				Finish(d);
+			}
+
+			RunStage(stage);
+		} break;
+		case STAGE_LAUNCHED: {
+			stage.result.get();
+		} break;
+		default: {
+		} break;
+	}
+
+	stage.state = STAGE_FINISHED;
+}
+
+bool CTaskGraph::TryLaunch(int i)
+{
+	Stage& stage = stages[i];
+
+	for (const int d: stage.deps) {
+		if (!IsFinished(d))
+			return false;
+	}
+
+	stage.state = STAGE_LAUNCHED;
+
+#ifdef THREADPOOL
+	stage.result = ThreadPool::Enqueue([this, i]() { RunStage(stages[i]); });
+#else
+	RunStage(stage);
+	stage.state = STAGE_FINISHED;
+#endif
+
+	return true;
+}
+
+
+void CTaskGraph::Execute(bool concurrent)
+{
+	if (!concurrent) {
+		for (Stage& stage: stages) {
+			stage.func();
+		}
+
+		return;
+	}
+
+	ZoneScoped;
+
+	for (Stage& stage: stages) {
+		stage.state = STAGE_PENDING;
+	}
+
+	seqCounter.store(0);
+	pendingStages.clear();
+
+	for (int j = 0, n = stages.size(); j < n; j++) {
+		Stage& stage = stages[j];
+
+		if (!stage.mainThread) {
+			if (!TryLaunch(j))
+				pendingStages.push_back(j);
+
+			continue;
+		}
+
+		for (const int d: stage.deps) {
+			Finish(d);
+		}
+
+		RunStage(stage);
+		stage.state = STAGE_FINISHED;
+
+		// launch whatever was only waiting for this stage
+		const auto pred = [this](int i) { return (stages[i].state != STAGE_PENDING || TryLaunch(i)); };
+		pendingStages.erase(std::remove_if(pendingStages.begin(), pendingStages.end(), pred), pendingStages.end());
+	}
+
+	for (int j = 0, n = stages.size(); j < n; j++) {
+		Finish(j);
+	}
+
+	assert(ValidateLastRun());
+}
+
+
+bool CTaskGraph::ValidateLastRun() const
+{
+	bool valid = true;
+
+	for (size_t j = 0; j < stages.size(); j++) {
+		for (size_t i = 0; i < j; i++) {
+			if (!Conflicts(i, j))
+				continue;
+			if (stages[i].finishSeq < stages[j].startSeq)
+				continue;
+
+			LOG_L(L_ERROR, "[TaskGraph::%s] stage \"%s\" overlapped or preceded conflicting stage \"%s\"", __func__, stages[j].name, stages[i].name);
+			valid = false;
+		}
+	}
+
+	return valid;
+}
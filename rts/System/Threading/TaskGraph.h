@@ -0,0 +1,96 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _TASK_GRAPH_H
+#define _TASK_GRAPH_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <vector>
+
+/**
+ * @brief runs a fixed sequence of stages, overlapping those that are independent
+ *
+ * Stages are added in their reference order and declare the resources
+ * (bits of a caller-defined mask) they read and write. A stage depends on
+ * every earlier stage it conflicts with (either one writes a resource the
+ * other reads or writes), so any schedule respecting these dependencies has
+ * the same effect as running the stages in reference order.
+ *
+ * Stages flagged as main-thread-only run on the calling thread, in reference
+ * order. The others are handed to the ThreadPool as soon as everything they
+ * depend on has finished and are waited for only when a later main-thread
+ * stage depends on them (or at the end of Execute), so they overlap with any
+ * main-thread stages in between. Debug builds verify after every concurrent
+ * run that no two conflicting stages overlapped or ran out of order.
+ */
+class CTaskGraph
+{
+public:
+	typedef std::uint64_t ResourceMask;
+
+	void Clear() { stages.clear(); }
+	bool Empty() const { return stages.empty(); }
+
+	/// appends a stage; returns its index
+	int AddStage(const char* name, ResourceMask reads, ResourceMask writes, bool mainThread, std::function<void()>&& func);
+
+	/**
+	 * Runs all stages; in reference order on the calling thread if
+	 * <concurrent> is false, otherwise overlapping independent stages.
+	 */
+	void Execute(bool concurrent);
+
+	size_t GetNumStages() const { return stages.size(); }
+	const char* GetStageName(int i) const { return stages[i].name; }
+
+	/// true if stage <j> must wait for the earlier stage <i>
+	bool Conflicts(int i, int j) const {
+		const Stage& a = stages[i];
+		const Stage& b = stages[j];
+		return (((a.writes & (b.reads | b.writes)) | (a.reads & b.writes)) != 0);
+	}
+
+private:
+	enum StageState {
+		STAGE_PENDING  = 0,
+		STAGE_LAUNCHED = 1,
+		STAGE_FINISHED = 2,
+	};
+
+	struct Stage {
+		const char* name;
+		std::function<void()> func;
+
+		ResourceMask reads;
+		ResourceMask writes;
+
+		// earlier stages this one conflicts with
+		std::vector<int> deps;
+
+		std::shared_future<void> result;
+
+		StageState state;
+		bool mainThread;
+
+		// debug bookkeeping, sequence numbers of the start and end of the last run
+		std::uint32_t startSeq;
+		std::uint32_t finishSeq;
+	};
+
+	void RunStage(Stage& stage);
+	void Finish(int i);
+	bool IsFinished(int i);
+	bool TryLaunch(int i);
+
+	bool ValidateLastRun() const;
+
+private:
+	std::vector<Stage> stages;
+	std::vector<int> pendingStages;
+
+	std::atomic<std::uint32_t> seqCounter = {0};
+};
+
+#endif
@@ -42,6 +42,7 @@
 
 #ifndef UNIT_TEST
 CONFIG(int, WorkerThreadCount).defaultValue(-1).safemodeValue(0).minimumValue(-1).description("Number of workers (including the main thread!) used by ThreadPool.");
+CONFIG(int, WorkerThreadAffinity).defaultValue(1).safemodeValue(0).minimumValue(0).maximumValue(2).description("How ThreadPool workers are pinned to CPU cores. 0 := not pinned, 1 := each worker to its own core, 2 := all workers share the cores not reserved for the main thread. Only cores allowed for the process (e.g. by taskset or numactl) are ever used.");
 #endif
 
 
@@ -107,6 +108,14 @@ static int GetConfigNumWorkers() {
 	#endif
 }
 
+static int GetConfigAffinityPolicy() {
+	#ifndef UNIT_TEST
+	return configHandler->GetInt("WorkerThreadAffinity");
+	#else
+	return 1;
+	#endif
+}
+
 static int GetDefaultNumWorkers() {
 	const int maxNumThreads = GetMaxThreads(); // min(MAX_THREADS, logicalCpus)
 	const int cfgNumWorkers = GetConfigNumWorkers();
@@ -417,11 +426,11 @@ static void KillThreads(int wantedNumThreads, int curNumThreads)
 }
 
 
-static std::uint32_t FindWorkerThreadCore(std::int32_t index, std::uint32_t availCores, std::uint32_t avoidCores)
+static std::uint64_t FindWorkerThreadCore(std::int32_t index, std::uint64_t availCores, std::uint64_t avoidCores)
 {
 	// find an unused core for worker-thread <index>
-	const auto FindCore = [&index](std::uint32_t targetCores) {
-		std::uint32_t workerCore = 1;
+	const auto FindCore = [&index](std::uint64_t targetCores) {
+		std::uint64_t workerCore = 1;
 		std::int32_t n = index;
 
 		while ((workerCore != 0) && !(workerCore & targetCores))
@@ -437,8 +446,8 @@ static std::uint32_t FindWorkerThreadCore(std::int32_t index, std::uint32_t avai
 		return workerCore;
 	};
 
-	const std::uint32_t threadAvailCore = FindCore(availCores);
-	const std::uint32_t threadAvoidCore = FindCore(avoidCores);
+	const std::uint64_t threadAvailCore = FindCore(availCores);
+	const std::uint64_t threadAvoidCore = FindCore(avoidCores);
 
 	if (threadAvailCore != 0)
 		return threadAvailCore;
@@ -447,7 +456,7 @@ static std::uint32_t FindWorkerThreadCore(std::int32_t index, std::uint32_t avai
 		return threadAvoidCore;
 
 	// fallback; use all
-	return (~0u);
+	return (~std::uint64_t(0));
 }
 
 
@@ -586,30 +595,33 @@ void SetMaximumThreadCount()
 
 void SetDefaultThreadCount()
 {
-	std::uint32_t systemCores  = springproc::CPUID::GetInstance().GetAvailableProceesorAffinityMask();
-	std::uint32_t mainAffinity = systemCores;
+	std::uint64_t systemCores  = springproc::CPUID::GetInstance().GetAvailableProceesorAffinityMask();
+	std::uint64_t mainAffinity = systemCores;
 
 	#ifndef UNIT_TEST
 	mainAffinity &= configHandler->GetUnsigned("SetCoreAffinity");
 	#endif
 
-	std::uint32_t workerAvailCores = systemCores & ~mainAffinity;
+	std::uint64_t workerAvailCores = systemCores & ~mainAffinity;
 
 	SetThreadCount(GetDefaultNumWorkers());
 
 	{
+		const int affinityPolicy = GetConfigAffinityPolicy();
+
 		// parallel_reduce now folds over shared_ptrs to futures
 		// const auto ReduceFunc = [](std::uint32_t a, std::future<std::uint32_t>& b) -> std::uint32_t { return (a | b.get()); };
-		const auto ReduceFunc = [](std::uint32_t a, std::shared_future<std::uint32_t> b) -> std::uint32_t { return (a | (b.get())); };
-		const auto AffinityFunc = [&]() -> std::uint32_t {
+		const auto ReduceFunc = [](std::uint64_t a, std::shared_future<std::uint64_t> b) -> std::uint64_t { return (a | (b.get())); };
+		const auto AffinityFunc = [&]() -> std::uint64_t {
 			const int i = ThreadPool::GetThreadNum();
 
 			// 0 is the source thread, skip
-			if (i == 0)
+			if (i == 0 || affinityPolicy == 0)
 				return 0;
 
-			const std::uint32_t workerCore = FindWorkerThreadCore(i - 1, workerAvailCores, mainAffinity);
-			// const std::uint32_t workerCore = workerAvailCores;
+			const std::uint64_t workerCore = (affinityPolicy == 1)?
+				FindWorkerThreadCore(i - 1, workerAvailCores, mainAffinity):
+				((workerAvailCores != 0)? workerAvailCores: systemCores);
 
 			char threadName[20];
 			std::snprintf(threadName, sizeof(threadName), "Worker %d", i);
@@ -618,8 +630,8 @@ void SetDefaultThreadCount()
 			return workerCore;
 		};
 
-		const std::uint32_t poolCoreAffinity = parallel_reduce(AffinityFunc, ReduceFunc);
-		const std::uint32_t mainCoreAffinity = Threading::HasHyperThreading() ? ~poolCoreAffinity : ~0;
+		const std::uint64_t poolCoreAffinity = parallel_reduce(AffinityFunc, ReduceFunc);
+		const std::uint64_t mainCoreAffinity = (Threading::HasHyperThreading() && affinityPolicy == 1) ? ~poolCoreAffinity : ~std::uint64_t(0);
 
 		if (mainAffinity == 0)
 			mainAffinity = systemCores;
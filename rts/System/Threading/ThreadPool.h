@@ -72,6 +72,8 @@ static inline auto parallel_reduce(F&& f, G&& g) -> std::invoke_result_t<F>
 #include <vector>
 #include <numeric>
 #include <atomic>
+#include <algorithm>
+#include <limits>
 
 #undef gt
 #include <memory>
@@ -111,7 +113,7 @@ namespace ThreadPool {
 
 	extern bool inMultiThreadedSection;
 
-	static constexpr int MAX_THREADS = 32;
+	static constexpr int MAX_THREADS = 64;
 }
 
 
@@ -594,48 +596,142 @@ private:
 
 #else
 
+/**
+ * Each participating thread starts out owning an equal contiguous share of
+ * the iteration range and takes chunks from its front, sized to a fraction
+ * of what it has left so they shrink as the share runs out. A thread whose
+ * share is exhausted steals the back half of the largest remaining share
+ * and continues on that; ranges are thus only split (lazily) when some
+ * thread actually runs idle, which keeps per-chunk overhead low for even
+ * workloads while still balancing skewed ones.
+ */
 template<typename F>
 class ForTaskGroup: public ITaskGroup
 {
 public:
-	typedef  TTaskGroup<F, void, int>  ChildTaskType;
-
 	ForTaskGroup(bool pooled) : ITaskGroup(false, pooled) {}
 
-	void Enqueue(const int from, const int to, const int step, F& func)
+	void Enqueue(const int from, const int to, const int step, const int minGrain, const int maxGrain, F& func)
 	{
 		assert(to >= from);
 
-		remainingTasks.store((step == 1) ? (to - from) : ((to - from + step - 1) / step));
-		ctr.store(0);
+		const int numIters = (step == 1) ? (to - from) : ((to - from + step - 1) / step);
+		const int numThreads = ThreadPool::GetNumThreads();
+
+		remainingTasks.store(numIters);
+
+		for (int i = 0; i < numThreads; i++) {
+			const int b = (int64_t(numIters) * (i    )) / numThreads;
+			const int e = (int64_t(numIters) * (i + 1)) / numThreads;
+
+			ranges[i].store(PackRange(b, e), std::memory_order_relaxed);
+		}
 
 		this->from = from;
-		this->to   = to;
 		this->step = step;
+		this->minGrain = std::max(minGrain, 1);
+		this->maxGrain = std::max(maxGrain, this->minGrain);
+		this->numRanges = numThreads;
 		this->func = func;
 	}
 
 	bool IsSliceTask() const override { return true; }
 	bool ExecuteStep() override
 	{
-		const int i = from + (step * ctr.fetch_add(1, std::memory_order_relaxed));
+		const int tid = ThreadPool::GetThreadNum() % numRanges;
 
-		if (i < to) {
-			func(i);
-			remainingTasks -= 1;
-			return true;
+		int b = 0;
+		int e = 0;
+
+		if (!TakeChunk(tid, b, e) && !StealChunk(tid, b, e))
+			return false;
+
+		for (int k = b; k < e; k++) {
+			func(from + step * k);
+		}
+
+		remainingTasks.fetch_sub(e - b, std::memory_order_release);
+		return true;
+	}
+
+private:
+	static uint64_t PackRange(uint32_t b, uint32_t e) { return ((uint64_t(b) << 32) | e); }
+	static int RangeBeg(uint64_t r) { return (r >> 32); }
+	static int RangeEnd(uint64_t r) { return (r & 0xFFFFFFFFu); }
+
+	int ChunkSize(int numLeft) const { return std::min(std::clamp(numLeft >> 2, minGrain, maxGrain), numLeft); }
+
+	// claims a chunk from the front of range <idx>
+	bool TakeChunk(int idx, int& b, int& e) {
+		uint64_t r = ranges[idx].load(std::memory_order_relaxed);
+
+		while (RangeBeg(r) < RangeEnd(r)) {
+			b = RangeBeg(r);
+			e = b + ChunkSize(RangeEnd(r) - b);
+
+			if (ranges[idx].compare_exchange_weak(r, PackRange(e, RangeEnd(r))))
+				return true;
 		}
 
 		return false;
 	}
 
+	// splits off the back half of the largest range left, runs the first chunk of it
+	// and makes the rest available in range <idx> (which must be empty at this point)
+	bool StealChunk(int idx, int& b, int& e) {
+		while (true) {
+			int victim = -1;
+			int maxLeft = 0;
+
+			for (int i = 0; i < numRanges; i++) {
+				const uint64_t r = ranges[i].load(std::memory_order_relaxed);
+				const int numLeft = RangeEnd(r) - RangeBeg(r);
+
+				if (numLeft > maxLeft) {
+					victim = i;
+					maxLeft = numLeft;
+				}
+			}
+
+			if (victim < 0)
+				return false;
+
+			uint64_t r = ranges[victim].load(std::memory_order_relaxed);
+
+			const int vb = RangeBeg(r);
+			const int ve = RangeEnd(r);
+
+			if (vb >= ve)
+				continue;
+
+			const int mid = ve - std::max((ve - vb) >> 1, std::min(minGrain, ve - vb));
+
+			if (!ranges[victim].compare_exchange_strong(r, PackRange(vb, mid)))
+				continue;
+
+			b = mid;
+			e = mid + ChunkSize(ve - mid);
+
+			uint64_t own = ranges[idx].load(std::memory_order_relaxed);
+
+			// if someone else refilled our range meanwhile, just run all we stole
+			if (RangeBeg(own) < RangeEnd(own) || !ranges[idx].compare_exchange_strong(own, PackRange(e, ve)))
+				e = ve;
+
+			return true;
+		}
+	}
+
 private:
-	std::atomic<int> ctr;
+	// packed [begin, end) iteration indices, one per thread
+	std::array<std::atomic<uint64_t>, ThreadPool::MAX_THREADS> ranges;
 	std::function<void(const int)> func;
 
 	int from;
-	int to;
 	int step;
+	int minGrain;
+	int maxGrain;
+	int numRanges;
 };
 #endif
 
@@ -670,8 +766,12 @@ struct TaskPool {
 };
 
 
+/**
+ * Calls f(i) for i in [start, end) with stride <step>. Threads hand out
+ * chunks of between <minGrain> and <maxGrain> iterations; see ForTaskGroup.
+ */
 template <typename F>
-static inline void for_mt(int start, int end, int step, F&& f)
+static inline void for_mt(int start, int end, int step, F&& f, int minGrain = 1, int maxGrain = std::numeric_limits<int>::max())
 {
 	ThreadPool::inMultiThreadedSection = true;
 
@@ -687,20 +787,16 @@ static inline void for_mt(int start, int end, int step, F&& f)
 		static TaskPool<ForTaskGroup, F> pool;
 		auto taskGroup = pool.GetTaskGroup();
 
-		taskGroup->Enqueue(start, end, step, f);
+		taskGroup->Enqueue(start, end, step, minGrain, maxGrain, f);
 		taskGroup->UpdateId();
 
 		assert(taskGroup->IsInJobQueue());
 
-		#if 0
-		ThreadPool::PushTaskGroup(taskGroup);
-		#else
 		// store the group in all worker queues s.t. each executes a slice
 		for (size_t i = 1; i < ThreadPool::GetNumThreads(); ++i) {
 			taskGroup->wantedThread.store(i);
 			ThreadPool::PushTaskGroup(taskGroup);
 		}
-		#endif
 
 		// make calling thread also run ExecuteLoop
 		ThreadPool::WaitForFinished(taskGroup);
@@ -722,25 +818,14 @@ static inline void for_mt_chunk(int b, int e, F&& f, int minChunkSize = 1, int m
 	if (numElems <= 0)
 		return;
 
-	static const int maxThreads = ThreadPool::GetNumThreads();
-
-	const int chunkSize = std::clamp(numElems / maxThreads + (numElems % maxThreads != 0), minChunkSize, maxChunkSize);
-	const int numThreads = numElems / chunkSize + (numElems % chunkSize != 0);
-
-	if (numThreads == 1) {
+	if (numElems <= minChunkSize) {
 		for (int i = b; i < e; ++i)
 			f(i);
 
 		return;
 	}
 
-	for_mt(0, numThreads, 1, [&f, b, e, chunkSize](const int jobId) {
-		const int bb = b + jobId * chunkSize;
-		const int ee = std::min(bb + chunkSize, e);
-
-		for (int i = bb; i < ee; ++i)
-			std::forward<F>(f)(i);
-	});
+	for_mt(b, e, 1, f, minChunkSize, maxChunkSize);
 }
 
 
@@ -807,7 +892,7 @@ static inline auto parallel_reduce(F&& f, G&& g) -> std::invoke_result_t<F>
 		ThreadPool::PushTaskGroup(tasks[i]);
 	}
 
-	return (std::accumulate(results.begin(), results.begin() + ThreadPool::GetNumThreads(), 0, g));
+	return (std::accumulate(results.begin(), results.begin() + ThreadPool::GetNumThreads(), RetType(0), g));
 }
 
 
@@ -138,14 +138,34 @@ bool COutputStreamSerializer::IsWriting()
 
 COutputStreamSerializer::ObjectRef* COutputStreamSerializer::FindObjectRef(void* inst, creg::Class* objClass, bool isEmbedded)
 {
-	std::vector<ObjectRef*>& refs = ptrToId[inst];
-	for (auto& obj: refs) {
+	const auto it = ptrToId.find(inst);
+	if (it == ptrToId.end())
+		return nullptr;
+
+	for (ObjectRef* obj = it->second; obj != nullptr; obj = obj->next) {
 		if (obj->isThisObject(inst, objClass, isEmbedded))
 			return obj;
 	}
 	return nullptr;
 }
 
+void COutputStreamSerializer::AddObjectRef(ObjectRef* obj)
+{
+	ObjectRef*& head = ptrToId[obj->ptr];
+
+	if (head == nullptr) {
+		head = obj;
+		return;
+	}
+
+	// append, FindObjectRef must keep returning the earliest match
+	ObjectRef* tail = head;
+	while (tail->next != nullptr)
+		tail = tail->next;
+
+	tail->next = obj;
+}
+
 void COutputStreamSerializer::SerializeObject(Class* c, void* ptr, ObjectRef* objr)
 {
 	const unsigned objstart = stream->tellp();
@@ -205,7 +225,7 @@ void COutputStreamSerializer::SerializeObjectInstance(void* inst, creg::Class* o
 	if (!obj) {
 		objects.emplace_back(inst, objects.size(), true, objClass);
 		obj = &objects.back();
-		ptrToId[inst].push_back(obj);
+		AddObjectRef(obj);
 	} else if (obj->isEmbedded) {
 		throw std::string("Reserialization of embedded object (") + objClass->name + ")";
 	} else {
@@ -235,7 +255,7 @@ void COutputStreamSerializer::SerializeObjectPtr(void** ptr, creg::Class* objCla
 		if (!obj) {
 			objects.emplace_back(*ptr, objects.size(), false, objClass);
 			obj = &objects.back();
-			ptrToId[*ptr].push_back(obj);
+			AddObjectRef(obj);
 			pendingObjects.push_back(obj);
 		}
 		id = obj->id;
@@ -295,7 +315,7 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 	// Insert the first object that will provide references to everything
 	objects.emplace_back(rootObj, objects.size(), false, rootObjClass);
 	obj = &objects.back();
-	ptrToId[rootObj].push_back(obj);
+	AddObjectRef(obj);
 	pendingObjects.push_back(obj);
 
 	// Save until all the referenced objects have been stored
@@ -373,7 +393,7 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 			const auto it = ptrToId.find(container);
 			if (container == nullptr || it == ptrToId.end())
 				throw std::string("Preallocation container of (") + oRef.class_->name + ") doesn't exist";
-			ObjectRef* objCont = it->second.front();
+			const ObjectRef* objCont = it->second;
 			// write container ID and offset of placement-new location
 			WriteVarSizeUInt(stream, objCont->id);
 			WriteVarSizeUInt(stream, (char*)oRef.ptr - (char*)container);
@@ -398,6 +418,7 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 			ph.metadataChecksum, int(objects.size()), int(classRefs.size()));
 
 	stream->seekp(endOffset);
+	// keep the table's capacity, the next package is usually of similar size
 	ptrToId.clear();
 	pendingObjects.clear();
 	objects.clear();
@@ -13,6 +13,8 @@
 #include <deque>
 #include <istream>
 
+#include "System/UnorderedMap.hpp"
+
 namespace creg {
 
 	/**
@@ -40,6 +42,7 @@ namespace creg {
 				classIndex=0;
 				isEmbedded=false;
 				class_=0;
+				next=nullptr;
 			}
 			ObjectRef(void* ptr, int id, bool isEmbedded, Class* class_) {
 				this->ptr = ptr;
@@ -47,6 +50,7 @@ namespace creg {
 				classIndex=0;
 				this->isEmbedded=isEmbedded;
 				this->class_=class_;
+				next=nullptr;
 			}
 			ObjectRef(const ObjectRef&src) :memberGroups(src.memberGroups){
 				ptr=src.ptr;
@@ -54,11 +58,14 @@ namespace creg {
 				classIndex=src.classIndex;
 				isEmbedded=src.isEmbedded;
 				class_=src.class_;
+				next=src.next;
 			}
 			void* ptr;
 			int id, classIndex;
 			bool isEmbedded;
 			Class* class_;
+			// next reference registered at the same address (e.g. an embedded member at offset 0)
+			ObjectRef* next;
 			std::vector<COutputStreamSerializer::ObjectMemberGroup> memberGroups;
 			bool isThisObject(void* objPtr, Class* objClass, bool objEmbedded) const
 			{
@@ -80,8 +87,21 @@ namespace creg {
 		// Temporary class reference
 		struct ClassRef;
 
+		// pointers are mostly 8- or 16-byte aligned and would cluster in
+		// an open-addressing table when hashed by identity, so mix them
+		struct PtrHash {
+			size_t operator()(const void* p) const {
+				std::uint64_t h = reinterpret_cast<std::uintptr_t>(p);
+				h ^= (h >> 33);
+				h *= 0xff51afd7ed558ccdull;
+				h ^= (h >> 33);
+				return h;
+			}
+		};
+
 		std::ostream* stream;
-		std::map<void*,std::vector<ObjectRef*> > ptrToId;
+		// head of the ObjectRef chain per address, in registration order
+		spring::unsynced_map<const void*, ObjectRef*, PtrHash> ptrToId;
 		std::deque<ObjectRef> objects;
 		std::vector<ObjectRef*> pendingObjects; // these objects still have to be saved
 		std::map<Class*, int> classSizes;
@@ -93,6 +113,7 @@ namespace creg {
 		void WriteObjectRef(void* inst, Class* cls, bool embedded);
 
 		ObjectRef* FindObjectRef(void* inst, Class* objClass, bool isEmbedded);
+		void AddObjectRef(ObjectRef* obj);
 
 		void SerializeObject(Class* c, void* ptr, ObjectRef* objr);
 
@@ -0,0 +1,261 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Misc/SmoothHeightMeshFilters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include <xmmintrin.h>
+
+#include <benchmark/benchmark.h>
+
+// builds the smooth mesh of a synthetic map (the default smoothRadius=40
+// at resolution 2 gives winSize=20) with the filters the mesh used before
+// they were vectorized and with the current ones; the outputs must match
+// bit for bit since the mesh is synced
+static constexpr int WIN_SIZE = 20;
+static constexpr int BLUR_SIZE = WIN_SIZE / 2;
+
+
+namespace Reference {
+	static void FindMaximumColumnHeights(const int2 map, const int y, const int minx, const int maxx, const int winSize, const float* ground, std::vector<float>& colsMaxima, std::vector<int>& maximaRows)
+	{
+		const int miny = std::max(y - winSize, 0);
+		const int maxy = std::min(y + winSize, map.y - 1);
+
+		for (int y1 = miny; y1 <= maxy; ++y1) {
+			for (int x = minx; x <= maxx; ++x)  {
+				const float curh = ground[x + y1 * map.x];
+
+				if (curh >= colsMaxima[x]) {
+					colsMaxima[x] = curh;
+					maximaRows[x] = y1;
+				}
+			}
+		}
+	}
+
+	static void FindRadialMaximum(const int2 map, int y, int minx, int maxx, int winSize, const std::vector<float>& colsMaxima, float* mesh)
+	{
+		for (int x = minx; x <= maxx; ++x) {
+			float maxRowHeight = -std::numeric_limits<float>::max();
+
+			const int startx = std::max(x - winSize, 0);
+			const int endx = std::min(x + winSize, map.x - 1);
+			const int endIdx = endx - 3;
+
+			__m128 best = _mm_loadu_ps(&colsMaxima[startx]);
+			for (int i = startx + 4; i < endIdx; i += 4) {
+				best = _mm_max_ps(best, _mm_loadu_ps(&colsMaxima[i]));
+			}
+
+			best = _mm_max_ps(best, _mm_loadu_ps(&colsMaxima[endIdx]));
+
+			__m128 bestAlt = _mm_movehl_ps(best, best);
+			best = _mm_max_ps(best, bestAlt);
+			bestAlt = _mm_shuffle_ps(best, best, _MM_SHUFFLE(0, 0, 0, 1));
+			best = _mm_max_ss(best, bestAlt);
+			_mm_store_ss(&maxRowHeight, best);
+
+			mesh[x + y * map.x] = maxRowHeight;
+		}
+	}
+
+	static void AdvanceMaximas(const int2 map, const int y, const int minx, const int maxx, const int winSize, const float* ground, std::vector<float>& colsMaxima, std::vector<int>& maximaRows)
+	{
+		const int miny = std::max(y - winSize, 0);
+		const int virtualRow = y + winSize;
+		const int maxy = std::min(virtualRow, map.y - 1);
+
+		for (int x = minx; x <= maxx; ++x) {
+			if (maximaRows[x] < miny) {
+				colsMaxima[x] = -std::numeric_limits<float>::max();
+
+				for (int y1 = miny; y1 <= maxy; ++y1) {
+					const float h = ground[x + y1 * map.x];
+
+					if (h >= colsMaxima[x]) {
+						colsMaxima[x] = h;
+						maximaRows[x] = y1;
+					}
+				}
+			} else if (virtualRow < map.y) {
+				const float h = ground[x + maxy * map.x];
+
+				if (h >= colsMaxima[x]) {
+					colsMaxima[x] = h;
+					maximaRows[x] = maxy;
+				}
+			}
+		}
+	}
+
+	static void MaxFilter(const float* ground, float* dst, int2 map, int2 min, int2 max, int winSize)
+	{
+		std::vector<float> colsMaxima(map.x, -std::numeric_limits<float>::max());
+		std::vector<int> maximaRows(map.x, -1);
+
+		const int minx = std::max(min.x - winSize, 0);
+		const int maxx = std::min(max.x + winSize, map.x - 1);
+
+		FindMaximumColumnHeights(map, min.y, minx, maxx, winSize, ground, colsMaxima, maximaRows);
+
+		for (int y = min.y; y <= max.y; ++y) {
+			FindRadialMaximum(map, y, min.x, max.x, winSize, colsMaxima, dst);
+			AdvanceMaximas(map, y + 1, minx, maxx, winSize, ground, colsMaxima, maximaRows);
+		}
+	}
+
+	static void BlurHorizontal(const float* src, const float* ground, float* dst, int2 map, int2 min, int2 max, int blurSize)
+	{
+		const int lineSize = map.x;
+		const int mapMaxX = map.x - 1;
+
+		for (int y = min.y; y <= max.y; ++y) {
+			float avg = 0.0f;
+			float lv = 0;
+			float rv = 0;
+			float weight = 1.f / ((float)(blurSize*2 + 1));
+			int li = min.x - blurSize;
+			int ri = min.x + blurSize;
+
+			for (int x1 = li; x1 <= ri; ++x1) {
+				avg += src[std::max(0, std::min(x1, mapMaxX)) + y * lineSize];
+			}
+			ri++;
+
+			for (int x = min.x; x <= max.x; ++x) {
+				avg += (-lv) + rv;
+				dst[x + y * lineSize] = std::max(ground[x + y * lineSize], avg*weight);
+
+				lv = src[std::max(0, std::min(li, mapMaxX)) + y * lineSize];
+				rv = src[            std::min(ri, mapMaxX)  + y * lineSize];
+				li++; ri++;
+			}
+		}
+	}
+
+	static void BlurVertical(const float* src, const float* ground, float* dst, int2 map, int2 min, int2 max, int blurSize)
+	{
+		const int lineSize = map.x;
+		const int mapMaxY = map.y - 1;
+
+		for (int x = min.x; x <= max.x; ++x) {
+			float avg = 0.0f;
+			float lv = 0;
+			float rv = 0;
+			float weight = 1.f / ((float)(blurSize*2 + 1));
+			int li = min.y - blurSize;
+			int ri = min.y + blurSize;
+
+			for (int y1 = li; y1 <= ri; ++y1) {
+				avg += src[x + std::max(0, std::min(y1, mapMaxY)) * lineSize];
+			}
+			ri++;
+
+			for (int y = min.y; y <= max.y; ++y) {
+				avg += (-lv) + rv;
+				dst[x + y * lineSize] = std::max(ground[x + y * lineSize], avg*weight);
+
+				lv = src[x + std::max(0, std::min(li, mapMaxY)) * lineSize];
+				rv = src[x +             std::min(ri, mapMaxY)  * lineSize];
+				li++; ri++;
+			}
+		}
+	}
+}
+
+
+struct Mesh {
+	Mesh(int size_)
+		: size{size_, size_}
+		, ground(size_ * size_)
+		, maxima(size_ * size_, 0.0f)
+		, temp(size_ * size_, 0.0f)
+		, smooth(size_ * size_, 0.0f)
+	{
+		// rolling hills with some plateaus (equal heights stress the tie-breaking)
+		// and per-sample noise (so the blur sums are not trivially exact)
+		unsigned int seed = 12345;
+
+		for (int y = 0; y < size.y; ++y) {
+			for (int x = 0; x < size.x; ++x) {
+				seed = seed * 1103515245 + 12345;
+
+				const float hills = 200.0f * std::sin(x * 0.031f) * std::cos(y * 0.017f);
+				const float noise = ((seed >> 16) & 1023) * 0.0173f;
+
+				ground[x + y * size.x] = std::max(std::floor(hills / 25.0f) * 25.0f, hills + noise) - 50.0f;
+			}
+		}
+	}
+
+	template<bool reference>
+	void Build(int2 min, int2 max) {
+		if constexpr (reference) {
+			Reference::MaxFilter(ground.data(), maxima.data(), size, min, max, WIN_SIZE);
+			Reference::BlurHorizontal(maxima.data(), ground.data(), temp.data(), size, min, max, BLUR_SIZE);
+			Reference::BlurVertical(temp.data(), ground.data(), smooth.data(), size, min, max, BLUR_SIZE);
+		} else {
+			SmoothHeightMeshNamespace::MaxFilter(ground.data(), maxima.data(), size, min, max, WIN_SIZE);
+			SmoothHeightMeshNamespace::BlurHorizontal(maxima.data(), ground.data(), temp.data(), size, min, max, BLUR_SIZE);
+			SmoothHeightMeshNamespace::BlurVertical(temp.data(), ground.data(), smooth.data(), size, min, max, BLUR_SIZE);
+		}
+	}
+
+	int2 size;
+
+	std::vector<float> ground;
+	std::vector<float> maxima;
+	std::vector<float> temp;
+	std::vector<float> smooth;
+};
+
+
+static bool SameOutput(int size, int2 min, int2 max)
+{
+	Mesh ref(size);
+	Mesh cur(size);
+
+	ref.Build<true>({0, 0}, {size - 1, size - 1});
+	cur.Build<false>({0, 0}, {size - 1, size - 1});
+
+	// incremental update of a sub-area on top of the full mesh
+	ref.Build<true>(min, max);
+	cur.Build<false>(min, max);
+
+	const size_t numBytes = ref.smooth.size() * sizeof(float);
+
+	return (std::memcmp(ref.maxima.data(), cur.maxima.data(), numBytes) == 0 && std::memcmp(ref.smooth.data(), cur.smooth.data(), numBytes) == 0);
+}
+
+template<bool reference>
+static void BM_SmoothHeightMesh(benchmark::State& state)
+{
+	const int size = state.range(0);
+	const int2 min = {(state.range(1) == 0)? 0: size / 3, (state.range(1) == 0)? 0: size / 4};
+	const int2 max = {(state.range(1) == 0)? size - 1: min.x + int(state.range(1)), (state.range(1) == 0)? size - 1: min.y + int(state.range(1))};
+
+	if (!SameOutput(size, min, max)) {
+		state.SkipWithError("output differs from the reference implementation");
+		return;
+	}
+
+	Mesh mesh(size);
+
+	for (auto _: state) {
+		mesh.Build<reference>(min, max);
+		benchmark::DoNotOptimize(mesh.smooth.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * (max.x - min.x + 1) * (max.y - min.y + 1));
+}
+
+// {mesh size, damaged area size (0 = whole mesh)}
+BENCHMARK_TEMPLATE(BM_SmoothHeightMesh, true )->ArgsProduct({{256, 512, 1024}, {0}})->Args({1024, 32})->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_SmoothHeightMesh, false)->ArgsProduct({{256, 512, 1024}, {0}})->Args({1024, 32})->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
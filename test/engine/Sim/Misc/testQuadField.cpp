@@ -1,12 +1,14 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include "Sim/Misc/QuadField.h"
+#include "System/ContainerUtil.h"
 #include "System/float3.h"
 #include "System/SpringMath.h"
 #include <stdlib.h>
 #include <time.h>
 
 #define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
 #include "lib/catch.hpp"
 
 static inline float randf()
@@ -102,3 +104,267 @@ TEST_CASE("QuadField")
 	INFO("Too little quads returned!");
 	CHECK_FALSE(fail);
 }
+
+
+
+// stand-in for units, CQuadField itself needs the full sim
+struct QuadObject {
+	float3 pos;
+	int group;
+	int cell;
+};
+
+// per-cell vectors as in CQuadField::Quad
+struct VectorCell {
+	std::vector<QuadObject*> objects;
+	std::vector< std::vector<QuadObject*> > groupObjects;
+};
+
+TEST_CASE("QuadFieldCellArray")
+{
+	srand( time(nullptr) );
+
+	static constexpr int NUM_CELLS  = 16;
+	static constexpr int NUM_GROUPS = 3;
+	static constexpr int NUM_OBJECTS = 200;
+	static constexpr int TEST_RUNS = 20000;
+
+	QuadFieldCellArray<QuadObject*> cells;
+	cells.Init(NUM_CELLS, NUM_GROUPS);
+
+	// reference keeping insertion order per group
+	std::vector< std::vector<QuadObject*> > groups(NUM_CELLS * NUM_GROUPS);
+	std::vector<QuadObject> objects(NUM_OBJECTS);
+
+	for (QuadObject& o: objects) {
+		o.group = rand() % NUM_GROUPS;
+		o.cell = -1;
+	}
+
+	bool fail = false;
+
+	for (int n = 0; n < TEST_RUNS && !fail; ++n) {
+		QuadObject& o = objects[rand() % NUM_OBJECTS];
+
+		if (o.cell >= 0) {
+			auto& g = groups[o.cell * NUM_GROUPS + o.group];
+
+			fail |= !cells.Erase(o.cell, o.group, &o);
+			g.erase(std::find(g.begin(), g.end(), &o));
+		}
+
+		o.cell = (rand() % 4 == 0)? -1: (rand() % NUM_CELLS);
+
+		if (o.cell >= 0) {
+			cells.Insert(o.cell, o.group, &o);
+			groups[o.cell * NUM_GROUPS + o.group].push_back(&o);
+		}
+
+		if (rand() % 100 == 0)
+			cells.Update();
+
+		for (int c = 0; c < NUM_CELLS; ++c) {
+			std::vector<QuadObject*> cellObjects;
+
+			for (int g = 0; g < NUM_GROUPS; ++g) {
+				const auto span = cells.Group(c, g);
+				const auto& ref = groups[c * NUM_GROUPS + g];
+
+				fail |= !std::equal(span.begin(), span.end(), ref.begin(), ref.end());
+				cellObjects.insert(cellObjects.end(), ref.begin(), ref.end());
+			}
+
+			const auto span = cells.Cell(c);
+			fail |= !std::equal(span.begin(), span.end(), cellObjects.begin(), cellObjects.end());
+		}
+	}
+
+	INFO("Flat cell contents differ from the reference!");
+	CHECK_FALSE(fail);
+}
+
+
+// GenerateWeaponTargets calls Lua for every unit of a quad, which may move
+// units into other cells; a cell that runs out of slack then relocates and
+// reallocates the whole array, so callers must iterate a copy of the group
+TEST_CASE("QuadFieldCellArrayRelocation")
+{
+	static constexpr int NUM_CELLS  = 4;
+	static constexpr int NUM_GROUPS = 2;
+	static constexpr int NUM_OBJECTS = 64;
+
+	QuadFieldCellArray<QuadObject*> cells;
+	cells.Init(NUM_CELLS, NUM_GROUPS);
+
+	std::vector<QuadObject> objects(NUM_OBJECTS);
+
+	for (int i = 0; i < 3; ++i) {
+		cells.Insert(0, 1, &objects[i]);
+	}
+
+	const auto liveSpan = cells.Group(0, 1);
+	const std::vector<QuadObject*> groupCopy(liveSpan.begin(), liveSpan.end());
+
+	const QuadObject* const* oldData = liveSpan.data();
+	const size_t oldCapacity = cells.GetCapacity();
+
+	std::vector<QuadObject*> visited;
+	std::vector<QuadObject*> moved;
+
+	for (QuadObject* o: groupCopy) {
+		visited.push_back(o);
+
+		// each visit moves more objects into cell 1 than its slack can hold
+		for (int i = 0; i < 8; ++i) {
+			QuadObject* m = &objects[3 + moved.size()];
+
+			cells.Insert(1, 0, m);
+			moved.push_back(m);
+		}
+	}
+
+	// the array did grow, so <liveSpan> would have been left dangling
+	CHECK(cells.GetCapacity() > oldCapacity);
+	CHECK(cells.Group(0, 1).data() != oldData);
+
+	CHECK(visited == groupCopy);
+
+	const auto group01 = cells.Group(0, 1);
+	const auto group10 = cells.Group(1, 0);
+
+	CHECK(std::equal(group01.begin(), group01.end(), groupCopy.begin(), groupCopy.end()));
+	CHECK(std::equal(group10.begin(), group10.end(), moved.begin(), moved.end()));
+}
+
+
+// compares the two quadfield storage layouts under the same load: objects
+// moving between cells every frame and radius queries over the cells
+// run with: test_QuadField "[benchmark]"
+TEST_CASE("QuadFieldStorageBenchmark", "[.][benchmark]")
+{
+	static constexpr int NUM_CELLS_X = 64;
+	static constexpr int NUM_GROUPS  = 8;
+	static constexpr int NUM_OBJECTS = 8000;
+	static constexpr int NUM_QUERIES = 2000;
+	static constexpr float CELL_SIZE = 128.0f;
+	static constexpr float QUERY_RADIUS = 500.0f;
+
+	const auto CellIdx = [](const float3& p) {
+		const int x = std::clamp(int(p.x / CELL_SIZE), 0, NUM_CELLS_X - 1);
+		const int z = std::clamp(int(p.z / CELL_SIZE), 0, NUM_CELLS_X - 1);
+		return (z * NUM_CELLS_X + x);
+	};
+
+	std::vector<QuadObject> vecObjects(NUM_OBJECTS);
+	std::vector<VectorCell> vecCells(NUM_CELLS_X * NUM_CELLS_X);
+
+	std::vector<QuadObject> flatObjects(NUM_OBJECTS);
+	QuadFieldCellArray<QuadObject*> flatCells;
+
+	std::vector<float3> steps(NUM_OBJECTS);
+	std::vector<float3> queries(NUM_QUERIES);
+
+	srand(1234);
+
+	for (VectorCell& c: vecCells) {
+		c.groupObjects.resize(NUM_GROUPS);
+	}
+
+	flatCells.Init(NUM_CELLS_X * NUM_CELLS_X, NUM_GROUPS);
+
+	for (int i = 0; i < NUM_OBJECTS; ++i) {
+		QuadObject& vo = vecObjects[i];
+		QuadObject& fo = flatObjects[i];
+
+		// clustered like armies rather than uniformly spread
+		const float3 center = {float((i / 500) % 4) * 2000.0f + 500.0f, 0.0f, float((i / 2000) % 4) * 2000.0f + 500.0f};
+
+		vo.pos = center + float3(randf() * 1000.0f, 0.0f, randf() * 1000.0f);
+		vo.group = i % NUM_GROUPS;
+		vo.cell = CellIdx(vo.pos);
+		fo = vo;
+
+		vecCells[vo.cell].objects.push_back(&vo);
+		vecCells[vo.cell].groupObjects[vo.group].push_back(&vo);
+		flatCells.Insert(fo.cell, fo.group, &fo);
+
+		steps[i] = float3(randf() - 0.5f, 0.0f, randf() - 0.5f) * 40.0f;
+	}
+
+	for (float3& q: queries) {
+		q = vecObjects[rand() % NUM_OBJECTS].pos;
+	}
+
+	flatCells.Update();
+
+	const auto Move = [&](std::vector<QuadObject>& objects, int frame, const auto& moveFunc) {
+		for (int i = 0; i < NUM_OBJECTS; ++i) {
+			QuadObject& o = objects[i];
+
+			// back and forth so the layout stays comparable between runs
+			o.pos += (((frame / 16) & 1)? -steps[i]: steps[i]);
+
+			const int cell = CellIdx(o.pos);
+
+			if (cell == o.cell)
+				continue;
+
+			moveFunc(o, cell);
+			o.cell = cell;
+		}
+	};
+
+	const auto Query = [&](const auto& cellFunc) {
+		size_t count = 0;
+
+		for (const float3& q: queries) {
+			const int minX = std::max(int((q.x - QUERY_RADIUS) / CELL_SIZE), 0);
+			const int minZ = std::max(int((q.z - QUERY_RADIUS) / CELL_SIZE), 0);
+			const int maxX = std::min(int((q.x + QUERY_RADIUS) / CELL_SIZE), NUM_CELLS_X - 1);
+			const int maxZ = std::min(int((q.z + QUERY_RADIUS) / CELL_SIZE), NUM_CELLS_X - 1);
+
+			for (int z = minZ; z <= maxZ; ++z) {
+				for (int x = minX; x <= maxX; ++x) {
+					for (const QuadObject* o: cellFunc(z * NUM_CELLS_X + x, q.x > q.z)) {
+						count += (o->pos.SqDistance2D(q) < Square(QUERY_RADIUS));
+					}
+				}
+			}
+		}
+
+		return count;
+	};
+
+	int vecFrame = 0;
+	int flatFrame = 0;
+
+	BENCHMARK("vector cells: move") {
+		Move(vecObjects, vecFrame++, [&](QuadObject& o, int cell) {
+			spring::VectorErase(vecCells[o.cell].objects, &o);
+			spring::VectorErase(vecCells[o.cell].groupObjects[o.group], &o);
+			spring::VectorInsertUnique(vecCells[cell].objects, &o, false);
+			spring::VectorInsertUnique(vecCells[cell].groupObjects[o.group], &o, false);
+		});
+	};
+	BENCHMARK("flat cells: move + repack") {
+		Move(flatObjects, flatFrame++, [&](QuadObject& o, int cell) {
+			flatCells.Erase(o.cell, o.group, &o);
+			flatCells.Insert(cell, o.group, &o);
+		});
+		flatCells.Update();
+	};
+
+	BENCHMARK("vector cells: query all") {
+		return Query([&](int c, bool) { return std::span<QuadObject* const>(vecCells[c].objects); });
+	};
+	BENCHMARK("flat cells: query all") {
+		return Query([&](int c, bool) { return flatCells.Cell(c); });
+	};
+
+	BENCHMARK("vector cells: query group") {
+		return Query([&](int c, bool odd) { return std::span<QuadObject* const>(vecCells[c].groupObjects[odd]); });
+	};
+	BENCHMARK("flat cells: query group") {
+		return Query([&](int c, bool odd) { return flatCells.Group(c, odd); });
+	};
+}
@@ -0,0 +1,489 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Units/Scripts/CobProgram.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Compares the old fetch-and-switch loop over raw COB bytecode with the
+// pre-decoded instruction stream CCobThread::Tick now runs. Set
+// COB_BENCHMARK_DIR to a directory of .cob files (e.g. a game's extracted
+// scripts/ folder) to run every function of every script in it, otherwise
+// a synthetic script is used. Engine callouts are stubbed to pop their
+// arguments; both loops must end with the same stack.
+
+namespace {
+	struct CobScript {
+		std::vector<int> code;
+		std::vector<std::string> scriptNames;
+		std::vector<int> scriptOffsets;
+		std::vector<int> scriptLengths;
+		int numStaticVars = 0;
+	};
+
+	// bytecode instructions executed per function before giving up (most scripts loop forever)
+	constexpr int MAX_STEPS = 4096;
+
+	int ReadInt(const std::vector<std::uint8_t>& data, size_t ofs) {
+		int v = 0;
+		if ((ofs + sizeof(v)) <= data.size())
+			std::memcpy(&v, &data[ofs], sizeof(v));
+		return v;
+	}
+
+	bool LoadScript(const std::filesystem::path& path, CobScript& script) {
+		std::ifstream ifs(path, std::ios::binary);
+		std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+		if (data.size() < 44)
+			return false;
+
+		const int numScripts = ReadInt(data, 4);
+		const int totalScriptLen = ReadInt(data, 12);
+		const int offsetToCodeIndex = ReadInt(data, 24);
+		const int offsetToNameOffsets = ReadInt(data, 28);
+		const int offsetToCode = ReadInt(data, 36);
+
+		if (numScripts <= 0 || offsetToCode <= 0 || size_t(offsetToCode) > data.size())
+			return false;
+
+		for (int i = 0; i < numScripts; ++i) {
+			const size_t nameOfs = ReadInt(data, offsetToNameOffsets + i * 4);
+
+			if (nameOfs >= data.size())
+				return false;
+
+			script.scriptNames.emplace_back(reinterpret_cast<const char*>(&data[nameOfs]), strnlen(reinterpret_cast<const char*>(&data[nameOfs]), data.size() - nameOfs));
+			script.scriptOffsets.push_back(ReadInt(data, offsetToCodeIndex + i * 4));
+		}
+		for (int i = 0; i < numScripts; ++i) {
+			script.scriptLengths.push_back(((i + 1) < numScripts ? script.scriptOffsets[i + 1] : totalScriptLen) - script.scriptOffsets[i]);
+		}
+
+		script.code.resize((data.size() - offsetToCode) / 4 + 4, 0);
+		std::memcpy(script.code.data(), &data[offsetToCode], data.size() - offsetToCode);
+		script.numStaticVars = ReadInt(data, 16);
+		return true;
+	}
+
+	CobScript MakeSyntheticScript() {
+		using namespace CobOpcode;
+
+		// Main: for (i = 0; i < 50; i++) { s = s + ((i * 3) & 7) - 1; if (s >= 100) s = 0; call Sub(i); } return s;
+		// Sub(x): return x * 2 + 1;
+		CobScript script;
+		std::vector<int>& c = script.code;
+
+		c.insert(c.end(), {CREATE_LOCAL_VAR, CREATE_LOCAL_VAR, PUSH_CONSTANT, 0, POP_LOCAL_VAR, 0, PUSH_CONSTANT, 0, POP_LOCAL_VAR, 1});
+
+		const int loopOfs = c.size();
+		c.insert(c.end(), {PUSH_LOCAL_VAR, 0, PUSH_CONSTANT, 50, SET_LESS, JUMP_NOT_EQUAL, 0});
+		const size_t exitJump = c.size() - 1;
+
+		c.insert(c.end(), {PUSH_LOCAL_VAR, 1, PUSH_LOCAL_VAR, 0, PUSH_CONSTANT, 3, MUL, PUSH_CONSTANT, 7, BITWISE_AND, ADD, PUSH_CONSTANT, 1, SUB, POP_LOCAL_VAR, 1});
+		c.insert(c.end(), {PUSH_LOCAL_VAR, 1, PUSH_CONSTANT, 100, SET_GREATER_OR_EQUAL, JUMP_NOT_EQUAL, 0});
+		const size_t skipJump = c.size() - 1;
+
+		c.insert(c.end(), {PUSH_CONSTANT, 0, POP_LOCAL_VAR, 1});
+		c[skipJump] = c.size();
+
+		c.insert(c.end(), {PUSH_LOCAL_VAR, 0, CALL, 1, 1, PUSH_LOCAL_VAR, 0, PUSH_CONSTANT, 1, ADD, POP_LOCAL_VAR, 0, JUMP, loopOfs});
+		c[exitJump] = c.size();
+
+		c.insert(c.end(), {PUSH_LOCAL_VAR, 1, RETURN});
+
+		const int subOfs = c.size();
+		c.insert(c.end(), {CREATE_LOCAL_VAR, PUSH_LOCAL_VAR, 0, PUSH_CONSTANT, 2, MUL, PUSH_CONSTANT, 1, ADD, RETURN});
+
+		script.scriptNames = {"Main", "Sub"};
+		script.scriptOffsets = {0, subOfs};
+		script.scriptLengths = {subOfs, int(c.size()) - subOfs};
+
+		c.insert(c.end(), 4, 0);
+		return script;
+	}
+
+	std::vector<CobScript>& GetScripts() {
+		static std::vector<CobScript> scripts;
+
+		if (!scripts.empty())
+			return scripts;
+
+		if (const char* dir = std::getenv("COB_BENCHMARK_DIR"); dir != nullptr) {
+			for (const auto& entry: std::filesystem::recursive_directory_iterator(dir)) {
+				if (entry.path().extension() != ".cob")
+					continue;
+
+				CobScript script;
+
+				if (LoadScript(entry.path(), script))
+					scripts.emplace_back(std::move(script));
+			}
+		}
+
+		if (scripts.empty())
+			scripts.emplace_back(MakeSyntheticScript());
+
+		return scripts;
+	}
+
+
+	struct Frame {
+		int returnAddr;
+		int stackTop;
+	};
+
+	struct Machine {
+		std::vector<int> dataStack;
+		std::vector<Frame> callStack;
+		std::vector<int> staticVars;
+		int paramCount = 0;
+		int steps = 0;
+
+		void Reset(const CobScript& script) {
+			dataStack.clear();
+			callStack.clear();
+			staticVars.assign(script.numStaticVars, 0);
+			callStack.push_back({-1, 0});
+			paramCount = 0;
+			steps = 0;
+		}
+
+		void Push(int v) { dataStack.push_back(v); }
+		int Pop() {
+			if (dataStack.empty())
+				return 0;
+			const int v = dataStack.back();
+			dataStack.pop_back();
+			return v;
+		}
+		void PopN(int n) {
+			for (int i = 0; i < n; ++i)
+				Pop();
+		}
+
+		int& Local(int i) {
+			static int dummy = 0;
+			const size_t idx = callStack.back().stackTop + i;
+			return (idx < dataStack.size())? dataStack[idx]: (dummy = 0);
+		}
+		int& Static(int i) {
+			static int dummy = 0;
+			return (static_cast<size_t>(i) < staticVars.size())? staticVars[i]: (dummy = 0);
+		}
+
+		// returns the pc to continue at, -1 when the outermost frame returned
+		int Return() {
+			const Frame f = callStack.back();
+
+			if (f.returnAddr == -1)
+				return -1;
+			if (dataStack.size() > size_t(f.stackTop))
+				dataStack.resize(f.stackTop);
+
+			callStack.pop_back();
+			return f.returnAddr;
+		}
+		void Call(int returnAddr, int numArgs) {
+			callStack.push_back({returnAddr, int(dataStack.size()) - numArgs});
+			paramCount = numArgs;
+		}
+	};
+
+	// stubbed engine callouts, identical for both loops; returns false for unhandled ops
+	bool ExecCallout(Machine& m, int op) {
+		switch (op) {
+			case COB_OP_MOVE: case COB_OP_TURN: case COB_OP_SPIN: m.PopN(2); return true;
+			case COB_OP_STOP_SPIN: case COB_OP_MOVE_NOW: case COB_OP_TURN_NOW: case COB_OP_EMIT_SFX: m.PopN(1); return true;
+			case COB_OP_SLEEP: case COB_OP_EXPLODE: case COB_OP_PLAY_SOUND: case COB_OP_SIGNAL: case COB_OP_SET_SIGNAL_MASK: case COB_OP_DROP: m.PopN(1); return true;
+			case COB_OP_SHOW: case COB_OP_HIDE: case COB_OP_WAIT_TURN: case COB_OP_WAIT_MOVE: case COB_OP_NOP: return true;
+			case COB_OP_GET_UNIT_VALUE: m.PopN(1); m.Push(0); return true;
+			case COB_OP_GET: m.PopN(5); m.Push(0); return true;
+			case COB_OP_SET: m.PopN(2); return true;
+			case COB_OP_ATTACH: m.PopN(3); return true;
+			case COB_OP_RAND: { const int hi = m.Pop(); const int lo = m.Pop(); m.Push((lo + hi) / 2); } return true;
+			default: break;
+		}
+		return false;
+	}
+
+	int ExecBinary(int op, int r1, int r2) {
+		switch (op) {
+			case COB_OP_ADD: return r1 + r2;
+			case COB_OP_SUB: return r1 - r2;
+			case COB_OP_MUL: return r1 * r2;
+			case COB_OP_DIV: return (r2 != 0)? r1 / r2: 1000;
+			case COB_OP_MOD: return (r2 != 0)? r1 % r2: 0;
+			case COB_OP_BITWISE_AND: return r1 & r2;
+			case COB_OP_BITWISE_OR: return r1 | r2;
+			case COB_OP_BITWISE_XOR: return r1 ^ r2;
+			case COB_OP_SET_LESS: return r1 < r2;
+			case COB_OP_SET_LESS_OR_EQUAL: return r1 <= r2;
+			case COB_OP_SET_GREATER: return r1 > r2;
+			case COB_OP_SET_GREATER_OR_EQUAL: return r1 >= r2;
+			case COB_OP_SET_EQUAL: return r1 == r2;
+			case COB_OP_SET_NOT_EQUAL: return r1 != r2;
+			case COB_OP_LOGICAL_AND: return r1 && r2;
+			case COB_OP_LOGICAL_OR: return r1 || r2;
+			case COB_OP_LOGICAL_XOR: return (!!r1) ^ (!!r2);
+			default: break;
+		}
+		return 0;
+	}
+
+
+	// the pre-decoding interpreter: fetch, decode and switch on every raw opcode
+	void RunLegacy(const CobScript& script, int function, Machine& m) {
+		const std::vector<int>& code = script.code;
+		int pc = script.scriptOffsets[function];
+
+		#define GET_LONG_PC() (code.at(pc++))
+
+		for (m.Reset(script); m.steps < MAX_STEPS; m.steps++) {
+			const int opcode = GET_LONG_PC();
+
+			switch (opcode) {
+				case CobOpcode::PUSH_CONSTANT: { m.Push(GET_LONG_PC()); } break;
+				case CobOpcode::PUSH_LOCAL_VAR: { const int i = GET_LONG_PC(); m.Push(m.Local(i)); } break;
+				case CobOpcode::POP_LOCAL_VAR: { const int i = GET_LONG_PC(); const int v = m.Pop(); m.Local(i) = v; } break;
+				case CobOpcode::PUSH_STATIC: { const int i = GET_LONG_PC(); if (size_t(i) < m.staticVars.size()) m.Push(m.staticVars[i]); } break;
+				case CobOpcode::POP_STATIC: { const int i = GET_LONG_PC(); const int v = m.Pop(); m.Static(i) = v; } break;
+				case CobOpcode::CREATE_LOCAL_VAR: { if (m.paramCount == 0) m.Push(0); else m.paramCount--; } break;
+				case CobOpcode::POP_STACK: { m.Pop(); } break;
+				case CobOpcode::BITWISE_NOT: { m.Push(~m.Pop()); } break;
+				case CobOpcode::LOGICAL_NOT: { m.Push(m.Pop() == 0); } break;
+				case CobOpcode::JUMP: { pc = GET_LONG_PC(); } break;
+				case CobOpcode::JUMP_NOT_EQUAL: { const int t = GET_LONG_PC(); if (m.Pop() == 0) pc = t; } break;
+				case CobOpcode::RETURN: { m.Pop(); if ((pc = m.Return()) == -1) return; } break;
+				case CobOpcode::CALL:
+				case CobOpcode::REAL_CALL: {
+					const int fn = GET_LONG_PC();
+					const int n = GET_LONG_PC();
+
+					if (size_t(fn) >= script.scriptNames.size())
+						break;
+					if (opcode == CobOpcode::CALL && script.scriptNames[fn].find("lua_") == 0) {
+						m.PopN(n);
+						break;
+					}
+					if (script.scriptLengths[fn] == 0)
+						break;
+
+					m.Call(pc, n);
+					pc = script.scriptOffsets[fn];
+				} break;
+				case CobOpcode::LUA_CALL: { GET_LONG_PC(); m.PopN(GET_LONG_PC()); } break;
+				case CobOpcode::START: {
+					const int fn = GET_LONG_PC();
+					const int n = GET_LONG_PC();
+
+					if (size_t(fn) < script.scriptLengths.size() && script.scriptLengths[fn] != 0)
+						m.PopN(n);
+				} break;
+
+				#define COB_LEGACY_BINARY_CASE(name, binop) \
+				case CobOpcode::name: { const int r2 = m.Pop(); const int r1 = m.Pop(); m.Push(ExecBinary(COB_OP_##name, r1, r2)); } break;
+				COB_CONSTANT_OPS(COB_LEGACY_BINARY_CASE)
+				COB_COMPARE_OPS(COB_LEGACY_BINARY_CASE)
+				COB_LEGACY_BINARY_CASE(DIV, /)
+				COB_LEGACY_BINARY_CASE(MOD, %)
+				COB_LEGACY_BINARY_CASE(BITWISE_XOR, ^)
+				COB_LEGACY_BINARY_CASE(LOGICAL_AND, &&)
+				COB_LEGACY_BINARY_CASE(LOGICAL_OR, ||)
+				COB_LEGACY_BINARY_CASE(LOGICAL_XOR, ^)
+				#undef COB_LEGACY_BINARY_CASE
+
+				#define COB_LEGACY_CALLOUT_CASE(name, operands, instrOp) \
+				case CobOpcode::name: { for (int i = 0; i < operands; ++i) GET_LONG_PC(); ExecCallout(m, COB_OP_##instrOp); } break;
+				COB_LEGACY_CALLOUT_CASE(MOVE, 2, MOVE)
+				COB_LEGACY_CALLOUT_CASE(TURN, 2, TURN)
+				COB_LEGACY_CALLOUT_CASE(SPIN, 2, SPIN)
+				COB_LEGACY_CALLOUT_CASE(STOP_SPIN, 2, STOP_SPIN)
+				COB_LEGACY_CALLOUT_CASE(SHOW, 1, SHOW)
+				COB_LEGACY_CALLOUT_CASE(HIDE, 1, HIDE)
+				COB_LEGACY_CALLOUT_CASE(CACHE, 1, NOP)
+				COB_LEGACY_CALLOUT_CASE(DONT_CACHE, 1, NOP)
+				COB_LEGACY_CALLOUT_CASE(SHADE, 1, NOP)
+				COB_LEGACY_CALLOUT_CASE(DONT_SHADE, 1, NOP)
+				COB_LEGACY_CALLOUT_CASE(MOVE_NOW, 2, MOVE_NOW)
+				COB_LEGACY_CALLOUT_CASE(TURN_NOW, 2, TURN_NOW)
+				COB_LEGACY_CALLOUT_CASE(EMIT_SFX, 1, EMIT_SFX)
+				COB_LEGACY_CALLOUT_CASE(WAIT_TURN, 2, WAIT_TURN)
+				COB_LEGACY_CALLOUT_CASE(WAIT_MOVE, 2, WAIT_MOVE)
+				COB_LEGACY_CALLOUT_CASE(SLEEP, 0, SLEEP)
+				COB_LEGACY_CALLOUT_CASE(RAND, 0, RAND)
+				COB_LEGACY_CALLOUT_CASE(GET_UNIT_VALUE, 0, GET_UNIT_VALUE)
+				COB_LEGACY_CALLOUT_CASE(GET, 0, GET)
+				COB_LEGACY_CALLOUT_CASE(SET, 0, SET)
+				COB_LEGACY_CALLOUT_CASE(ATTACH, 0, ATTACH)
+				COB_LEGACY_CALLOUT_CASE(DROP, 0, DROP)
+				COB_LEGACY_CALLOUT_CASE(SIGNAL, 0, SIGNAL)
+				COB_LEGACY_CALLOUT_CASE(SET_SIGNAL_MASK, 0, SET_SIGNAL_MASK)
+				COB_LEGACY_CALLOUT_CASE(EXPLODE, 1, EXPLODE)
+				COB_LEGACY_CALLOUT_CASE(PLAY_SOUND, 1, PLAY_SOUND)
+				#undef COB_LEGACY_CALLOUT_CASE
+
+				default: {
+					return;
+				} break;
+			}
+		}
+
+		#undef GET_LONG_PC
+	}
+
+	// the decoded stream; CCobThread::Tick uses threaded dispatch where available
+	void RunDecoded(const CobScript& script, CCobProgram& program, int function, Machine& m) {
+		const CobInstruction* ip = program.GetInstruction(script.code, script.scriptOffsets[function]);
+
+		const auto Jump = [&]() {
+			return ((ip->target != nullptr)? ip->target: program.GetInstruction(script.code, ip->jumpPC));
+		};
+
+		for (m.Reset(script); m.steps < MAX_STEPS; ) {
+			int r1;
+			int r2;
+
+			switch (ip->op) {
+				case COB_OP_PUSH_CONSTANT: { m.Push(ip->a); m.steps += 1; ip += 1; } continue;
+				case COB_OP_PUSH_CONSTANT_2: { m.Push(ip->a); m.Push(ip->b); m.steps += 2; ip += 2; } continue;
+				case COB_OP_PUSH_LOCAL_VAR: { m.Push(m.Local(ip->a)); } break;
+				case COB_OP_POP_LOCAL_VAR: { r1 = m.Pop(); m.Local(ip->a) = r1; } break;
+				case COB_OP_PUSH_STATIC: { if (size_t(ip->a) < m.staticVars.size()) m.Push(m.staticVars[ip->a]); } break;
+				case COB_OP_POP_STATIC: { r1 = m.Pop(); m.Static(ip->a) = r1; } break;
+				case COB_OP_CREATE_LOCAL_VAR: { if (m.paramCount == 0) m.Push(0); else m.paramCount--; } break;
+				case COB_OP_POP_STACK: { m.Pop(); } break;
+				case COB_OP_BITWISE_NOT: { m.Push(~m.Pop()); } break;
+				case COB_OP_LOGICAL_NOT: { m.Push(m.Pop() == 0); } break;
+				case COB_OP_JUMP: { m.steps += 1; ip = Jump(); } continue;
+				case COB_OP_GOTO: { ip = Jump(); } continue;
+				case COB_OP_JUMP_NOT_EQUAL: { m.steps += 1; ip = (m.Pop() == 0)? Jump(): ip + 1; } continue;
+				case COB_OP_RETURN: {
+					m.Pop();
+					if ((r1 = m.Return()) == -1)
+						return;
+					m.steps += 1;
+					ip = program.GetInstruction(script.code, r1);
+				} continue;
+				case COB_OP_REAL_CALL: { m.Call(ip->pc, ip->b); m.steps += 1; ip = Jump(); } continue;
+				case COB_OP_LUA_CALL: case COB_OP_START: { m.PopN(ip->b); } break;
+
+				#define COB_DECODED_CONSTANT_CASE(name, binop) \
+				case COB_OP_##name##_CONSTANT: { r1 = m.Pop(); m.Push(r1 binop ip->a); m.steps += 2; ip += 2; } continue;
+				COB_CONSTANT_OPS(COB_DECODED_CONSTANT_CASE)
+				#undef COB_DECODED_CONSTANT_CASE
+
+				#define COB_DECODED_COMPARE_CASE(name, cmp)                                                                         \
+				case COB_OP_##name##_CONSTANT: { r1 = m.Pop(); m.Push(r1 cmp ip->a); m.steps += 2; ip += 2; } continue;          \
+				case COB_OP_##name##_JUMP: { r2 = m.Pop(); r1 = m.Pop(); m.steps += 2; ip = (r1 cmp r2)? ip + 2: Jump(); } continue; \
+				case COB_OP_##name##_CONSTANT_JUMP: { r1 = m.Pop(); m.steps += 3; ip = (r1 cmp ip->a)? ip + 3: Jump(); } continue;
+				COB_COMPARE_OPS(COB_DECODED_COMPARE_CASE)
+				#undef COB_DECODED_COMPARE_CASE
+
+				case COB_OP_UNKNOWN: {
+					return;
+				} break;
+				case COB_OP_OUT_OF_RANGE: {
+					(void) script.code.at(ip->pc);
+					return;
+				} break;
+
+				default: {
+					if (ExecCallout(m, ip->op))
+						break;
+
+					r2 = m.Pop();
+					r1 = m.Pop();
+					m.Push(ExecBinary(ip->op, r1, r2));
+				} break;
+			}
+
+			m.steps += 1;
+			ip += 1;
+		}
+	}
+
+
+	template<typename Run>
+	void RunAll(benchmark::State& state, Run&& run) {
+		Machine m;
+		int64_t steps = 0;
+
+		for (auto _ : state) {
+			for (CobScript& script: GetScripts()) {
+				for (size_t fn = 0; fn < script.scriptOffsets.size(); ++fn) {
+					try {
+						run(script, fn, m);
+					} catch (const std::out_of_range&) {
+					}
+
+					steps += m.steps;
+					benchmark::DoNotOptimize(m.dataStack.data());
+				}
+			}
+		}
+
+		state.counters["instructions"] = benchmark::Counter(steps, benchmark::Counter::kIsRate);
+	}
+}
+
+
+static void BenchCobDecode(benchmark::State& state) {
+	for (auto _ : state) {
+		for (const CobScript& script: GetScripts()) {
+			CCobProgram program;
+			program.Init(script.code, script.scriptNames, script.scriptOffsets, script.scriptLengths);
+			benchmark::DoNotOptimize(program.GetNumInstructions());
+		}
+	}
+}
+
+static void BenchCobLegacyLoop(benchmark::State& state) {
+	RunAll(state, [](const CobScript& script, int fn, Machine& m) { RunLegacy(script, fn, m); });
+}
+
+static void BenchCobDecodedStream(benchmark::State& state) {
+	std::vector<CCobProgram> programs(GetScripts().size());
+
+	for (size_t i = 0; i < programs.size(); ++i) {
+		const CobScript& s = GetScripts()[i];
+		programs[i].Init(s.code, s.scriptNames, s.scriptOffsets, s.scriptLengths);
+	}
+
+	// both loops have to agree on every function that finishes within MAX_STEPS
+	for (size_t i = 0; i < programs.size(); ++i) {
+		const CobScript& s = GetScripts()[i];
+
+		for (size_t fn = 0; fn < s.scriptOffsets.size(); ++fn) {
+			Machine a;
+			Machine b;
+
+			try { RunLegacy(s, fn, a); } catch (const std::out_of_range&) { continue; }
+			try { RunDecoded(s, programs[i], fn, b); } catch (const std::out_of_range&) { continue; }
+
+			if (a.steps >= MAX_STEPS || b.steps >= MAX_STEPS)
+				continue;
+			if (a.steps == b.steps && a.dataStack == b.dataStack)
+				continue;
+
+			state.SkipWithError(("decoded stream diverged in " + s.scriptNames[fn]).c_str());
+			return;
+		}
+	}
+
+	RunAll(state, [&](const CobScript& script, int fn, Machine& m) { RunDecoded(script, programs[&script - GetScripts().data()], fn, m); });
+}
+
+BENCHMARK(BenchCobDecode);
+BENCHMARK(BenchCobLegacyLoop);
+BENCHMARK(BenchCobDecodedStream);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,238 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/LoadSave/BlockCompressedSave.h"
+#include "System/Threading/ThreadPool.h"
+#include "System/Platform/Threading.h"
+#include "System/Misc/SpringTime.h"
+
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+struct do_once {
+	do_once() { Threading::DetectCores(); ThreadPool::SetThreadCount(ThreadPool::GetMaxThreads()); }
+};
+
+InitSpringTime ist;
+do_once doonce;
+
+
+static constexpr size_t CHUNK_SIZE = CChunkedOutputBuf::CHUNK_SIZE;
+
+static std::string GetContents(const CChunkedOutputBuf& buf)
+{
+	std::string str;
+
+	for (size_t i = 0, n = buf.GetNumChunks(); i < n; i++) {
+		str.append(buf.GetChunkData(i), buf.GetChunkSize(i));
+	}
+
+	return str;
+}
+
+static std::string MakeData(size_t size)
+{
+	std::string str(size, 0);
+
+	// compressible but not trivially so
+	for (size_t i = 0; i < size; i++) {
+		str[i] = char((i * 7 + (i >> 9)) & 0x7F);
+	}
+
+	return str;
+}
+
+static std::vector<std::uint8_t> Pack(const std::string& data)
+{
+	CChunkedOutputBuf buf;
+	std::ostream os(&buf);
+
+	os.write(data.data(), data.size());
+	return (BlockCompressedSave::Compress(buf, Z_BEST_SPEED));
+}
+
+
+
+TEST_CASE("ChunkedOutputBuf")
+{
+	SECTION("empty") {
+		CChunkedOutputBuf buf;
+		std::ostream os(&buf);
+
+		CHECK(os.tellp() == 0);
+		CHECK(buf.GetSize() == 0);
+		CHECK(buf.GetNumChunks() == 0);
+	}
+
+	SECTION("write across chunk boundaries") {
+		const std::string ref = MakeData(CHUNK_SIZE * 2 + 123);
+
+		CChunkedOutputBuf buf;
+		std::ostream os(&buf);
+
+		// mix of bulk writes and single characters
+		os.write(ref.data(), CHUNK_SIZE - 1);
+		os.put(ref[CHUNK_SIZE - 1]);
+		os.put(ref[CHUNK_SIZE]);
+		os.write(ref.data() + CHUNK_SIZE + 1, ref.size() - CHUNK_SIZE - 1);
+
+		CHECK(size_t(os.tellp()) == ref.size());
+		CHECK(buf.GetSize() == ref.size());
+		CHECK(buf.GetNumChunks() == 3);
+		CHECK(buf.GetChunkSize(2) == 123);
+		CHECK(GetContents(buf) == ref);
+	}
+
+	SECTION("seek back and overwrite across a chunk boundary") {
+		std::string ref = MakeData(CHUNK_SIZE + 4096);
+
+		CChunkedOutputBuf buf;
+		std::ostream os(&buf);
+
+		os.write(ref.data(), ref.size());
+
+		const std::string patch(64, 'X');
+		const size_t patchPos = CHUNK_SIZE - 32;
+
+		os.seekp(patchPos);
+		CHECK(size_t(os.tellp()) == patchPos);
+
+		os.write(patch.data(), patch.size());
+		ref.replace(patchPos, patch.size(), patch);
+
+		CHECK(size_t(os.tellp()) == patchPos + patch.size());
+		// overwriting must not shrink the buffer
+		CHECK(buf.GetSize() == ref.size());
+		CHECK(GetContents(buf) == ref);
+
+		// patch the header like SavePackage does, then continue at the end
+		os.seekp(0);
+		os.write("HEAD", 4);
+		ref.replace(0, 4, "HEAD");
+
+		os.seekp(0, std::ios_base::end);
+		CHECK(size_t(os.tellp()) == ref.size());
+
+		os.write("TAIL", 4);
+		ref += "TAIL";
+
+		CHECK(buf.GetSize() == ref.size());
+		CHECK(GetContents(buf) == ref);
+	}
+
+	SECTION("seek to the exact end of a full chunk") {
+		const std::string ref = MakeData(CHUNK_SIZE);
+
+		CChunkedOutputBuf buf;
+		std::ostream os(&buf);
+
+		os.write(ref.data(), ref.size());
+		os.seekp(0);
+		os.seekp(0, std::ios_base::end);
+
+		CHECK(size_t(os.tellp()) == CHUNK_SIZE);
+
+		os.put('!');
+
+		CHECK(buf.GetNumChunks() == 2);
+		CHECK(GetContents(buf) == ref + "!");
+	}
+
+	SECTION("seek past the end fails") {
+		CChunkedOutputBuf buf;
+		std::ostream os(&buf);
+
+		os.write("abcd", 4);
+		os.seekp(5);
+
+		CHECK(os.fail());
+	}
+}
+
+
+TEST_CASE("BlockCompressedSave")
+{
+	SECTION("round trip") {
+		for (const size_t size: {size_t(0), size_t(1), CHUNK_SIZE - 1, CHUNK_SIZE, CHUNK_SIZE * 3 + 17}) {
+			const std::string ref = MakeData(size);
+			const std::vector<std::uint8_t> file = Pack(ref);
+
+			std::string out = "garbage";
+
+			CHECK(BlockCompressedSave::HasMagic(file.data(), file.size()));
+			CHECK(BlockCompressedSave::Decompress(file.data(), file.size(), out));
+			CHECK(out == ref);
+		}
+	}
+
+	SECTION("legacy gzip saves are not detected") {
+		const std::string ref = MakeData(4096);
+
+		z_stream zs;
+		std::memset(&zs, 0, sizeof(zs));
+
+		// windowBits + 16 writes a gzip header, like CGZFileHandler reads
+		REQUIRE(deflateInit2(&zs, Z_BEST_SPEED, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+
+		std::vector<std::uint8_t> file(deflateBound(&zs, ref.size()));
+
+		zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(ref.data()));
+		zs.avail_in = ref.size();
+		zs.next_out = file.data();
+		zs.avail_out = file.size();
+
+		REQUIRE(deflate(&zs, Z_FINISH) == Z_STREAM_END);
+		file.resize(zs.total_out);
+		deflateEnd(&zs);
+
+		std::string out;
+
+		CHECK(!BlockCompressedSave::HasMagic(file.data(), file.size()));
+		CHECK(!BlockCompressedSave::Decompress(file.data(), file.size(), out));
+	}
+
+	SECTION("corrupt files are rejected") {
+		const std::string ref = MakeData(CHUNK_SIZE + 4096);
+		std::string out;
+
+		// header is {magic, version, blockSize, numBlocks}, followed by {rawSize, packedSize} per block
+		constexpr size_t BLOCK_SIZE_OFFSET = 8;
+		constexpr size_t FIRST_ENTRY = 16;
+
+		{
+			std::vector<std::uint8_t> file = Pack(ref);
+			CHECK(!BlockCompressedSave::Decompress(file.data(), file.size() - 1, out));
+		}
+		{
+			std::vector<std::uint8_t> file = Pack(ref);
+			file[file.size() - 3] ^= 0xFF;
+			CHECK(!BlockCompressedSave::Decompress(file.data(), file.size(), out));
+		}
+		{
+			// a block larger than blockSize must not be trusted for the allocation
+			std::vector<std::uint8_t> file = Pack(ref);
+			const std::uint8_t hugeSize[4] = {0xFF, 0xFF, 0xFF, 0x7F};
+
+			std::memcpy(file.data() + FIRST_ENTRY, hugeSize, sizeof(hugeSize));
+			CHECK(!BlockCompressedSave::Decompress(file.data(), file.size(), out));
+		}
+		{
+			// nor a block size other than the one the writer uses
+			std::vector<std::uint8_t> file = Pack(ref);
+			const std::uint8_t hugeBlockSize[4] = {0xFF, 0xFF, 0xFF, 0xFF};
+
+			std::memcpy(file.data() + BLOCK_SIZE_OFFSET, hugeBlockSize, sizeof(hugeBlockSize));
+			CHECK(!BlockCompressedSave::Decompress(file.data(), file.size(), out));
+		}
+		{
+			std::vector<std::uint8_t> file = Pack(ref);
+			CHECK(!BlockCompressedSave::Decompress(file.data(), 8, out));
+		}
+	}
+}
@@ -0,0 +1,118 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Net/Protocol/BaseNetProtocol.h"
+#include "System/GlobalConfig.h"
+#include "System/Net/RawPacket.h"
+#include "System/Net/UDPConnection.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+// sends batches of messages between two connections over the loopback interface,
+// sizes chosen to cover both chunk-packing of small messages and fragmentation
+// of messages that span several chunks
+static constexpr int PORT_A = 22456;
+static constexpr int PORT_B = 22457;
+
+struct ConnectionPair {
+	ConnectionPair(bool compression)
+		: a(PORT_A, "127.0.0.1", PORT_B)
+		, b(PORT_B, "127.0.0.1", PORT_A)
+	{
+		// the bandwidth limiter would dominate the measurement
+		globalConfig.linkOutgoingBandwidth = 0;
+		globalConfig.networkCompression = compression;
+
+		a.SetPeerCompression(compression);
+		b.SetPeerCompression(compression);
+		a.Unmute();
+		b.Unmute();
+	}
+
+	// returns the number of messages that arrived
+	size_t Exchange(const std::vector< std::shared_ptr<const netcode::RawPacket> >& msgs) {
+		for (const auto& msg: msgs) {
+			a.SendData(msg);
+		}
+
+		a.Flush(true);
+
+		size_t numRecv = 0;
+
+		for (int i = 0; i < 1000 && numRecv < msgs.size(); ++i) {
+			b.Update();
+
+			while (b.GetData() != nullptr) {
+				numRecv += 1;
+			}
+		}
+
+		// reply so both sides have traffic as in a game (a connection that never
+		// receives data keeps announcing itself as new), this also acks everything
+		// and lets the sender recycle its chunks
+		b.SendData(reply);
+		b.Flush(true);
+
+		for (int i = 0; i < 1000 && a.GetData() == nullptr; ++i) {
+			a.Update();
+		}
+
+		return numRecv;
+	}
+
+	netcode::UDPConnection a;
+	netcode::UDPConnection b;
+
+	std::shared_ptr<const netcode::RawPacket> reply{CBaseNetProtocol::Get().SendKeyFrame(0)};
+};
+
+
+static std::vector< std::shared_ptr<const netcode::RawPacket> > MakeMessages(size_t count, size_t msgSize)
+{
+	std::vector< std::shared_ptr<const netcode::RawPacket> > msgs;
+	msgs.reserve(count);
+
+	for (size_t i = 0; i < count; ++i) {
+		if (msgSize == 0) {
+			msgs.emplace_back(CBaseNetProtocol::Get().SendKeyFrame(i));
+		} else {
+			msgs.emplace_back(CBaseNetProtocol::Get().SendSystemMessage(0, std::string(msgSize, 'a' + (i % 26))));
+		}
+	}
+
+	return msgs;
+}
+
+static void BM_UDPConnectionExchange(benchmark::State& state)
+{
+	ConnectionPair pair(state.range(2) != 0);
+
+	const auto msgs = MakeMessages(state.range(0), state.range(1));
+
+	size_t numRecv = 0;
+	size_t numBytes = 0;
+
+	for (const auto& msg: msgs) {
+		numBytes += msg->length;
+	}
+
+	for (auto _: state) {
+		numRecv += pair.Exchange(msgs);
+	}
+
+	state.SetItemsProcessed(numRecv);
+	state.SetBytesProcessed(numBytes * state.iterations());
+	state.counters["lost"] = (msgs.size() * state.iterations()) - numRecv;
+	state.counters["wireBytes"] = benchmark::Counter(pair.b.GetDataReceived(), benchmark::Counter::kAvgIterations);
+}
+
+// {messages per batch, message size (0 = 5-byte keyframes), compression}
+BENCHMARK(BM_UDPConnectionExchange)
+	->ArgsProduct({{64}, {0, 100}, {0, 1}})
+	->ArgsProduct({{16}, {1000}, {0, 1}})
+	->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
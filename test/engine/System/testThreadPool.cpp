@@ -9,7 +9,9 @@
 
 #include <vector>
 #include <atomic>
+#include <functional>
 #include <future>
+#include <limits>
 
 #define CATCH_CONFIG_MAIN
 #include "lib/catch.hpp"
@@ -120,7 +122,7 @@ TEST_CASE("test_parallel_reduce")
 {
 	LOG("[%s::test_parallel_reduce]", __func__);
 
-	const auto ReduceFunc = [](int a, std::shared_ptr< std::future<int> >& b) -> int { return (a + (b.get())->get()); };
+	const auto ReduceFunc = [](int a, std::shared_future<int> b) -> int { return (a + b.get()); };
 	const auto TestFunc = []() -> int {
 		const int threadnum = ThreadPool::GetThreadNum();
 		SAFE_CHECK(threadnum >= 0);
@@ -256,6 +258,220 @@ TEST_CASE("test_for_vs_for_mt")
 }
 
 
+// the shared-counter scheme for_mt used before range stealing, for comparison
+template<typename F>
+class SharedCounterForTaskGroup: public ITaskGroup
+{
+public:
+	SharedCounterForTaskGroup(bool pooled) : ITaskGroup(false, pooled) {}
+
+	void Enqueue(const int from, const int to, F& func)
+	{
+		remainingTasks.store(to - from);
+		ctr.store(0);
+
+		this->from = from;
+		this->to   = to;
+		this->func = func;
+	}
+
+	bool IsSliceTask() const override { return true; }
+	bool ExecuteStep() override
+	{
+		const int i = from + ctr.fetch_add(1, std::memory_order_relaxed);
+
+		if (i < to) {
+			func(i);
+			remainingTasks -= 1;
+			return true;
+		}
+
+		return false;
+	}
+
+private:
+	std::atomic<int> ctr;
+	std::function<void(const int)> func;
+
+	int from;
+	int to;
+};
+
+template <typename F>
+static void shared_counter_for_mt(int start, int end, F&& f)
+{
+	static TaskPool<SharedCounterForTaskGroup, F> pool;
+	auto taskGroup = pool.GetTaskGroup();
+
+	taskGroup->Enqueue(start, end, f);
+	taskGroup->UpdateId();
+
+	for (size_t i = 1; i < ThreadPool::GetNumThreads(); ++i) {
+		taskGroup->wantedThread.store(i);
+		ThreadPool::PushTaskGroup(taskGroup);
+	}
+
+	ThreadPool::WaitForFinished(taskGroup);
+}
+
+// old for_mt_chunk; one static chunk per thread
+template <typename F>
+static void static_chunk_for_mt(int b, int e, F&& f)
+{
+	const int numThreads = ThreadPool::GetNumThreads();
+	const int chunkSize = (e - b) / numThreads + ((e - b) % numThreads != 0);
+
+	shared_counter_for_mt(0, numThreads, [&](const int jobId) {
+		const int bb = b + jobId * chunkSize;
+		const int ee = std::min(bb + chunkSize, e);
+
+		for (int i = bb; i < ee; ++i)
+			f(i);
+	});
+}
+
+
+// Stand-in for GroundMoveSystem collision handling: units created together have
+// consecutive ids and tend to stay together, so the number of neighbours each
+// unit is tested against (its cost) is high for runs of consecutive indices.
+static std::vector<int> MakeClusteredCosts(int numUnits, int numClusters, int clusterSize, int clusterCost)
+{
+	std::vector<int> costs(numUnits, 1);
+	CGlobalUnsyncedRNG rng;
+	rng.Seed(numUnits);
+
+	for (int c = 0; c < numClusters; c++) {
+		const int b = rng.NextInt(numUnits - clusterSize);
+
+		for (int i = b; i < b + clusterSize; i++) {
+			costs[i] = clusterCost;
+		}
+	}
+
+	return costs;
+}
+
+static void for_mt_schedulers_kernel(const char* name, const std::vector<int>& costs, int numRuns)
+{
+	std::vector<float> results(costs.size(), 0.0f);
+
+	const auto Kernel = [&](const int i) {
+		float r = 0.0f;
+
+		for (int k = 0; k < costs[i] * 64; k++) {
+			r += math::sqrt(float(k + i));
+		}
+
+		results[i] = r;
+	};
+	const auto TimeLoop = [&](const auto& loop) {
+		const spring_time start = spring_now();
+
+		for (int n = 0; n < numRuns; n++) {
+			loop();
+		}
+
+		return ((spring_now() - start).toMilliSecsf() / numRuns);
+	};
+
+	const int numElems = costs.size();
+
+	const float tFor = TimeLoop([&]() { for (int i = 0; i < numElems; i++) Kernel(i); });
+	const float tShared = TimeLoop([&]() { shared_counter_for_mt(0, numElems, Kernel); });
+	const float tStatic = TimeLoop([&]() { static_chunk_for_mt(0, numElems, Kernel); });
+	const float tForMT = TimeLoop([&]() { for_mt(0, numElems, Kernel); });
+	const float tChunk = TimeLoop([&]() { for_mt_chunk(0, numElems, Kernel, 16); });
+
+	LOG("\t[%s] %s (%d elements, %d threads)", __func__, name, numElems, ThreadPool::GetNumThreads());
+	LOG("\t\tfor                  %.4fms", tFor);
+	LOG("\t\tshared-counter for_mt %.4fms (%.0f%%)", tShared, (tShared / tFor) * 100.0f);
+	LOG("\t\tstatic-chunk for_mt   %.4fms (%.0f%%)", tStatic, (tStatic / tFor) * 100.0f);
+	LOG("\t\tfor_mt               %.4fms (%.0f%%)", tForMT, (tForMT / tFor) * 100.0f);
+	LOG("\t\tfor_mt_chunk(16)     %.4fms (%.0f%%)", tChunk, (tChunk / tFor) * 100.0f);
+}
+
+// every index in [start, end) with stride <step> must be visited exactly once,
+// however the range-stealing ForTaskGroup splits and hands out the chunks
+static void for_mt_visits_aux(int start, int end, int step, const std::vector<int>& costs, const std::function<void(const std::function<void(int)>&)>& loop)
+{
+	std::vector<std::atomic<int>> visits(end);
+	std::atomic<float> sink = {0.0f};
+
+	for (auto& v: visits) {
+		v = 0;
+	}
+
+	loop([&](const int i) {
+		float r = 0.0f;
+
+		// skew the per-index work so that threads steal from each other
+		for (int k = 0, n = costs[i % costs.size()] * 16; k < n; k++) {
+			r += math::sqrt(float(k + i));
+		}
+
+		sink = r;
+		visits[i]++;
+	});
+
+	int numWrong = 0;
+
+	for (int i = 0; i < end; i++) {
+		const int expected = (i >= start && ((i - start) % step) == 0);
+		numWrong += (visits[i] != expected);
+	}
+
+	CHECK(numWrong == 0);
+}
+
+TEST_CASE("test_for_mt_visits")
+{
+	LOG("[%s::test_for_mt_visits]", __func__);
+
+	ThreadPool::SetThreadCount(NUM_THREADS);
+
+	const std::vector<int> uniformCosts(1, 1);
+	const std::vector<int> clusteredCosts = MakeClusteredCosts(5000, 3, 200, 100);
+
+	SECTION("skewed") {
+		for (const auto* costs: {&uniformCosts, &clusteredCosts}) {
+			for_mt_visits_aux(0, 5000, 1, *costs, [&](const auto& f) { for_mt(0, 5000, f); });
+			for_mt_visits_aux(0, 1, 1, *costs, [&](const auto& f) { for_mt(0, 1, f); });
+			for_mt_visits_aux(0, NUM_THREADS + 1, 1, *costs, [&](const auto& f) { for_mt(0, NUM_THREADS + 1, f); });
+		}
+	}
+
+	SECTION("stepped") {
+		for (const int step: {2, 3, 7, 64}) {
+			for_mt_visits_aux(   0, 5000, step, clusteredCosts, [&](const auto& f) { for_mt(   0, 5000, step, f); });
+			for_mt_visits_aux(  13, 4999, step, clusteredCosts, [&](const auto& f) { for_mt(  13, 4999, step, f); });
+			for_mt_visits_aux(4990, 5000, step, clusteredCosts, [&](const auto& f) { for_mt(4990, 5000, step, f); });
+		}
+	}
+
+	SECTION("grains") {
+		const std::pair<int, int> grains[] = {{1, 1}, {4, 16}, {64, 64}, {100, 1000}, {1000, std::numeric_limits<int>::max()}, {10000, 10000}};
+
+		for (const auto& [minGrain, maxGrain]: grains) {
+			for_mt_visits_aux(0, 5000, 1, clusteredCosts, [&](const auto& f) { for_mt_chunk(0, 5000, f, minGrain, maxGrain); });
+			for_mt_visits_aux(7, 4001, 1, clusteredCosts, [&](const auto& f) { for_mt_chunk(7, 4001, f, minGrain, maxGrain); });
+			for_mt_visits_aux(5, 5000, 3, clusteredCosts, [&](const auto& f) { for_mt(5, 5000, 3, f, minGrain, maxGrain); });
+		}
+	}
+}
+
+TEST_CASE("test_for_mt_schedulers", "[.][benchmark]")
+{
+	LOG("[%s::test_for_mt_schedulers]", __func__);
+
+	ThreadPool::SetThreadCount(NUM_THREADS);
+
+	for_mt_schedulers_kernel("uniform cheap", std::vector<int>(20000, 1), 50);
+	for_mt_schedulers_kernel("uniform heavy", std::vector<int>(2000, 50), 20);
+	for_mt_schedulers_kernel("clustered", MakeClusteredCosts(5000, 4, 100, 200), 20);
+	for_mt_schedulers_kernel("single cluster", MakeClusteredCosts(5000, 1, 250, 200), 20);
+}
+
+
 static void test_parallel_reaction_times_aux(int numRuns)
 {
 	LOG("\t[%s]", __func__);
@@ -31,10 +31,11 @@ no console output (you still could use this.exe > z.tzt though).
 	DEFINE_bool  (playerstats,  false, "Print playerstats");
 	DEFINE_bool  (teamstats,    false, "Print teamstats");
 	DEFINE_int32 (team,         -1,    "Select team");
+	DEFINE_int32 (frame,        -1,    "Start dumping at the last indexed keyframe before this frame");
 	DEFINE_string(teamsstatcsv, "",    "Write teamstats in a csv file");
 
 
-void TrafficDump(CDemoReader& reader, bool trafficStats);
+void TrafficDump(CDemoReader& reader, bool trafficStats, int frame);
 void WriteTeamstatHistory(CDemoReader& reader, unsigned team, const std::string& file);
 
 int main (int argc, char* argv[])
@@ -56,7 +57,22 @@ int main (int argc, char* argv[])
 	reader.LoadStats();
 	if (FLAGS_dump)
 	{
-		TrafficDump(reader, true);
+		int frame = -1;
+		if (FLAGS_frame >= 0)
+		{
+			const DemoKeyFrame* keyFrame = nullptr;
+			if (reader.LoadKeyFrameIndex())
+				keyFrame = reader.GetKeyFrame(FLAGS_frame);
+			if (keyFrame != nullptr && reader.SeekToKeyFrame(*keyFrame, 0.0f)) {
+				// TrafficDump numbers frame messages from 0 and increments before printing;
+				// frameNum counts the keyframe's own message, so that one is number frameNum - 1
+				const int keyFrameMsgNum = keyFrame->frameNum - 1;
+				frame = keyFrameMsgNum - 1;
+			} else {
+				std::cout << "No keyframe before frame " << FLAGS_frame << ", dumping from the start" << std::endl;
+			}
+		}
+		TrafficDump(reader, true, frame);
 		return 0;
 	}
 	if (!FLAGS_teamsstatcsv.empty())
@@ -74,6 +90,8 @@ int main (int argc, char* argv[])
 		wstringstream buf;
 		buf << reader.GetFileHeader();
 		std::wcout << buf.str();
+		if (reader.LoadKeyFrameIndex())
+			std::wcout << L"Keyframes: " << reader.GetKeyFrames().size() << L" (every " << reader.GetKeyFramePeriod() << L" frames)" << std::endl;
 	}
 	if (FLAGS_playerstats || FLAGS_stats)
 	{
@@ -190,11 +208,10 @@ void PrintBinary(const unsigned char* const buf, int len)
 	std::cout << std::dec; //reset to decimal
 }
 
-void TrafficDump(CDemoReader& reader, bool trafficStats)
+void TrafficDump(CDemoReader& reader, bool trafficStats, int frame)
 {
 	InitCommandNames();
 	std::vector<unsigned> trafficCounter(NETMSG_LAST, 0);
-	int frame = -1;
 	int cmdId = 0;
 	while (!reader.ReachedEnd())
 	{